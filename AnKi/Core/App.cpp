@@ -13,6 +13,7 @@
 #include <AnKi/Util/System.h>
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/NameTable.h>
 #include <AnKi/Core/CoreTracer.h>
 #include <AnKi/Core/GpuMemory/RebarTransientMemoryPool.h>
 #include <AnKi/Core/GpuMemory/GpuVisibleTransientMemoryPool.h>
@@ -49,16 +50,51 @@ static StatCounter g_cpuAllocatedMemStatVar(StatCategory::kCpuMem, "Total", Stat
 static StatCounter g_cpuAllocationCountStatVar(StatCategory::kCpuMem, "Allocations/frame", StatFlag::kBytes | StatFlag::kZeroEveryFrame);
 static StatCounter g_cpuFreesCountStatVar(StatCategory::kCpuMem, "Frees/frame", StatFlag::kBytes | StatFlag::kZeroEveryFrame);
 
+/// The StatCounters of a TrackedMemoryPool.
+class MemoryPoolStatCounters
+{
+public:
+	StatCounter m_liveBytes;
+	StatCounter m_peakBytes;
+	StatCounter m_allocations;
+};
+
+MemoryPoolStatCounters& App::getMemoryPoolStatCounters(TrackedMemoryPool pool)
+{
+	// Constructed on first use so they are registered only if the MemoryPoolTelemetry CVar is on
+	static Array<MemoryPoolStatCounters, U32(TrackedMemoryPool::kCount)> counters = {{
+#define ANKI_TRACKED_MEMORY_POOL(name) \
+	{{StatCategory::kCpuMem, #name " pool", StatFlag::kBytes | StatFlag::kMainThreadUpdates}, \
+	 {StatCategory::kCpuMem, #name " pool peak", StatFlag::kBytes | StatFlag::kMainThreadUpdates}, \
+	 {StatCategory::kCpuMem, #name " pool allocations/frame", StatFlag::kMainThreadUpdates}},
+#include <AnKi/Core/TrackedMemoryPools.def.h>
+	}};
+
+	return counters[pool];
+}
+
 NumericCVar<U32> g_windowWidthCVar(CVarSubsystem::kCore, "Width", 1920, 16, 16 * 1024, "Width");
 NumericCVar<U32> g_windowHeightCVar(CVarSubsystem::kCore, "Height", 1080, 16, 16 * 1024, "Height");
 NumericCVar<U32> g_windowFullscreenCVar(CVarSubsystem::kCore, "WindowFullscreen", 1, 0, 2,
 										"0: windowed, 1: borderless fullscreen, 2: exclusive fullscreen");
 NumericCVar<U32> g_targetFpsCVar(CVarSubsystem::kCore, "TargetFps", 60u, 1u, kMaxU32, "Target FPS");
-static NumericCVar<U32> g_jobThreadCountCVar(CVarSubsystem::kCore, "JobThreadCount", max(2u, getCpuCoresCount() / 2u), 2u, 1024u,
-											 "Number of job thread");
+static NumericCVar<U32> g_jobThreadCountCVar(CVarSubsystem::kCore, "JobThreadCount", 0u, 0u, 1024u,
+											 "Number of job threads. 0: One per physical core");
+static NumericCVar<U32> g_jobThreadPlacementCVar(CVarSubsystem::kCore, "JobThreadPlacement", (ANKI_OS_ANDROID) ? 0 : 3, 0,
+												 U32(ThreadPlacementPolicy::kCount) - 1,
+												 "Pinning of the job threads. 0: None, 1: Compact, 2: Scatter, 3: Skip SMT siblings");
 NumericCVar<U32> g_displayStatsCVar(CVarSubsystem::kCore, "DisplayStats", 0, 0, 2, "Display stats, 0: None, 1: Simple, 2: Detailed");
 BoolCVar g_clearCachesCVar(CVarSubsystem::kCore, "ClearCaches", false, "Clear all caches");
 BoolCVar g_verboseLogCVar(CVarSubsystem::kCore, "VerboseLog", false, "Verbose logging");
+static BoolCVar g_asyncLogCVar(CVarSubsystem::kCore, "AsyncLog", false,
+							   "Log through per-thread ring buffers drained by a background thread so the threads that log don't block");
+static StringCVar g_binaryLogCaptureCVar(CVarSubsystem::kCore, "BinaryLogCapture", "",
+										"Capture the log, the trace events and the counters to this binary file. Decode it with BinaryLogDecoder");
+static BoolCVar g_threadCachedMemoryPoolsCVar(CVarSubsystem::kCore, "ThreadCachedMemoryPools", false,
+											 "Serve the small allocations of the default and core memory pools from per-thread caches");
+static BoolCVar g_memoryPoolTelemetryCVar(CVarSubsystem::kCore, "MemoryPoolTelemetry", false,
+										  "Track the live bytes, the peak, the allocation sizes and the allocation rate of the memory of every "
+										  "subsystem");
 BoolCVar g_benchmarkModeCVar(CVarSubsystem::kCore, "BenchmarkMode", false, "Run in a benchmark mode. Fixed timestep, unlimited target FPS");
 NumericCVar<U32> g_benchmarkModeFrameCountCVar(CVarSubsystem::kCore, "BenchmarkModeFrameCount", 60 * 60 * 2, 1, kMaxU32,
 											   "How many frames the benchmark will run before it quits");
@@ -143,6 +179,8 @@ App::~App()
 
 void App::cleanup()
 {
+	logMemoryPoolTelemetry();
+
 	SceneGraph::freeSingleton();
 	ScriptManager::freeSingleton();
 	MainRenderer::freeSingleton();
@@ -167,11 +205,19 @@ void App::cleanup()
 
 	GlobalFrameIndex::freeSingleton();
 
+	if(BinaryLog::isCapturing())
+	{
+		BinaryLog::getSingleton().endCapture();
+	}
+
 	m_settingsDir.destroy();
 	m_cacheDir.destroy();
 
+	NameTable::freeSingleton();
 	CoreMemoryPool::freeSingleton();
 	DefaultMemoryPool::freeSingleton();
+
+	Logger::getSingleton().enableAsync(false);
 }
 
 Error App::init()
@@ -190,16 +236,28 @@ Error App::initInternal()
 {
 	StatsSet::getSingleton().initFromMainThread();
 	Logger::getSingleton().enableVerbosity(g_verboseLogCVar.get());
+	Logger::getSingleton().enableAsync(g_asyncLogCVar.get());
 
 	AllocAlignedCallback allocCb = m_originalAllocCallback;
 	void* allocCbUserData = m_originalAllocUserData;
 	initMemoryCallbacks(allocCb, allocCbUserData);
 
-	DefaultMemoryPool::allocateSingleton(allocCb, allocCbUserData);
-	CoreMemoryPool::allocateSingleton(allocCb, allocCbUserData);
+	AllocAlignedCallback coreAllocCb = allocCb;
+	void* coreAllocCbUserData = allocCbUserData;
+	trackMemoryPool(TrackedMemoryPool::kCore, coreAllocCb, coreAllocCbUserData);
+
+	const HeapMemoryPoolMode poolMode = (g_threadCachedMemoryPoolsCVar.get()) ? HeapMemoryPoolMode::kThreadCached : HeapMemoryPoolMode::kPassthrough;
+	DefaultMemoryPool::allocateSingleton(coreAllocCb, coreAllocCbUserData, poolMode);
+	CoreMemoryPool::allocateSingleton(coreAllocCb, coreAllocCbUserData, poolMode);
+	NameTable::allocateSingleton();
 
 	ANKI_CHECK(initDirs());
 
+	if(!g_binaryLogCaptureCVar.get().isEmpty())
+	{
+		ANKI_CHECK(BinaryLog::getSingleton().beginCapture(g_binaryLogCaptureCVar.get().cstr()));
+	}
+
 	// Print a message
 	const char* buildType =
 #if ANKI_OPTIMIZE
@@ -237,7 +295,16 @@ Error App::initInternal()
 	}
 #endif
 
-	ANKI_CORE_LOGI("Number of job threads: %u", g_jobThreadCountCVar.get());
+	// The topology can't be queried when the CVars are constructed so the default is resolved here
+	U32 jobThreadCount = g_jobThreadCountCVar.get();
+	if(jobThreadCount == 0)
+	{
+		CpuTopology topology;
+		getCpuTopology(topology);
+		jobThreadCount = max(2u, topology.m_physicalCoreCount);
+	}
+
+	ANKI_CORE_LOGI("Number of job threads: %u", jobThreadCount);
 
 	if(g_benchmarkModeCVar.get() && g_vsyncCVar.get())
 	{
@@ -277,8 +344,7 @@ Error App::initInternal()
 	//
 	// ThreadPool
 	//
-	const Bool pinThreads = !ANKI_OS_ANDROID;
-	CoreThreadJobManager::allocateSingleton(g_jobThreadCountCVar.get(), pinThreads);
+	CoreThreadJobManager::allocateSingleton(jobThreadCount, ThreadPlacementPolicy(g_jobThreadPlacementCVar.get()));
 
 	//
 	// Graphics API
@@ -286,6 +352,7 @@ Error App::initInternal()
 	GrManagerInitInfo grInit;
 	grInit.m_allocCallback = allocCb;
 	grInit.m_allocCallbackUserData = allocCbUserData;
+	trackMemoryPool(TrackedMemoryPool::kGr, grInit.m_allocCallback, grInit.m_allocCallbackUserData);
 	grInit.m_cacheDirectory = m_cacheDir.toCString();
 	ANKI_CHECK(GrManager::allocateSingleton().init(grInit));
 
@@ -311,8 +378,11 @@ Error App::initInternal()
 	//
 	// Physics
 	//
+	AllocAlignedCallback physicsAllocCb = allocCb;
+	void* physicsAllocCbUserData = allocCbUserData;
+	trackMemoryPool(TrackedMemoryPool::kPhysics, physicsAllocCb, physicsAllocCbUserData);
 	PhysicsWorld::allocateSingleton();
-	ANKI_CHECK(PhysicsWorld::getSingleton().init(allocCb, allocCbUserData));
+	ANKI_CHECK(PhysicsWorld::getSingleton().init(physicsAllocCb, physicsAllocCbUserData));
 
 	//
 	// Resources
@@ -331,12 +401,18 @@ Error App::initInternal()
 	g_dataPathsCVar.set(extraPaths);
 #endif
 
-	ANKI_CHECK(ResourceManager::allocateSingleton().init(allocCb, allocCbUserData));
+	AllocAlignedCallback resourceAllocCb = allocCb;
+	void* resourceAllocCbUserData = allocCbUserData;
+	trackMemoryPool(TrackedMemoryPool::kResource, resourceAllocCb, resourceAllocCbUserData);
+	ANKI_CHECK(ResourceManager::allocateSingleton().init(resourceAllocCb, resourceAllocCbUserData));
 
 	//
 	// UI
 	//
-	ANKI_CHECK(UiManager::allocateSingleton().init(allocCb, allocCbUserData));
+	AllocAlignedCallback uiAllocCb = allocCb;
+	void* uiAllocCbUserData = allocCbUserData;
+	trackMemoryPool(TrackedMemoryPool::kUi, uiAllocCb, uiAllocCbUserData);
+	ANKI_CHECK(UiManager::allocateSingleton().init(uiAllocCb, uiAllocCbUserData));
 
 	//
 	// GPU scene
@@ -350,17 +426,24 @@ Error App::initInternal()
 	renderInit.m_swapchainSize = UVec2(NativeWindow::getSingleton().getWidth(), NativeWindow::getSingleton().getHeight());
 	renderInit.m_allocCallback = allocCb;
 	renderInit.m_allocCallbackUserData = allocCbUserData;
+	trackMemoryPool(TrackedMemoryPool::kRenderer, renderInit.m_allocCallback, renderInit.m_allocCallbackUserData);
 	ANKI_CHECK(MainRenderer::allocateSingleton().init(renderInit));
 
 	//
 	// Script
 	//
-	ScriptManager::allocateSingleton(allocCb, allocCbUserData);
+	AllocAlignedCallback scriptAllocCb = allocCb;
+	void* scriptAllocCbUserData = allocCbUserData;
+	trackMemoryPool(TrackedMemoryPool::kScript, scriptAllocCb, scriptAllocCbUserData);
+	ScriptManager::allocateSingleton(scriptAllocCb, scriptAllocCbUserData);
 
 	//
 	// Scene
 	//
-	ANKI_CHECK(SceneGraph::allocateSingleton().init(allocCb, allocCbUserData));
+	AllocAlignedCallback sceneAllocCb = allocCb;
+	void* sceneAllocCbUserData = allocCbUserData;
+	trackMemoryPool(TrackedMemoryPool::kScene, sceneAllocCb, sceneAllocCbUserData);
+	ANKI_CHECK(SceneGraph::allocateSingleton().init(sceneAllocCb, sceneAllocCbUserData));
 
 	ANKI_CORE_LOGI("Application initialized");
 
@@ -448,6 +531,9 @@ Error App::mainLoop()
 
 			ANKI_CHECK(SceneGraph::getSingleton().update(prevUpdateTime, crntTime));
 
+			// Pick up the files that were added or deleted from the data paths
+			ANKI_CHECK(ResourceManager::getSingleton().getFilesystem().updateFileIndex());
+
 			// Render
 			TexturePtr presentableTex = GrManager::getSingleton().acquireNextPresentableTexture();
 			ANKI_CHECK(MainRenderer::getSingleton().render(presentableTex.get()));
@@ -515,6 +601,7 @@ Error App::mainLoop()
 			}
 #endif
 
+			updateMemoryPoolTelemetry();
 			StatsSet::getSingleton().endFrame();
 
 			++GlobalFrameIndex::getSingleton().m_value;
@@ -555,6 +642,105 @@ void App::initMemoryCallbacks(AllocAlignedCallback& allocCb, void*& allocCbUserD
 	}
 }
 
+void App::trackMemoryPool(TrackedMemoryPool pool, AllocAlignedCallback& allocCb, void*& allocCbUserData)
+{
+	if(!g_memoryPoolTelemetryCVar.get())
+	{
+		return;
+	}
+
+	constexpr Array<const Char*, U32(TrackedMemoryPool::kCount)> kNames = {
+#define ANKI_TRACKED_MEMORY_POOL(name) #name,
+#include <AnKi/Core/TrackedMemoryPools.def.h>
+	};
+
+	getMemoryPoolStatCounters(pool);
+
+	MemoryPoolTelemetry& telemetry = m_memoryPoolTelemetry[pool];
+	telemetry.init(allocCb, allocCbUserData, kNames[pool]);
+
+	for(U32 bucket = 0; bucket < MemoryPoolTelemetry::kHistogramBucketCount; ++bucket)
+	{
+		Array<Char, 48>& name = m_memoryPoolHistogramCounterNames[pool][bucket];
+		snprintf(name.getBegin(), name.getSize(), "c%sPoolAllocationsOf%zuB", kNames[pool],
+				 max<PtrSize>(1, MemoryPoolTelemetry::getHistogramBucketMinSize(bucket)));
+	}
+
+	allocCb = MemoryPoolTelemetry::allocCallback;
+	allocCbUserData = &telemetry;
+}
+
+void App::updateMemoryPoolTelemetry()
+{
+	if(!g_memoryPoolTelemetryCVar.get())
+	{
+		return;
+	}
+
+	for(MemoryPoolTelemetry& telemetry : m_memoryPoolTelemetry)
+	{
+		if(telemetry.isInitialized())
+		{
+			telemetry.endFrame();
+		}
+	}
+
+	// The StatsSet and the per-frame counters of the CoreTracer
+#define ANKI_TRACKED_MEMORY_POOL(name) \
+	{ \
+		const MemoryPoolTelemetry& telemetry = m_memoryPoolTelemetry[TrackedMemoryPool::k##name]; \
+		MemoryPoolStatCounters& counters = getMemoryPoolStatCounters(TrackedMemoryPool::k##name); \
+		counters.m_liveBytes.set(telemetry.getLiveBytes()); \
+		counters.m_peakBytes.set(telemetry.getPeakBytes()); \
+		counters.m_allocations.set(telemetry.getFrameAllocationCount()); \
+		ANKI_TRACE_INC_COUNTER(name##PoolLiveBytes, telemetry.getLiveBytes()); \
+		ANKI_TRACE_INC_COUNTER(name##PoolPeakBytes, telemetry.getPeakBytes()); \
+		ANKI_TRACE_INC_COUNTER(name##PoolAllocations, telemetry.getFrameAllocationCount()); \
+	}
+#include <AnKi/Core/TrackedMemoryPools.def.h>
+
+#if ANKI_TRACING_ENABLED
+	for(U32 pool = 0; pool < U32(TrackedMemoryPool::kCount); ++pool)
+	{
+		Array<U64, MemoryPoolTelemetry::kHistogramBucketCount> histogram;
+		m_memoryPoolTelemetry[pool].getFrameHistogram(histogram);
+		for(U32 bucket = 0; bucket < MemoryPoolTelemetry::kHistogramBucketCount; ++bucket)
+		{
+			if(histogram[bucket])
+			{
+				Tracer::getSingleton().incrementCounter(m_memoryPoolHistogramCounterNames[pool][bucket].getBegin(), histogram[bucket]);
+			}
+		}
+	}
+#endif
+}
+
+void App::logMemoryPoolTelemetry() const
+{
+	for(const MemoryPoolTelemetry& telemetry : m_memoryPoolTelemetry)
+	{
+		if(!telemetry.isInitialized())
+		{
+			continue;
+		}
+
+		ANKI_CORE_LOGI("%s memory: live %zu KB, peak %zu KB, %" PRIu64 " allocations", telemetry.getName(), telemetry.getLiveBytes() / 1024,
+					   telemetry.getPeakBytes() / 1024, telemetry.getAllocationCount());
+
+		Array<U64, MemoryPoolTelemetry::kHistogramBucketCount> histogram;
+		telemetry.getHistogram(histogram);
+		for(U32 bucket = 0; bucket < MemoryPoolTelemetry::kHistogramBucketCount; ++bucket)
+		{
+			if(histogram[bucket])
+			{
+				const F64 percent = F64(histogram[bucket]) / F64(telemetry.getAllocationCount()) * 100.0;
+				ANKI_CORE_LOGI("\t>= %zu bytes: %" PRIu64 " allocations (%.2f%%)", MemoryPoolTelemetry::getHistogramBucketMinSize(bucket),
+							   histogram[bucket], percent);
+			}
+		}
+	}
+}
+
 Bool App::toggleDeveloperConsole()
 {
 	SceneNode& node = SceneGraph::getSingleton().findSceneNode("_DevConsole");
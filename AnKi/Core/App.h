@@ -8,6 +8,7 @@
 #include <AnKi/Core/CVarSet.h>
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/Ptr.h>
+#include <AnKi/Util/MemoryPoolTelemetry.h>
 #include <AnKi/Ui/UiImmediateModeBuilder.h>
 
 namespace anki {
@@ -16,6 +17,7 @@ namespace anki {
 class UiQueueElement;
 class RenderQueue;
 class StatCounter;
+class MemoryPoolStatCounters;
 extern NumericCVar<U32> g_windowWidthCVar;
 extern NumericCVar<U32> g_windowHeightCVar;
 extern NumericCVar<U32> g_windowFullscreenCVar;
@@ -71,10 +73,34 @@ private:
 	void* m_originalAllocUserData = nullptr;
 	AllocAlignedCallback m_originalAllocCallback = nullptr;
 
+	/// The subsystems that have their own MemoryPoolTelemetry.
+	enum class TrackedMemoryPool : U8
+	{
+#define ANKI_TRACKED_MEMORY_POOL(name) k##name,
+#include <AnKi/Core/TrackedMemoryPools.def.h>
+
+		kCount
+	};
+
+	/// Only initialized if the MemoryPoolTelemetry CVar is on.
+	Array<MemoryPoolTelemetry, U32(TrackedMemoryPool::kCount)> m_memoryPoolTelemetry;
+
+	/// The CoreTracer counter names of the histograms of m_memoryPoolTelemetry.
+	Array2d<Array<Char, 48>, U32(TrackedMemoryPool::kCount), MemoryPoolTelemetry::kHistogramBucketCount> m_memoryPoolHistogramCounterNames;
+
+	static MemoryPoolStatCounters& getMemoryPoolStatCounters(TrackedMemoryPool pool);
+
 	static void* statsAllocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment);
 
 	void initMemoryCallbacks(AllocAlignedCallback& allocCb, void*& allocCbUserData);
 
+	/// Put a MemoryPoolTelemetry between a subsystem and the allocation callback if the MemoryPoolTelemetry CVar is on.
+	void trackMemoryPool(TrackedMemoryPool pool, AllocAlignedCallback& allocCb, void*& allocCbUserData);
+
+	void updateMemoryPoolTelemetry();
+
+	void logMemoryPoolTelemetry() const;
+
 	Error initInternal();
 
 	Error initDirs();
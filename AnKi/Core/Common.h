@@ -24,8 +24,8 @@ class CoreMemoryPool : public HeapMemoryPool, public MakeSingleton<CoreMemoryPoo
 	friend class MakeSingleton;
 
 private:
-	CoreMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData)
-		: HeapMemoryPool(allocCb, allocCbUserData, "CoreMemPool")
+	CoreMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, HeapMemoryPoolMode mode = HeapMemoryPoolMode::kPassthrough)
+		: HeapMemoryPool(allocCb, allocCbUserData, "CoreMemPool", mode)
 	{
 	}
 
@@ -38,8 +38,8 @@ class CoreThreadJobManager : public ThreadJobManager, public MakeSingleton<CoreT
 	friend class MakeSingleton;
 
 public:
-	CoreThreadJobManager(U32 threadCount, Bool pinToCores = false)
-		: ThreadJobManager(threadCount, pinToCores)
+	CoreThreadJobManager(U32 threadCount, ThreadPlacementPolicy placement = ThreadPlacementPolicy::kNone)
+		: ThreadJobManager(threadCount, placement)
 	{
 	}
 };
@@ -22,6 +22,11 @@ static StatCounter g_gpuSceneBufferFragmentationStatVar(StatCategory::kGpuMem, "
 static NumericCVar<PtrSize> g_gpuSceneInitialSizeCVar(CVarSubsystem::kCore, "GpuSceneInitialSize", 64_MB, 16_MB, 2_GB,
 													  "Global memory for the GPU scene");
 
+static NumericCVar<PtrSize> g_gpuSceneCompactionBudgetCVar(CVarSubsystem::kCore, "GpuSceneCompactionBudget", 1_MB, 0, 64_MB,
+															 "The bytes the GPU scene compaction can move every frame. 0 disables it");
+static NumericCVar<F32> g_gpuSceneCompactionThresholdCVar(CVarSubsystem::kCore, "GpuSceneCompactionThreshold", 0.3f, 0.0f, 1.0f,
+														  "The GPU scene fragmentation that triggers the compaction");
+
 void GpuSceneBuffer::init()
 {
 	const PtrSize poolSize = g_gpuSceneInitialSizeCVar.get();
@@ -37,6 +42,16 @@ void GpuSceneBuffer::init()
 	deferredFree(alloc);
 }
 
+void GpuSceneBuffer::endFrame()
+{
+	m_pool.endFrame();
+	m_pool.compact(g_gpuSceneCompactionBudgetCVar.get(), g_gpuSceneCompactionThresholdCVar.get());
+
+#if ANKI_STATS_ENABLED
+	updateStats();
+#endif
+}
+
 void GpuSceneBuffer::updateStats() const
 {
 	F32 externalFragmentation;
@@ -96,6 +111,7 @@ void GpuSceneMicroPatcher::newCopy(StackMemoryPool& frameCpuPool, PtrSize gpuSce
 		m_crntFramePatchHeaders = DynamicArray<PatchHeader, MemoryPoolPtrWrapper<StackMemoryPool>>(&frameCpuPool);
 		m_crntFramePatchData = DynamicArray<U32, MemoryPoolPtrWrapper<StackMemoryPool>>(&frameCpuPool);
 	}
+	ANKI_ASSERT(&m_crntFramePatchData.getMemoryPool() == &frameCpuPool && "All the copies of a frame should use the same pool");
 
 	while(patchIt < patchEnd)
 	{
@@ -59,6 +59,19 @@ public:
 		return U32(m_token.m_size);
 	}
 
+	/// Call it from a relocation callback. If it's the allocation that moved it will point to the new place.
+	/// @return True if it's the allocation that moved.
+	Bool relocate(const SegregatedListsGpuMemoryPoolToken& oldToken, const SegregatedListsGpuMemoryPoolToken& newToken)
+	{
+		if(!isValid() || !(m_token == oldToken))
+		{
+			return false;
+		}
+
+		m_token = newToken;
+		return true;
+	}
+
 private:
 	SegregatedListsGpuMemoryPoolToken m_token;
 };
@@ -83,19 +96,23 @@ public:
 		return alloc;
 	}
 
-	void deferredFree(GpuSceneBufferAllocation& alloc)
+	/// Allocate memory that the compaction is allowed to move. The callback is called when that happens and it should use
+	/// GpuSceneBufferAllocation::relocate().
+	GpuSceneBufferAllocation allocate(PtrSize size, U32 alignment, SegregatedListsGpuMemoryPoolRelocationCallback callback, void* callbackUserData)
 	{
-		m_pool.deferredFree(alloc.m_token);
+		GpuSceneBufferAllocation alloc;
+		m_pool.allocate(size, alignment, alloc.m_token, callback, callbackUserData);
+		return alloc;
 	}
 
-	void endFrame()
+	void deferredFree(GpuSceneBufferAllocation& alloc)
 	{
-		m_pool.endFrame();
-#if ANKI_STATS_ENABLED
-		updateStats();
-#endif
+		m_pool.deferredFree(alloc.m_token);
 	}
 
+	/// Frees the garbage and runs a step of the compaction.
+	void endFrame();
+
 	Buffer& getBuffer() const
 	{
 		return m_pool.getGpuBuffer();
@@ -135,6 +152,8 @@ public:
 	Error init();
 
 	/// Copy data for the GPU scene to a staging buffer.
+	/// @param frameCpuPool The staging data of the whole frame is allocated from the pool of the 1st call so all calls should pass the same pool
+	///                     and it should be thread-safe. Don't pass per-thread pools.
 	/// @note It's thread-safe.
 	void newCopy(StackMemoryPool& frameCpuPool, PtrSize gpuSceneDestOffset, PtrSize dataSize, const void* data);
 
@@ -15,6 +15,11 @@ static StatCounter g_unifiedGeomBufferTotalStatVar(StatCategory::kGpuMem, "UGB t
 static StatCounter g_unifiedGeomBufferFragmentationStatVar(StatCategory::kGpuMem, "UGB fragmentation",
 														   StatFlag::kFloat | StatFlag::kMainThreadUpdates);
 
+static NumericCVar<PtrSize> g_unifiedGeometryBufferCompactionBudgetCVar(CVarSubsystem::kCore, "UnifiedGeometryBufferCompactionBudget", 1_MB, 0,
+																		   64_MB, "The bytes the UGB compaction can move every frame. 0 disables it");
+static NumericCVar<F32> g_unifiedGeometryBufferCompactionThresholdCVar(CVarSubsystem::kCore, "UnifiedGeometryBufferCompactionThreshold", 0.3f, 0.0f,
+																	   1.0f, "The UGB fragmentation that triggers the compaction");
+
 static NumericCVar<PtrSize> g_unifiedGometryBufferSizeCvar(CVarSubsystem::kCore, "UnifiedGeometryBufferSize", 128_MB, 16_MB, 2_GB,
 														   "Global index and vertex buffer size");
 
@@ -39,6 +44,16 @@ void UnifiedGeometryBuffer::init()
 	deferredFree(alloc);
 }
 
+void UnifiedGeometryBuffer::endFrame()
+{
+	m_pool.endFrame();
+	m_pool.compact(g_unifiedGeometryBufferCompactionBudgetCVar.get(), g_unifiedGeometryBufferCompactionThresholdCVar.get());
+
+#if ANKI_STATS_ENABLED
+	updateStats();
+#endif
+}
+
 void UnifiedGeometryBuffer::updateStats() const
 {
 	F32 externalFragmentation;
@@ -7,6 +7,7 @@
 
 #include <AnKi/Core/Common.h>
 #include <AnKi/Gr/Utils/SegregatedListsGpuMemoryPool.h>
+#include <numeric>
 
 namespace anki {
 
@@ -67,6 +68,20 @@ public:
 		return m_fakeAllocatedSize;
 	}
 
+	/// Call it from a relocation callback. If it's the allocation that moved it will point to the new place.
+	/// @return True if it's the allocation that moved.
+	Bool relocate(const SegregatedListsGpuMemoryPoolToken& oldToken, const SegregatedListsGpuMemoryPoolToken& newToken)
+	{
+		if(!isValid() || !(m_token == oldToken))
+		{
+			return false;
+		}
+
+		m_fakeOffset = U32(newToken.m_offset + (m_fakeOffset - m_token.m_offset));
+		m_token = newToken;
+		return true;
+	}
+
 private:
 	SegregatedListsGpuMemoryPoolToken m_token;
 	U32 m_fakeOffset = kMaxU32; ///< In some allocations with weird alignments we need a different offset.
@@ -89,23 +104,16 @@ public:
 	/// The alignment doesn't need to be power of 2 unlike other allocators.
 	UnifiedGeometryBufferAllocation allocate(PtrSize size, U32 alignment)
 	{
-		ANKI_ASSERT(size && alignment);
-
-		const U32 fixedAlignment = max(4u, nextPowerOfTwo(alignment)); // Fix the alignment and make sure it's at least 4
-		const U32 fixedSize = getAlignedRoundUp(4u, U32(size) + alignment); // Over-allocate and align to 4 because some cmd buffer ops need it
-		ANKI_ASSERT(fixedSize >= size);
-
-		UnifiedGeometryBufferAllocation out;
-		m_pool.allocate(fixedSize, fixedAlignment, out.m_token);
-
-		const U32 remainder = out.m_token.m_offset % alignment;
-		out.m_fakeOffset = U32(out.m_token.m_offset + (alignment - remainder));
-		ANKI_ASSERT(isAligned(alignment, out.m_fakeOffset));
-
-		out.m_fakeAllocatedSize = U32(size);
-		ANKI_ASSERT(PtrSize(out.m_fakeOffset) + out.m_fakeAllocatedSize <= out.m_token.m_offset + out.m_token.m_size);
+		return allocateInternal(size, alignment, nullptr, nullptr);
+	}
 
-		return out;
+	/// Allocate memory that the compaction is allowed to move. The callback is called when that happens and it should use
+	/// UnifiedGeometryBufferAllocation::relocate().
+	UnifiedGeometryBufferAllocation allocate(PtrSize size, U32 alignment, SegregatedListsGpuMemoryPoolRelocationCallback callback,
+											 void* callbackUserData)
+	{
+		ANKI_ASSERT(callback);
+		return allocateInternal(size, alignment, callback, callbackUserData);
 	}
 
 	/// Allocate a vertex buffer.
@@ -115,6 +123,14 @@ public:
 		return allocate(texelSize * count, texelSize);
 	}
 
+	/// Allocate a vertex buffer that the compaction is allowed to move.
+	UnifiedGeometryBufferAllocation allocateFormat(Format format, U32 count, SegregatedListsGpuMemoryPoolRelocationCallback callback,
+												   void* callbackUserData)
+	{
+		const U32 texelSize = getFormatInfo(format).m_texelSize;
+		return allocate(texelSize * count, texelSize, callback, callbackUserData);
+	}
+
 	void deferredFree(UnifiedGeometryBufferAllocation& alloc)
 	{
 		m_pool.deferredFree(alloc.m_token);
@@ -122,13 +138,8 @@ public:
 		alloc.m_fakeOffset = kMaxU32;
 	}
 
-	void endFrame()
-	{
-		m_pool.endFrame();
-#if ANKI_STATS_ENABLED
-		updateStats();
-#endif
-	}
+	/// Frees the garbage and runs a step of the compaction.
+	void endFrame();
 
 	Buffer& getBuffer() const
 	{
@@ -147,6 +158,37 @@ private:
 
 	~UnifiedGeometryBuffer() = default;
 
+	UnifiedGeometryBufferAllocation allocateInternal(PtrSize size, U32 alignment, SegregatedListsGpuMemoryPoolRelocationCallback callback,
+													 void* callbackUserData)
+	{
+		ANKI_ASSERT(size && alignment);
+
+		// Fix the alignment and make sure it's at least 4. Relocatable allocations need an offset that is a multiple of the alignment so that the
+		// distance from the real to the fake offset is the same wherever the compaction places them
+		const U32 fixedAlignment = (callback) ? std::lcm(4u, alignment) : max(4u, nextPowerOfTwo(alignment));
+		const U32 fixedSize = getAlignedRoundUp(4u, U32(size) + alignment); // Over-allocate and align to 4 because some cmd buffer ops need it
+		ANKI_ASSERT(fixedSize >= size);
+
+		UnifiedGeometryBufferAllocation out;
+		if(callback)
+		{
+			m_pool.allocate(fixedSize, fixedAlignment, out.m_token, callback, callbackUserData);
+		}
+		else
+		{
+			m_pool.allocate(fixedSize, fixedAlignment, out.m_token);
+		}
+
+		const U32 remainder = out.m_token.m_offset % alignment;
+		out.m_fakeOffset = U32(out.m_token.m_offset + (alignment - remainder));
+		ANKI_ASSERT(isAligned(alignment, out.m_fakeOffset));
+
+		out.m_fakeAllocatedSize = U32(size);
+		ANKI_ASSERT(PtrSize(out.m_fakeOffset) + out.m_fakeAllocatedSize <= out.m_token.m_offset + out.m_token.m_size);
+
+		return out;
+	}
+
 	void updateStats() const;
 };
 
@@ -0,0 +1,17 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+// The subsystems that get a MemoryPoolTelemetry when the MemoryPoolTelemetry CVar is on. It's ANKI_TRACKED_MEMORY_POOL(name)
+
+ANKI_TRACKED_MEMORY_POOL(Core)
+ANKI_TRACKED_MEMORY_POOL(Gr)
+ANKI_TRACKED_MEMORY_POOL(Physics)
+ANKI_TRACKED_MEMORY_POOL(Resource)
+ANKI_TRACKED_MEMORY_POOL(Ui)
+ANKI_TRACKED_MEMORY_POOL(Renderer)
+ANKI_TRACKED_MEMORY_POOL(Script)
+ANKI_TRACKED_MEMORY_POOL(Scene)
+
+#undef ANKI_TRACKED_MEMORY_POOL
@@ -15,7 +15,7 @@ Bool GraphicsStateTracker::updateHashes()
 	{
 		if(m_staticState.m_vert.m_activeAttribs.getAnySet())
 		{
-			m_hashes.m_vert = 0xC0FEE;
+			StreamingHasher hasher(0xC0FEE);
 
 			for(VertexAttributeSemantic i : EnumIterable<VertexAttributeSemantic>())
 			{
@@ -25,12 +25,14 @@ Bool GraphicsStateTracker::updateHashes()
 				}
 
 				ANKI_ASSERT(m_staticState.m_vert.m_attribsSetMask.get(i) && "Forgot to set the vert attribute");
-				m_hashes.m_vert = appendObjectHash(m_staticState.m_vert.m_attribs[i], m_hashes.m_vert);
+				hasher.appendObject(m_staticState.m_vert.m_attribs[i]);
 
 				ANKI_ASSERT(m_staticState.m_vert.m_bindingsSetMask.get(m_staticState.m_vert.m_attribs[i].m_binding)
 							&& "Forgot to inform about the vert binding");
-				m_hashes.m_vert = appendObjectHash(m_staticState.m_vert.m_bindings[m_staticState.m_vert.m_attribs[i].m_binding], m_hashes.m_vert);
+				hasher.appendObject(m_staticState.m_vert.m_bindings[m_staticState.m_vert.m_attribs[i].m_binding]);
 			}
+
+			m_hashes.m_vert = hasher.getHash();
 		}
 		else
 		{
@@ -64,18 +66,20 @@ Bool GraphicsStateTracker::updateHashes()
 		const Bool hasDepth =
 			m_staticState.m_misc.m_depthStencilFormat != Format::kNone && getFormatInfo(m_staticState.m_misc.m_depthStencilFormat).isDepth();
 
-		m_hashes.m_depthStencil = 0xC0FEE;
+		StreamingHasher hasher(0xC0FEE);
 
 		if(hasStencil)
 		{
-			m_hashes.m_depthStencil = appendObjectHash(m_staticState.m_stencil, m_hashes.m_depthStencil);
+			hasher.appendObject(m_staticState.m_stencil);
 		}
 
 		if(hasDepth)
 		{
-			m_hashes.m_depthStencil = appendObjectHash(m_staticState.m_depth, m_hashes.m_depthStencil);
+			hasher.appendObject(m_staticState.m_depth);
 		}
 
+		m_hashes.m_depthStencil = hasher.getHash();
+
 		someHashWasDirty = true;
 	}
 
@@ -83,15 +87,17 @@ Bool GraphicsStateTracker::updateHashes()
 	{
 		if(m_staticState.m_misc.m_colorRtMask.getAnySet())
 		{
-			m_hashes.m_blend = m_staticState.m_blend.m_alphaToCoverage;
+			StreamingHasher hasher(m_staticState.m_blend.m_alphaToCoverage);
 
 			for(U32 i = 0; i < kMaxColorRenderTargets; ++i)
 			{
 				if(m_staticState.m_misc.m_colorRtMask.get(i))
 				{
-					m_hashes.m_blend = appendObjectHash(m_staticState.m_blend.m_colorRts[i], m_hashes.m_blend);
+					hasher.appendObject(m_staticState.m_blend.m_colorRts[i]);
 				}
 			}
+
+			m_hashes.m_blend = hasher.getHash();
 		}
 		else
 		{
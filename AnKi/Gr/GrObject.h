@@ -62,6 +62,11 @@ public:
 		return m_refcount.fetchSub(1);
 	}
 
+	I32 getRefcount() const
+	{
+		return m_refcount.load();
+	}
+
 	/// A unique identifier for caching objects.
 	U64 getUuid() const
 	{
@@ -155,10 +155,10 @@ public:
 class RenderGraph::Batch
 {
 public:
-	DynamicArray<U32, MemoryPoolPtrWrapper<StackMemoryPool>> m_passIndices;
-	DynamicArray<TextureBarrier, MemoryPoolPtrWrapper<StackMemoryPool>> m_textureBarriersBefore;
-	DynamicArray<BufferBarrier, MemoryPoolPtrWrapper<StackMemoryPool>> m_bufferBarriersBefore;
-	DynamicArray<ASBarrier, MemoryPoolPtrWrapper<StackMemoryPool>> m_asBarriersBefore;
+	SmallDynamicArray<U32, 8, MemoryPoolPtrWrapper<StackMemoryPool>> m_passIndices;
+	SmallDynamicArray<TextureBarrier, 8, MemoryPoolPtrWrapper<StackMemoryPool>> m_textureBarriersBefore;
+	SmallDynamicArray<BufferBarrier, 8, MemoryPoolPtrWrapper<StackMemoryPool>> m_bufferBarriersBefore;
+	SmallDynamicArray<ASBarrier, 2, MemoryPoolPtrWrapper<StackMemoryPool>> m_asBarriersBefore;
 
 	Batch(StackMemoryPool* pool)
 		: m_passIndices(pool)
@@ -1094,9 +1094,19 @@ void RenderGraph::recordAndSubmitCommandBuffers(FencePtr* optionalFence)
 	ANKI_TRACE_SCOPED_EVENT(GrRenderGraphRecordAndSubmit);
 	ANKI_ASSERT(m_ctx);
 
-	const U32 batchGroupCount = min(CoreThreadJobManager::getSingleton().getThreadCount(), m_ctx->m_batches.getSize());
+	const U32 threadCount = CoreThreadJobManager::getSingleton().getThreadCount();
+	const U32 batchGroupCount = min(threadCount, m_ctx->m_batches.getSize());
 	StackMemoryPool* pool = m_ctx->m_rts.getMemoryPool().m_pool;
 
+	// The waiting thread might run tasks as well so it needs an arena
+	if(m_recordArenas.getThreadCount() != threadCount + 1) [[unlikely]]
+	{
+		m_recordArenas.destroy();
+		m_recordArenas.init(GrMemoryPool::getSingleton().getAllocationCallback(), GrMemoryPool::getSingleton().getAllocationCallbackUserData(),
+							threadCount + 1, 64_KB, "RenderGraphRecordArena");
+	}
+	m_recordArenas.newFrame();
+
 	DynamicArray<CommandBufferPtr, MemoryPoolPtrWrapper<StackMemoryPool>> cmdbs(pool);
 	cmdbs.resize(batchGroupCount);
 	SpinLock cmdbsMtx;
@@ -1112,9 +1122,11 @@ void RenderGraph::recordAndSubmitCommandBuffers(FencePtr* optionalFence)
 		}
 
 		CoreThreadJobManager::getSingleton().dispatchTask(
-			[this, start, end, pool, &cmdbs, &cmdbsMtx, group, batchGroupCount]([[maybe_unused]] U32 tid) {
+			[this, start, end, &cmdbs, &cmdbsMtx, group, batchGroupCount](U32 tid) {
 				ANKI_TRACE_SCOPED_EVENT(GrRenderGraphTask);
 
+				StackMemoryPool* threadPool = &m_recordArenas.getArena(tid);
+
 				Array<Char, 32> name;
 				snprintf(name.getBegin(), name.getSize(), "RenderGraph cmdb %u-%u", start, end);
 				CommandBufferInitInfo cmdbInit(name.getBegin());
@@ -1161,7 +1173,7 @@ void RenderGraph::recordAndSubmitCommandBuffers(FencePtr* optionalFence)
 					const Batch& batch = m_ctx->m_batches[i];
 
 					// Set the barriers
-					DynamicArray<TextureBarrierInfo, MemoryPoolPtrWrapper<StackMemoryPool>> texBarriers(pool);
+					DynamicArray<TextureBarrierInfo, MemoryPoolPtrWrapper<StackMemoryPool>> texBarriers(threadPool);
 					texBarriers.resizeStorage(batch.m_textureBarriersBefore.getSize());
 					for(const TextureBarrier& barrier : batch.m_textureBarriersBefore)
 					{
@@ -1172,7 +1184,7 @@ void RenderGraph::recordAndSubmitCommandBuffers(FencePtr* optionalFence)
 						inf.m_textureView = TextureView(&tex, barrier.m_subresource);
 					}
 
-					DynamicArray<BufferBarrierInfo, MemoryPoolPtrWrapper<StackMemoryPool>> buffBarriers(pool);
+					DynamicArray<BufferBarrierInfo, MemoryPoolPtrWrapper<StackMemoryPool>> buffBarriers(threadPool);
 					buffBarriers.resizeStorage(batch.m_bufferBarriersBefore.getSize());
 					for(const BufferBarrier& barrier : batch.m_bufferBarriersBefore)
 					{
@@ -1188,7 +1200,7 @@ void RenderGraph::recordAndSubmitCommandBuffers(FencePtr* optionalFence)
 						return a.m_bufferView.getBuffer().getUuid() < b.m_bufferView.getBuffer().getUuid();
 					});
 
-					DynamicArray<AccelerationStructureBarrierInfo, MemoryPoolPtrWrapper<StackMemoryPool>> asBarriers(pool);
+					DynamicArray<AccelerationStructureBarrierInfo, MemoryPoolPtrWrapper<StackMemoryPool>> asBarriers(threadPool);
 					for(const ASBarrier& barrier : batch.m_asBarriersBefore)
 					{
 						AccelerationStructureBarrierInfo& inf = *asBarriers.emplaceBack();
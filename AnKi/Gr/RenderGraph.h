@@ -12,6 +12,8 @@
 #include <AnKi/Gr/CommandBuffer.h>
 #include <AnKi/Gr/AccelerationStructure.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SmallDynamicArray.h>
+#include <AnKi/Util/FrameArenas.h>
 #include <AnKi/Util/BitSet.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Util/Function.h>
@@ -295,9 +297,10 @@ protected:
 
 	Function<void(RenderPassWorkContext&), MemoryPoolPtrWrapper<StackMemoryPool>> m_callback;
 
-	DynamicArray<RenderPassDependency, MemoryPoolPtrWrapper<StackMemoryPool>> m_rtDeps;
-	DynamicArray<RenderPassDependency, MemoryPoolPtrWrapper<StackMemoryPool>> m_buffDeps;
-	DynamicArray<RenderPassDependency, MemoryPoolPtrWrapper<StackMemoryPool>> m_asDeps;
+	// Most passes have a handful of dependencies so keep them inline and avoid the allocations
+	SmallDynamicArray<RenderPassDependency, 8, MemoryPoolPtrWrapper<StackMemoryPool>> m_rtDeps;
+	SmallDynamicArray<RenderPassDependency, 4, MemoryPoolPtrWrapper<StackMemoryPool>> m_buffDeps;
+	SmallDynamicArray<RenderPassDependency, 2, MemoryPoolPtrWrapper<StackMemoryPool>> m_asDeps;
 
 	BitSet<kMaxRenderGraphRenderTargets, U64> m_readRtMask{false};
 	BitSet<kMaxRenderGraphRenderTargets, U64> m_writeRtMask{false};
@@ -574,6 +577,8 @@ private:
 	BakeContext* m_ctx = nullptr;
 	U64 m_version = 0;
 
+	FrameArenas m_recordArenas; ///< Scratch memory of the command buffer recording tasks, one arena per job thread.
+
 	static constexpr U kMaxBufferedTimestamps = kMaxFramesInFlight + 1;
 	class
 	{
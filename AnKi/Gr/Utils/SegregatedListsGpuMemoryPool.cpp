@@ -9,6 +9,9 @@
 
 namespace anki {
 
+static constexpr PtrSize kMaxBinnedSize = 1_KB;
+static constexpr U32 kBlocksPerBin = 128;
+
 class SegregatedListsGpuMemoryPool::Chunk : public SegregatedListsAllocatorBuilderChunkBase<SingletonMemoryPoolWrapper<GrMemoryPool>>
 {
 public:
@@ -72,8 +75,11 @@ void SegregatedListsGpuMemoryPool::init(BufferUsageBit gpuBufferUsage, ConstWeak
 	m_builder = newInstance<Builder>(GrMemoryPool::getSingleton());
 	m_builder->getInterface().m_parent = this;
 
+	// Small allocations (GPU scene objects mostly) come from many threads at once. Serve them from the lock-free bins of the builder
+	m_builder->initBins(min<PtrSize>(kMaxBinnedSize, classUpperSizes.getBack()), kBlocksPerBin);
+
 	m_frame = 0;
-	m_allocatedSize = 0;
+	m_allocatedSize.setNonAtomically(0);
 	m_allowCoWs = allowCoWs;
 	m_mapAccess = map;
 }
@@ -100,6 +106,8 @@ void SegregatedListsGpuMemoryPool::destroy()
 		}
 	}
 
+	m_relocatables.destroy();
+
 	deleteInstance(GrMemoryPool::getSingleton(), m_builder);
 	m_gpuBuffer.reset(nullptr);
 
@@ -121,7 +129,10 @@ Error SegregatedListsGpuMemoryPool::allocateChunk(Chunk*& newChunk, PtrSize& chu
 		buffInit.m_size = m_initialBufferSize;
 		buffInit.m_usage = m_bufferUsage | BufferUsageBit::kAllTransfer;
 		buffInit.m_mapAccess = m_mapAccess;
-		m_gpuBuffer = GrManager::getSingleton().newBuffer(buffInit);
+		BufferPtr newBuffer = GrManager::getSingleton().newBuffer(buffInit);
+
+		LockGuard lock(m_lock);
+		m_gpuBuffer = newBuffer;
 
 		if(!!m_mapAccess)
 		{
@@ -179,6 +190,7 @@ Error SegregatedListsGpuMemoryPool::allocateChunk(Chunk*& newChunk, PtrSize& chu
 		newChunk->m_offsetInGpuBuffer = m_gpuBuffer->getSize();
 
 		// Switch the buffers
+		LockGuard lock(m_lock);
 		m_gpuBuffer = newBuffer;
 
 		if(!!m_mapAccess)
@@ -208,8 +220,6 @@ void SegregatedListsGpuMemoryPool::allocate(PtrSize size, U32 alignment, Segrega
 	ANKI_ASSERT(size > 0 && alignment > 0);
 	ANKI_ASSERT(token == SegregatedListsGpuMemoryPoolToken());
 
-	LockGuard lock(m_lock);
-
 	Chunk* chunk;
 	PtrSize offset;
 	const Error err = m_builder->allocate(size, alignment, chunk, offset);
@@ -223,7 +233,24 @@ void SegregatedListsGpuMemoryPool::allocate(PtrSize size, U32 alignment, Segrega
 	token.m_offset = offset + chunk->m_offsetInGpuBuffer;
 	token.m_size = size;
 
-	m_allocatedSize += size;
+	m_allocatedSize.fetchAdd(size);
+}
+
+void SegregatedListsGpuMemoryPool::allocate(PtrSize size, U32 alignment, SegregatedListsGpuMemoryPoolToken& token,
+											SegregatedListsGpuMemoryPoolRelocationCallback callback, void* callbackUserData)
+{
+	ANKI_ASSERT(callback);
+	allocate(size, alignment, token);
+
+	Relocatable reloc;
+	reloc.m_token = token;
+	reloc.m_callback = callback;
+	reloc.m_callbackUserData = callbackUserData;
+	reloc.m_alignment = alignment;
+
+	LockGuard lock(m_lock);
+	ANKI_ASSERT(m_relocatables.find(token.m_offset) == m_relocatables.getEnd());
+	m_relocatables.emplace(token.m_offset, reloc);
 }
 
 void SegregatedListsGpuMemoryPool::deferredFree(SegregatedListsGpuMemoryPoolToken& token)
@@ -238,6 +265,15 @@ void SegregatedListsGpuMemoryPool::deferredFree(SegregatedListsGpuMemoryPoolToke
 	{
 		LockGuard lock(m_lock);
 		m_garbage[m_frame].emplaceBack(token);
+
+		if(!m_relocatables.isEmpty())
+		{
+			auto it = m_relocatables.find(token.m_offset);
+			if(it != m_relocatables.getEnd())
+			{
+				m_relocatables.erase(it);
+			}
+		}
 	}
 
 	token = {};
@@ -247,30 +283,173 @@ void SegregatedListsGpuMemoryPool::endFrame()
 {
 	ANKI_ASSERT(isInitialized());
 
-	LockGuard lock(m_lock);
-
-	m_frame = (m_frame + 1) % kMaxFramesInFlight;
+	GrDynamicArray<SegregatedListsGpuMemoryPoolToken> garbage;
+	{
+		LockGuard lock(m_lock);
+		m_frame = (m_frame + 1) % kMaxFramesInFlight;
+		garbage = std::move(m_garbage[m_frame]);
+	}
 
-	// Throw out the garbage
-	for(SegregatedListsGpuMemoryPoolToken& token : m_garbage[m_frame])
+	// Throw out the garbage. Do it outside m_lock since the builder might take it to switch the GPU buffer
+	for(SegregatedListsGpuMemoryPoolToken& token : garbage)
 	{
 		m_builder->free(static_cast<Chunk*>(token.m_chunk), token.m_chunkOffset, token.m_size);
 
-		ANKI_ASSERT(m_allocatedSize >= token.m_size);
-		m_allocatedSize -= token.m_size;
+		[[maybe_unused]] const PtrSize prevAllocatedSize = m_allocatedSize.fetchSub(token.m_size);
+		ANKI_ASSERT(prevAllocatedSize >= token.m_size);
+	}
+}
+
+PtrSize SegregatedListsGpuMemoryPool::compact(PtrSize maxBytesToMove, F32 minFragmentation)
+{
+	ANKI_ASSERT(isInitialized());
+
+	if(maxBytesToMove == 0)
+	{
+		return 0;
+	}
+
+	{
+		LockGuard lock(m_lock);
+		if(!m_gpuBuffer.isCreated() || m_relocatables.isEmpty())
+		{
+			return 0;
+		}
 	}
 
-	m_garbage[m_frame].destroy();
+	// Check the free lists first. Flushing the bins empties the caches of the fast path so do that only if there is work to do. The blocks that sit
+	// in the bins don't count as free so it's an estimate but it's good enough to decide
+	if(m_builder->computeExternalFragmentation() < minFragmentation)
+	{
+		return 0;
+	}
+
+	// Give the blocks that the bins hold back to the free lists or they will hide free space
+	m_builder->flushBins();
+
+	// Gather the candidates
+	GrDynamicArray<Relocatable> candidates;
+	{
+		LockGuard lock(m_lock);
+
+		candidates.resizeStorage(U32(m_relocatables.getSize()));
+		for(const Relocatable& reloc : m_relocatables)
+		{
+			candidates.emplaceBack(reloc);
+		}
+	}
+
+	// The allocations at the end are the ones that keep the free space apart
+	std::sort(candidates.getBegin(), candidates.getEnd(), [](const Relocatable& a, const Relocatable& b) {
+		return a.m_token.m_offset > b.m_token.m_offset;
+	});
+
+	constexpr U32 kMaxFailedMoves = 16;
+	U32 failedMoves = 0;
+	PtrSize bytesMoved = 0;
+	GrDynamicArray<CopyBufferToBufferInfo> copies;
+	for(const Relocatable& reloc : candidates)
+	{
+		const SegregatedListsGpuMemoryPoolToken& oldToken = reloc.m_token;
+		if(bytesMoved + oldToken.m_size > maxBytesToMove)
+		{
+			continue;
+		}
+
+		// Compaction shouldn't grow the buffer so use the free space only
+		Chunk* chunk = nullptr;
+		PtrSize chunkOffset = 0;
+		if(m_builder->allocateWithoutNewChunk(oldToken.m_size, reloc.m_alignment, chunk, chunkOffset) == Error::kNone
+		   && chunkOffset + chunk->m_offsetInGpuBuffer >= oldToken.m_offset)
+		{
+			// Didn't find a better place
+			m_builder->free(chunk, chunkOffset, oldToken.m_size);
+			chunk = nullptr;
+		}
+
+		if(chunk == nullptr)
+		{
+			if(++failedMoves == kMaxFailedMoves)
+			{
+				break;
+			}
+
+			continue;
+		}
+
+		SegregatedListsGpuMemoryPoolToken newToken;
+		newToken.m_chunk = chunk;
+		newToken.m_chunkOffset = chunkOffset;
+		newToken.m_offset = chunkOffset + chunk->m_offsetInGpuBuffer;
+		newToken.m_size = oldToken.m_size;
+		m_allocatedSize.fetchAdd(newToken.m_size);
+
+		copies.emplaceBack(CopyBufferToBufferInfo{oldToken.m_offset, newToken.m_offset, newToken.m_size});
+		bytesMoved += newToken.m_size;
+
+		{
+			LockGuard lock(m_lock);
+
+			auto it = m_relocatables.find(oldToken.m_offset);
+			ANKI_ASSERT(it != m_relocatables.getEnd());
+			m_relocatables.erase(it);
+
+			Relocatable newReloc = reloc;
+			newReloc.m_token = newToken;
+			m_relocatables.emplace(newToken.m_offset, newReloc);
+
+			// The GPU might still be using the old memory
+			m_garbage[m_frame].emplaceBack(oldToken);
+		}
+
+		reloc.m_callback(reloc.m_callbackUserData, oldToken, newToken);
+	}
+
+	if(copies.getSize() == 0)
+	{
+		return 0;
+	}
+
+	ANKI_GR_LOGV("Compacting %s: moving %zu bytes in %u allocations", m_bufferName.cstr(), bytesMoved, copies.getSize());
+
+	// Other threads might have grown the buffer in the meantime. The offsets stay the same in the new buffer
+	BufferPtr gpuBuffer;
+	{
+		LockGuard lock(m_lock);
+		gpuBuffer = m_gpuBuffer;
+	}
+
+	// Do the copies. The new and the old places never overlap since the old ones are still allocated
+	CommandBufferInitInfo cmdbInit("SegregatedListsGpuMemoryPool compaction");
+	cmdbInit.m_flags = CommandBufferFlag::kSmallBatch;
+	CommandBufferPtr cmdb = GrManager::getSingleton().newCommandBuffer(cmdbInit);
+
+	BufferBarrierInfo barrier;
+	barrier.m_bufferView = BufferView(gpuBuffer.get());
+	barrier.m_previousUsage = m_bufferUsage;
+	barrier.m_nextUsage = BufferUsageBit::kAllTransfer;
+	cmdb->setPipelineBarrier({}, {&barrier, 1}, {});
+
+	cmdb->copyBufferToBuffer(gpuBuffer.get(), gpuBuffer.get(), copies);
+
+	barrier.m_previousUsage = BufferUsageBit::kAllTransfer;
+	barrier.m_nextUsage = m_bufferUsage;
+	cmdb->setPipelineBarrier({}, {&barrier, 1}, {});
+
+	cmdb->endRecording();
+	GrManager::getSingleton().submit(cmdb.get());
+
+	return bytesMoved;
 }
 
 void SegregatedListsGpuMemoryPool::getStats(F32& externalFragmentation, PtrSize& userAllocatedSize, PtrSize& totalSize) const
 {
 	ANKI_ASSERT(isInitialized());
 
-	LockGuard lock(m_lock);
-
 	externalFragmentation = m_builder->computeExternalFragmentation();
-	userAllocatedSize = m_allocatedSize;
+	userAllocatedSize = m_allocatedSize.load();
+
+	LockGuard lock(m_lock);
 	totalSize = (m_gpuBuffer) ? m_gpuBuffer->getSize() : 0;
 }
 
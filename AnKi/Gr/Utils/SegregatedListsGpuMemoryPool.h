@@ -6,6 +6,7 @@
 #pragma once
 
 #include <AnKi/Util/SegregatedListsAllocatorBuilder.h>
+#include <AnKi/Util/HashMap.h>
 #include <AnKi/Gr/Buffer.h>
 
 namespace anki {
@@ -40,6 +41,12 @@ private:
 	PtrSize m_chunkOffset = kMaxPtrSize;
 };
 
+/// Called when SegregatedListsGpuMemoryPool::compact() moves an allocation. The owner of the allocation should replace the old token with the new
+/// one and patch whatever holds the old offset. The contents have already been copied when the new offset is used by the GPU.
+/// @memberof SegregatedListsGpuMemoryPool
+using SegregatedListsGpuMemoryPoolRelocationCallback = void (*)(void* userData, const SegregatedListsGpuMemoryPoolToken& oldToken,
+																const SegregatedListsGpuMemoryPoolToken& newToken);
+
 /// GPU memory allocator based on segregated lists. It allocates a GPU buffer with some initial size. If there is a need to grow it allocates a bigger
 /// buffer and copies contents of the old one to the new (CoW).
 class SegregatedListsGpuMemoryPool
@@ -65,6 +72,11 @@ public:
 	/// @note It's thread-safe.
 	void allocate(PtrSize size, U32 alignment, SegregatedListsGpuMemoryPoolToken& token);
 
+	/// Allocate memory that compact() is allowed to move. The callback will be called every time the allocation moves.
+	/// @note It's thread-safe.
+	void allocate(PtrSize size, U32 alignment, SegregatedListsGpuMemoryPoolToken& token, SegregatedListsGpuMemoryPoolRelocationCallback callback,
+				  void* callbackUserData);
+
 	/// Free memory a few frames down the line.
 	/// @note It's thread-safe.
 	void deferredFree(SegregatedListsGpuMemoryPoolToken& token);
@@ -72,6 +84,12 @@ public:
 	/// @note It's thread-safe.
 	void endFrame();
 
+	/// Incremental compaction. If the external fragmentation is higher than minFragmentation it moves relocatable allocations to free space with
+	/// lower offsets. The allocations that sit the highest are moved first. It moves up to maxBytesToMove bytes using GPU copies.
+	/// @return The bytes that were moved.
+	/// @note It's not thread-safe with getGpuBuffer(). Call it between frames.
+	PtrSize compact(PtrSize maxBytesToMove, F32 minFragmentation);
+
 	/// Need to be checking this constantly to get the updated buffer in case of CoWs.
 	/// @note It's not thread-safe.
 	Buffer& getGpuBuffer() const
@@ -92,23 +110,35 @@ public:
 private:
 	class BuilderInterface;
 	class Chunk;
-	using Builder = SegregatedListsAllocatorBuilder<Chunk, BuilderInterface, DummyMutex, SingletonMemoryPoolWrapper<GrMemoryPool>>;
+
+	class Relocatable
+	{
+	public:
+		SegregatedListsGpuMemoryPoolToken m_token;
+		SegregatedListsGpuMemoryPoolRelocationCallback m_callback = nullptr;
+		void* m_callbackUserData = nullptr;
+		U32 m_alignment = 0;
+	};
+	using Builder = SegregatedListsAllocatorBuilder<Chunk, BuilderInterface, Mutex, SingletonMemoryPoolWrapper<GrMemoryPool>>;
 
 	BufferUsageBit m_bufferUsage = BufferUsageBit::kNone;
 	GrDynamicArray<PtrSize> m_classes;
 	PtrSize m_initialBufferSize = 0;
 	GrString m_bufferName;
 
+	/// Protects the garbage, the relocatables and the GPU buffer. The builder has its own lock and it takes m_lock when it grows the buffer so never
+	/// call the builder while holding m_lock.
 	mutable Mutex m_lock;
 
 	Builder* m_builder = nullptr;
 	BufferPtr m_gpuBuffer;
 	void* m_mappedGpuBufferMemory = nullptr;
-	PtrSize m_allocatedSize = 0;
+	Atomic<PtrSize> m_allocatedSize = {0};
 
 	GrDynamicArray<Chunk*> m_deletedChunks;
 
 	Array<GrDynamicArray<SegregatedListsGpuMemoryPoolToken>, kMaxFramesInFlight> m_garbage;
+	GrHashMap<PtrSize, Relocatable> m_relocatables; ///< The key is the offset of the allocation.
 	U8 m_frame = 0;
 	Bool m_allowCoWs = true;
 
@@ -320,11 +320,10 @@ void BindlessDescriptorSet::unbindTexture(U32 idx)
 
 PipelineLayoutFactory2::~PipelineLayoutFactory2()
 {
-	for(auto it : m_pplLayouts)
-	{
-		vkDestroyPipelineLayout(getVkDevice(), it->m_handle, nullptr);
-		deleteInstance(GrMemoryPool::getSingleton(), it);
-	}
+	m_pplLayouts.iterate([]([[maybe_unused]] U64 hash, PipelineLayout2* layout) {
+		vkDestroyPipelineLayout(getVkDevice(), layout->m_handle, nullptr);
+		deleteInstance(GrMemoryPool::getSingleton(), layout);
+	});
 
 	for(auto it : m_dsLayouts)
 	{
@@ -416,75 +415,94 @@ Error PipelineLayoutFactory2::getOrCreatePipelineLayout(const ShaderReflectionDe
 	// Compute the hash
 	const U64 hash = computeHash(&refl, sizeof(refl));
 
+	// Fast path, doesn't lock
+	if(m_pplLayouts.findHash(hash, layout)) [[likely]]
+	{
+		return Error::kNone;
+	}
+
 	LockGuard lock(m_mtx);
 
-	auto it = m_pplLayouts.find(hash);
-	if(it != m_pplLayouts.getEnd())
+	// Check again
+	if(m_pplLayouts.findHash(hash, layout))
 	{
-		layout = *it;
+		return Error::kNone;
 	}
-	else
+
+	// Create new
+	layout = newInstance<PipelineLayout2>(GrMemoryPool::getSingleton());
+	const Error err = initPipelineLayout(refl, *layout);
+	if(err)
 	{
-		// Create new
+		// vkCreatePipelineLayout is the last thing that can fail so there is no handle to destroy
+		deleteInstance(GrMemoryPool::getSingleton(), layout);
+		layout = nullptr;
+		return err;
+	}
 
-		layout = newInstance<PipelineLayout2>(GrMemoryPool::getSingleton());
-		m_pplLayouts.emplace(hash, layout);
-		layout->m_refl = refl;
+	// Publish it when it's fully initialized because readers don't lock
+	m_pplLayouts.emplaceHash(hash, layout);
 
-		// Find dset count
-		layout->m_dsetCount = 0;
-		for(U8 iset = 0; iset < kMaxDescriptorSets; ++iset)
-		{
-			if(refl.m_bindingCounts[iset])
-			{
-				layout->m_dsetCount = max<U8>(iset + 1u, layout->m_dsetCount);
+	return Error::kNone;
+}
 
-				for(U32 i = 0; i < refl.m_bindingCounts[iset]; ++i)
-				{
-					layout->m_descriptorCounts[iset] += refl.m_bindings[iset][i].m_arraySize;
-				}
-			}
-		}
+Error PipelineLayoutFactory2::initPipelineLayout(const ShaderReflectionDescriptorRelated& refl, PipelineLayout2& layout)
+{
+	layout.m_refl = refl;
 
-		if(refl.m_vkBindlessDescriptorSet != kMaxU8)
+	// Find dset count
+	layout.m_dsetCount = 0;
+	for(U8 iset = 0; iset < kMaxDescriptorSets; ++iset)
+	{
+		if(refl.m_bindingCounts[iset])
 		{
-			layout->m_dsetCount = max<U8>(refl.m_vkBindlessDescriptorSet + 1, layout->m_dsetCount);
-		}
+			layout.m_dsetCount = max<U8>(iset + 1u, layout.m_dsetCount);
 
-		// Create the DS layouts
-		for(U32 iset = 0; iset < layout->m_dsetCount; ++iset)
-		{
-			if(refl.m_vkBindlessDescriptorSet == iset)
+			for(U32 i = 0; i < refl.m_bindingCounts[iset]; ++i)
 			{
-				layout->m_dsetLayouts[iset] = BindlessDescriptorSet::getSingleton().m_layout;
-			}
-			else
-			{
-				DescriptorSetLayout* dlayout;
-				ANKI_CHECK(getOrCreateDescriptorSetLayout({refl.m_bindings[iset].getBegin(), refl.m_bindingCounts[iset]}, dlayout));
-
-				layout->m_dsetLayouts[iset] = dlayout->m_handle;
+				layout.m_descriptorCounts[iset] += refl.m_bindings[iset][i].m_arraySize;
 			}
 		}
+	}
 
-		VkPipelineLayoutCreateInfo ci = {};
-		ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		ci.pSetLayouts = &layout->m_dsetLayouts[0];
-		ci.setLayoutCount = layout->m_dsetCount;
+	if(refl.m_vkBindlessDescriptorSet != kMaxU8)
+	{
+		layout.m_dsetCount = max<U8>(refl.m_vkBindlessDescriptorSet + 1, layout.m_dsetCount);
+	}
 
-		VkPushConstantRange pushConstantRange;
-		if(refl.m_pushConstantsSize > 0)
+	// Create the DS layouts
+	for(U32 iset = 0; iset < layout.m_dsetCount; ++iset)
+	{
+		if(refl.m_vkBindlessDescriptorSet == iset)
 		{
-			pushConstantRange.offset = 0;
-			pushConstantRange.size = refl.m_pushConstantsSize;
-			pushConstantRange.stageFlags = VK_SHADER_STAGE_ALL;
-			ci.pushConstantRangeCount = 1;
-			ci.pPushConstantRanges = &pushConstantRange;
+			layout.m_dsetLayouts[iset] = BindlessDescriptorSet::getSingleton().m_layout;
 		}
+		else
+		{
+			DescriptorSetLayout* dlayout;
+			ANKI_CHECK(getOrCreateDescriptorSetLayout({refl.m_bindings[iset].getBegin(), refl.m_bindingCounts[iset]}, dlayout));
 
-		ANKI_VK_CHECK(vkCreatePipelineLayout(getVkDevice(), &ci, nullptr, &layout->m_handle));
+			layout.m_dsetLayouts[iset] = dlayout->m_handle;
+		}
 	}
 
+	VkPipelineLayoutCreateInfo ci = {};
+	ci.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	ci.pSetLayouts = &layout.m_dsetLayouts[0];
+	ci.setLayoutCount = layout.m_dsetCount;
+
+	VkPushConstantRange pushConstantRange;
+	if(refl.m_pushConstantsSize > 0)
+	{
+		pushConstantRange.offset = 0;
+		pushConstantRange.size = refl.m_pushConstantsSize;
+		pushConstantRange.stageFlags = VK_SHADER_STAGE_ALL;
+		ci.pushConstantRangeCount = 1;
+		ci.pPushConstantRanges = &pushConstantRange;
+	}
+
+	ANKI_VK_CHECK(vkCreatePipelineLayout(getVkDevice(), &ci, nullptr, &layout.m_handle));
+
 	return Error::kNone;
 }
 
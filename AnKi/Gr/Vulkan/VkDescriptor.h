@@ -7,6 +7,7 @@
 
 #include <AnKi/Gr/Vulkan/VkCommon.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/ConcurrentHashMap.h>
 #include <AnKi/Util/WeakArray.h>
 
 namespace anki {
@@ -135,12 +136,14 @@ private:
 		VkDescriptorSetLayout m_handle = {};
 	};
 
-	GrHashMap<U64, PipelineLayout2*> m_pplLayouts;
+	GrConcurrentHashMap<U64, PipelineLayout2*> m_pplLayouts; ///< Lookups from the command buffers don't lock.
 	GrHashMap<U64, DescriptorSetLayout*> m_dsLayouts;
 
-	Mutex m_mtx;
+	Mutex m_mtx; ///< Protects m_dsLayouts and serializes the creation of pipeline layouts.
 
 	Error getOrCreateDescriptorSetLayout(ConstWeakArray<ShaderReflectionBinding> bindings, DescriptorSetLayout*& layout);
+
+	Error initPipelineLayout(const ShaderReflectionDescriptorRelated& refl, PipelineLayout2& layout);
 };
 
 /// Part of the command buffer that deals with descriptors.
@@ -8,7 +8,7 @@
 #include <AnKi/Gr/Vulkan/VkCommon.h>
 #include <AnKi/Gr/ShaderProgram.h>
 #include <AnKi/Gr/BackendCommon/GraphicsStateTracker.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SwissHashMap.h>
 
 namespace anki {
 
@@ -25,7 +25,7 @@ public:
 	void flushState(GraphicsStateTracker& state, VkCommandBuffer& cmdb);
 
 private:
-	GrHashMap<U64, VkPipeline> m_map;
+	GrSwissHashMap<U64, VkPipeline> m_map; ///< Searched every time the state changes.
 	RWMutex m_mtx;
 };
 
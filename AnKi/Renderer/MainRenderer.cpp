@@ -21,6 +21,7 @@ namespace anki {
 static StatCounter g_rendererCpuTimeStatVar(StatCategory::kTime, "Renderer",
 											StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates);
 StatCounter g_rendererGpuTimeStatVar(StatCategory::kTime, "GPU frame", StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates);
+static StatCounter g_framePoolAllocationCountStatVar(StatCategory::kMisc, "Frame pool allocations", StatFlag::kMainThreadUpdates);
 
 MainRenderer::MainRenderer()
 {
@@ -158,6 +159,9 @@ Error MainRenderer::render(Texture* presentTex)
 		m_rgraph->getStatistics(rgraphStats);
 		g_rendererGpuTimeStatVar.set(rgraphStats.m_gpuTime * 1000.0);
 
+		// The pool gets reset at the beginning of the frame so that's the allocations of this frame
+		g_framePoolAllocationCountStatVar.set(m_framePool.getAllocationCount());
+
 		if(rgraphStats.m_gpuTime > 0.0)
 		{
 			// WARNING: The name of the event is somewhat special. Search it to see why
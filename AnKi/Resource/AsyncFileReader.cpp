@@ -0,0 +1,629 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Resource/AsyncFileReader.h>
+#include <AnKi/Resource/ResourceFilesystem.h>
+#include <AnKi/Core/StatsSet.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/HighRezTimer.h>
+#if ANKI_OS_LINUX
+#	include <linux/io_uring.h>
+#	include <sys/mman.h>
+#	include <sys/syscall.h>
+#	include <sys/uio.h>
+#	include <unistd.h>
+#endif
+
+namespace anki {
+
+static StatCounter g_asyncFileReadsStatVar(StatCategory::kMisc, "Async file reads in flight", StatFlag::kNone);
+
+/// Big reads that go to the threads are split so many threads can work on them. It matters for packages that decompress as they read.
+inline constexpr PtrSize kMaxThreadReadSize = 256_KB;
+
+class AsyncFileReader::Request : public IntrusiveListEnabled<Request>
+{
+public:
+	AsyncFileReadRequest m_info;
+	AsyncFileReadBatch* m_batch = nullptr;
+	PtrSize m_doneSize = 0; ///< Short reads of io_uring need to continue from here.
+#if ANKI_OS_LINUX
+	iovec m_iov = {};
+#endif
+};
+
+#if ANKI_OS_LINUX
+/// A minimal io_uring that talks directly to the kernel. A thread waits for the completions.
+class AsyncFileReader::IoUring
+{
+public:
+	static constexpr U32 kEntryCount = 128;
+
+	/// io_uring reads are U32 so split the big ones.
+	static constexpr PtrSize kMaxReadSize = 1_GB;
+
+	/// When io_uring_enter() is out of resources retry that many times, doubling the sleep time every time, before failing the reads.
+	static constexpr U32 kMaxSubmitRetries = 10;
+	static constexpr Second kRetrySleepTime = 0.05_ms;
+
+	/// The max sleep time of the completion thread when io_uring_enter() keeps failing.
+	static constexpr Second kMaxErrorSleepTime = 100.0_ms;
+
+	I32 m_fd = -1;
+
+	void* m_sqRing = nullptr;
+	PtrSize m_sqRingSize = 0;
+	void* m_cqRing = nullptr;
+	PtrSize m_cqRingSize = 0;
+	io_uring_sqe* m_sqes = nullptr;
+	PtrSize m_sqesSize = 0;
+
+	U32* m_sqHead = nullptr;
+	U32* m_sqTail = nullptr;
+	U32* m_sqArray = nullptr;
+	U32 m_sqMask = 0;
+	U32 m_sqLocalTail = 0; ///< The tail of the entries that are filled but not yet visible to the kernel.
+
+	U32* m_cqHead = nullptr;
+	U32* m_cqTail = nullptr;
+	io_uring_cqe* m_cqes = nullptr;
+	U32 m_cqMask = 0;
+
+	Thread m_thread{"IoUring"};
+	Bool m_threadStarted = false;
+
+	Mutex m_mtx; ///< Protects the submission queue and the members below.
+	IntrusiveList<Request> m_pending; ///< Requests waiting for room in the ring.
+	U32 m_inFlightCount = 0;
+
+	Atomic<Bool> m_quit = {false}; ///< In case the no-op that wakes the completion thread can't be submitted.
+
+	~IoUring()
+	{
+		ANKI_ASSERT(m_pending.isEmpty() && m_inFlightCount == 0);
+
+		if(m_threadStarted)
+		{
+			// Wake the completion thread with a no-op
+			{
+				LockGuard<Mutex> lock(m_mtx);
+				m_quit.store(true);
+				io_uring_sqe& sqe = newSqe();
+				sqe.opcode = IORING_OP_NOP;
+				sqe.user_data = 0;
+				IntrusiveList<Request> failed;
+				submitSqes(failed);
+				ANKI_ASSERT(failed.isEmpty());
+			}
+
+			[[maybe_unused]] const Error err = m_thread.join();
+		}
+
+		if(m_sqes)
+		{
+			munmap(m_sqes, m_sqesSize);
+		}
+
+		if(m_cqRing && m_cqRing != m_sqRing)
+		{
+			munmap(m_cqRing, m_cqRingSize);
+		}
+
+		if(m_sqRing)
+		{
+			munmap(m_sqRing, m_sqRingSize);
+		}
+
+		if(m_fd >= 0)
+		{
+			close(m_fd);
+		}
+	}
+
+	Error init()
+	{
+		io_uring_params params = {};
+		m_fd = I32(syscall(__NR_io_uring_setup, kEntryCount, &params));
+		if(m_fd < 0)
+		{
+			ANKI_RESOURCE_LOGV("io_uring_setup() failed: %s", strerror(errno));
+			return Error::kFunctionFailed;
+		}
+
+		m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(U32);
+		m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		const Bool singleMmap = !!(params.features & IORING_FEAT_SINGLE_MMAP);
+		if(singleMmap)
+		{
+			m_sqRingSize = m_cqRingSize = max(m_sqRingSize, m_cqRingSize);
+		}
+
+		m_sqRing = mapRing(m_sqRingSize, IORING_OFF_SQ_RING);
+		if(!m_sqRing)
+		{
+			return Error::kFunctionFailed;
+		}
+
+		if(singleMmap)
+		{
+			m_cqRing = m_sqRing;
+		}
+		else
+		{
+			m_cqRing = mapRing(m_cqRingSize, IORING_OFF_CQ_RING);
+			if(!m_cqRing)
+			{
+				return Error::kFunctionFailed;
+			}
+		}
+
+		m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		m_sqes = static_cast<io_uring_sqe*>(mapRing(m_sqesSize, IORING_OFF_SQES));
+		if(!m_sqes)
+		{
+			return Error::kFunctionFailed;
+		}
+
+		U8* sq = static_cast<U8*>(m_sqRing);
+		m_sqHead = reinterpret_cast<U32*>(sq + params.sq_off.head);
+		m_sqTail = reinterpret_cast<U32*>(sq + params.sq_off.tail);
+		m_sqArray = reinterpret_cast<U32*>(sq + params.sq_off.array);
+		m_sqMask = *reinterpret_cast<U32*>(sq + params.sq_off.ring_mask);
+		m_sqLocalTail = *m_sqTail;
+
+		U8* cq = static_cast<U8*>(m_cqRing);
+		m_cqHead = reinterpret_cast<U32*>(cq + params.cq_off.head);
+		m_cqTail = reinterpret_cast<U32*>(cq + params.cq_off.tail);
+		m_cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+		m_cqMask = *reinterpret_cast<U32*>(cq + params.cq_off.ring_mask);
+
+		m_thread.start(this, [](ThreadCallbackInfo& info) -> Error {
+			static_cast<IoUring*>(info.m_userData)->completionWorker();
+			return Error::kNone;
+		});
+		m_threadStarted = true;
+
+		return Error::kNone;
+	}
+
+	void* mapRing(PtrSize size, U64 offset)
+	{
+		void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, off_t(offset));
+		if(ptr == MAP_FAILED)
+		{
+			ANKI_RESOURCE_LOGE("Mapping the io_uring failed: %s", strerror(errno));
+			return nullptr;
+		}
+
+		return ptr;
+	}
+
+	/// Queue requests. Thread-safe.
+	void submit(IntrusiveList<Request>& requests)
+	{
+		IntrusiveList<Request> failed;
+		{
+			LockGuard<Mutex> lock(m_mtx);
+
+			while(!requests.isEmpty())
+			{
+				m_pending.pushBack(requests.popFront());
+			}
+
+			submitPending(failed);
+		}
+
+		while(!failed.isEmpty())
+		{
+			finishRequest(failed.popFront(), true);
+		}
+	}
+
+	/// Move as many pending requests to the ring as possible. Needs m_mtx locked.
+	/// @param[out] failed The requests that couldn't be submitted. The caller should finish them after unlocking m_mtx.
+	void submitPending(IntrusiveList<Request>& failed)
+	{
+		while(!m_pending.isEmpty() && m_inFlightCount < kEntryCount)
+		{
+			Request* req = m_pending.popFront();
+			const PtrSize remaining = req->m_info.m_size - req->m_doneSize;
+
+			req->m_iov.iov_base = static_cast<U8*>(req->m_info.m_destination) + req->m_doneSize;
+			req->m_iov.iov_len = min(remaining, kMaxReadSize);
+
+			// Use readv instead of read to support older kernels
+			io_uring_sqe& sqe = newSqe();
+			sqe.opcode = IORING_OP_READV;
+			sqe.fd = req->m_info.m_file->getFileDescriptor();
+			sqe.off = req->m_info.m_offset + req->m_doneSize;
+			sqe.addr = ptrToNumber(&req->m_iov);
+			sqe.len = 1;
+			sqe.user_data = ptrToNumber(req);
+
+			++m_inFlightCount;
+		}
+
+		submitSqes(failed);
+	}
+
+	/// Get the next free submission entry. Needs m_mtx locked.
+	io_uring_sqe& newSqe()
+	{
+		ANKI_ASSERT(m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) < kEntryCount);
+
+		const U32 idx = m_sqLocalTail & m_sqMask;
+		io_uring_sqe& sqe = m_sqes[idx];
+		zeroMemory(sqe);
+		m_sqArray[idx] = idx;
+		++m_sqLocalTail;
+
+		return sqe;
+	}
+
+	/// Make the new entries visible to the kernel and submit them. Needs m_mtx locked.
+	/// @param[out] failed The requests of the entries that couldn't be submitted.
+	void submitSqes(IntrusiveList<Request>& failed)
+	{
+		__atomic_store_n(m_sqTail, m_sqLocalTail, __ATOMIC_RELEASE);
+
+		U32 toSubmit = m_sqLocalTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+		U32 retryCount = 0;
+		while(toSubmit)
+		{
+			const I64 ret = syscall(__NR_io_uring_enter, m_fd, toSubmit, 0, 0, nullptr, 0);
+			if(ret > 0)
+			{
+				toSubmit -= U32(ret);
+				retryCount = 0;
+				continue;
+			}
+
+			const I32 err = (ret == 0) ? EAGAIN : errno;
+			if(err == EINTR)
+			{
+				continue;
+			}
+
+			if((err == EAGAIN || err == EBUSY) && retryCount < kMaxSubmitRetries)
+			{
+				// The kernel is out of resources or the completion queue is full. Give the completion thread some time to reap
+				HighRezTimer::sleep(kRetrySleepTime * F64(1u << retryCount));
+				++retryCount;
+				continue;
+			}
+
+			ANKI_RESOURCE_LOGE("io_uring_enter() failed. Failing %u reads: %s", toSubmit, strerror(err));
+			dropUnsubmittedSqes(failed);
+			break;
+		}
+	}
+
+	/// Take back the entries that the kernel didn't consume. Without SQPOLL the kernel reads the ring only inside io_uring_enter() and that is
+	/// called with m_mtx locked, so it's safe to move the tail back. Needs m_mtx locked.
+	void dropUnsubmittedSqes(IntrusiveList<Request>& failed)
+	{
+		const U32 head = __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE);
+		for(U32 i = head; i != m_sqLocalTail; ++i)
+		{
+			const io_uring_sqe& sqe = m_sqes[i & m_sqMask];
+			if(sqe.user_data != 0)
+			{
+				failed.pushBack(numberToPtr<Request*>(sqe.user_data));
+				ANKI_ASSERT(m_inFlightCount > 0);
+				--m_inFlightCount;
+			}
+		}
+
+		m_sqLocalTail = head;
+		__atomic_store_n(m_sqTail, m_sqLocalTail, __ATOMIC_RELEASE);
+	}
+
+	void completionWorker()
+	{
+		Bool quit = false;
+		U32 errorCount = 0;
+		while(!quit)
+		{
+			const I64 ret = syscall(__NR_io_uring_enter, m_fd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+			if(ret < 0 && errno != EINTR)
+			{
+				// Don't spin if the error persists. Log it once and back off. Reap anyway, some completions might have arrived
+				if(errorCount == 0)
+				{
+					ANKI_RESOURCE_LOGE("io_uring_enter() failed: %s", strerror(errno));
+				}
+
+				HighRezTimer::sleep(min(kRetrySleepTime * F64(1u << min(errorCount, 16u)), kMaxErrorSleepTime));
+				++errorCount;
+
+				quit = m_quit.load();
+			}
+			else
+			{
+				if(errorCount > 1)
+				{
+					ANKI_RESOURCE_LOGI("io_uring_enter() recovered after %u failures", errorCount);
+				}
+
+				errorCount = 0;
+			}
+
+			// Reap the completions
+			IntrusiveList<Request> resubmit;
+			IntrusiveList<Request> done;
+			IntrusiveList<Request> failed;
+			U32 completedCount = 0;
+
+			U32 head = *m_cqHead;
+			const U32 tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+			while(head != tail)
+			{
+				const io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+				++head;
+
+				if(cqe.user_data == 0)
+				{
+					quit = true;
+					continue;
+				}
+
+				++completedCount;
+				Request* req = numberToPtr<Request*>(cqe.user_data);
+
+				if(cqe.res == -EINTR || cqe.res == -EAGAIN)
+				{
+					resubmit.pushBack(req);
+				}
+				else if(cqe.res <= 0)
+				{
+					ANKI_RESOURCE_LOGE("io_uring read failed: %s", (cqe.res < 0) ? strerror(-cqe.res) : "Unexpected end of file");
+					failed.pushBack(req);
+				}
+				else
+				{
+					req->m_doneSize += PtrSize(cqe.res);
+					if(req->m_doneSize < req->m_info.m_size)
+					{
+						// Short read, continue from where it stopped
+						resubmit.pushBack(req);
+					}
+					else
+					{
+						done.pushBack(req);
+					}
+				}
+			}
+
+			__atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+
+			if(completedCount)
+			{
+				LockGuard<Mutex> lock(m_mtx);
+
+				m_inFlightCount -= completedCount;
+				while(!resubmit.isEmpty())
+				{
+					m_pending.pushFront(resubmit.popBack());
+				}
+
+				submitPending(failed);
+			}
+
+			while(!done.isEmpty())
+			{
+				finishRequest(done.popFront(), false);
+			}
+
+			while(!failed.isEmpty())
+			{
+				finishRequest(failed.popFront(), true);
+			}
+		}
+	}
+};
+#endif
+
+Error AsyncFileReadBatch::wait()
+{
+	LockGuard<Mutex> lock(m_mtx);
+	while(m_pendingCount.load() != 0)
+	{
+		m_condVar.wait(m_mtx);
+	}
+
+	const Bool failed = m_failed;
+	m_failed = false;
+	return (failed) ? Error::kFileAccess : Error::kNone;
+}
+
+void AsyncFileReadBatch::requestDone(Bool failed)
+{
+	// Do everything under the lock so wait() can't return before this function stops touching the batch
+	LockGuard<Mutex> lock(m_mtx);
+	m_failed = m_failed || failed;
+	if(m_pendingCount.fetchSub(1) == 1)
+	{
+		m_condVar.notifyAll();
+	}
+}
+
+AsyncFileReader::~AsyncFileReader()
+{
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		m_quit = true;
+		m_condVar.notifyAll();
+	}
+
+	for(Thread* thread : m_threads)
+	{
+		[[maybe_unused]] const Error err = thread->join();
+		deleteInstance(ResourceMemoryPool::getSingleton(), thread);
+	}
+
+	ANKI_ASSERT(m_queue.isEmpty());
+
+#if ANKI_OS_LINUX
+	deleteInstance(ResourceMemoryPool::getSingleton(), m_ring);
+#endif
+}
+
+Error AsyncFileReader::init(U32 threadCount, [[maybe_unused]] Bool useIoUring)
+{
+	ANKI_ASSERT(threadCount > 0);
+	ANKI_ASSERT(m_threads.getSize() == 0 && "Already initialized");
+
+#if ANKI_OS_LINUX
+	if(useIoUring)
+	{
+		m_ring = newInstance<IoUring>(ResourceMemoryPool::getSingleton());
+		if(m_ring->init())
+		{
+			ANKI_RESOURCE_LOGW("io_uring is not available. File reads will fall back to threads");
+			deleteInstance(ResourceMemoryPool::getSingleton(), m_ring);
+			m_ring = nullptr;
+		}
+	}
+#endif
+
+	m_threads.resize(threadCount);
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		ResourceString threadName;
+		threadName.sprintf("FileRead#%u", i);
+		m_threads[i] = newInstance<Thread>(ResourceMemoryPool::getSingleton(), threadName.cstr());
+		m_threads[i]->start(this, threadCallback);
+	}
+
+	ANKI_RESOURCE_LOGV("Async file reader uses %s and %u threads", (m_ring) ? "io_uring" : "pread", threadCount);
+	return Error::kNone;
+}
+
+void AsyncFileReader::submit(ConstWeakArray<AsyncFileReadRequest> requests, AsyncFileReadBatch& batch)
+{
+	ANKI_ASSERT(m_threads.getSize() > 0 && "Not initialized");
+
+	if(requests.getSize() == 0)
+	{
+		return;
+	}
+
+	auto useRing = [this](const AsyncFileReadRequest& info) {
+		return m_ring && info.m_file->getFileDescriptor() >= 0;
+	};
+
+	auto computeChunkCount = [&](const AsyncFileReadRequest& info) -> U32 {
+		return (info.m_size == 0 || useRing(info)) ? 1 : U32((info.m_size + kMaxThreadReadSize - 1) / kMaxThreadReadSize);
+	};
+
+	// Count all the requests first so the batch won't be done before all of them are submitted
+	U32 requestCount = 0;
+	for(const AsyncFileReadRequest& info : requests)
+	{
+		requestCount += computeChunkCount(info);
+	}
+
+	batch.m_pendingCount.fetchAdd(requestCount);
+	g_asyncFileReadsStatVar.increment(requestCount);
+
+	IntrusiveList<Request> ringRequests;
+	IntrusiveList<Request> threadRequests;
+	for(const AsyncFileReadRequest& info : requests)
+	{
+		ANKI_ASSERT(info.m_file);
+		ANKI_ASSERT(info.m_destination || info.m_size == 0);
+
+		const U32 chunkCount = computeChunkCount(info);
+		for(U32 chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			Request* req = newInstance<Request>(ResourceMemoryPool::getSingleton());
+			req->m_info = info;
+			req->m_batch = &batch;
+
+			if(info.m_size == 0)
+			{
+				finishRequest(req, false);
+			}
+			else if(useRing(info))
+			{
+				ringRequests.pushBack(req);
+			}
+			else
+			{
+				const PtrSize chunkOffset = chunk * kMaxThreadReadSize;
+				req->m_info.m_offset += chunkOffset;
+				req->m_info.m_size = min(info.m_size - chunkOffset, kMaxThreadReadSize);
+				req->m_info.m_destination = static_cast<U8*>(info.m_destination) + chunkOffset;
+				threadRequests.pushBack(req);
+			}
+		}
+	}
+
+#if ANKI_OS_LINUX
+	if(!ringRequests.isEmpty())
+	{
+		m_ring->submit(ringRequests);
+	}
+#endif
+
+	if(!threadRequests.isEmpty())
+	{
+		LockGuard<Mutex> lock(m_mtx);
+		while(!threadRequests.isEmpty())
+		{
+			m_queue.pushBack(threadRequests.popFront());
+		}
+
+		m_condVar.notifyAll();
+	}
+}
+
+void AsyncFileReader::finishRequest(Request* req, Bool failed)
+{
+	AsyncFileReadBatch* batch = req->m_batch;
+	deleteInstance(ResourceMemoryPool::getSingleton(), req);
+	g_asyncFileReadsStatVar.decrement(1u);
+
+	// This should be the last thing that touches the batch
+	batch->requestDone(failed);
+}
+
+Error AsyncFileReader::threadCallback(ThreadCallbackInfo& info)
+{
+	AsyncFileReader& self = *static_cast<AsyncFileReader*>(info.m_userData);
+	return self.threadWorker();
+}
+
+Error AsyncFileReader::threadWorker()
+{
+	while(true)
+	{
+		Request* req = nullptr;
+
+		{
+			// Wait for something. Quit only when the queue is empty
+			LockGuard<Mutex> lock(m_mtx);
+			while(!m_quit && m_queue.isEmpty())
+			{
+				m_condVar.wait(m_mtx);
+			}
+
+			if(m_queue.isEmpty())
+			{
+				break;
+			}
+
+			req = m_queue.popFront();
+		}
+
+		const AsyncFileReadRequest& info = req->m_info;
+		const Error err = info.m_file->readAt(info.m_offset, info.m_destination, info.m_size);
+		finishRequest(req, !!err);
+	}
+
+	return Error::kNone;
+}
+
+} // end namespace anki
@@ -0,0 +1,122 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Resource/Common.h>
+#include <AnKi/Util/Thread.h>
+#include <AnKi/Util/List.h>
+#include <AnKi/Util/WeakArray.h>
+
+namespace anki {
+
+// Forward
+class ResourceFile;
+
+/// @addtogroup resource
+/// @{
+
+/// A read request of the AsyncFileReader.
+class AsyncFileReadRequest
+{
+public:
+	ResourceFile* m_file = nullptr; ///< It should stay alive until the batch is done.
+	PtrSize m_offset = 0; ///< Offset from the start of the file.
+	PtrSize m_size = 0;
+	void* m_destination = nullptr;
+};
+
+/// A number of reads that were submitted together.
+class AsyncFileReadBatch
+{
+	friend class AsyncFileReader;
+
+public:
+	AsyncFileReadBatch() = default;
+
+	AsyncFileReadBatch(const AsyncFileReadBatch&) = delete; // Non-copyable
+
+	~AsyncFileReadBatch()
+	{
+		ANKI_ASSERT(m_pendingCount.load() == 0 && "Need to wait for the batch before destroying it");
+	}
+
+	AsyncFileReadBatch& operator=(const AsyncFileReadBatch&) = delete; // Non-copyable
+
+	/// Check if all the reads are done. It's just a hint, call wait() before destroying the batch.
+	Bool isDone() const
+	{
+		return m_pendingCount.load() == 0;
+	}
+
+	/// Block until all the reads of the batch are done.
+	/// @return Error::kFileAccess if one of the reads failed.
+	Error wait();
+
+private:
+	Atomic<U32> m_pendingCount = {0};
+	Bool m_failed = false; ///< Protected by m_mtx.
+	Mutex m_mtx;
+	ConditionVariable m_condVar;
+
+	void requestDone(Bool failed);
+};
+
+/// Reads ranges of ResourceFiles in the background. On Linux the files that have a file descriptor are read using io_uring. Everything else
+/// is read using positional reads from a number of threads, big reads are split between them. Submitting many reads at once lets the OS
+/// overlap the disk latency.
+class AsyncFileReader
+{
+public:
+	AsyncFileReader() = default;
+
+	AsyncFileReader(const AsyncFileReader&) = delete; // Non-copyable
+
+	~AsyncFileReader();
+
+	AsyncFileReader& operator=(const AsyncFileReader&) = delete; // Non-copyable
+
+	/// @param threadCount The number of threads of the fallback path.
+	/// @param useIoUring Try to use io_uring. If it's not supported it will use the threads for all the reads.
+	Error init(U32 threadCount, Bool useIoUring);
+
+	/// Submit a number of reads. The batch should not be in use by another submission. It's thread-safe.
+	void submit(ConstWeakArray<AsyncFileReadRequest> requests, AsyncFileReadBatch& batch);
+
+	/// Read a number of ranges and wait for all of them to finish. It's thread-safe.
+	Error read(ConstWeakArray<AsyncFileReadRequest> requests)
+	{
+		AsyncFileReadBatch batch;
+		submit(requests, batch);
+		return batch.wait();
+	}
+
+	Bool isUsingIoUring() const
+	{
+		return m_ring != nullptr;
+	}
+
+private:
+	class Request;
+	class IoUring;
+
+	// Thread pool part
+	ResourceDynamicArray<Thread*> m_threads;
+	Mutex m_mtx;
+	ConditionVariable m_condVar;
+	IntrusiveList<Request> m_queue; ///< Protected by m_mtx.
+	Bool m_quit = false;
+
+	IoUring* m_ring = nullptr;
+
+	static Error threadCallback(ThreadCallbackInfo& info);
+
+	Error threadWorker();
+
+	static void finishRequest(Request* req, Bool failed);
+};
+/// @}
+
+} // end namespace anki
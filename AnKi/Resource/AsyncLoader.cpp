@@ -11,25 +11,61 @@
 namespace anki {
 
 static StatCounter g_asyncTasksInFlightStatVar(StatCategory::kMisc, "Async loader tasks", StatFlag::kNone);
+static StatCounter g_asyncHighPriorityQueueStatVar(StatCategory::kMisc, "Async loader high priority queue", StatFlag::kNone);
+static StatCounter g_asyncMediumPriorityQueueStatVar(StatCategory::kMisc, "Async loader medium priority queue", StatFlag::kNone);
+static StatCounter g_asyncLowPriorityQueueStatVar(StatCategory::kMisc, "Async loader low priority queue", StatFlag::kNone);
+static StatCounter g_asyncCanceledTasksStatVar(StatCategory::kMisc, "Async loader canceled tasks", StatFlag::kNone);
 
-AsyncLoader::AsyncLoader()
-	: m_thread("AsyncLoad")
+static StatCounter& getQueueStatVar(AsyncLoaderPriority priority)
 {
-	m_thread.start(this, threadCallback);
+	static Array<StatCounter*, U32(AsyncLoaderPriority::kCount)> stats = {&g_asyncHighPriorityQueueStatVar, &g_asyncMediumPriorityQueueStatVar,
+																		   &g_asyncLowPriorityQueueStatVar};
+	return *stats[priority];
+}
+
+AsyncLoader::AsyncLoader(U32 threadCount)
+{
+	ANKI_ASSERT(threadCount > 0);
+
+	for(Atomic<U32>& depth : m_queueDepths)
+	{
+		depth.setNonAtomically(0);
+	}
+
+	m_threads.resize(threadCount);
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		ResourceString threadName;
+		threadName.sprintf("AsyncLoad#%u", i);
+		m_threads[i] = newInstance<Thread>(ResourceMemoryPool::getSingleton(), threadName.cstr());
+		m_threads[i]->start(this, threadCallback);
+	}
 }
 
 AsyncLoader::~AsyncLoader()
 {
 	stop();
 
-	if(!m_taskQueue.isEmpty())
+	for(Thread* thread : m_threads)
+	{
+		deleteInstance(ResourceMemoryPool::getSingleton(), thread);
+	}
+
+	Bool warned = false;
+	for(AsyncLoaderPriority priority : EnumIterable<AsyncLoaderPriority>())
 	{
-		ANKI_RESOURCE_LOGW("Stoping loading thread while there is work to do");
+		IntrusiveList<AsyncLoaderTask>& queue = m_taskQueues[priority];
 
-		while(!m_taskQueue.isEmpty())
+		if(!queue.isEmpty() && !warned)
 		{
-			AsyncLoaderTask* task = &m_taskQueue.getFront();
-			m_taskQueue.popFront();
+			ANKI_RESOURCE_LOGW("Stoping loading thread while there is work to do");
+			warned = true;
+		}
+
+		while(!queue.isEmpty())
+		{
+			AsyncLoaderTask* task = &queue.getFront();
+			queue.popFront();
 			deleteInstance(ResourceMemoryPool::getSingleton(), task);
 		}
 	}
@@ -40,10 +76,13 @@ void AsyncLoader::stop()
 	{
 		LockGuard<Mutex> lock(m_mtx);
 		m_quit = true;
-		m_condVar.notifyOne();
+		m_condVar.notifyAll();
 	}
 
-	[[maybe_unused]] Error err = m_thread.join();
+	for(Thread* thread : m_threads)
+	{
+		[[maybe_unused]] Error err = thread->join();
+	}
 }
 
 Error AsyncLoader::threadCallback(ThreadCallbackInfo& info)
@@ -52,6 +91,31 @@ Error AsyncLoader::threadCallback(ThreadCallbackInfo& info)
 	return self.threadWorker();
 }
 
+void AsyncLoader::pushTask(AsyncLoaderTask* task)
+{
+	m_taskQueues[task->m_priority].pushBack(task);
+	m_queueDepths[task->m_priority].fetchAdd(1);
+	getQueueStatVar(task->m_priority).increment(1);
+}
+
+AsyncLoaderTask* AsyncLoader::popTask()
+{
+	for(AsyncLoaderPriority priority : EnumIterable<AsyncLoaderPriority>())
+	{
+		IntrusiveList<AsyncLoaderTask>& queue = m_taskQueues[priority];
+		if(!queue.isEmpty())
+		{
+			AsyncLoaderTask* task = &queue.getFront();
+			queue.popFront();
+			m_queueDepths[priority].fetchSub(1);
+			getQueueStatVar(priority).decrement(1u);
+			return task;
+		}
+	}
+
+	return nullptr;
+}
+
 Error AsyncLoader::threadWorker()
 {
 	Error err = Error::kNone;
@@ -59,79 +123,82 @@ Error AsyncLoader::threadWorker()
 	while(!err)
 	{
 		AsyncLoaderTask* task = nullptr;
-		Bool quit = false;
 
 		{
 			// Wait for something
 			LockGuard<Mutex> lock(m_mtx);
-			while(m_taskQueue.isEmpty() && !m_quit)
+			while(!m_quit && (task = popTask()) == nullptr)
 			{
 				m_condVar.wait(m_mtx);
 			}
-
-			// Do some work
-			if(m_quit)
-			{
-				quit = true;
-			}
-			else
-			{
-				task = &m_taskQueue.getFront();
-				m_taskQueue.popFront();
-			}
 		}
 
-		if(quit)
+		if(task == nullptr)
 		{
+			// Quit
 			break;
 		}
-		else
+
+		if(task->isCanceled())
 		{
-			// Exec the task
-			ANKI_ASSERT(task);
-			AsyncLoaderTaskContext ctx;
+			m_canceledTaskCount.fetchAdd(1);
+			g_asyncCanceledTasksStatVar.increment(1);
+			g_asyncTasksInFlightStatVar.decrement(1u);
+			m_tasksInFlightCount.fetchSub(1);
+			deleteInstance(ResourceMemoryPool::getSingleton(), task);
+			continue;
+		}
 
-			{
-				ANKI_TRACE_SCOPED_EVENT(RsrcAsyncTask);
-				err = (*task)(ctx);
-				g_asyncTasksInFlightStatVar.decrement(1u);
-			}
+		// Exec the task
+		AsyncLoaderTaskContext ctx;
 
-			if(!err)
-			{
-				m_tasksInFlightCount.fetchSub(1);
-			}
-			else
-			{
-				ANKI_RESOURCE_LOGE("Async loader task failed");
-			}
+		{
+			ANKI_TRACE_SCOPED_EVENT(RsrcAsyncTask);
+			err = (*task)(ctx);
+			g_asyncTasksInFlightStatVar.decrement(1u);
+		}
 
-			// Do other stuff
-			if(ctx.m_resubmitTask)
-			{
-				LockGuard<Mutex> lock(m_mtx);
-				m_taskQueue.pushBack(task);
-			}
-			else
-			{
-				// Delete the task
-				deleteInstance(ResourceMemoryPool::getSingleton(), task);
-			}
+		if(!err)
+		{
+			m_tasksInFlightCount.fetchSub(1);
+		}
+		else
+		{
+			ANKI_RESOURCE_LOGE("Async loader task failed");
+		}
+
+		// Do other stuff
+		if(ctx.m_resubmitTask)
+		{
+			m_tasksInFlightCount.fetchAdd(1);
+			g_asyncTasksInFlightStatVar.increment(1);
+
+			LockGuard<Mutex> lock(m_mtx);
+			pushTask(task);
+			m_condVar.notifyOne();
+		}
+		else
+		{
+			// Delete the task
+			deleteInstance(ResourceMemoryPool::getSingleton(), task);
 		}
 	}
 
 	return err;
 }
 
-void AsyncLoader::submitTask(AsyncLoaderTask* task)
+void AsyncLoader::submitTask(AsyncLoaderTask* task, AsyncLoaderPriority priority)
 {
 	ANKI_ASSERT(task);
+	ANKI_ASSERT(priority < AsyncLoaderPriority::kCount);
 
 	m_tasksInFlightCount.fetchAdd(1);
 	g_asyncTasksInFlightStatVar.increment(1);
 
+	task->m_priority = priority;
+
 	LockGuard<Mutex> lock(m_mtx);
-	m_taskQueue.pushBack(task);
+	pushTask(task);
 	m_condVar.notifyOne();
 }
 
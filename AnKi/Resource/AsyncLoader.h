@@ -8,6 +8,8 @@
 #include <AnKi/Resource/Common.h>
 #include <AnKi/Util/Thread.h>
 #include <AnKi/Util/List.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/Enum.h>
 
 namespace anki {
 
@@ -17,34 +19,64 @@ class AsyncLoader;
 /// @addtogroup resource
 /// @{
 
+/// The priority of an AsyncLoaderTask. Every priority has its own queue and the loader threads always pick the oldest task of the highest priority.
+enum class AsyncLoaderPriority : U8
+{
+	kHigh,
+	kMedium,
+	kLow,
+
+	kCount,
+	kFirst = 0
+};
+ANKI_ENUM_ALLOW_NUMERIC_OPERATIONS(AsyncLoaderPriority)
+
 class AsyncLoaderTaskContext
 {
 public:
-	/// Resubmit the same task at the end of the queue.
+	/// Resubmit the same task at the end of its queue.
 	Bool m_resubmitTask = false;
 };
 
 /// Interface for tasks for the AsyncLoader.
 class AsyncLoaderTask : public IntrusiveListEnabled<AsyncLoaderTask>
 {
+	friend class AsyncLoader;
+
 public:
 	virtual ~AsyncLoaderTask()
 	{
 	}
 
 	virtual Error operator()(AsyncLoaderTaskContext& ctx) = 0;
+
+	/// Return true if the result of the task is not needed any more (eg the resource it loads got released). Canceled tasks are deleted without
+	/// running. It's called from the loader threads right before the task runs.
+	virtual Bool isCanceled() const
+	{
+		return false;
+	}
+
+	AsyncLoaderPriority getPriority() const
+	{
+		return m_priority;
+	}
+
+private:
+	AsyncLoaderPriority m_priority = AsyncLoaderPriority::kMedium;
 };
 
-/// Asynchronous resource loader.
+/// Asynchronous resource loader. It has a number of threads that execute the tasks.
 class AsyncLoader
 {
 public:
-	AsyncLoader();
+	/// @param threadCount The number of the loader threads.
+	AsyncLoader(U32 threadCount = 1);
 
 	~AsyncLoader();
 
 	/// Submit a task.
-	void submitTask(AsyncLoaderTask* task);
+	void submitTask(AsyncLoaderTask* task, AsyncLoaderPriority priority = AsyncLoaderPriority::kMedium);
 
 	/// Create a new asynchronous loading task.
 	template<typename TTask, typename... TArgs>
@@ -55,33 +87,56 @@ public:
 
 	/// Create and submit a new asynchronous loading task.
 	template<typename TTask, typename... TArgs>
-	void submitNewTask(TArgs&&... args)
+	void submitNewTask(AsyncLoaderPriority priority, TArgs&&... args)
 	{
-		submitTask(newTask<TTask>(std::forward<TArgs>(args)...));
+		submitTask(newTask<TTask>(std::forward<TArgs>(args)...), priority);
 	}
 
-	/// Get the total number of completed tasks.
+	/// Get the number of tasks that have been submitted and haven't finished.
 	U32 getTasksInFlightCount() const
 	{
 		return m_tasksInFlightCount.load();
 	}
 
+	/// Get the number of tasks that wait in the queue of a priority.
+	U32 getQueueDepth(AsyncLoaderPriority priority) const
+	{
+		return m_queueDepths[priority].load();
+	}
+
+	/// Get the number of tasks that got canceled so far.
+	U64 getCanceledTaskCount() const
+	{
+		return m_canceledTaskCount.load();
+	}
+
+	U32 getThreadCount() const
+	{
+		return m_threads.getSize();
+	}
+
 private:
-	Thread m_thread;
-	Barrier m_barrier = {2};
+	ResourceDynamicArray<Thread*> m_threads;
 
 	Mutex m_mtx;
 	ConditionVariable m_condVar;
-	IntrusiveList<AsyncLoaderTask> m_taskQueue;
+	Array<IntrusiveList<AsyncLoaderTask>, U32(AsyncLoaderPriority::kCount)> m_taskQueues;
 	Bool m_quit = false;
 
 	Atomic<U32> m_tasksInFlightCount = {0};
+	Array<Atomic<U32>, U32(AsyncLoaderPriority::kCount)> m_queueDepths;
+	Atomic<U64> m_canceledTaskCount = {0};
 
 	/// Thread callback
 	static Error threadCallback(ThreadCallbackInfo& info);
 
 	Error threadWorker();
 
+	/// Pop the next task. Needs to be called with m_mtx locked.
+	AsyncLoaderTask* popTask();
+
+	void pushTask(AsyncLoaderTask* task);
+
 	void stop();
 };
 /// @}
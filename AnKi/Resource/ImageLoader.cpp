@@ -187,12 +187,42 @@ public:
 		ANKI_ASSERT(!"Not Implemented");
 		return kMaxPtrSize;
 	}
+
+	/// See ResourceFile::getMappedView.
+	virtual const void* getMappedView([[maybe_unused]] PtrSize offset, [[maybe_unused]] PtrSize size)
+	{
+		return nullptr;
+	}
+
+	/// See ResourceFile::adviseAccess.
+	virtual void adviseAccess([[maybe_unused]] PtrSize offset, [[maybe_unused]] PtrSize size, [[maybe_unused]] FileAccessHint hint)
+	{
+	}
+
+	/// Check if the file supports reads that are queued and done all together by flushQueuedReads().
+	virtual Bool supportsQueuedReads() const
+	{
+		return false;
+	}
+
+	virtual void queueRead([[maybe_unused]] PtrSize offset, [[maybe_unused]] void* buff, [[maybe_unused]] PtrSize size)
+	{
+		ANKI_ASSERT(!"Not supported");
+	}
+
+	/// Do all the queued reads and wait for them to finish.
+	virtual Error flushQueuedReads()
+	{
+		return Error::kNone;
+	}
 };
 
 class ImageLoader::RsrcFile : public FileInterface
 {
 public:
 	ResourceFilePtr m_rfile;
+	AsyncFileReader* m_asyncReader = nullptr;
+	ResourceDynamicArray<AsyncFileReadRequest> m_queuedReads;
 
 	Error read(void* buff, PtrSize size) final
 	{
@@ -208,6 +238,44 @@ public:
 	{
 		return m_rfile->getSize();
 	}
+
+	const void* getMappedView(PtrSize offset, PtrSize size) final
+	{
+		return m_rfile->getMappedView(offset, size);
+	}
+
+	void adviseAccess(PtrSize offset, PtrSize size, FileAccessHint hint) final
+	{
+		m_rfile->adviseAccess(offset, size, hint);
+	}
+
+	Bool supportsQueuedReads() const final
+	{
+		// Only files that can be read in parallel. The rest would be read one by one anyway
+		return m_asyncReader && m_rfile->getFileDescriptor() >= 0;
+	}
+
+	void queueRead(PtrSize offset, void* buff, PtrSize size) final
+	{
+		ANKI_ASSERT(supportsQueuedReads());
+		AsyncFileReadRequest& req = *m_queuedReads.emplaceBack();
+		req.m_file = m_rfile.get();
+		req.m_offset = offset;
+		req.m_size = size;
+		req.m_destination = buff;
+	}
+
+	Error flushQueuedReads() final
+	{
+		if(m_queuedReads.getSize() == 0)
+		{
+			return Error::kNone;
+		}
+
+		const Error err = m_asyncReader->read(m_queuedReads);
+		m_queuedReads.destroy();
+		return err;
+	}
 };
 
 class ImageLoader::SystemFile : public FileInterface
@@ -545,6 +613,38 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 	// It's time to read
 	//
 
+	// The segment is read sequentially so let the OS know
+	PtrSize offset = sizeof(ImageBinaryHeader) + skipSize;
+	const PtrSize segmentSize = calcSizeOfSegment(header, preferredCompression);
+	file.adviseAccess(offset, segmentSize, FileAccessHint::kSequential);
+	file.adviseAccess(offset, segmentSize, FileAccessHint::kWillNeed);
+
+	// Point to the memory of the file if it's mapped. If not queue the read so all the reads will happen together or just read the data
+	const Bool queueReads = file.supportsQueuedReads();
+	auto readOrMap = [&](PtrSize dataSize, DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>, PtrSize>& data,
+						 ConstWeakArray<U8, PtrSize>& mappedData) -> Error {
+		const void* view = file.getMappedView(offset, dataSize);
+		if(view)
+		{
+			mappedData = ConstWeakArray<U8, PtrSize>(static_cast<const U8*>(view), dataSize);
+			ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::kCurrent));
+		}
+		else if(queueReads)
+		{
+			data.resize(dataSize);
+			file.queueRead(offset, &data[0], dataSize);
+			ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::kCurrent));
+		}
+		else
+		{
+			data.resize(dataSize);
+			ANKI_CHECK(file.read(&data[0], dataSize));
+		}
+
+		offset += dataSize;
+		return Error::kNone;
+	};
+
 	// Allocate the surfaces
 	mipCount = 0;
 	if(header.m_type != ImageBinaryType::k3D)
@@ -568,14 +668,14 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 						surf.m_width = mipWidth;
 						surf.m_height = mipHeight;
 
-						surf.m_data.resize(dataSize);
-						ANKI_CHECK(file.read(&surf.m_data[0], dataSize));
+						ANKI_CHECK(readOrMap(dataSize, surf.m_data, surf.m_mappedData));
 
 						mipCount = max(header.m_mipmapCount - mip, mipCount);
 					}
 					else
 					{
 						ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::kCurrent));
+						offset += dataSize;
 					}
 				}
 			}
@@ -605,14 +705,14 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 				vol.m_height = mipHeight;
 				vol.m_depth = mipDepth;
 
-				vol.m_data.resize(dataSize);
-				ANKI_CHECK(file.read(&vol.m_data[0], dataSize));
+				ANKI_CHECK(readOrMap(dataSize, vol.m_data, vol.m_mappedData));
 
 				mipCount = max(header.m_mipmapCount - mip, mipCount);
 			}
 			else
 			{
 				ANKI_CHECK(file.seek(dataSize, FileSeekOrigin::kCurrent));
+				offset += dataSize;
 			}
 
 			mipWidth /= 2;
@@ -625,17 +725,24 @@ Error ImageLoader::loadAnkiImage(FileInterface& file, U32 maxImageSize, ImageBin
 		depth = volumes[0].m_depth;
 	}
 
+	ANKI_CHECK(file.flushQueuedReads());
+
 	return Error::kNone;
 }
 
 Error ImageLoader::loadStb(Bool isFloat, FileInterface& fs, U32& width, U32& height,
 						   DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>, PtrSize>& data)
 {
-	// Read the file
+	// Read the file. No need to copy it if it's memory mapped
 	DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>, PtrSize> fileData(data.getMemoryPool());
 	const PtrSize fileSize = fs.getSize();
-	fileData.resize(fileSize);
-	ANKI_CHECK(fs.read(&fileData[0], fileSize));
+	const U8* fileMemory = static_cast<const U8*>(fs.getMappedView(0, fileSize));
+	if(!fileMemory)
+	{
+		fileData.resize(fileSize);
+		ANKI_CHECK(fs.read(&fileData[0], fileSize));
+		fileMemory = &fileData[0];
+	}
 
 	// Use STB to read the image
 	int stbw, stbh, comp;
@@ -643,11 +750,11 @@ Error ImageLoader::loadStb(Bool isFloat, FileInterface& fs, U32& width, U32& hei
 	U8* stbdata;
 	if(isFloat)
 	{
-		stbdata = reinterpret_cast<U8*>(stbi_loadf_from_memory(&fileData[0], I32(fileSize), &stbw, &stbh, &comp, 4));
+		stbdata = reinterpret_cast<U8*>(stbi_loadf_from_memory(fileMemory, I32(fileSize), &stbw, &stbh, &comp, 4));
 	}
 	else
 	{
-		stbdata = reinterpret_cast<U8*>(stbi_load_from_memory(&fileData[0], I32(fileSize), &stbw, &stbh, &comp, 4));
+		stbdata = reinterpret_cast<U8*>(stbi_load_from_memory(fileMemory, I32(fileSize), &stbw, &stbh, &comp, 4));
 	}
 
 	if(!stbdata)
@@ -669,16 +776,27 @@ Error ImageLoader::loadStb(Bool isFloat, FileInterface& fs, U32& width, U32& hei
 	return Error::kNone;
 }
 
-Error ImageLoader::load(ResourceFilePtr rfile, const CString& filename, U32 maxImageSize)
+Error ImageLoader::load(ResourceFilePtr rfile, const CString& filename, U32 maxImageSize, AsyncFileReader* asyncReader)
 {
 	RsrcFile file;
 	file.m_rfile = std::move(rfile);
+	file.m_asyncReader = asyncReader;
 
 	const Error err = loadInternal(file, filename, maxImageSize);
 	if(err)
 	{
 		ANKI_RESOURCE_LOGE("Failed to read image: %s", filename.cstr());
 	}
+	else
+	{
+		// Keep the file alive if the data point to it
+		const Bool mapped =
+			(m_surfaces.getSize() && m_surfaces[0].m_mappedData.getSize()) || (m_volumes.getSize() && m_volumes[0].m_mappedData.getSize());
+		if(mapped)
+		{
+			m_mappedFile = std::move(file.m_rfile);
+		}
+	}
 
 	return err;
 }
@@ -19,11 +19,18 @@ public:
 	U32 m_width;
 	U32 m_height;
 	DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>, PtrSize> m_data;
+	ConstWeakArray<U8, PtrSize> m_mappedData; ///< Points to the memory mapped file. If it's set m_data is empty.
 
 	ImageLoaderSurface(MemoryPoolPtrWrapper<BaseMemoryPool> pool)
 		: m_data(pool)
 	{
 	}
+
+	/// Get the data no matter if they are owned or not.
+	ConstWeakArray<U8, PtrSize> getData() const
+	{
+		return (m_mappedData.getSize()) ? m_mappedData : ConstWeakArray<U8, PtrSize>(m_data);
+	}
 };
 
 /// An image volume
@@ -35,11 +42,18 @@ public:
 	U32 m_height;
 	U32 m_depth;
 	DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>, PtrSize> m_data;
+	ConstWeakArray<U8, PtrSize> m_mappedData; ///< Points to the memory mapped file. If it's set m_data is empty.
 
 	ImageLoaderVolume(MemoryPoolPtrWrapper<BaseMemoryPool> pool)
 		: m_data(pool)
 	{
 	}
+
+	/// Get the data no matter if they are owned or not.
+	ConstWeakArray<U8, PtrSize> getData() const
+	{
+		return (m_mappedData.getSize()) ? m_mappedData : ConstWeakArray<U8, PtrSize>(m_data);
+	}
 };
 
 /// Loads bitmaps from regular system files or resource files. Supported formats are .tga and .ankitex.
@@ -112,8 +126,9 @@ public:
 
 	const ImageLoaderVolume& getVolume(U32 level) const;
 
-	/// Load a resource image file.
-	Error load(ResourceFilePtr file, const CString& filename, U32 maxImageSize = kMaxU32);
+	/// Load a resource image file. If the file is memory mapped the surfaces will point to the file's memory instead of owning copies.
+	/// @param asyncReader If it's not nullptr the image data of ankitex files will be read using it.
+	Error load(ResourceFilePtr file, const CString& filename, U32 maxImageSize = kMaxU32, AsyncFileReader* asyncReader = nullptr);
 
 	/// Load a system image file.
 	Error load(const CString& filename, U32 maxImageSize = kMaxU32);
@@ -129,6 +144,8 @@ private:
 
 	DynamicArray<ImageLoaderVolume, MemoryPoolPtrWrapper<BaseMemoryPool>> m_volumes;
 
+	ResourceFilePtr m_mappedFile; ///< Keep the file alive if the surfaces point to its memory.
+
 	U32 m_mipmapCount = 0;
 	U32 m_width = 0;
 	U32 m_height = 0;
@@ -34,6 +34,12 @@ public:
 	{
 		return ImageResource::load(m_ctx);
 	}
+
+	Bool isCanceled() const final
+	{
+		// If the task holds the only reference the image resource is gone and nobody can get to the texture any more
+		return m_ctx.m_tex.isCreated() && m_ctx.m_tex->getRefcount() == 1;
+	}
 };
 
 ImageResource::~ImageResource()
@@ -68,7 +74,7 @@ Error ImageResource::load(const ResourceFilename& filename, Bool async)
 	ResourceFilePtr file;
 	ANKI_CHECK(openFile(filename, file));
 
-	ANKI_CHECK(loader.load(file, filename, g_maxImageSizeCVar.get()));
+	ANKI_CHECK(loader.load(file, filename, g_maxImageSizeCVar.get(), &ResourceManager::getSingleton().getFilesystem().getAsyncFileReader()));
 
 	// Various sizes
 	init.m_width = loader.getWidth();
@@ -222,7 +228,7 @@ Error ImageResource::load(const ResourceFilename& filename, Bool async)
 	// Upload the data
 	if(async)
 	{
-		ResourceManager::getSingleton().getAsyncLoader().submitTask(task);
+		ResourceManager::getSingleton().getAsyncLoader().submitTask(task, getLoadPriority());
 	}
 	else
 	{
@@ -276,8 +282,8 @@ Error ImageResource::load(LoadingContext& ctx)
 			if(ctx.m_texType == TextureType::k3D)
 			{
 				const auto& vol = ctx.m_loader.getVolume(mip);
-				surfOrVolSize = vol.m_data.getSize();
-				surfOrVolData = &vol.m_data[0];
+				surfOrVolSize = vol.getData().getSize();
+				surfOrVolData = vol.getData().getBegin();
 
 				allocationSize = computeVolumeSize(ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip, ctx.m_tex->getDepth() >> mip,
 												   ctx.m_tex->getFormat());
@@ -285,8 +291,8 @@ Error ImageResource::load(LoadingContext& ctx)
 			else
 			{
 				const auto& surf = ctx.m_loader.getSurface(mip, face, layer);
-				surfOrVolSize = surf.m_data.getSize();
-				surfOrVolData = &surf.m_data[0];
+				surfOrVolSize = surf.getData().getSize();
+				surfOrVolData = surf.getData().getBegin();
 
 				allocationSize = computeSurfaceSize(ctx.m_tex->getWidth() >> mip, ctx.m_tex->getHeight() >> mip, ctx.m_tex->getFormat());
 			}
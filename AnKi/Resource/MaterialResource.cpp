@@ -163,7 +163,7 @@ Error MaterialResource::parseShaderProgram(XmlElement shaderProgramEl, Bool asyn
 	ResourceString fname;
 	fname.sprintf("ShaderBinaries/%s.ankiprogbin", shaderName.cstr());
 
-	ANKI_CHECK(ResourceManager::getSingleton().loadResource(fname, m_prog, async));
+	ANKI_CHECK(ResourceManager::getSingleton().loadResource(fname, m_prog, async, getLoadPriority()));
 
 	// Find present techniques
 	for(const ShaderBinaryTechnique& t : m_prog->getBinary().m_techniques)
@@ -448,7 +448,7 @@ Error MaterialResource::parseInput(XmlElement inputEl, Bool async, BitSet<128>&
 		// If it has letters it's a texture
 		if(containsAlpharithmetic)
 		{
-			ANKI_CHECK(ResourceManager::getSingleton().loadResource(value, foundVar->m_image, async));
+			ANKI_CHECK(ResourceManager::getSingleton().loadResource(value, foundVar->m_image, async, getLoadPriority()));
 
 			foundVar->m_U32 = foundVar->m_image->getTexture().getOrCreateBindlessTextureIndex(TextureSubresourceDesc::all());
 		}
@@ -534,20 +534,20 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 
 	MaterialVariant& variant = m_variantMatrix[key.getRenderingTechnique()][key.getSkinned()][key.getVelocity()][key.getMeshletRendering()];
 
+	static_assert(sizeof(m_variantMatrix) / sizeof(MaterialVariant) <= sizeof(U32) * 8);
+	const U32 variantBit = 1u << U32(&variant - &m_variantMatrix[0][0][0][0]);
+
 	// Check if it's initialized
+	if(m_createdVariantsMask.load(AtomicMemoryOrder::kAcquire) & variantBit) [[likely]]
 	{
-		RLockGuard<RWMutex> lock(m_variantMatrixMtx);
-		if(variant.m_prog.isCreated()) [[likely]]
-		{
-			return variant;
-		}
+		return variant;
 	}
 
 	// Not initialized, init it
-	WLockGuard<RWMutex> lock(m_variantMatrixMtx);
+	LockGuard<Mutex> lock(m_variantMatrixMtx);
 
 	// Check again
-	if(variant.m_prog.isCreated())
+	if(m_createdVariantsMask.load(AtomicMemoryOrder::kRelaxed) & variantBit)
 	{
 		return variant;
 	}
@@ -624,6 +624,8 @@ const MaterialVariant& MaterialResource::getOrCreateVariant(const RenderingKey&
 		variant.m_rtShaderGroupHandleIndex = progVariant->getShaderGroupHandleIndex();
 	}
 
+	m_createdVariantsMask.fetchOr(variantBit, AtomicMemoryOrder::kRelease);
+
 	return variant;
 }
 
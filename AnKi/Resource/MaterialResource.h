@@ -239,7 +239,8 @@ private:
 	ShaderProgramResourcePtr m_prog;
 
 	mutable Array4d<MaterialVariant, U(RenderingTechnique::kCount), 2, 2, 2> m_variantMatrix; ///< [technique][skinned][vel][meshletRendering]
-	mutable RWMutex m_variantMatrixMtx;
+	mutable Atomic<U32> m_createdVariantsMask = {0}; ///< One bit per m_variantMatrix element. Lookups check it without locking.
+	mutable Mutex m_variantMatrixMtx; ///< Serializes the creation of variants.
 
 	ResourceDynamicArray<PartialMutation> m_partialMutation; ///< Only with the non-builtins.
 
@@ -39,6 +39,10 @@ Error MeshBinaryLoader::load(const ResourceFilename& filename)
 	ANKI_CHECK(checkHeader());
 	ANKI_CHECK(loadSubmeshes());
 
+	// The buffers will be read right after loading the header so start paging them in
+	const PtrSize buffersOffset = sizeof(m_header) + m_subMeshes.getSizeInBytes();
+	m_file->adviseAccess(buffersOffset, m_file->getSize() - buffersOffset, FileAccessHint::kWillNeed);
+
 	return Error::kNone;
 }
 
@@ -271,104 +275,66 @@ Error MeshBinaryLoader::checkHeader() const
 }
 
 Error MeshBinaryLoader::storeIndexBuffer(U32 lod, void* ptr, PtrSize size)
+{
+	const AsyncFileReadRequest req = getIndexBufferReadRequest(lod, ptr, size);
+	return m_file->readAt(req.m_offset, req.m_destination, req.m_size);
+}
+
+Error MeshBinaryLoader::storeVertexBuffer(U32 lod, U32 bufferIdx, void* ptr, PtrSize size)
+{
+	const AsyncFileReadRequest req = getVertexBufferReadRequest(lod, bufferIdx, ptr, size);
+	return m_file->readAt(req.m_offset, req.m_destination, req.m_size);
+}
+
+Error MeshBinaryLoader::storeMeshletIndicesBuffer(U32 lod, void* ptr, PtrSize size)
+{
+	const AsyncFileReadRequest req = getMeshletIndicesBufferReadRequest(lod, ptr, size);
+	return m_file->readAt(req.m_offset, req.m_destination, req.m_size);
+}
+
+Error MeshBinaryLoader::storeMeshletBuffer(U32 lod, WeakArray<MeshBinaryMeshlet> out)
+{
+	const AsyncFileReadRequest req = getMeshletBufferReadRequest(lod, out);
+	return m_file->readAt(req.m_offset, req.m_destination, req.m_size);
+}
+
+AsyncFileReadRequest MeshBinaryLoader::getIndexBufferReadRequest(U32 lod, void* ptr, PtrSize size) const
 {
 	ANKI_ASSERT(ptr);
 	ANKI_ASSERT(isLoaded());
 	ANKI_ASSERT(lod < m_header.m_lodCount);
 	ANKI_ASSERT(size == getIndexBufferSize(lod));
 
-	PtrSize seek = sizeof(m_header) + m_subMeshes.getSizeInBytes();
-	for(U32 l = lod + 1; l < m_header.m_lodCount; ++l)
-	{
-		seek += getLodBuffersSize(l);
-	}
-
-	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::kBeginning));
-	ANKI_CHECK(m_file->read(ptr, size));
-
-	return Error::kNone;
+	return newReadRequest(getIndexBufferOffset(lod), ptr, size);
 }
 
-Error MeshBinaryLoader::storeVertexBuffer(U32 lod, U32 bufferIdx, void* ptr, PtrSize size)
+AsyncFileReadRequest MeshBinaryLoader::getVertexBufferReadRequest(U32 lod, U32 bufferIdx, void* ptr, PtrSize size) const
 {
 	ANKI_ASSERT(ptr);
 	ANKI_ASSERT(isLoaded());
 	ANKI_ASSERT(size == getVertexBufferSize(lod, bufferIdx));
 	ANKI_ASSERT(lod < m_header.m_lodCount);
 
-	PtrSize seek = sizeof(m_header) + m_subMeshes.getSizeInBytes();
-
-	for(U32 l = lod + 1; l < m_header.m_lodCount; ++l)
-	{
-		seek += getLodBuffersSize(l);
-	}
-
-	seek += getIndexBufferSize(lod);
-
-	for(U32 i = 0; i < bufferIdx; ++i)
-	{
-		seek += getVertexBufferSize(lod, i);
-	}
-
-	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::kBeginning));
-	ANKI_CHECK(m_file->read(ptr, size));
-
-	return Error::kNone;
+	return newReadRequest(getVertexBufferOffset(lod, bufferIdx), ptr, size);
 }
 
-Error MeshBinaryLoader::storeMeshletIndicesBuffer(U32 lod, void* ptr, PtrSize size)
+AsyncFileReadRequest MeshBinaryLoader::getMeshletIndicesBufferReadRequest(U32 lod, void* ptr, PtrSize size) const
 {
 	ANKI_ASSERT(ptr);
 	ANKI_ASSERT(isLoaded());
 	ANKI_ASSERT(size == getMeshletPrimitivesBufferSize(lod));
 	ANKI_ASSERT(lod < m_header.m_lodCount);
 
-	PtrSize seek = sizeof(m_header) + m_subMeshes.getSizeInBytes();
-
-	for(U32 l = lod + 1; l < m_header.m_lodCount; ++l)
-	{
-		seek += getLodBuffersSize(l);
-	}
-
-	seek += getIndexBufferSize(lod);
-
-	for(U32 i = 0; i < m_header.m_vertexBuffers.getSize(); ++i)
-	{
-		seek += getVertexBufferSize(lod, i);
-	}
-
-	seek += getMeshletsBufferSize(lod);
-
-	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::kBeginning));
-	ANKI_CHECK(m_file->read(ptr, size));
-
-	return Error::kNone;
+	return newReadRequest(getMeshletsBufferOffset(lod) + getMeshletsBufferSize(lod), ptr, size);
 }
 
-Error MeshBinaryLoader::storeMeshletBuffer(U32 lod, WeakArray<MeshBinaryMeshlet> out)
+AsyncFileReadRequest MeshBinaryLoader::getMeshletBufferReadRequest(U32 lod, WeakArray<MeshBinaryMeshlet> out) const
 {
 	ANKI_ASSERT(isLoaded());
 	ANKI_ASSERT(out.getSizeInBytes() == getMeshletsBufferSize(lod));
 	ANKI_ASSERT(lod < m_header.m_lodCount);
 
-	PtrSize seek = sizeof(m_header) + m_subMeshes.getSizeInBytes();
-
-	for(U32 l = lod + 1; l < m_header.m_lodCount; ++l)
-	{
-		seek += getLodBuffersSize(l);
-	}
-
-	seek += getIndexBufferSize(lod);
-
-	for(U32 i = 0; i < m_header.m_vertexBuffers.getSize(); ++i)
-	{
-		seek += getVertexBufferSize(lod, i);
-	}
-
-	ANKI_CHECK(m_file->seek(seek, FileSeekOrigin::kBeginning));
-	ANKI_CHECK(m_file->read(&out[0], out.getSizeInBytes()));
-
-	return Error::kNone;
+	return newReadRequest(getMeshletsBufferOffset(lod), &out[0], out.getSizeInBytes());
 }
 
 Error MeshBinaryLoader::storeIndicesAndPosition(U32 lod, ResourceDynamicArray<U32>& indices, ResourceDynamicArray<Vec3>& positions)
@@ -380,32 +346,49 @@ Error MeshBinaryLoader::storeIndicesAndPosition(U32 lod, ResourceDynamicArray<U3
 	{
 		indices.resize(m_header.m_indexCounts[lod]);
 
-		// Store to staging buff
+		// Store to staging buff. If the file is memory mapped read straight from it. checkHeader() made sure the buffers are inside the file
 		DynamicArray<U8, MemoryPoolPtrWrapper<BaseMemoryPool>, PtrSize> staging(m_subMeshes.getMemoryPool());
-		staging.resize(getIndexBufferSize(lod));
-		ANKI_CHECK(storeIndexBuffer(lod, &staging[0], staging.getSizeInBytes()));
+		const U8* src = static_cast<const U8*>(m_file->getMappedView(getIndexBufferOffset(lod), getIndexBufferSize(lod)));
+		if(!src)
+		{
+			staging.resize(getIndexBufferSize(lod));
+			ANKI_CHECK(storeIndexBuffer(lod, &staging[0], staging.getSizeInBytes()));
+			src = &staging[0];
+		}
 
 		// Copy from staging
 		ANKI_ASSERT(m_header.m_indexType == IndexType::kU16);
 		for(U32 i = 0; i < m_header.m_indexCounts[lod]; ++i)
 		{
-			indices[i] = *reinterpret_cast<U16*>(&staging[PtrSize(i) * 2]);
+			U16 idx;
+			memcpy(&idx, src + PtrSize(i) * sizeof(U16), sizeof(U16));
+			indices[i] = idx;
 		}
 	}
 
 	// Store positions
 	{
 		const MeshBinaryVertexAttribute& attrib = m_header.m_vertexAttributes[VertexStreamId::kPosition];
-		DynamicArray<U16Vec4, MemoryPoolPtrWrapper<BaseMemoryPool>> tempPositions(m_subMeshes.getMemoryPool());
-		tempPositions.resize(m_header.m_vertexCounts[lod]);
 		static_assert(kMeshRelatedVertexStreamFormats[VertexStreamId::kPosition] == Format::kR16G16B16A16_Unorm, "Incorrect format");
-		ANKI_CHECK(storeVertexBuffer(lod, attrib.m_bufferIndex, &tempPositions[0], tempPositions.getSizeInBytes()));
+		const PtrSize positionsSize = PtrSize(m_header.m_vertexCounts[lod]) * sizeof(U16Vec4);
+
+		DynamicArray<U16Vec4, MemoryPoolPtrWrapper<BaseMemoryPool>> tempPositions(m_subMeshes.getMemoryPool());
+		const U8* src = static_cast<const U8*>(m_file->getMappedView(getVertexBufferOffset(lod, attrib.m_bufferIndex), positionsSize));
+		if(!src)
+		{
+			tempPositions.resize(m_header.m_vertexCounts[lod]);
+			ANKI_CHECK(storeVertexBuffer(lod, attrib.m_bufferIndex, &tempPositions[0], tempPositions.getSizeInBytes()));
+			src = reinterpret_cast<const U8*>(&tempPositions[0]);
+		}
 
 		positions.resize(m_header.m_vertexCounts[lod]);
 
-		for(U32 i = 0; i < tempPositions.getSize(); ++i)
+		for(U32 i = 0; i < m_header.m_vertexCounts[lod]; ++i)
 		{
-			positions[i] = Vec3(tempPositions[i].xyz()) / F32(kMaxU16);
+			U16Vec4 pos;
+			memcpy(&pos, src + PtrSize(i) * sizeof(U16Vec4), sizeof(U16Vec4));
+
+			positions[i] = Vec3(pos.xyz()) / F32(kMaxU16);
 			positions[i] *= Vec3(&attrib.m_scale[0]);
 			positions[i] += Vec3(&attrib.m_translation[0]);
 		}
@@ -414,6 +397,31 @@ Error MeshBinaryLoader::storeIndicesAndPosition(U32 lod, ResourceDynamicArray<U3
 	return Error::kNone;
 }
 
+PtrSize MeshBinaryLoader::getIndexBufferOffset(U32 lod) const
+{
+	ANKI_ASSERT(lod < m_header.m_lodCount);
+
+	// The LODs are stored in reverse order
+	PtrSize offset = sizeof(m_header) + m_subMeshes.getSizeInBytes();
+	for(U32 l = lod + 1; l < m_header.m_lodCount; ++l)
+	{
+		offset += getLodBuffersSize(l);
+	}
+
+	return offset;
+}
+
+PtrSize MeshBinaryLoader::getVertexBufferOffset(U32 lod, U32 bufferIdx) const
+{
+	PtrSize offset = getIndexBufferOffset(lod) + getIndexBufferSize(lod);
+	for(U32 i = 0; i < bufferIdx; ++i)
+	{
+		offset += getVertexBufferSize(lod, i);
+	}
+
+	return offset;
+}
+
 PtrSize MeshBinaryLoader::getLodBuffersSize(U32 lod) const
 {
 	ANKI_ASSERT(lod < m_header.m_lodCount);
@@ -49,6 +49,18 @@ public:
 
 	Error storeMeshletBuffer(U32 lod, WeakArray<MeshBinaryMeshlet> out);
 
+	/// @{
+	/// Same as the store* methods but instead of reading they return a request that can be batched with other reads in the AsyncFileReader.
+	/// The loader needs to stay alive until the reads are done.
+	AsyncFileReadRequest getIndexBufferReadRequest(U32 lod, void* ptr, PtrSize size) const;
+
+	AsyncFileReadRequest getVertexBufferReadRequest(U32 lod, U32 bufferIdx, void* ptr, PtrSize size) const;
+
+	AsyncFileReadRequest getMeshletIndicesBufferReadRequest(U32 lod, void* ptr, PtrSize size) const;
+
+	AsyncFileReadRequest getMeshletBufferReadRequest(U32 lod, WeakArray<MeshBinaryMeshlet> out) const;
+	/// @}
+
 	/// Instead of calling storeIndexBuffer and storeVertexBuffer use this method to get those buffers into the CPU.
 	Error storeIndicesAndPosition(U32 lod, ResourceDynamicArray<U32>& indices, ResourceDynamicArray<Vec3>& positions);
 
@@ -105,6 +117,28 @@ private:
 
 	PtrSize getLodBuffersSize(U32 lod) const;
 
+	/// Offset of the index buffer of a LOD from the start of the file.
+	PtrSize getIndexBufferOffset(U32 lod) const;
+
+	/// Offset of a vertex buffer of a LOD from the start of the file.
+	PtrSize getVertexBufferOffset(U32 lod, U32 bufferIdx) const;
+
+	/// Offset of the meshlets of a LOD from the start of the file.
+	PtrSize getMeshletsBufferOffset(U32 lod) const
+	{
+		return getVertexBufferOffset(lod, m_header.m_vertexBuffers.getSize());
+	}
+
+	AsyncFileReadRequest newReadRequest(PtrSize offset, void* ptr, PtrSize size) const
+	{
+		AsyncFileReadRequest req;
+		req.m_file = m_file.get();
+		req.m_offset = offset;
+		req.m_size = size;
+		req.m_destination = ptr;
+		return req;
+	}
+
 	Error checkHeader() const;
 	Error checkFormat(VertexStreamId stream, Bool isOptional, Bool canBeTransformed) const;
 	Error loadSubmeshes();
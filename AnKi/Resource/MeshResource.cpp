@@ -119,6 +119,8 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 
 	// LODs
 	m_lods.resize(header.m_lodCount);
+	// The UGB allocations of the meshes are not relocatable. Their offsets are baked into the BLASes, the meshlet descriptors, the ModelResource and
+	// the GPU scene mesh LODs and none of them can be patched after a move yet
 	for(I32 l = I32(header.m_lodCount - 1); l >= 0; --l)
 	{
 		Lod& lod = m_lods[l];
@@ -217,7 +219,7 @@ Error MeshResource::load(const ResourceFilename& filename, Bool async)
 	// Submit the loading task
 	if(async)
 	{
-		ResourceManager::getSingleton().getAsyncLoader().submitTask(task.get());
+		ResourceManager::getSingleton().getAsyncLoader().submitTask(task.get(), getLoadPriority());
 		LoadTask* pTask;
 		task.moveAndReset(pTask);
 	}
@@ -234,7 +236,8 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 	GrManager& gr = GrManager::getSingleton();
 	TransferGpuAllocator& transferAlloc = ResourceManager::getSingleton().getTransferGpuAllocator();
 
-	Array<TransferGpuAllocatorHandle, kMaxLodCount*(U32(VertexStreamId::kMeshRelatedCount) + 1 + 3)> handles;
+	constexpr U32 kMaxHandleCount = kMaxLodCount * (U32(VertexStreamId::kMeshRelatedCount) + 1 + 3);
+	Array<TransferGpuAllocatorHandle, kMaxHandleCount> handles;
 	U32 handleCount = 0;
 
 	Buffer* unifiedGeometryBuffer = &UnifiedGeometryBuffer::getSingleton().getBuffer();
@@ -249,6 +252,11 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 									   BufferUsageBit::kTransferDestination};
 	cmdb->setPipelineBarrier({}, {&barrier, 1}, {});
 
+	// Queue the reads of all the buffers of all the LODs at once and then wait for them. The copies can be recorded before the data are there
+	Array<AsyncFileReadRequest, kMaxHandleCount> readRequests;
+	U32 readRequestCount = 0;
+	Array<ResourceDynamicArray<MeshBinaryMeshlet>, kMaxLodCount> binaryMeshlets;
+
 	// Upload index and vertex buffers
 	for(U32 lodIdx = 0; lodIdx < m_lods.getSize(); ++lodIdx)
 	{
@@ -262,7 +270,7 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 			void* data = handle.getMappedMemory();
 			ANKI_ASSERT(data);
 
-			ANKI_CHECK(loader.storeIndexBuffer(lodIdx, data, handle.getRange()));
+			readRequests[readRequestCount++] = loader.getIndexBufferReadRequest(lodIdx, data, handle.getRange());
 
 			cmdb->copyBufferToBuffer(handle, lod.m_indexBufferAllocationToken);
 		}
@@ -282,7 +290,7 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 			ANKI_ASSERT(data);
 
 			// Load to staging
-			ANKI_CHECK(loader.storeVertexBuffer(lodIdx, U32(stream), data, handle.getRange()));
+			readRequests[readRequestCount++] = loader.getVertexBufferReadRequest(lodIdx, U32(stream), data, handle.getRange());
 
 			// Copy
 			cmdb->copyBufferToBuffer(handle, lod.m_vertexBuffersAllocationToken[stream]);
@@ -294,15 +302,25 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 			TransferGpuAllocatorHandle& handle = handles[handleCount++];
 			const PtrSize primitivesSize = lod.m_meshletIndices.getAllocatedSize();
 			ANKI_CHECK(transferAlloc.allocate(primitivesSize, handle));
-			ANKI_CHECK(loader.storeMeshletIndicesBuffer(lodIdx, handle.getMappedMemory(), primitivesSize));
+			readRequests[readRequestCount++] = loader.getMeshletIndicesBufferReadRequest(lodIdx, handle.getMappedMemory(), primitivesSize);
 
 			cmdb->copyBufferToBuffer(handle, lod.m_meshletIndices);
 
-			// Meshlets
-			ResourceDynamicArray<MeshBinaryMeshlet> binaryMeshlets;
-			binaryMeshlets.resize(loader.getHeader().m_meshletCounts[lodIdx]);
-			ANKI_CHECK(loader.storeMeshletBuffer(lodIdx, WeakArray(binaryMeshlets)));
+			// Meshlets. They will be processed when the reads are done
+			binaryMeshlets[lodIdx].resize(loader.getHeader().m_meshletCounts[lodIdx]);
+			readRequests[readRequestCount++] = loader.getMeshletBufferReadRequest(lodIdx, WeakArray(binaryMeshlets[lodIdx]));
+		}
+	}
+
+	ANKI_CHECK(ResourceManager::getSingleton().getFilesystem().getAsyncFileReader().read({&readRequests[0], readRequestCount}));
+
+	// Process the meshlets
+	for(U32 lodIdx = 0; lodIdx < m_lods.getSize(); ++lodIdx)
+	{
+		const Lod& lod = m_lods[lodIdx];
 
+		if(lod.m_meshletBoundingVolumes.isValid())
+		{
 			TransferGpuAllocatorHandle& handle2 = handles[handleCount++];
 			ANKI_CHECK(transferAlloc.allocate(lod.m_meshletBoundingVolumes.getAllocatedSize(), handle2));
 			WeakArray<MeshletBoundingVolume> outMeshletBoundingVolumes(static_cast<MeshletBoundingVolume*>(handle2.getMappedMemory()),
@@ -313,9 +331,9 @@ Error MeshResource::loadAsync(MeshBinaryLoader& loader) const
 			WeakArray<MeshletGeometryDescriptor> outMeshletGeomDescriptors(static_cast<MeshletGeometryDescriptor*>(handle3.getMappedMemory()),
 																		   loader.getHeader().m_meshletCounts[lodIdx]);
 
-			for(U32 i = 0; i < binaryMeshlets.getSize(); ++i)
+			for(U32 i = 0; i < binaryMeshlets[lodIdx].getSize(); ++i)
 			{
-				const MeshBinaryMeshlet& inMeshlet = binaryMeshlets[i];
+				const MeshBinaryMeshlet& inMeshlet = binaryMeshlets[lodIdx][i];
 				MeshletGeometryDescriptor& outMeshletGeom = outMeshletGeomDescriptors[i];
 				MeshletBoundingVolume& outMeshletBoundingVolume = outMeshletBoundingVolumes[i];
 
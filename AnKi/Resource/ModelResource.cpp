@@ -62,17 +62,17 @@ void ModelPatch::getRayTracingInfo(const RenderingKey& key, ModelRayTracingInfo&
 	info.m_shaderGroupHandleIndex = variant.getRtShaderGroupHandleIndex();
 }
 
-Error ModelPatch::init([[maybe_unused]] ModelResource* model, CString meshFName, const CString& mtlFName, U32 subMeshIndex, Bool async)
+Error ModelPatch::init(ModelResource* model, CString meshFName, const CString& mtlFName, U32 subMeshIndex, Bool async)
 {
 #if ANKI_ASSERTIONS_ENABLED
 	m_model = model;
 #endif
 
 	// Load material
-	ANKI_CHECK(ResourceManager::getSingleton().loadResource(mtlFName, m_mtl, async));
+	ANKI_CHECK(ResourceManager::getSingleton().loadResource(mtlFName, m_mtl, async, model->getLoadPriority()));
 
 	// Load mesh
-	ANKI_CHECK(ResourceManager::getSingleton().loadResource(meshFName, m_mesh, async));
+	ANKI_CHECK(ResourceManager::getSingleton().loadResource(meshFName, m_mesh, async, model->getLoadPriority()));
 
 	if(subMeshIndex != kMaxU32 && subMeshIndex >= m_mesh->getSubMeshCount())
 	{
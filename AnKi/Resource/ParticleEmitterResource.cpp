@@ -73,7 +73,7 @@ Error ParticleEmitterResource::load(const ResourceFilename& filename, Bool async
 	CString cstr;
 	ANKI_CHECK(rootEl.getChildElement("material", el));
 	ANKI_CHECK(el.getAttributeText("value", cstr));
-	ANKI_CHECK(ResourceManager::getSingleton().loadResource(cstr, m_material, async));
+	ANKI_CHECK(ResourceManager::getSingleton().loadResource(cstr, m_material, async, getLoadPriority()));
 
 	return Error::kNone;
 }
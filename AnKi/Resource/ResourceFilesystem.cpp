@@ -18,6 +18,13 @@ StringCVar g_dataPathsCVar(CVarSubsystem::kResource, "DataPaths", ".",
 						   "The engine loads assets only in from these paths. Separate them with : (it's smart enough to identify drive letters in "
 						   "Windows). After a path you can add an optional | and what follows it is a number of words to include or exclude paths. "
 						   "eg. my_path|include_this,include_that,+exclude_this");
+static NumericCVar<U32> g_fileReaderThreadCountCVar(CVarSubsystem::kResource, "FileReaderThreadCount", 2, 1, 16,
+													  "The number of threads that read files when io_uring is not used");
+static BoolCVar g_ioUringCVar(CVarSubsystem::kResource, "IoUring", true, "Use io_uring for file reads if it's available (Linux only)");
+static BoolCVar g_memoryMapResourceFilesCVar(CVarSubsystem::kResource, "MemoryMapResourceFiles", ANKI_POSIX,
+											 "Memory map the files that are not in archives instead of reading them with stdio");
+static BoolCVar g_watchDataPathsCVar(CVarSubsystem::kResource, "WatchDataPaths", false,
+									 "Watch the data directories for new and deleted files and update the file index when they change");
 
 static Error tokenizePath(CString path, ResourceString& actualPath, ResourceStringList& includedWords, ResourceStringList& excludedWords)
 {
@@ -58,11 +65,51 @@ static Error tokenizePath(CString path, ResourceString& actualPath, ResourceStri
 	return Error::kNone;
 }
 
+/// Make the filenames comparable. Use forward slashes and remove "." and empty path components. Leading slashes are kept.
+static void normalizeFilename(CString in, ResourceString& out)
+{
+	out.destroy();
+
+	const Char* c = in.cstr();
+	if(*c == '/' || *c == '\\')
+	{
+		out = "/";
+	}
+
+	while(*c != '\0')
+	{
+		// Find the next component
+		while(*c == '/' || *c == '\\')
+		{
+			++c;
+		}
+
+		const Char* begin = c;
+		while(*c != '\0' && *c != '/' && *c != '\\')
+		{
+			++c;
+		}
+
+		const PtrSize len = PtrSize(c - begin);
+		if(len == 0 || (len == 1 && *begin == '.'))
+		{
+			continue;
+		}
+
+		if(!out.isEmpty() && out != "/")
+		{
+			out += "/";
+		}
+		out += ResourceString(begin, c);
+	}
+}
+
 /// C resource file
 class CResourceFile final : public ResourceFile
 {
 public:
 	File m_file;
+	Mutex m_readAtMtx;
 
 	Error read(void* buff, PtrSize size) override
 	{
@@ -97,14 +144,168 @@ public:
 	{
 		return m_file.getSize();
 	}
+
+	Error readAt(PtrSize offset, void* buff, PtrSize size) override
+	{
+		ANKI_TRACE_SCOPED_EVENT(RsrcFileRead);
+
+#if ANKI_POSIX
+		if(m_file.getFileDescriptor() >= 0)
+		{
+			return m_file.readAt(offset, buff, size);
+		}
+#endif
+
+		// Special file, do it the slow way
+		LockGuard<Mutex> lock(m_readAtMtx);
+		const PtrSize pos = m_file.tell();
+		Error err = m_file.seek(offset, FileSeekOrigin::kBeginning);
+		if(!err)
+		{
+			err = m_file.read(buff, size);
+		}
+
+		const Error err2 = m_file.seek(pos, FileSeekOrigin::kBeginning);
+		return (err) ? err : err2;
+	}
+
+#if ANKI_POSIX
+	I32 getFileDescriptor() const override
+	{
+		return m_file.getFileDescriptor();
+	}
+#endif
 };
 
+#if ANKI_POSIX
+/// Memory mapped file. Reads are plain copies from the page cache and loaders can access the contents without any copy.
+class MappedResourceFile final : public ResourceFile
+{
+public:
+	MemoryMappedFile m_file;
+	PtrSize m_pos = 0;
+
+	Error read(void* buff, PtrSize size) override
+	{
+		ANKI_TRACE_SCOPED_EVENT(RsrcFileRead);
+
+		if(size > m_file.getSize() - m_pos)
+		{
+			ANKI_RESOURCE_LOGE("File read failed");
+			return Error::kFileAccess;
+		}
+
+		if(size)
+		{
+			memcpy(buff, m_file.getData() + m_pos, size);
+			m_pos += size;
+		}
+
+		return Error::kNone;
+	}
+
+	Error readAllText(ResourceString& out) override
+	{
+		if(m_file.getSize() == 0)
+		{
+			return Error::kFunctionFailed;
+		}
+
+		out = ResourceString('?', m_file.getSize());
+		return read(&out[0], m_file.getSize());
+	}
+
+	Error readU32(U32& u) override
+	{
+		// Assume machine and file have same endianness
+		return read(&u, sizeof(u));
+	}
+
+	Error readF32(F32& f) override
+	{
+		// Assume machine and file have same endianness
+		return read(&f, sizeof(f));
+	}
+
+	Error seek(PtrSize offset, FileSeekOrigin origin) override
+	{
+		PtrSize newPos;
+		switch(origin)
+		{
+		case FileSeekOrigin::kBeginning:
+			newPos = offset;
+			break;
+		case FileSeekOrigin::kCurrent:
+			newPos = m_pos + offset;
+			break;
+		default:
+			ANKI_ASSERT(origin == FileSeekOrigin::kEnd);
+			newPos = m_file.getSize() + offset;
+		}
+
+		if(newPos > m_file.getSize())
+		{
+			ANKI_RESOURCE_LOGE("Seeking past the end of the file");
+			return Error::kFileAccess;
+		}
+
+		m_pos = newPos;
+		return Error::kNone;
+	}
+
+	PtrSize getSize() const override
+	{
+		return m_file.getSize();
+	}
+
+	Error readAt(PtrSize offset, void* buff, PtrSize size) override
+	{
+		ANKI_TRACE_SCOPED_EVENT(RsrcFileRead);
+
+		if(offset > m_file.getSize() || size > m_file.getSize() - offset)
+		{
+			ANKI_RESOURCE_LOGE("File read failed");
+			return Error::kFileAccess;
+		}
+
+		if(size)
+		{
+			memcpy(buff, m_file.getData() + offset, size);
+		}
+
+		return Error::kNone;
+	}
+
+	I32 getFileDescriptor() const override
+	{
+		return m_file.getFileDescriptor();
+	}
+
+	const void* getMappedView(PtrSize offset, PtrSize size) const override
+	{
+		if(offset > m_file.getSize() || size > m_file.getSize() - offset)
+		{
+			return nullptr;
+		}
+
+		return m_file.getData() + offset;
+	}
+
+	void adviseAccess(PtrSize offset, PtrSize size, FileAccessHint hint) const override
+	{
+		m_file.adviseAccess(offset, size, hint);
+	}
+};
+#endif
+
 /// ZIP file
 class ZipResourceFile final : public ResourceFile
 {
 public:
 	unzFile m_archive = nullptr;
 	PtrSize m_size = 0;
+	PtrSize m_pos = 0;
+	Mutex m_readAtMtx;
 
 	~ZipResourceFile()
 	{
@@ -117,7 +318,7 @@ public:
 		}
 	}
 
-	Error open(const CString& archive, const CString& archivedFname)
+	Error open(const CString& archive, unz_file_pos filePos)
 	{
 		// Open archive
 		m_archive = unzOpen(&archive[0]);
@@ -127,9 +328,8 @@ public:
 			return Error::kFileAccess;
 		}
 
-		// Locate archived
-		const int caseSensitive = 1;
-		if(unzLocateFile(m_archive, &archivedFname[0], caseSensitive) != UNZ_OK)
+		// Go to the file. The position comes from the listing of the archive so there is no need to search for it
+		if(unzGoToFilePos(m_archive, &filePos) != UNZ_OK)
 		{
 			ANKI_RESOURCE_LOGE("Failed to locate file in archive");
 			return Error::kFileAccess;
@@ -174,6 +374,7 @@ public:
 			return Error::kFileAccess;
 		}
 
+		m_pos += size;
 		return Error::kNone;
 	}
 
@@ -208,6 +409,8 @@ public:
 				ANKI_RESOURCE_LOGE("Rewind failed");
 				return Error::kFunctionFailed;
 			}
+
+			m_pos = 0;
 		}
 
 		// Move forward by reading dummy data
@@ -227,6 +430,103 @@ public:
 		ANKI_ASSERT(m_size > 0);
 		return m_size;
 	}
+
+	Error readAt(PtrSize offset, void* buff, PtrSize size) override
+	{
+		// The entry can only be decompressed sequentially so seek to the offset and then restore the position
+		LockGuard<Mutex> lock(m_readAtMtx);
+		const PtrSize pos = m_pos;
+		Error err = (offset >= m_pos) ? seek(offset - m_pos, FileSeekOrigin::kCurrent) : seek(offset, FileSeekOrigin::kBeginning);
+		if(!err)
+		{
+			err = read(buff, size);
+		}
+
+		if(!err)
+		{
+			err = (pos >= m_pos) ? seek(pos - m_pos, FileSeekOrigin::kCurrent) : seek(pos, FileSeekOrigin::kBeginning);
+		}
+
+		return err;
+	}
+};
+
+/// A file inside a resource package. Seeking is cheap and reads only decompress the blocks they need.
+class PackageResourceFile final : public ResourceFile
+{
+public:
+	ResourcePackagePtr m_package;
+	U32 m_fileIdx = kMaxU32;
+	PtrSize m_pos = 0;
+	ResourcePackageBlockCache m_blockCache; ///< Small consecutive reads hit the same block.
+
+	Error read(void* buff, PtrSize size) override
+	{
+		ANKI_CHECK(m_package->readFile(m_fileIdx, m_pos, buff, size, &m_blockCache));
+		m_pos += size;
+		return Error::kNone;
+	}
+
+	Error readAllText(ResourceString& out) override
+	{
+		const PtrSize size = getSize();
+		if(size == 0)
+		{
+			return Error::kFunctionFailed;
+		}
+
+		out = ResourceString('?', size);
+		return read(&out[0], size);
+	}
+
+	Error readU32(U32& u) override
+	{
+		// Assume machine and file have same endianness
+		return read(&u, sizeof(u));
+	}
+
+	Error readF32(F32& f) override
+	{
+		// Assume machine and file have same endianness
+		return read(&f, sizeof(f));
+	}
+
+	Error seek(PtrSize offset, FileSeekOrigin origin) override
+	{
+		PtrSize newPos;
+		if(origin == FileSeekOrigin::kBeginning)
+		{
+			newPos = offset;
+		}
+		else if(origin == FileSeekOrigin::kCurrent)
+		{
+			newPos = m_pos + offset;
+		}
+		else
+		{
+			newPos = getSize() + offset;
+		}
+
+		if(newPos > getSize())
+		{
+			ANKI_RESOURCE_LOGE("Seeking past the end of the file");
+			return Error::kFunctionFailed;
+		}
+
+		m_pos = newPos;
+		return Error::kNone;
+	}
+
+	PtrSize getSize() const override
+	{
+		return m_package->getFileSize(m_fileIdx);
+	}
+
+	Error readAt(PtrSize offset, void* buff, PtrSize size) override
+	{
+		// Don't touch the cache so reads from many threads can decompress in parallel
+		return m_package->readFile(m_fileIdx, offset, buff, size);
+	}
 };
 
 ResourceFilesystem::~ResourceFilesystem()
@@ -284,6 +584,8 @@ Error ResourceFilesystem::init()
 	ANKI_CHECK(addNewPath(g_androidApp->activity->externalDataPath, {}, {}));
 #endif
 
+	ANKI_CHECK(m_asyncFileReader.init(g_fileReaderThreadCountCVar.get(), g_ioUringCVar.get()));
+
 	return Error::kNone;
 }
 
@@ -291,38 +593,53 @@ Error ResourceFilesystem::addNewPath(CString filepath, const ResourceStringList&
 {
 	ANKI_RESOURCE_LOGV("Adding new resource path: %s", filepath.cstr());
 
-	U32 fileCount = 0; // Count files manually because it's slower to get that number from the list
-	constexpr CString extension(".ankizip");
+	Path path;
+	path.m_path.sprintf("%s", &filepath[0]);
+	path.m_includedStrings = includedStrings;
+	path.m_excludedStrings = excludedStrings;
+
+	ANKI_CHECK(populatePath(path));
 
-	auto includePath = [&](CString p) -> Bool {
-		for(const ResourceString& s : excludedStrings)
+	const U32 fileCount = U32(path.m_files.getSize());
+	if(fileCount == 0)
+	{
+		ANKI_RESOURCE_LOGW("Ignoring empty resource path: %s", &filepath[0]);
+	}
+	else
+	{
+		if(g_watchDataPathsCVar.get() && !path.m_isArchive && !path.m_package)
 		{
-			const Bool found = p.find(s) != CString::kNpos;
-			if(found)
-			{
-				return false;
-			}
+			path.m_watcher.reset(newInstance<INotify>(ResourceMemoryPool::getSingleton()));
+			ANKI_CHECK(path.m_watcher->init(filepath, true));
 		}
 
-		if(!includedStrings.isEmpty())
-		{
-			for(const ResourceString& s : includedStrings)
-			{
-				const Bool found = p.find(s) != CString::kNpos;
-				if(found)
-				{
-					return true;
-				}
-			}
+		WLockGuard<RWMutex> lock(m_fileIndexMtx);
+		m_paths.emplaceFront(std::move(path));
+
+		ANKI_RESOURCE_LOGI("Added new data path \"%s\" that contains %u files", &filepath[0], fileCount);
+	}
 
-			return false;
+	if(false)
+	{
+		for(const ResourceString& s : m_paths.getFront().m_files)
+		{
+			printf("%s\n", s.cstr());
 		}
+	}
+
+	return Error::kNone;
+}
+
+Error ResourceFilesystem::populatePath(Path& path)
+{
+	constexpr CString extension(".ankizip");
+	constexpr CString packageExtension(kResourcePackageExtension);
+	const CString filepath = path.m_path;
 
-		return true;
-	};
+	path.m_files.destroy();
+	path.m_fileIndex.destroy();
 
 	PtrSize pos;
-	Path path;
 	if((pos = filepath.find(extension)) != CString::kNpos && pos == filepath.getLength() - extension.getLength())
 	{
 		// It's an archive
@@ -348,18 +665,20 @@ Error ResourceFilesystem::addNewPath(CString filepath, const ResourceStringList&
 			Array<char, 1024> filename;
 
 			unz_file_info info;
-			if(unzGetCurrentFileInfo(zfile, &info, &filename[0], filename.getSize(), nullptr, 0, nullptr, 0) != UNZ_OK)
+			unz_file_pos filePos;
+			if(unzGetCurrentFileInfo(zfile, &info, &filename[0], filename.getSize(), nullptr, 0, nullptr, 0) != UNZ_OK
+			   || unzGetFilePos(zfile, &filePos) != UNZ_OK)
 			{
 				unzClose(zfile);
 				ANKI_RESOURCE_LOGE("unzGetCurrentFileInfo() failed");
 				return Error::kFileAccess;
 			}
 
+			// Remember the position of the file so opening it doesn't have to search the archive
 			const Bool itsADir = info.uncompressed_size == 0;
-			if(!itsADir && includePath(&filename[0]))
+			if(!itsADir)
 			{
-				path.m_files.pushBackSprintf("%s", &filename[0]);
-				++fileCount;
+				addFileToIndex(path, &filename[0], filePos.pos_in_zip_directory, U32(filePos.num_of_file));
 			}
 		} while(unzGoToNextFile(zfile) == UNZ_OK);
 
@@ -367,40 +686,213 @@ Error ResourceFilesystem::addNewPath(CString filepath, const ResourceStringList&
 
 		path.m_isArchive = true;
 	}
+	else if((pos = filepath.find(packageExtension)) != CString::kNpos && pos == filepath.getLength() - packageExtension.getLength())
+	{
+		// It's a package. Keep it open, all its files will read from it
+
+		if(!path.m_package)
+		{
+			path.m_package.reset(newInstance<ResourcePackage>(ResourceMemoryPool::getSingleton()));
+			ANKI_CHECK(path.m_package->open(filepath));
+		}
+
+		for(U32 i = 0; i < path.m_package->getFileCount(); ++i)
+		{
+			addFileToIndex(path, path.m_package->getFilename(i), 0, i);
+		}
+	}
 	else
 	{
 		// It's simple directory
 
 		ANKI_CHECK(walkDirectoryTree(filepath, [&](const CString& fname, Bool isDir) -> Error {
-			if(!isDir && includePath(fname))
+			if(!isDir)
 			{
-				path.m_files.pushBackSprintf("%s", fname.cstr());
-				++fileCount;
+				addFileToIndex(path, fname, 0, kMaxU32);
 			}
 
 			return Error::kNone;
 		}));
 	}
 
-	ANKI_ASSERT(path.m_files.getSize() == fileCount);
-	if(fileCount == 0)
+	return Error::kNone;
+}
+
+void ResourceFilesystem::addFileToIndex(Path& path, CString fname, U64 archiveOffset, U32 archiveIdx)
+{
+	for(const ResourceString& s : path.m_excludedStrings)
 	{
-		ANKI_RESOURCE_LOGW("Ignoring empty resource path: %s", &filepath[0]);
+		if(fname.find(s) != CString::kNpos)
+		{
+			return;
+		}
 	}
-	else
+
+	if(!path.m_includedStrings.isEmpty())
 	{
-		path.m_path.sprintf("%s", &filepath[0]);
-		m_paths.emplaceFront(std::move(path));
+		Bool included = false;
+		for(const ResourceString& s : path.m_includedStrings)
+		{
+			included = included || fname.find(s) != CString::kNpos;
+		}
 
-		ANKI_RESOURCE_LOGI("Added new data path \"%s\" that contains %u files", &filepath[0], fileCount);
+		if(!included)
+		{
+			return;
+		}
 	}
 
-	if(false)
+	ResourceString normalized;
+	normalizeFilename(fname, normalized);
+
+	auto it = path.m_fileIndex.find(normalized.toCString());
+	if(it != path.m_fileIndex.getEnd())
 	{
-		for(const ResourceString& s : m_paths.getFront().m_files)
+		if(*it->m_filename != normalized)
 		{
-			printf("%s\n", s.cstr());
+			ANKI_RESOURCE_LOGW("Filename hash collision. %s will be ignored in: %s", normalized.cstr(), path.m_path.cstr());
+		}
+
+		return;
+	}
+
+	path.m_files.pushBack(normalized);
+
+	Path::FileEntry entry;
+	entry.m_filename = &path.m_files.getBack();
+	entry.m_archiveOffset = archiveOffset;
+	entry.m_archiveIdx = archiveIdx;
+	path.m_fileIndex.emplace(entry.m_filename->toCString(), entry);
+}
+
+void ResourceFilesystem::removeFromIndex(Path& path, CString fname, Bool isDirectory)
+{
+	ResourceString normalized;
+	normalizeFilename(fname, normalized);
+
+	ResourceString prefix;
+	if(isDirectory)
+	{
+		prefix.sprintf("%s/", normalized.cstr());
+	}
+
+	// All the files of the list are in the index, the ones with colliding hashes were never added
+	auto it = path.m_files.getBegin();
+	while(it != path.m_files.getEnd())
+	{
+		auto next = it;
+		++next;
+
+		if((isDirectory) ? it->find(prefix.toCString()) == 0 : *it == normalized)
+		{
+			auto indexIt = path.m_fileIndex.find(it->toCString());
+			ANKI_ASSERT(indexIt != path.m_fileIndex.getEnd() && indexIt->m_filename == &(*it));
+			path.m_fileIndex.erase(indexIt);
+			path.m_files.erase(it);
+
+			if(!isDirectory)
+			{
+				break;
+			}
 		}
+
+		it = next;
+	}
+}
+
+Error ResourceFilesystem::updateFileIndex()
+{
+	// The list of paths doesn't change after init() so no need to lock to iterate it
+	for(Path& path : m_paths)
+	{
+		if(!path.m_watcher)
+		{
+			continue;
+		}
+
+		DynamicArray<INotifyEvent> events;
+		ANKI_CHECK(path.m_watcher->pollEvents(events));
+
+		// Turn the events to insertions and removals. Modifications don't change the index
+		class IndexChange
+		{
+		public:
+			ResourceString m_filename;
+			Bool m_remove;
+			Bool m_isDirectory;
+		};
+
+		ResourceDynamicArray<IndexChange> changes;
+		Bool rescan = false;
+		for(const INotifyEvent& event : events)
+		{
+			if(event.m_type == INotifyEventType::kOverflow)
+			{
+				rescan = true;
+				break;
+			}
+			else if(event.m_type == INotifyEventType::kDeleted)
+			{
+				changes.emplaceBack(IndexChange{event.m_path.toCString(), true, event.m_isDirectory});
+			}
+			else if(event.m_type == INotifyEventType::kCreated && !event.m_isDirectory)
+			{
+				changes.emplaceBack(IndexChange{event.m_path.toCString(), false, false});
+			}
+			else if(event.m_type == INotifyEventType::kCreated)
+			{
+				// A new directory is not empty if it was moved here. List it without holding the lock
+				ResourceString dir;
+				dir.sprintf("%s/%s", path.m_path.cstr(), event.m_path.cstr());
+				if(directoryExists(dir))
+				{
+					ANKI_CHECK(walkDirectoryTree(dir, [&](CString fname, Bool isDir) -> Error {
+						if(!isDir)
+						{
+							changes.emplaceBack(IndexChange{ResourceString().sprintf("%s/%s", event.m_path.cstr(), fname.cstr()), false, false});
+						}
+
+						return Error::kNone;
+					}));
+				}
+			}
+		}
+
+		if(rescan)
+		{
+			// Events were lost. List the files without holding the lock and then swap. Moving the lists keeps the strings where the index points to
+			Path newPath;
+			newPath.m_path = path.m_path;
+			newPath.m_includedStrings = path.m_includedStrings;
+			newPath.m_excludedStrings = path.m_excludedStrings;
+			ANKI_CHECK(populatePath(newPath));
+
+			WLockGuard<RWMutex> lock(m_fileIndexMtx);
+			path.m_files = std::move(newPath.m_files);
+			path.m_fileIndex = std::move(newPath.m_fileIndex);
+		}
+		else if(!changes.isEmpty())
+		{
+			WLockGuard<RWMutex> lock(m_fileIndexMtx);
+			for(const IndexChange& change : changes)
+			{
+				if(change.m_remove)
+				{
+					removeFromIndex(path, change.m_filename, change.m_isDirectory);
+				}
+				else
+				{
+					addFileToIndex(path, change.m_filename, 0, kMaxU32);
+				}
+			}
+		}
+		else
+		{
+			continue;
+		}
+
+		ANKI_RESOURCE_LOGV("Data path changed and it was %s: %s. It contains %u files", (rescan) ? "re-indexed" : "updated", path.m_path.cstr(),
+						   U32(path.m_files.getSize()));
 	}
 
 	return Error::kNone;
@@ -429,43 +921,65 @@ Error ResourceFilesystem::openFileInternal(const ResourceFilename& filename, Res
 {
 	rfile = nullptr;
 
+	ResourceString normalized;
+	normalizeFilename(filename, normalized);
+
 	// Search for the fname in reverse order
+	RLockGuard<RWMutex> lock(m_fileIndexMtx);
 	for(const Path& p : m_paths)
 	{
-		for(const ResourceString& pfname : p.m_files)
+		auto it = p.m_fileIndex.find(normalized.toCString());
+		if(it == p.m_fileIndex.getEnd() || *it->m_filename != normalized)
 		{
-			if(pfname != filename)
-			{
-				continue;
-			}
+			continue;
+		}
+
+		// Found
+		const Path::FileEntry& entry = *it;
+		if(p.m_package)
+		{
+			PackageResourceFile* file = newInstance<PackageResourceFile>(ResourceMemoryPool::getSingleton());
+			rfile = file;
+
+			file->m_package = p.m_package;
+			file->m_fileIdx = entry.m_archiveIdx;
+		}
+		else if(p.m_isArchive)
+		{
+			ZipResourceFile* file = newInstance<ZipResourceFile>(ResourceMemoryPool::getSingleton());
+			rfile = file;
 
-			// Found
-			if(p.m_isArchive)
+			unz_file_pos filePos;
+			filePos.pos_in_zip_directory = uLong(entry.m_archiveOffset);
+			filePos.num_of_file = entry.m_archiveIdx;
+			ANKI_CHECK(file->open(p.m_path.toCString(), filePos));
+		}
+		else
+		{
+			ResourceString newFname;
+			newFname.sprintf("%s/%s", &p.m_path[0], normalized.cstr());
+
+#if ANKI_POSIX
+			if(g_memoryMapResourceFilesCVar.get())
 			{
-				ZipResourceFile* file = newInstance<ZipResourceFile>(ResourceMemoryPool::getSingleton());
+				MappedResourceFile* file = newInstance<MappedResourceFile>(ResourceMemoryPool::getSingleton());
 				rfile = file;
-
-				ANKI_CHECK(file->open(p.m_path.toCString(), filename));
+				ANKI_CHECK(file->m_file.open(newFname));
 			}
 			else
+#endif
 			{
-				ResourceString newFname;
-				newFname.sprintf("%s/%s", &p.m_path[0], &filename[0]);
-
 				CResourceFile* file = newInstance<CResourceFile>(ResourceMemoryPool::getSingleton());
 				rfile = file;
 				ANKI_CHECK(file->m_file.open(newFname, FileOpenFlag::kRead));
+			}
 
 #if 0
-				printf("Opening asset %s\n", &newFname[0]);
+			printf("Opening asset %s\n", &newFname[0]);
 #endif
-			}
 		}
 
-		if(rfile)
-		{
-			break;
-		}
+		break;
 	} // end for all paths
 
 	// File not found? On Win/Linux try to find it outside the resource dirs. On Android try the archive
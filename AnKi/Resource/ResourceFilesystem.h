@@ -6,9 +6,14 @@
 #pragma once
 
 #include <AnKi/Resource/Common.h>
+#include <AnKi/Resource/AsyncFileReader.h>
+#include <AnKi/Resource/ResourcePackage.h>
 #include <AnKi/Util/String.h>
 #include <AnKi/Util/StringList.h>
 #include <AnKi/Util/File.h>
+#include <AnKi/Util/MemoryMappedFile.h>
+#include <AnKi/Util/INotify.h>
+#include <AnKi/Util/HashMap.h>
 #include <AnKi/Util/Ptr.h>
 #include <AnKi/Core/CVarSet.h>
 
@@ -54,6 +59,29 @@ public:
 	/// Get the size of the file.
 	virtual PtrSize getSize() const = 0;
 
+	/// Read from an offset of the file. It doesn't use or change the position indicator and it's thread-safe.
+	virtual Error readAt(PtrSize offset, void* buff, PtrSize size) = 0;
+
+	/// Get a file descriptor that can be used to read the contents of the file directly (POSIX only).
+	/// @return The descriptor or -1 if the file can't be read that way (eg it's in an archive).
+	virtual I32 getFileDescriptor() const
+	{
+		return -1;
+	}
+
+	/// Get a pointer to a range of the file's contents without copying them. Only memory mapped files support it.
+	/// @return The contents or nullptr if the file is not memory mapped or the range is out of the file's bounds. The pointer is valid for as long
+	///         as the file is alive. Callers can fall back to readAt() that reports bad ranges as errors.
+	virtual const void* getMappedView([[maybe_unused]] PtrSize offset, [[maybe_unused]] PtrSize size) const
+	{
+		return nullptr;
+	}
+
+	/// Give a hint about how a range of the file will be read. Only memory mapped files make use of it.
+	virtual void adviseAccess([[maybe_unused]] PtrSize offset, [[maybe_unused]] PtrSize size, [[maybe_unused]] FileAccessHint hint) const
+	{
+	}
+
 	void retain() const
 	{
 		m_refcount.fetchAdd(1);
@@ -97,7 +125,16 @@ public:
 	/// Search the path list to find the file. Then open the file for reading. It's thread-safe.
 	Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
-	/// Iterate all the filenames from all paths provided.
+	/// If the data directories are watched (see the WatchDataPaths CVar) re-index the ones that changed. It's thread-safe against openFile().
+	Error updateFileIndex();
+
+	/// Use it to read many ranges of files in parallel.
+	AsyncFileReader& getAsyncFileReader()
+	{
+		return m_asyncFileReader;
+	}
+
+	/// Iterate all the filenames from all paths provided. Don't call it at the same time as updateFileIndex().
 	template<typename TFunc>
 	Error iterateAllFilenames(TFunc func) const
 	{
@@ -117,8 +154,22 @@ private:
 	class Path
 	{
 	public:
-		ResourceStringList m_files; ///< Files inside the directory.
-		ResourceString m_path; ///< A directory or an archive.
+		/// Where to find a file of the path.
+		class FileEntry
+		{
+		public:
+			const ResourceString* m_filename = nullptr; ///< Points to m_files. It's used to detect hash collisions.
+			U64 m_archiveOffset = 0; ///< The offset of the file in the directory of the zip archive.
+			U32 m_archiveIdx = kMaxU32; ///< The index of the file in the zip archive or in the package.
+		};
+
+		ResourceStringList m_files; ///< Files inside the directory. The filenames are normalized.
+		ResourceHashMap<CString, FileEntry> m_fileIndex; ///< Normalized filename to file.
+		ResourceString m_path; ///< A directory, an archive or a package.
+		ResourceStringList m_includedStrings;
+		ResourceStringList m_excludedStrings;
+		ResourcePackagePtr m_package; ///< Set if it's a package.
+		UniquePtr<INotify, SingletonMemoryPoolDeleter<ResourceMemoryPool>> m_watcher; ///< Set if it's a directory that is watched.
 		Bool m_isArchive = false;
 
 		Path() = default;
@@ -135,18 +186,34 @@ private:
 		Path& operator=(Path&& b)
 		{
 			m_files = std::move(b.m_files);
+			m_fileIndex = std::move(b.m_fileIndex);
 			m_path = std::move(b.m_path);
+			m_includedStrings = std::move(b.m_includedStrings);
+			m_excludedStrings = std::move(b.m_excludedStrings);
+			m_package = std::move(b.m_package);
+			m_watcher = std::move(b.m_watcher);
 			m_isArchive = b.m_isArchive;
 			return *this;
 		}
 	};
 
 	ResourceList<Path> m_paths;
+	RWMutex m_fileIndexMtx; ///< Protects the files and the indices of the paths.
 	ResourceString m_cacheDir;
+	AsyncFileReader m_asyncFileReader;
 
-	/// Add a filesystem path or an archive. The path is read-only.
+	/// Add a filesystem path, an archive or a package. The path is read-only.
 	Error addNewPath(CString path, const ResourceStringList& includeStrings, const ResourceStringList& excludedStrings);
 
+	/// List the files of a path and build its index.
+	static Error populatePath(Path& path);
+
+	/// Add a file to the index of a path if the included and excluded strings of the path allow it.
+	static void addFileToIndex(Path& path, CString filename, U64 archiveOffset, U32 archiveIdx);
+
+	/// Remove a file or all the files of a directory from the index of a path.
+	static void removeFromIndex(Path& path, CString filename, Bool isDirectory);
+
 	Error openFileInternal(const ResourceFilename& filename, ResourceFile*& rfile);
 };
 /// @}
@@ -8,6 +8,7 @@
 #include <AnKi/Resource/ShaderProgramResourceSystem.h>
 #include <AnKi/Resource/AnimationResource.h>
 #include <AnKi/Util/Logger.h>
+#include <AnKi/Util/System.h>
 #include <AnKi/Core/CVarSet.h>
 
 #include <AnKi/Resource/MaterialResource.h>
@@ -27,6 +28,8 @@ namespace anki {
 
 static NumericCVar<PtrSize> g_transferScratchMemorySizeCVar(CVarSubsystem::kResource, "TransferScratchMemorySize", 256_MB, 1_MB, 4_GB,
 															"Memory that is used fot texture and buffer uploads");
+static NumericCVar<U32> g_asyncLoaderThreadCountCVar(CVarSubsystem::kResource, "AsyncLoaderThreadCount", clamp(getCpuCoresCount() / 4u, 1u, 4u), 1u,
+													  32u, "Number of the threads that load resources asynchronously");
 
 ResourceManager::ResourceManager()
 {
@@ -53,8 +56,8 @@ Error ResourceManager::init(AllocAlignedCallback allocCallback, void* allocCallb
 	m_fs = newInstance<ResourceFilesystem>(ResourceMemoryPool::getSingleton());
 	ANKI_CHECK(m_fs->init());
 
-	// Init the thread
-	m_asyncLoader = newInstance<AsyncLoader>(ResourceMemoryPool::getSingleton());
+	// Init the threads
+	m_asyncLoader = newInstance<AsyncLoader>(ResourceMemoryPool::getSingleton(), g_asyncLoaderThreadCountCVar.get());
 
 	m_transferGpuAlloc = newInstance<TransferGpuAllocator>(ResourceMemoryPool::getSingleton());
 	ANKI_CHECK(m_transferGpuAlloc->init(g_transferScratchMemorySizeCVar.get()));
@@ -67,13 +70,14 @@ Error ResourceManager::init(AllocAlignedCallback allocCallback, void* allocCallb
 }
 
 template<typename T>
-Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out, Bool async)
+Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out, Bool async, AsyncLoaderPriority priority)
 {
 	ANKI_ASSERT(!out.isCreated() && "Already loaded");
 
 	Error err = Error::kNone;
 
-	T* const other = findLoadedResource<T>(filename);
+	const Name filenameName(filename);
+	T* const other = findLoadedResource<T>(filenameName);
 
 	if(other)
 	{
@@ -89,6 +93,7 @@ Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out
 		// Increment the refcount in that case where async jobs increment it and decrement it in the scope of a load()
 		ptr->retain();
 
+		ptr->m_loadPriority = priority;
 		err = ptr->load(filename, async);
 		if(err)
 		{
@@ -97,7 +102,7 @@ Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out
 			return err;
 		}
 
-		ptr->setFilename(filename);
+		ptr->setFilename(filenameName);
 		ptr->setUuid(++m_uuid);
 
 		// Register resource
@@ -113,7 +118,7 @@ Error ResourceManager::loadResource(const CString& filename, ResourcePtr<T>& out
 
 // Instansiate the ResourceManager::loadResource()
 #define ANKI_INSTANTIATE_RESOURCE(rsrc_, ptr_) \
-	template Error ResourceManager::loadResource<rsrc_>(const CString& filename, ResourcePtr<rsrc_>& out, Bool async);
+	template Error ResourceManager::loadResource<rsrc_>(const CString& filename, ResourcePtr<rsrc_>& out, Bool async, AsyncLoaderPriority priority);
 #define ANKI_INSTANSIATE_RESOURCE_DELIMITER()
 #include <AnKi/Resource/InstantiationMacros.h>
 #undef ANKI_INSTANTIATE_RESOURCE
@@ -7,7 +7,9 @@
 
 #include <AnKi/Resource/TransferGpuAllocator.h>
 #include <AnKi/Resource/ResourceFilesystem.h>
-#include <AnKi/Util/List.h>
+#include <AnKi/Resource/AsyncLoader.h>
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/NameTable.h>
 #include <AnKi/Util/Functions.h>
 #include <AnKi/Util/String.h>
 
@@ -40,44 +42,27 @@ protected:
 		m_ptrs.destroy();
 	}
 
-	Type* findLoadedResource(const CString& filename)
+	Type* findLoadedResource(Name filename)
 	{
-		auto it = find(filename);
-		return (it != m_ptrs.end()) ? *it : nullptr;
+		auto it = m_ptrs.find(filename);
+		return (it != m_ptrs.getEnd()) ? *it : nullptr;
 	}
 
 	void registerResource(Type* ptr)
 	{
-		ANKI_ASSERT(find(ptr->getFilename()) == m_ptrs.getEnd());
-		m_ptrs.pushBack(ptr);
+		ANKI_ASSERT(m_ptrs.find(ptr->getFilenameName()) == m_ptrs.getEnd());
+		m_ptrs.emplace(ptr->getFilenameName(), ptr);
 	}
 
 	void unregisterResource(Type* ptr)
 	{
-		auto it = find(ptr->getFilename());
-		ANKI_ASSERT(it != m_ptrs.end());
+		auto it = m_ptrs.find(ptr->getFilenameName());
+		ANKI_ASSERT(it != m_ptrs.getEnd());
 		m_ptrs.erase(it);
 	}
 
 private:
-	using Container = ResourceList<Type*>;
-
-	Container m_ptrs;
-
-	typename Container::Iterator find(const CString& filename)
-	{
-		typename Container::Iterator it;
-
-		for(it = m_ptrs.getBegin(); it != m_ptrs.getEnd(); ++it)
-		{
-			if((*it)->getFilename() == filename)
-			{
-				break;
-			}
-		}
-
-		return it;
-	}
+	ResourceHashMap<Name, Type*> m_ptrs; ///< The loaded resources keyed by their interned filename.
 };
 
 /// Resource manager. It holds a few global variables
@@ -105,8 +90,9 @@ public:
 	Error init(AllocAlignedCallback allocCallback, void* allocCallbackData);
 
 	/// Load a resource.
+	/// @param priority The priority of the async loading tasks. It's ignored if the resource is already loaded.
 	template<typename T>
-	Error loadResource(const CString& filename, ResourcePtr<T>& out, Bool async = true);
+	Error loadResource(const CString& filename, ResourcePtr<T>& out, Bool async = true, AsyncLoaderPriority priority = AsyncLoaderPriority::kMedium);
 
 	// Internals:
 
@@ -116,7 +102,7 @@ public:
 	}
 
 	template<typename T>
-	ANKI_INTERNAL T* findLoadedResource(const CString& filename)
+	ANKI_INTERNAL T* findLoadedResource(Name filename)
 	{
 		return TypeResourceManager<T>::findLoadedResource(filename);
 	}
@@ -154,7 +140,7 @@ public:
 
 private:
 	ResourceFilesystem* m_fs = nullptr;
-	AsyncLoader* m_asyncLoader = nullptr; ///< Async loading thread
+	AsyncLoader* m_asyncLoader = nullptr; ///< Async loading threads
 	ShaderProgramResourceSystem* m_shaderProgramSystem = nullptr;
 	TransferGpuAllocator* m_transferGpuAlloc = nullptr;
 
@@ -7,8 +7,10 @@
 
 #include <AnKi/Resource/Common.h>
 #include <AnKi/Resource/ResourceFilesystem.h>
+#include <AnKi/Resource/AsyncLoader.h>
 #include <AnKi/Util/Atomic.h>
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/NameTable.h>
 
 namespace anki {
 
@@ -42,15 +44,22 @@ public:
 
 	CString getFilename() const
 	{
-		ANKI_ASSERT(!m_fname.isEmpty());
+		ANKI_ASSERT(m_fname.isValid());
 		return m_fname.toCString();
 	}
 
+	/// Get the interned filename.
+	Name getFilenameName() const
+	{
+		ANKI_ASSERT(m_fname.isValid());
+		return m_fname;
+	}
+
 	// Internals:
 
-	ANKI_INTERNAL void setFilename(const CString& fname)
+	ANKI_INTERNAL void setFilename(Name fname)
 	{
-		ANKI_ASSERT(m_fname.isEmpty());
+		ANKI_ASSERT(!m_fname.isValid() && fname.isValid());
 		m_fname = fname;
 	}
 
@@ -67,6 +76,12 @@ public:
 		return m_uuid;
 	}
 
+	/// The priority of the async tasks of the load(). The resources that the load() loads should get the same.
+	ANKI_INTERNAL AsyncLoaderPriority getLoadPriority() const
+	{
+		return m_loadPriority;
+	}
+
 	ANKI_INTERNAL Error openFile(const ResourceFilename& filename, ResourceFilePtr& file);
 
 	ANKI_INTERNAL Error openFileReadAllText(const ResourceFilename& filename, ResourceString& file);
@@ -75,8 +90,9 @@ public:
 
 private:
 	mutable Atomic<I32> m_refcount = {0};
-	ResourceString m_fname; ///< Unique resource name.
+	Name m_fname; ///< Unique resource name.
 	U64 m_uuid = 0;
+	AsyncLoaderPriority m_loadPriority = AsyncLoaderPriority::kMedium;
 };
 /// @}
 
@@ -0,0 +1,373 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Resource/ResourcePackage.h>
+#include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/Hash.h>
+#include <AnKi/Util/StringList.h>
+#include <AnKi/Util/Tracer.h>
+#include <ZLib/zlib.h>
+
+namespace anki {
+
+static U64 computeFilenameHash(CString filename)
+{
+	return computeHash(filename.cstr(), filename.getLength());
+}
+
+Error ResourcePackage::open(CString filename)
+{
+	ANKI_CHECK(m_file.open(filename, FileOpenFlag::kRead | FileOpenFlag::kBinary));
+	m_filename = filename;
+
+	ANKI_CHECK(m_file.read(&m_header, sizeof(m_header)));
+	if(m_header.m_magic != kResourcePackageMagic)
+	{
+		ANKI_RESOURCE_LOGE("Wrong magic of resource package: %s", filename.cstr());
+		return Error::kUserData;
+	}
+
+	if(m_header.m_blockSize == 0 || m_header.m_fileCount == 0 || !isPowerOfTwo(m_header.m_hashTableSize)
+	   || m_header.m_hashTableSize <= m_header.m_fileCount || m_header.m_filenamesSize == 0)
+	{
+		ANKI_RESOURCE_LOGE("Wrong header of resource package: %s", filename.cstr());
+		return Error::kUserData;
+	}
+
+	// Read the table of contents
+	m_files.resize(m_header.m_fileCount);
+	m_blocks.resize(m_header.m_blockCount);
+	m_hashTable.resize(m_header.m_hashTableSize);
+	m_filenames.resize(U32(m_header.m_filenamesSize));
+
+	ANKI_CHECK(m_file.seek(m_header.m_tocOffset, FileSeekOrigin::kBeginning));
+	ANKI_CHECK(m_file.read(m_files.getBegin(), m_files.getSizeInBytes()));
+	if(m_blocks.getSize())
+	{
+		ANKI_CHECK(m_file.read(m_blocks.getBegin(), m_blocks.getSizeInBytes()));
+	}
+	ANKI_CHECK(m_file.read(m_hashTable.getBegin(), m_hashTable.getSizeInBytes()));
+	ANKI_CHECK(m_file.read(m_filenames.getBegin(), m_filenames.getSizeInBytes()));
+
+	if(validateToc())
+	{
+		ANKI_RESOURCE_LOGE("Corrupted table of contents of resource package: %s", filename.cstr());
+		return Error::kUserData;
+	}
+
+	return Error::kNone;
+}
+
+Error ResourcePackage::validateToc() const
+{
+	if(m_filenames.getBack() != '\0')
+	{
+		return Error::kUserData;
+	}
+
+	for(const ResourcePackageBlock& block : m_blocks)
+	{
+		if(block.m_uncompressedSize == 0 || block.m_uncompressedSize > m_header.m_blockSize || block.m_compressedSize > block.m_uncompressedSize
+		   || block.m_offset + block.m_compressedSize > m_header.m_tocOffset)
+		{
+			return Error::kUserData;
+		}
+	}
+
+	for(const ResourcePackageFileEntry& file : m_files)
+	{
+		const U64 blockCount = (file.m_size + m_header.m_blockSize - 1) / m_header.m_blockSize;
+		if(file.m_filenameOffset >= m_filenames.getSize() || file.m_firstBlock + blockCount > m_blocks.getSize())
+		{
+			return Error::kUserData;
+		}
+
+		// readFile() finds the block of an offset by dividing with the block size so all the blocks but the last have to be full and the blocks
+		// have to add up to the file
+		U64 size = 0;
+		for(U64 i = 0; i < blockCount; ++i)
+		{
+			const U32 uncompressedSize = m_blocks[U32(file.m_firstBlock + i)].m_uncompressedSize;
+			if(i + 1 < blockCount && uncompressedSize != m_header.m_blockSize)
+			{
+				return Error::kUserData;
+			}
+
+			size += uncompressedSize;
+		}
+
+		if(size != file.m_size)
+		{
+			return Error::kUserData;
+		}
+	}
+
+	for(U32 fileIdx : m_hashTable)
+	{
+		if(fileIdx != kMaxU32 && fileIdx >= m_files.getSize())
+		{
+			return Error::kUserData;
+		}
+	}
+
+	return Error::kNone;
+}
+
+U32 ResourcePackage::findFile(CString filename) const
+{
+	const U64 hash = computeFilenameHash(filename);
+	const U32 mask = m_header.m_hashTableSize - 1;
+
+	// The table is never full so there is always an empty bucket to stop the search
+	for(U32 bucket = U32(hash) & mask;; bucket = (bucket + 1) & mask)
+	{
+		const U32 fileIdx = m_hashTable[bucket];
+		if(fileIdx == kMaxU32)
+		{
+			return kMaxU32;
+		}
+
+		if(m_files[fileIdx].m_filenameHash == hash && getFilename(fileIdx) == filename)
+		{
+			return fileIdx;
+		}
+	}
+}
+
+Error ResourcePackage::readRaw(PtrSize offset, void* buff, PtrSize size) const
+{
+#if ANKI_POSIX
+	if(m_file.getFileDescriptor() >= 0)
+	{
+		return m_file.readAt(offset, buff, size);
+	}
+#endif
+
+	LockGuard<Mutex> lock(m_fileMtx);
+	ANKI_CHECK(m_file.seek(offset, FileSeekOrigin::kBeginning));
+	return m_file.read(buff, size);
+}
+
+Error ResourcePackage::readBlock(U32 blockIdx, U8* out, ResourceDynamicArray<U8>& compressed) const
+{
+	const ResourcePackageBlock& block = m_blocks[blockIdx];
+
+	if(block.m_compressedSize == block.m_uncompressedSize)
+	{
+		// Stored uncompressed
+		return readRaw(block.m_offset, out, block.m_uncompressedSize);
+	}
+
+	compressed.resize(block.m_compressedSize);
+	ANKI_CHECK(readRaw(block.m_offset, compressed.getBegin(), block.m_compressedSize));
+
+	uLongf uncompressedSize = block.m_uncompressedSize;
+	const int ret = uncompress(out, &uncompressedSize, compressed.getBegin(), block.m_compressedSize);
+	if(ret != Z_OK || uncompressedSize != block.m_uncompressedSize)
+	{
+		ANKI_RESOURCE_LOGE("Failed to decompress block %u of resource package: %s", blockIdx, m_filename.cstr());
+		return Error::kFileAccess;
+	}
+
+	return Error::kNone;
+}
+
+Error ResourcePackage::readFile(U32 fileIdx, PtrSize offset, void* buff, PtrSize size, ResourcePackageBlockCache* cache) const
+{
+	ANKI_TRACE_SCOPED_EVENT(RsrcFileRead);
+
+	const ResourcePackageFileEntry& file = m_files[fileIdx];
+	if(offset + size > file.m_size)
+	{
+		ANKI_RESOURCE_LOGE("Reading past the end of the file: %s", getFilename(fileIdx).cstr());
+		return Error::kFileAccess;
+	}
+
+	ResourceDynamicArray<U8> compressed;
+	ResourceDynamicArray<U8> localBlock;
+	U8* out = static_cast<U8*>(buff);
+	while(size)
+	{
+		const U32 blockIdx = file.m_firstBlock + U32(offset / m_header.m_blockSize);
+		const U32 offsetInBlock = U32(offset % m_header.m_blockSize);
+		const U32 uncompressedSize = m_blocks[blockIdx].m_uncompressedSize;
+		const PtrSize copySize = min<PtrSize>(size, uncompressedSize - offsetInBlock);
+
+		if(cache && cache->m_blockIdx == blockIdx)
+		{
+			memcpy(out, &cache->m_data[offsetInBlock], copySize);
+		}
+		else if(copySize == uncompressedSize)
+		{
+			// Need the whole block, decompress it directly to the output
+			ANKI_CHECK(readBlock(blockIdx, out, compressed));
+		}
+		else
+		{
+			ResourceDynamicArray<U8>& blockData = (cache) ? cache->m_data : localBlock;
+			blockData.resize(m_header.m_blockSize);
+			if(cache)
+			{
+				cache->m_blockIdx = kMaxU32;
+			}
+
+			ANKI_CHECK(readBlock(blockIdx, blockData.getBegin(), compressed));
+			memcpy(out, &blockData[offsetInBlock], copySize);
+
+			if(cache)
+			{
+				cache->m_blockIdx = blockIdx;
+			}
+		}
+
+		out += copySize;
+		offset += copySize;
+		size -= copySize;
+	}
+
+	return Error::kNone;
+}
+
+Error buildResourcePackage(CString inputDir, CString outFilename, U32 blockSize, U32 compressionLevel)
+{
+	ANKI_ASSERT(blockSize > 0 && compressionLevel <= 9);
+
+	// Gather the files. Sort them so the output is deterministic
+	ResourceStringList filenames;
+	ANKI_CHECK(walkDirectoryTree(inputDir, [&](CString fname, Bool isDir) -> Error {
+		if(!isDir)
+		{
+			filenames.pushBackSprintf("%s", fname.cstr());
+		}
+
+		return Error::kNone;
+	}));
+
+	if(filenames.isEmpty())
+	{
+		ANKI_RESOURCE_LOGE("No files found in: %s", inputDir.cstr());
+		return Error::kUserData;
+	}
+
+	filenames.sortAll();
+
+	File outFile;
+	ANKI_CHECK(outFile.open(outFilename, FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+
+	// The header will be written again in the end
+	ResourcePackageHeader header = {};
+	header.m_magic = kResourcePackageMagic;
+	header.m_blockSize = blockSize;
+	ANKI_CHECK(outFile.write(&header, sizeof(header)));
+	PtrSize outOffset = sizeof(header);
+
+	ResourceDynamicArray<ResourcePackageFileEntry> files;
+	ResourceDynamicArray<ResourcePackageBlock> blocks;
+	ResourceDynamicArray<Char> filenameChars;
+	ResourceDynamicArrayLarge<U8> fileData;
+	ResourceDynamicArray<U8> compressed;
+	compressed.resize(U32(compressBound(blockSize)));
+	for(const ResourceString& fname : filenames)
+	{
+		ResourceString fullFname;
+		fullFname.sprintf("%s/%s", inputDir.cstr(), fname.cstr());
+
+		// Skip the package itself if it's written inside the input directory
+		if(fullFname == outFilename)
+		{
+			continue;
+		}
+
+		File inFile;
+		ANKI_CHECK(inFile.open(fullFname, FileOpenFlag::kRead | FileOpenFlag::kBinary));
+		fileData.resize(inFile.getSize());
+		if(fileData.getSize())
+		{
+			ANKI_CHECK(inFile.read(fileData.getBegin(), fileData.getSize()));
+		}
+
+		ResourcePackageFileEntry& entry = *files.emplaceBack();
+		entry.m_filenameHash = computeFilenameHash(fname);
+		entry.m_size = fileData.getSize();
+		entry.m_filenameOffset = filenameChars.getSize();
+		entry.m_firstBlock = blocks.getSize();
+
+		for(const Char c : fname)
+		{
+			filenameChars.emplaceBack(c);
+		}
+		filenameChars.emplaceBack('\0');
+
+		// Compress the blocks one by one. Keep the ones that don't compress well uncompressed
+		for(PtrSize offset = 0; offset < fileData.getSize(); offset += blockSize)
+		{
+			const U32 uncompressedSize = U32(min<PtrSize>(blockSize, fileData.getSize() - offset));
+			const U8* uncompressed = &fileData[offset];
+
+			uLongf compressedSize = compressed.getSize();
+			const int ret = compress2(compressed.getBegin(), &compressedSize, uncompressed, uncompressedSize, I32(compressionLevel));
+			if(ret != Z_OK)
+			{
+				ANKI_RESOURCE_LOGE("compress2() failed: %s", fullFname.cstr());
+				return Error::kFunctionFailed;
+			}
+
+			ResourcePackageBlock& block = *blocks.emplaceBack();
+			block.m_offset = outOffset;
+			block.m_uncompressedSize = uncompressedSize;
+			if(compressedSize < uncompressedSize)
+			{
+				block.m_compressedSize = U32(compressedSize);
+				ANKI_CHECK(outFile.write(compressed.getBegin(), compressedSize));
+			}
+			else
+			{
+				block.m_compressedSize = uncompressedSize;
+				ANKI_CHECK(outFile.write(uncompressed, uncompressedSize));
+			}
+
+			outOffset += block.m_compressedSize;
+		}
+	}
+
+	// Build the hash table. Keep it at most half full so lookups that fail stop early
+	ResourceDynamicArray<U32> hashTable;
+	hashTable.resize(nextPowerOfTwo(files.getSize() * 2 + 1), kMaxU32);
+	const U32 mask = hashTable.getSize() - 1;
+	for(U32 fileIdx = 0; fileIdx < files.getSize(); ++fileIdx)
+	{
+		U32 bucket = U32(files[fileIdx].m_filenameHash) & mask;
+		while(hashTable[bucket] != kMaxU32)
+		{
+			bucket = (bucket + 1) & mask;
+		}
+
+		hashTable[bucket] = fileIdx;
+	}
+
+	// Write the table of contents and then the final header
+	header.m_fileCount = files.getSize();
+	header.m_blockCount = blocks.getSize();
+	header.m_hashTableSize = hashTable.getSize();
+	header.m_tocOffset = outOffset;
+	header.m_filenamesSize = filenameChars.getSize();
+
+	ANKI_CHECK(outFile.write(files.getBegin(), files.getSizeInBytes()));
+	if(blocks.getSize())
+	{
+		ANKI_CHECK(outFile.write(blocks.getBegin(), blocks.getSizeInBytes()));
+	}
+	ANKI_CHECK(outFile.write(hashTable.getBegin(), hashTable.getSizeInBytes()));
+	ANKI_CHECK(outFile.write(filenameChars.getBegin(), filenameChars.getSizeInBytes()));
+
+	ANKI_CHECK(outFile.seek(0, FileSeekOrigin::kBeginning));
+	ANKI_CHECK(outFile.write(&header, sizeof(header)));
+
+	ANKI_RESOURCE_LOGI("Packed %u files (%u blocks) into %s. Compressed data size %zu bytes", files.getSize(), blocks.getSize(),
+					   outFilename.cstr(), outOffset);
+	return Error::kNone;
+}
+
+} // end namespace anki
@@ -0,0 +1,156 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Resource/Common.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Ptr.h>
+#include <AnKi/Util/Thread.h>
+
+namespace anki {
+
+/// @addtogroup resource
+/// @{
+
+inline constexpr const Char* kResourcePackageExtension = ".ankipak";
+inline constexpr Array<U8, 8> kResourcePackageMagic = {'A', 'N', 'K', 'I', 'P', 'A', 'K', '1'};
+inline constexpr U32 kDefaultResourcePackageBlockSize = 128_KB;
+
+/// The header of a resource package. A package contains a number of files. The contents of every file are split into blocks that are
+/// compressed independently so any range of a file can be read by decompressing only the blocks that it touches. The blocks of all the files
+/// follow the header and after them there is the table of contents:
+/// - ResourcePackageFileEntry[m_fileCount]
+/// - ResourcePackageBlock[m_blockCount]
+/// - U32 hashTable[m_hashTableSize], a file index per bucket or kMaxU32 if the bucket is empty. Collisions are resolved with linear probing.
+/// - Char filenames[m_filenamesSize], null terminated filenames.
+class ResourcePackageHeader
+{
+public:
+	Array<U8, 8> m_magic;
+	U32 m_blockSize; ///< The uncompressed size of the blocks. Only the last block of each file can be smaller.
+	U32 m_fileCount;
+	U32 m_blockCount;
+	U32 m_hashTableSize; ///< It's a power of two.
+	U64 m_tocOffset; ///< The offset of the table of contents from the start of the package.
+	U64 m_filenamesSize;
+};
+static_assert(sizeof(ResourcePackageHeader) == 40);
+
+/// A file inside a resource package.
+class ResourcePackageFileEntry
+{
+public:
+	U64 m_filenameHash; ///< computeHash() of the filename without the null terminator.
+	U64 m_size; ///< Uncompressed size.
+	U32 m_filenameOffset; ///< Offset in the filenames of the table of contents.
+	U32 m_firstBlock; ///< The blocks of a file are consecutive.
+};
+static_assert(sizeof(ResourcePackageFileEntry) == 24);
+
+/// A block of a file inside a resource package.
+class ResourcePackageBlock
+{
+public:
+	U64 m_offset; ///< Offset from the start of the package.
+	U32 m_compressedSize; ///< If it's equal to m_uncompressedSize then the block is stored uncompressed.
+	U32 m_uncompressedSize;
+};
+static_assert(sizeof(ResourcePackageBlock) == 16);
+
+/// Holds the last block that was decompressed to speed up small consecutive reads.
+class ResourcePackageBlockCache
+{
+public:
+	U32 m_blockIdx = kMaxU32;
+	ResourceDynamicArray<U8> m_data;
+};
+
+/// An open resource package. The table of contents is kept in memory. It's shared by all the files that are open from the package.
+class ResourcePackage
+{
+public:
+	ResourcePackage() = default;
+
+	ResourcePackage(const ResourcePackage&) = delete; // Non-copyable
+
+	ResourcePackage& operator=(const ResourcePackage&) = delete; // Non-copyable
+
+	Error open(CString filename);
+
+	U32 getFileCount() const
+	{
+		return m_header.m_fileCount;
+	}
+
+	CString getFilename(U32 fileIdx) const
+	{
+		return &m_filenames[m_files[fileIdx].m_filenameOffset];
+	}
+
+	PtrSize getFileSize(U32 fileIdx) const
+	{
+		return m_files[fileIdx].m_size;
+	}
+
+	/// Find a file using the hash table.
+	/// @return The index of the file or kMaxU32 if it's not in the package.
+	U32 findFile(CString filename) const;
+
+	/// Read a range of a file. It reads and decompresses only the blocks that the range touches. It's thread-safe if the cache is not shared.
+	/// @param cache Optional. Partially read blocks are decompressed there and reused by the next reads.
+	Error readFile(U32 fileIdx, PtrSize offset, void* buff, PtrSize size, ResourcePackageBlockCache* cache = nullptr) const;
+
+	void retain() const
+	{
+		m_refcount.fetchAdd(1);
+	}
+
+	I32 release() const
+	{
+		return m_refcount.fetchSub(1);
+	}
+
+private:
+	mutable File m_file;
+	mutable Mutex m_fileMtx; ///< Reads of files without a file descriptor need to seek.
+	ResourceString m_filename;
+
+	ResourcePackageHeader m_header = {};
+	ResourceDynamicArray<ResourcePackageFileEntry> m_files;
+	ResourceDynamicArray<ResourcePackageBlock> m_blocks;
+	ResourceDynamicArray<U32> m_hashTable;
+	ResourceDynamicArray<Char> m_filenames;
+
+	mutable Atomic<I32> m_refcount = {0};
+
+	Error readRaw(PtrSize offset, void* buff, PtrSize size) const;
+
+	Error readBlock(U32 blockIdx, U8* out, ResourceDynamicArray<U8>& compressed) const;
+
+	Error validateToc() const;
+};
+
+/// Resource package smart pointer deleter.
+class ResourcePackageDeleter
+{
+public:
+	void operator()(ResourcePackage* x)
+	{
+		deleteInstance(ResourceMemoryPool::getSingleton(), x);
+	}
+};
+
+using ResourcePackagePtr = IntrusivePtr<ResourcePackage, ResourcePackageDeleter>;
+
+/// Pack all the files of a directory into a resource package.
+/// @param inputDir The files are stored with their paths relative to this directory.
+/// @param outFilename The package to create.
+/// @param blockSize The uncompressed size of the blocks. Smaller blocks make random reads cheaper and bigger blocks compress better.
+/// @param compressionLevel zlib compression level from 0 (store) to 9 (best).
+Error buildResourcePackage(CString inputDir, CString outFilename, U32 blockSize = kDefaultResourcePackageBlockSize, U32 compressionLevel = 9);
+/// @}
+
+} // end namespace anki
@@ -28,11 +28,9 @@ ShaderProgramResource::ShaderProgramResource()
 
 ShaderProgramResource::~ShaderProgramResource()
 {
-	for(auto it : m_variants)
-	{
-		ShaderProgramResourceVariant* variant = &(*it);
+	m_variants.iterate([]([[maybe_unused]] U64 hash, ShaderProgramResourceVariant* variant) {
 		deleteInstance(ResourceMemoryPool::getSingleton(), variant);
-	}
+	});
 
 	ResourceMemoryPool::getSingleton().free(m_binary);
 }
@@ -84,46 +82,45 @@ void ShaderProgramResource::getOrCreateVariant(const ShaderProgramResourceVarian
 	}
 
 	// Compute variant hash
-	U64 hash = computeHash(&info.m_shaderTypes, sizeof(info.m_shaderTypes));
+	StreamingHasher hasher;
+	hasher.appendObject(info.m_shaderTypes);
 
 	for(ShaderType stype : EnumBitsIterable<ShaderType, ShaderTypeBit>(info.m_shaderTypes))
 	{
 		const PtrSize len = strlen(info.m_techniqueNames[stype].getBegin());
 		ANKI_ASSERT(len > 0);
-		hash = appendHash(info.m_techniqueNames[stype].getBegin(), len, hash);
+		// Include the terminator or the names of different shader types could be split differently and produce the same bytes
+		hasher.append(info.m_techniqueNames[stype].getBegin(), len + 1);
 	}
 
 	if(m_binary->m_mutators.getSize())
 	{
-		hash = appendHash(info.m_mutation.getBegin(), m_binary->m_mutators.getSize() * sizeof(info.m_mutation[0]), hash);
+		hasher.append(info.m_mutation.getBegin(), m_binary->m_mutators.getSize() * sizeof(info.m_mutation[0]));
 	}
 
+	const U64 hash = hasher.getHash();
+
 	// Check if the variant is in the cache
+	ShaderProgramResourceVariant* cachedVariant;
+	if(m_variants.findHash(hash, cachedVariant)) [[likely]]
 	{
-		RLockGuard<RWMutex> lock(m_mtx);
-
-		auto it = m_variants.find(hash);
-		if(it != m_variants.getEnd())
+		// Done
+		variant = cachedVariant;
+		if(!!(info.m_shaderTypes & ShaderTypeBit::kAllGraphics))
 		{
-			// Done
-			variant = *it;
-			if(!!(info.m_shaderTypes & ShaderTypeBit::kAllGraphics))
-			{
-				ANKI_ASSERT(variant->m_prog->getShaderTypes() == info.m_shaderTypes);
-			}
-			return;
+			ANKI_ASSERT(variant->m_prog->getShaderTypes() == info.m_shaderTypes);
 		}
+		return;
 	}
 
 	// Create the variant
-	WLockGuard<RWMutex> lock(m_mtx);
+	LockGuard<Mutex> lock(m_mtx);
 
 	// Check again
-	auto it = m_variants.find(hash);
-	if(it != m_variants.getEnd())
+	if(m_variants.findHash(hash, cachedVariant))
 	{
 		// Done
-		variant = *it;
+		variant = cachedVariant;
 		return;
 	}
 
@@ -131,7 +128,7 @@ void ShaderProgramResource::getOrCreateVariant(const ShaderProgramResourceVarian
 	ShaderProgramResourceVariant* v = createNewVariant(info);
 	if(v)
 	{
-		m_variants.emplace(hash, v);
+		m_variants.emplaceHash(hash, v);
 	}
 	variant = v;
 	if(!!(info.m_shaderTypes & ShaderTypeBit::kAllGraphics))
@@ -11,7 +11,7 @@
 #include <AnKi/Gr/ShaderProgram.h>
 #include <AnKi/Util/BitSet.h>
 #include <AnKi/Util/String.h>
-#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/ConcurrentHashMap.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Math.h>
 
@@ -135,8 +135,8 @@ public:
 private:
 	ShaderBinary* m_binary = nullptr;
 
-	mutable ResourceHashMap<U64, ShaderProgramResourceVariant*> m_variants;
-	mutable RWMutex m_mtx;
+	mutable ResourceConcurrentHashMap<U64, ShaderProgramResourceVariant*> m_variants; ///< Lookups from the render threads don't lock.
+	mutable Mutex m_mtx; ///< Serializes the creation of variants.
 
 	ShaderProgramResourceVariant* createNewVariant(const ShaderProgramResourceVariantInitInfo& info) const;
 
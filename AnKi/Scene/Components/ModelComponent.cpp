@@ -234,8 +234,8 @@ Error ModelComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 		}
 
 		ANKI_ASSERT(count * 4 == m_gpuSceneUniforms.getAllocatedSize());
-		GpuSceneMicroPatcher::getSingleton().newCopy(*info.m_framePool, m_gpuSceneUniforms.getOffset(), m_gpuSceneUniforms.getAllocatedSize(),
-													 &allUniforms[0]);
+		GpuSceneMicroPatcher::getSingleton().newCopy(SceneGraph::getSingleton().getFrameMemoryPool(), m_gpuSceneUniforms.getOffset(),
+													 m_gpuSceneUniforms.getAllocatedSize(), &allUniforms[0]);
 	}
 
 	// Upload transforms
@@ -252,7 +252,7 @@ Error ModelComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 	if(aabbUpdated) [[unlikely]]
 	{
 		const Aabb aabbWorld = computeAabbWorldSpace(info.m_node->getWorldTransform());
-		SceneGraph::getSingleton().updateSceneBounds(aabbWorld.getMin().xyz(), aabbWorld.getMax().xyz());
+		info.m_node->setWorldBoundingVolume(aabbWorld.getMin().xyz(), aabbWorld.getMax().xyz(), true);
 	}
 
 	// Update the buckets
@@ -200,9 +200,10 @@ ParticleEmitterComponent::ParticleEmitterComponent(SceneNode* node)
 	const U32 vertCount = 4;
 	const U32 indexCount = 6;
 
-	m_quadPositions = UnifiedGeometryBuffer::getSingleton().allocateFormat(kMeshRelatedVertexStreamFormats[VertexStreamId::kPosition], vertCount);
-	m_quadUvs = UnifiedGeometryBuffer::getSingleton().allocateFormat(kMeshRelatedVertexStreamFormats[VertexStreamId::kUv], vertCount);
-	m_quadIndices = UnifiedGeometryBuffer::getSingleton().allocateFormat(Format::kR16_Uint, indexCount);
+	UnifiedGeometryBuffer& ugb = UnifiedGeometryBuffer::getSingleton();
+	m_quadPositions = ugb.allocateFormat(kMeshRelatedVertexStreamFormats[VertexStreamId::kPosition], vertCount, relocateGpuMemory, this);
+	m_quadUvs = ugb.allocateFormat(kMeshRelatedVertexStreamFormats[VertexStreamId::kUv], vertCount, relocateGpuMemory, this);
+	m_quadIndices = ugb.allocateFormat(Format::kR16_Uint, indexCount, relocateGpuMemory, this);
 
 	static_assert(kMeshRelatedVertexStreamFormats[VertexStreamId::kPosition] == Format::kR16G16B16A16_Unorm);
 	WeakArray<U16Vec4> transientPositions;
@@ -301,11 +302,12 @@ void ParticleEmitterComponent::loadParticleEmitterResource(CString filename)
 	}
 
 	// GPU scene allocations
-	m_gpuScenePositions = GpuSceneBuffer::getSingleton().allocate(sizeof(Vec3) * m_props.m_maxNumOfParticles, alignof(F32));
-	m_gpuSceneAlphas = GpuSceneBuffer::getSingleton().allocate(sizeof(F32) * m_props.m_maxNumOfParticles, alignof(F32));
-	m_gpuSceneScales = GpuSceneBuffer::getSingleton().allocate(sizeof(F32) * m_props.m_maxNumOfParticles, alignof(F32));
-	m_gpuSceneUniforms =
-		GpuSceneBuffer::getSingleton().allocate(m_particleEmitterResource->getMaterial()->getPrefilledLocalUniforms().getSizeInBytes(), alignof(U32));
+	GpuSceneBuffer& gpuScene = GpuSceneBuffer::getSingleton();
+	m_gpuScenePositions = gpuScene.allocate(sizeof(Vec3) * m_props.m_maxNumOfParticles, alignof(F32), relocateGpuMemory, this);
+	m_gpuSceneAlphas = gpuScene.allocate(sizeof(F32) * m_props.m_maxNumOfParticles, alignof(F32), relocateGpuMemory, this);
+	m_gpuSceneScales = gpuScene.allocate(sizeof(F32) * m_props.m_maxNumOfParticles, alignof(F32), relocateGpuMemory, this);
+	m_gpuSceneUniforms = gpuScene.allocate(m_particleEmitterResource->getMaterial()->getPrefilledLocalUniforms().getSizeInBytes(), alignof(U32),
+										   relocateGpuMemory, this);
 
 	// Allocate buckets
 	for(RenderingTechnique t :
@@ -324,6 +326,23 @@ void ParticleEmitterComponent::loadParticleEmitterResource(CString filename)
 	}
 }
 
+void ParticleEmitterComponent::relocateGpuMemory(void* userData, const SegregatedListsGpuMemoryPoolToken& oldToken,
+												 const SegregatedListsGpuMemoryPoolToken& newToken)
+{
+	ParticleEmitterComponent& self = *static_cast<ParticleEmitterComponent*>(userData);
+
+	[[maybe_unused]] const Bool relocated = self.m_quadPositions.relocate(oldToken, newToken) || self.m_quadUvs.relocate(oldToken, newToken)
+											|| self.m_quadIndices.relocate(oldToken, newToken)
+											|| self.m_gpuScenePositions.relocate(oldToken, newToken)
+											|| self.m_gpuSceneAlphas.relocate(oldToken, newToken)
+											|| self.m_gpuSceneScales.relocate(oldToken, newToken)
+											|| self.m_gpuSceneUniforms.relocate(oldToken, newToken);
+	ANKI_ASSERT(relocated);
+
+	// The offsets are baked into the GPU scene objects, upload them again
+	self.m_resourceUpdated = true;
+}
+
 Error ParticleEmitterComponent::update(SceneComponentUpdateInfo& info, Bool& updated)
 {
 	if(!m_particleEmitterResource.isCreated()) [[unlikely]]
@@ -340,23 +359,25 @@ Error ParticleEmitterComponent::update(SceneComponentUpdateInfo& info, Bool& upd
 	Aabb aabbWorld;
 	if(m_simulationType == SimulationType::kSimple)
 	{
-		simulate(info.m_previousTime, info.m_currentTime, info.m_node->getWorldTransform(), WeakArray<SimpleParticle>(m_simpleParticles), positions,
-				 scales, alphas, aabbWorld);
+		simulate(*info.m_framePool, info.m_previousTime, info.m_currentTime, info.m_node->getWorldTransform(),
+				 WeakArray<SimpleParticle>(m_simpleParticles), positions, scales, alphas, aabbWorld);
 	}
 	else
 	{
 		ANKI_ASSERT(m_simulationType == SimulationType::kPhysicsEngine);
-		simulate(info.m_previousTime, info.m_currentTime, info.m_node->getWorldTransform(), WeakArray<PhysicsParticle>(m_physicsParticles), positions,
-				 scales, alphas, aabbWorld);
+		simulate(*info.m_framePool, info.m_previousTime, info.m_currentTime, info.m_node->getWorldTransform(),
+				 WeakArray<PhysicsParticle>(m_physicsParticles), positions, scales, alphas, aabbWorld);
 	}
 
+	info.m_node->setWorldBoundingVolume(aabbWorld.getMin().xyz(), aabbWorld.getMax().xyz(), false);
+
 	// Upload particles to the GPU scene
 	GpuSceneMicroPatcher& patcher = GpuSceneMicroPatcher::getSingleton();
 	if(m_aliveParticleCount > 0)
 	{
-		patcher.newCopy(*info.m_framePool, m_gpuScenePositions, sizeof(Vec3) * m_aliveParticleCount, positions);
-		patcher.newCopy(*info.m_framePool, m_gpuSceneScales, sizeof(F32) * m_aliveParticleCount, scales);
-		patcher.newCopy(*info.m_framePool, m_gpuSceneAlphas, sizeof(F32) * m_aliveParticleCount, alphas);
+		patcher.newCopy(SceneGraph::getSingleton().getFrameMemoryPool(), m_gpuScenePositions, sizeof(Vec3) * m_aliveParticleCount, positions);
+		patcher.newCopy(SceneGraph::getSingleton().getFrameMemoryPool(), m_gpuSceneScales, sizeof(F32) * m_aliveParticleCount, scales);
+		patcher.newCopy(SceneGraph::getSingleton().getFrameMemoryPool(), m_gpuSceneAlphas, sizeof(F32) * m_aliveParticleCount, alphas);
 	}
 
 	if(m_resourceUpdated)
@@ -374,7 +395,8 @@ Error ParticleEmitterComponent::update(SceneComponentUpdateInfo& info, Bool& upd
 		m_gpuSceneParticleEmitter.uploadToGpuScene(particles);
 
 		// Upload uniforms
-		patcher.newCopy(*info.m_framePool, m_gpuSceneUniforms, m_particleEmitterResource->getMaterial()->getPrefilledLocalUniforms().getSizeInBytes(),
+		patcher.newCopy(SceneGraph::getSingleton().getFrameMemoryPool(), m_gpuSceneUniforms,
+						m_particleEmitterResource->getMaterial()->getPrefilledLocalUniforms().getSizeInBytes(),
 						m_particleEmitterResource->getMaterial()->getPrefilledLocalUniforms().getBegin());
 
 		// Upload mesh LODs
@@ -488,8 +510,8 @@ Error ParticleEmitterComponent::update(SceneComponentUpdateInfo& info, Bool& upd
 }
 
 template<typename TParticle>
-void ParticleEmitterComponent::simulate(Second prevUpdateTime, Second crntTime, const Transform& worldTransform, WeakArray<TParticle> particles,
-										Vec3*& positions, F32*& scales, F32*& alphas, Aabb& aabbWorld)
+void ParticleEmitterComponent::simulate(StackMemoryPool& framePool, Second prevUpdateTime, Second crntTime, const Transform& worldTransform,
+										WeakArray<TParticle> particles, Vec3*& positions, F32*& scales, F32*& alphas, Aabb& aabbWorld)
 {
 	// - Deactivate the dead particles
 	// - Calc the AABB
@@ -499,10 +521,9 @@ void ParticleEmitterComponent::simulate(Second prevUpdateTime, Second crntTime,
 	Vec3 aabbMax(kMinF32);
 	m_aliveParticleCount = 0;
 
-	positions =
-		static_cast<Vec3*>(SceneGraph::getSingleton().getFrameMemoryPool().allocate(m_props.m_maxNumOfParticles * sizeof(Vec3), alignof(Vec3)));
-	scales = static_cast<F32*>(SceneGraph::getSingleton().getFrameMemoryPool().allocate(m_props.m_maxNumOfParticles * sizeof(F32), alignof(F32)));
-	alphas = static_cast<F32*>(SceneGraph::getSingleton().getFrameMemoryPool().allocate(m_props.m_maxNumOfParticles * sizeof(F32), alignof(F32)));
+	positions = static_cast<Vec3*>(framePool.allocate(m_props.m_maxNumOfParticles * sizeof(Vec3), alignof(Vec3)));
+	scales = static_cast<F32*>(framePool.allocate(m_props.m_maxNumOfParticles * sizeof(F32), alignof(F32)));
+	alphas = static_cast<F32*>(framePool.allocate(m_props.m_maxNumOfParticles * sizeof(F32), alignof(F32)));
 
 	F32 maxParticleSize = -1.0f;
 
@@ -80,9 +80,12 @@ private:
 
 	Error update(SceneComponentUpdateInfo& info, Bool& updated) override;
 
+	static void relocateGpuMemory(void* userData, const SegregatedListsGpuMemoryPoolToken& oldToken,
+								  const SegregatedListsGpuMemoryPoolToken& newToken);
+
 	template<typename TParticle>
-	void simulate(Second prevUpdateTime, Second crntTime, const Transform& worldTransform, WeakArray<TParticle> particles, Vec3*& positions,
-				  F32*& scales, F32*& alphas, Aabb& aabbWorld);
+	void simulate(StackMemoryPool& framePool, Second prevUpdateTime, Second crntTime, const Transform& worldTransform, WeakArray<TParticle> particles,
+				  Vec3*& positions, F32*& scales, F32*& alphas, Aabb& aabbWorld);
 };
 /// @}
 
@@ -58,7 +58,7 @@ public:
 	const Second m_previousTime;
 	const Second m_currentTime;
 	const Second m_dt;
-	StackMemoryPool* m_framePool = nullptr;
+	StackMemoryPool* m_framePool = nullptr; ///< Frame memory of the thread that runs the update. Only that thread should use it.
 
 	SceneComponentUpdateInfo(Second prevTime, Second crntTime)
 		: m_previousTime(prevTime)
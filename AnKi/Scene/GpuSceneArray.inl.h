@@ -14,7 +14,13 @@ GpuSceneArray<TGpuSceneObject, kId>::GpuSceneArray(U32 maxArraySize)
 {
 	maxArraySize = getAlignedRoundUp(sizeof(SubMask), maxArraySize);
 	const U32 alignment = GrManager::getSingleton().getDeviceCapabilities().m_storageBufferBindOffsetAlignment;
-	m_gpuSceneAllocation = GpuSceneBuffer::getSingleton().allocate(sizeof(TGpuSceneObject) * maxArraySize, alignment);
+
+	// Everyone asks for the offset of the array every frame so it can be moved around
+	auto relocate = [](void* userData, const SegregatedListsGpuMemoryPoolToken& oldToken, const SegregatedListsGpuMemoryPoolToken& newToken) {
+		[[maybe_unused]] const Bool relocated = static_cast<GpuSceneArray*>(userData)->m_gpuSceneAllocation.relocate(oldToken, newToken);
+		ANKI_ASSERT(relocated);
+	};
+	m_gpuSceneAllocation = GpuSceneBuffer::getSingleton().allocate(sizeof(TGpuSceneObject) * maxArraySize, alignment, relocate, this);
 
 	m_inUseIndicesMask.resize(maxArraySize / sizeof(SubMask), false);
 	ANKI_ASSERT(m_inUseIndicesCount == 0);
@@ -42,6 +42,10 @@ static StatCounter g_sceneUpdateTimeStatVar(StatCategory::kTime, "All scene upda
 static StatCounter g_scenePhysicsTimeStatVar(StatCategory::kTime, "Physics",
 											 StatFlag::kMilisecond | StatFlag::kShowAverage | StatFlag::kMainThreadUpdates);
 
+static StatCounter g_sceneFrameArenasMemoryStatVar(StatCategory::kCpuMem, "Scene frame arenas", StatFlag::kBytes | StatFlag::kMainThreadUpdates);
+static StatCounter g_sceneFrameArenasHighWaterMarkStatVar(StatCategory::kCpuMem, "Scene frame arena peak",
+														  StatFlag::kBytes | StatFlag::kMainThreadUpdates);
+
 static NumericCVar<U32> g_octreeMaxDepthCVar(CVarSubsystem::kScene, "OctreeMaxDepth", 5, 2, 10, "The max depth of the octree");
 
 NumericCVar<F32> g_probeEffectiveDistanceCVar(CVarSubsystem::kScene, "ProbeEffectiveDistance", 256.0f, 1.0f, kMaxF32,
@@ -71,16 +75,6 @@ static NumericCVar<U32> g_minGpuSceneRenderablesCVar(CVarSubsystem::kScene, "Min
 
 constexpr U32 kUpdateNodeBatchSize = 10;
 
-class SceneGraph::UpdateSceneNodesCtx
-{
-public:
-	IntrusiveList<SceneNode>::Iterator m_crntNode;
-	SpinLock m_crntNodeLock;
-
-	Second m_prevUpdateTime;
-	Second m_crntTime;
-};
-
 SceneGraph::SceneGraph()
 {
 }
@@ -106,6 +100,9 @@ Error SceneGraph::init(AllocAlignedCallback allocCallback, void* allocCallbackDa
 
 	m_framePool.init(allocCallback, allocCallbackData, 1_MB, 2.0, 0, true, ANKI_SAFE_ALIGNMENT, "SceneGraphFramePool");
 
+	// One more arena for the thread that waits for the jobs since it might run some of them
+	m_frameArenas.init(allocCallback, allocCallbackData, CoreThreadJobManager::getSingleton().getThreadCount() + 1, 256_KB, "SceneGraphFrameArena");
+
 	// Init the default main camera
 	ANKI_CHECK(newSceneNode<SceneNode>("mainCamera", m_defaultMainCam));
 	CameraComponent* camc = m_defaultMainCam->newComponent<CameraComponent>();
@@ -136,15 +133,16 @@ Error SceneGraph::registerNode(SceneNode* node)
 	ANKI_ASSERT(node);
 
 	// Add to dict if it has a name
-	if(node->getName())
+	const Name name = node->getInternedName();
+	if(name.isValid())
 	{
-		if(tryFindSceneNode(node->getName()))
+		if(tryFindSceneNode(name))
 		{
 			ANKI_SCENE_LOGE("Node with the same name already exists");
 			return Error::kUserData;
 		}
 
-		m_nodesDict.emplace(node->getName(), node);
+		m_nodesDict.emplace(name, node);
 	}
 
 	// Add to vector
@@ -166,9 +164,9 @@ void SceneGraph::unregisterNode(SceneNode* node)
 	}
 
 	// Remove from dict
-	if(node->getName())
+	if(node->getInternedName().isValid())
 	{
-		auto it = m_nodesDict.find(node->getName());
+		auto it = m_nodesDict.find(node->getInternedName());
 		ANKI_ASSERT(it != m_nodesDict.getEnd());
 		m_nodesDict.erase(it);
 	}
@@ -182,6 +180,13 @@ SceneNode& SceneGraph::findSceneNode(const CString& name)
 }
 
 SceneNode* SceneGraph::tryFindSceneNode(const CString& name)
+{
+	// Don't intern names that are only looked up
+	const Name interned = Name::find(name);
+	return (interned.isValid()) ? tryFindSceneNode(interned) : nullptr;
+}
+
+SceneNode* SceneGraph::tryFindSceneNode(Name name)
 {
 	auto it = m_nodesDict.find(name);
 	return (it == m_nodesDict.getEnd()) ? nullptr : (*it);
@@ -222,8 +227,9 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 
 	const Second startUpdateTime = HighRezTimer::getCurrentTime();
 
-	// Reset the framepool
+	// Reset the frame memory
 	m_framePool.reset();
+	m_frameArenas.newFrame();
 
 	// Delete stuff
 	{
@@ -247,32 +253,67 @@ Error SceneGraph::update(Second prevUpdateTime, Second crntTime)
 		ANKI_TRACE_SCOPED_EVENT(SceneNodesUpdate);
 		ANKI_CHECK(m_events.updateAllEvents(prevUpdateTime, crntTime));
 
-		UpdateSceneNodesCtx updateCtx;
-		updateCtx.m_crntNode = m_nodes.getBegin();
-		updateCtx.m_prevUpdateTime = prevUpdateTime;
-		updateCtx.m_crntTime = crntTime;
+		// Walk the hot data arrays once instead of letting every node copy its previous transform while it's updated
+		m_hotData.updatePreviousWorldTransforms();
 
-		for(U i = 0; i < CoreThreadJobManager::getSingleton().getThreadCount(); i++)
+		// Gather the nodes that don't have a parent. The children will be updated by their parents
+		DynamicArray<SceneNode*, MemoryPoolPtrWrapper<StackMemoryPool>> rootNodes(&m_framePool);
+		rootNodes.resizeStorage(m_nodesCount);
+		for(SceneNode& node : m_nodes)
 		{
-			CoreThreadJobManager::getSingleton().dispatchTask([this, &updateCtx]([[maybe_unused]] U32 tid) {
-				if(updateNodes(updateCtx))
-				{
-					ANKI_SCENE_LOGF("Will not recover");
-				}
-			});
+			if(node.getParent() == nullptr)
+			{
+				rootNodes.emplaceBack(&node);
+			}
 		}
 
-		CoreThreadJobManager::getSingleton().waitForAllTasksToFinish();
+		ThreadJobManager& jobManager = CoreThreadJobManager::getSingleton();
+
+		const ThreadJobHandle nodesUpdated =
+			jobManager.parallelFor(0, rootNodes.getSize(), kUpdateNodeBatchSize,
+								   [this, &rootNodes, prevUpdateTime, crntTime](U32 begin, U32 end, U32 tid) {
+									   ANKI_TRACE_SCOPED_EVENT(SceneNodeUpdate);
+									   for(U32 i = begin; i < end; ++i)
+									   {
+										   if(updateNode(prevUpdateTime, crntTime, *rootNodes[i], tid))
+										   {
+											   ANKI_SCENE_LOGF("Will not recover");
+										   }
+									   }
+								   });
+
+		// The GPU scene arrays don't depend on each other so flush them in parallel after the nodes are updated
+#define ANKI_CAT_TYPE(arrayName, gpuSceneType, id, cvarName) \
+	jobManager.dispatchTask( \
+		[]([[maybe_unused]] U32 tid) { \
+			GpuSceneArrays::arrayName::getSingleton().flush(); \
+		}, \
+		ConstWeakArray<ThreadJobHandle>(&nodesUpdated, 1));
+#include <AnKi/Scene/GpuSceneArrays.def.h>
+
+		jobManager.waitForAllTasksToFinish();
+
+		// Same for the scene bounds. The renderable components only write their bounds, gather them here without a lock
+		Vec3 boundsMin, boundsMax;
+		if(m_hotData.gatherUpdatedSceneBounds(boundsMin, boundsMax))
+		{
+			updateSceneBounds(boundsMin, boundsMax);
+		}
 	}
 
-#define ANKI_CAT_TYPE(arrayName, gpuSceneType, id, cvarName) GpuSceneArrays::arrayName::getSingleton().flush();
-#include <AnKi/Scene/GpuSceneArrays.def.h>
+	PtrSize frameArenasHighWaterMark = 0;
+	for(U32 tid = 0; tid < m_frameArenas.getThreadCount(); ++tid)
+	{
+		frameArenasHighWaterMark = max(frameArenasHighWaterMark, m_frameArenas.getHighWaterMark(tid));
+	}
+	g_sceneFrameArenasMemoryStatVar.set(m_frameArenas.getMemoryUsage());
+	g_sceneFrameArenasHighWaterMarkStatVar.set(frameArenasHighWaterMark);
 
 	g_sceneUpdateTimeStatVar.set((HighRezTimer::getCurrentTime() - startUpdateTime) * 1000.0);
 	return Error::kNone;
 }
 
-Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
+Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node, U32 tid)
 {
 	ANKI_TRACE_INC_COUNTER(SceneNodeUpdated, 1);
 
@@ -280,7 +321,7 @@ Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
 
 	// Components update
 	SceneComponentUpdateInfo componentUpdateInfo(prevTime, crntTime);
-	componentUpdateInfo.m_framePool = &m_framePool;
+	componentUpdateInfo.m_framePool = &m_frameArenas.getArena(tid);
 
 	Bool atLeastOneComponentUpdated = false;
 	node.iterateComponents([&](SceneComponent& comp) {
@@ -305,7 +346,7 @@ Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
 	if(!err)
 	{
 		err = node.visitChildrenMaxDepth(0, [&](SceneNode& child) -> Error {
-			return updateNode(prevTime, crntTime, child);
+			return updateNode(prevTime, crntTime, child, tid);
 		});
 	}
 
@@ -327,56 +368,6 @@ Error SceneGraph::updateNode(Second prevTime, Second crntTime, SceneNode& node)
 	return err;
 }
 
-Error SceneGraph::updateNodes(UpdateSceneNodesCtx& ctx)
-{
-	ANKI_TRACE_SCOPED_EVENT(SceneNodeUpdate);
-
-	IntrusiveList<SceneNode>::ConstIterator end = m_nodes.getEnd();
-
-	Bool quit = false;
-	Error err = Error::kNone;
-	while(!quit && !err)
-	{
-		// Fetch a batch of scene nodes that don't have parent
-		Array<SceneNode*, kUpdateNodeBatchSize> batch;
-		U batchSize = 0;
-
-		{
-			LockGuard<SpinLock> lock(ctx.m_crntNodeLock);
-
-			while(1)
-			{
-				if(batchSize == batch.getSize())
-				{
-					break;
-				}
-
-				if(ctx.m_crntNode == end)
-				{
-					quit = true;
-					break;
-				}
-
-				SceneNode& node = *ctx.m_crntNode;
-				if(node.getParent() == nullptr)
-				{
-					batch[batchSize++] = &node;
-				}
-
-				++ctx.m_crntNode;
-			}
-		}
-
-		// Process nodes
-		for(U i = 0; i < batchSize && !err; ++i)
-		{
-			err = updateNode(ctx.m_prevUpdateTime, ctx.m_crntTime, *batch[i]);
-		}
-	}
-
-	return err;
-}
-
 LightComponent* SceneGraph::getDirectionalLight() const
 {
 	LightComponent* out = (m_dirLights.getSize()) ? m_dirLights[0] : nullptr;
@@ -7,9 +7,11 @@
 
 #include <AnKi/Scene/Common.h>
 #include <AnKi/Scene/SceneNode.h>
+#include <AnKi/Scene/SceneHotData.h>
 #include <AnKi/Math.h>
 #include <AnKi/Util/HashMap.h>
 #include <AnKi/Util/BlockArray.h>
+#include <AnKi/Util/FrameArenas.h>
 #include <AnKi/Scene/Events/EventManager.h>
 #include <AnKi/Resource/Common.h>
 #include <AnKi/Core/CVarSet.h>
@@ -94,6 +96,7 @@ public:
 
 	SceneNode& findSceneNode(const CString& name);
 	SceneNode* tryFindSceneNode(const CString& name);
+	SceneNode* tryFindSceneNode(Name name);
 
 	/// Iterate the scene nodes using a lambda
 	template<typename Func>
@@ -152,6 +155,17 @@ public:
 		return m_componentArrays;
 	}
 
+	/// The transforms, the bounds and the timestamps of all nodes as structure of arrays.
+	SceneHotData& getHotData()
+	{
+		return m_hotData;
+	}
+
+	const SceneHotData& getHotData() const
+	{
+		return m_hotData;
+	}
+
 	void addDirectionalLight(LightComponent* comp)
 	{
 		ANKI_ASSERT(m_dirLights.find(comp) == m_dirLights.getEnd());
@@ -210,8 +224,6 @@ public:
 	}
 
 private:
-	class UpdateSceneNodesCtx;
-
 	class InitMemPoolDummy
 	{
 	public:
@@ -222,10 +234,11 @@ private:
 	} m_initMemPoolDummy;
 
 	mutable StackMemoryPool m_framePool;
+	FrameArenas m_frameArenas; ///< Frame memory of the threads that update the scene nodes.
 
 	IntrusiveList<SceneNode> m_nodes;
 	U32 m_nodesCount = 0;
-	GrHashMap<CString, SceneNode*> m_nodesDict;
+	GrHashMap<Name, SceneNode*> m_nodesDict;
 
 	SceneNode* m_mainCam = nullptr;
 	Timestamp m_activeCameraChangeTimestamp = 0;
@@ -242,6 +255,7 @@ private:
 	Atomic<U32> m_nodesUuid = {1};
 
 	SceneComponentArrays m_componentArrays;
+	SceneHotData m_hotData;
 
 	SceneDynamicArray<LightComponent*> m_dirLights;
 	SceneDynamicArray<SkyboxComponent*> m_skyboxes;
@@ -257,8 +271,7 @@ private:
 	/// Delete the nodes that are marked for deletion
 	void deleteNodesMarkedForDeletion();
 
-	Error updateNodes(UpdateSceneNodesCtx& ctx);
-	Error updateNode(Second prevTime, Second crntTime, SceneNode& node);
+	Error updateNode(Second prevTime, Second crntTime, SceneNode& node, U32 tid);
 };
 
 template<typename Node, typename... Args>
@@ -0,0 +1,117 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Scene/SceneHotData.h>
+
+namespace anki {
+
+SceneHotData::~SceneHotData()
+{
+	ANKI_ASSERT(m_slotCount == 0 && "Some scene nodes are still alive");
+
+	for(SceneHotDataChunk* chunk : m_chunks)
+	{
+		deleteInstance(SceneMemoryPool::getSingleton(), chunk);
+	}
+}
+
+SceneHotDataSlot SceneHotData::allocate(SceneNode* node)
+{
+	ANKI_ASSERT(node);
+
+	while(m_firstNonFullChunk < m_chunks.getSize() && m_chunks[m_firstNonFullChunk]->m_aliveMask == kMaxU64)
+	{
+		++m_firstNonFullChunk;
+	}
+
+	if(m_firstNonFullChunk == m_chunks.getSize())
+	{
+		SceneHotDataChunk* newChunk = newInstance<SceneHotDataChunk>(SceneMemoryPool::getSingleton());
+		newChunk->m_chunkIdx = m_chunks.getSize();
+		m_chunks.emplaceBack(newChunk);
+	}
+
+	SceneHotDataChunk& chunk = *m_chunks[m_firstNonFullChunk];
+	const U32 idx = U32(__builtin_ctzll(~chunk.m_aliveMask));
+	chunk.m_aliveMask |= 1_U64 << idx;
+	chunk.m_movedMask.fetchAnd(~(1_U64 << idx));
+	chunk.m_sceneBoundsMask.fetchAnd(~(1_U64 << idx));
+
+	chunk.m_worldTransforms[idx] = Transform::getIdentity();
+	chunk.m_prevWorldTransforms[idx] = Transform::getIdentity();
+	chunk.m_worldBoundsMin[idx] = Vec3(0.0f);
+	chunk.m_worldBoundsMax[idx] = Vec3(0.0f);
+	chunk.m_timestamps[idx] = 0;
+	chunk.m_nodes[idx] = node;
+
+	++m_slotCount;
+
+	SceneHotDataSlot slot;
+	slot.m_chunk = &chunk;
+	slot.m_idx = idx;
+	return slot;
+}
+
+void SceneHotData::free(SceneHotDataSlot& slot)
+{
+	ANKI_ASSERT(slot.isValid());
+	ANKI_ASSERT(slot.m_chunk->m_aliveMask & (1_U64 << slot.m_idx));
+
+	slot.m_chunk->m_aliveMask &= ~(1_U64 << slot.m_idx);
+	slot.m_chunk->m_movedMask.fetchAnd(~(1_U64 << slot.m_idx));
+	slot.m_chunk->m_sceneBoundsMask.fetchAnd(~(1_U64 << slot.m_idx));
+	slot.m_chunk->m_nodes[slot.m_idx] = nullptr;
+
+	ANKI_ASSERT(m_chunks[slot.m_chunk->m_chunkIdx] == slot.m_chunk);
+	m_firstNonFullChunk = min(m_firstNonFullChunk, slot.m_chunk->m_chunkIdx);
+
+	ANKI_ASSERT(m_slotCount > 0);
+	--m_slotCount;
+
+	slot = {};
+}
+
+void SceneHotData::updatePreviousWorldTransforms()
+{
+	for(SceneHotDataChunk* chunk : m_chunks)
+	{
+		U64 mask = chunk->m_movedMask.exchange(0);
+		while(mask)
+		{
+			const U32 idx = U32(__builtin_ctzll(mask));
+			mask &= mask - 1;
+			chunk->m_prevWorldTransforms[idx] = chunk->m_worldTransforms[idx];
+		}
+	}
+}
+
+Bool SceneHotData::gatherUpdatedSceneBounds(Vec3& aabbMin, Vec3& aabbMax)
+{
+	Vec3 outMin(kMaxF32);
+	Vec3 outMax(kMinF32);
+	Bool found = false;
+	for(SceneHotDataChunk* chunk : m_chunks)
+	{
+		U64 mask = chunk->m_sceneBoundsMask.exchange(0);
+		found = found || mask != 0;
+		while(mask)
+		{
+			const U32 idx = U32(__builtin_ctzll(mask));
+			mask &= mask - 1;
+			outMin = outMin.min(chunk->m_worldBoundsMin[idx]);
+			outMax = outMax.max(chunk->m_worldBoundsMax[idx]);
+		}
+	}
+
+	if(found)
+	{
+		aabbMin = outMin;
+		aabbMax = outMax;
+	}
+
+	return found;
+}
+
+} // end namespace anki
@@ -0,0 +1,124 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Scene/Common.h>
+#include <AnKi/Math.h>
+#include <AnKi/Collision/Aabb.h>
+#include <AnKi/Util/Atomic.h>
+
+namespace anki {
+
+/// @addtogroup scene
+/// @{
+
+/// The hot data of SceneHotDataChunk::kSize scene nodes stored as structure of arrays. Passes that touch only the transforms, the bounds or the
+/// timestamps of many nodes walk these arrays instead of the scene nodes and the components.
+class SceneHotDataChunk
+{
+public:
+	static constexpr U32 kSize = 64;
+
+	Array<Transform, kSize> m_worldTransforms;
+	Array<Transform, kSize> m_prevWorldTransforms;
+	Array<Vec3, kSize> m_worldBoundsMin; ///< The world space bounding volume of the renderable components.
+	Array<Vec3, kSize> m_worldBoundsMax;
+	Array<Timestamp, kSize> m_timestamps; ///< The last frame a component of the node was updated.
+	Array<SceneNode*, kSize> m_nodes;
+	U64 m_aliveMask = 0; ///< Which of the slots are used.
+	Atomic<U64> m_movedMask = {0}; ///< The slots whose world transform changed this frame.
+	Atomic<U64> m_sceneBoundsMask = {0}; ///< The slots whose bounds changed this frame and should extend the scene bounds.
+	U32 m_chunkIdx = 0; ///< The index of the chunk inside SceneHotData.
+};
+
+/// A handle to the hot data of a single scene node.
+class SceneHotDataSlot
+{
+public:
+	SceneHotDataChunk* m_chunk = nullptr;
+	U32 m_idx = kMaxU32; ///< Index inside the chunk.
+
+	Bool isValid() const
+	{
+		return m_chunk != nullptr;
+	}
+};
+
+/// Holds the hot data of all scene nodes in chunks of SceneHotDataChunk::kSize nodes. The chunks never move in memory so the slots stay valid
+/// until they are freed. Freed slots are re-used lowest first to keep the live nodes packed.
+/// @note Allocating and freeing slots is not thread-safe. Writing the data of different slots from different threads is fine.
+class SceneHotData
+{
+public:
+	SceneHotData() = default;
+
+	SceneHotData(const SceneHotData&) = delete; // Non-copyable
+
+	~SceneHotData();
+
+	SceneHotData& operator=(const SceneHotData&) = delete; // Non-copyable
+
+	SceneHotDataSlot allocate(SceneNode* node);
+
+	void free(SceneHotDataSlot& slot);
+
+	U32 getChunkCount() const
+	{
+		return m_chunks.getSize();
+	}
+
+	/// Get the number of allocated slots.
+	U32 getSize() const
+	{
+		return m_slotCount;
+	}
+
+	/// Copy the world transforms of the nodes that moved last frame to their previous world transforms. The nodes that didn't move last
+	/// frame already have the two equal. Call it once per frame before the nodes update their transforms.
+	void updatePreviousWorldTransforms();
+
+	/// Compute the union of the bounds that were set this frame and should extend the scene bounds. Call it once per frame after the nodes
+	/// are updated.
+	/// @return False if no bounds were set.
+	Bool gatherUpdatedSceneBounds(Vec3& aabbMin, Vec3& aabbMax);
+
+	/// Iterate the chunks that have live slots. The functor has the signature void(const SceneHotDataChunk& chunk). Use
+	/// SceneHotDataChunk::m_aliveMask to skip the free slots.
+	template<typename TFunc>
+	void iterateChunks(TFunc func) const
+	{
+		for(const SceneHotDataChunk* chunk : m_chunks)
+		{
+			if(chunk->m_aliveMask)
+			{
+				func(*chunk);
+			}
+		}
+	}
+
+	/// Iterate the live slots. The functor has the signature void(const SceneHotDataChunk& chunk, U32 idx).
+	template<typename TFunc>
+	void iterateSlots(TFunc func) const
+	{
+		iterateChunks([&](const SceneHotDataChunk& chunk) {
+			U64 mask = chunk.m_aliveMask;
+			while(mask)
+			{
+				const U32 idx = U32(__builtin_ctzll(mask));
+				mask &= mask - 1;
+				func(chunk, idx);
+			}
+		});
+	}
+
+private:
+	SceneDynamicArray<SceneHotDataChunk*> m_chunks;
+	U32 m_firstNonFullChunk = 0; ///< All chunks before that are full.
+	U32 m_slotCount = 0;
+};
+/// @}
+
+} // end namespace anki
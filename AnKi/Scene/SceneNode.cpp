@@ -43,10 +43,11 @@ namespace anki {
 
 SceneNode::SceneNode(CString name)
 	: m_uuid(SceneGraph::getSingleton().getNewUuid())
+	, m_hotData(SceneGraph::getSingleton().getHotData().allocate(this))
 {
 	if(name)
 	{
-		m_name = name;
+		m_name = Name(name);
 	}
 
 	// Add the implicit MoveComponent
@@ -70,6 +71,8 @@ SceneNode::~SceneNode()
 			ANKI_ASSERT(0);
 		}
 	}
+
+	SceneGraph::getSingleton().getHotData().free(m_hotData);
 }
 
 void SceneNode::setMarkedForDeletion()
@@ -124,26 +127,22 @@ Bool SceneNode::updateTransform()
 {
 	const Bool needsUpdate = m_localTransformDirty;
 	m_localTransformDirty = false;
-	const Bool updatedLastFrame = m_transformUpdatedThisFrame;
-	m_transformUpdatedThisFrame = needsUpdate;
 
-	if(needsUpdate || updatedLastFrame)
-	{
-		m_prevWTrf = m_wtrf;
-	}
-
-	// Update world transform
+	// Update world transform. The previous world transform is updated by SceneHotData::updatePreviousWorldTransforms()
 	if(needsUpdate)
 	{
+		m_hotData.m_chunk->m_movedMask.fetchOr(1_U64 << m_hotData.m_idx);
+
+		Transform& wtrf = m_hotData.m_chunk->m_worldTransforms[m_hotData.m_idx];
 		const SceneNode* parent = getParent();
 
 		if(parent == nullptr || m_ignoreParentNodeTransform)
 		{
-			m_wtrf = m_ltrf;
+			wtrf = m_ltrf;
 		}
 		else
 		{
-			m_wtrf = parent->getWorldTransform().combineTransformations(m_ltrf);
+			wtrf = parent->getWorldTransform().combineTransformations(m_ltrf);
 		}
 
 		// Make children dirty as well. Don't walk the whole tree because you will re-walk it later
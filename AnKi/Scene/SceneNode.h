@@ -6,11 +6,13 @@
 #pragma once
 
 #include <AnKi/Scene/Components/SceneComponent.h>
+#include <AnKi/Scene/SceneHotData.h>
 #include <AnKi/Util/Hierarchy.h>
 #include <AnKi/Util/BitMask.h>
 #include <AnKi/Util/BitSet.h>
 #include <AnKi/Util/List.h>
 #include <AnKi/Util/Enum.h>
+#include <AnKi/Util/NameTable.h>
 
 namespace anki {
 
@@ -42,7 +44,13 @@ public:
 	/// Return the name. It may be empty for nodes that we don't want to track.
 	CString getName() const
 	{
-		return (!m_name.isEmpty()) ? m_name.toCString() : CString();
+		return m_name.toCString();
+	}
+
+	/// Return the interned name. It's invalid if the node doesn't have a name.
+	Name getInternedName() const
+	{
+		return m_name;
 	}
 
 	U64 getUuid() const
@@ -59,13 +67,13 @@ public:
 
 	Timestamp getComponentMaxTimestamp() const
 	{
-		return m_maxComponentTimestamp;
+		return m_hotData.m_chunk->m_timestamps[m_hotData.m_idx];
 	}
 
 	void setComponentMaxTimestamp(Timestamp maxComponentTimestamp)
 	{
 		ANKI_ASSERT(maxComponentTimestamp > 0);
-		m_maxComponentTimestamp = maxComponentTimestamp;
+		m_hotData.m_chunk->m_timestamps[m_hotData.m_idx] = maxComponentTimestamp;
 	}
 
 	void addChild(SceneNode* obj)
@@ -302,12 +310,37 @@ public:
 
 	const Transform& getWorldTransform() const
 	{
-		return m_wtrf;
+		return m_hotData.m_chunk->m_worldTransforms[m_hotData.m_idx];
 	}
 
 	const Transform& getPreviousWorldTransform() const
 	{
-		return m_prevWTrf;
+		return m_hotData.m_chunk->m_prevWorldTransforms[m_hotData.m_idx];
+	}
+
+	/// The world space bounding volume of the renderable components of the node.
+	Aabb getWorldBoundingVolume() const
+	{
+		return Aabb(m_hotData.m_chunk->m_worldBoundsMin[m_hotData.m_idx], m_hotData.m_chunk->m_worldBoundsMax[m_hotData.m_idx]);
+	}
+
+	/// The renderable components set that when they compute their world space bounding volume.
+	/// @param extendSceneBounds If true the bounds will be added to the scene bounds at the end of the SceneGraph update.
+	/// @note It's thread-safe for different nodes.
+	void setWorldBoundingVolume(const Vec3& aabbMin, const Vec3& aabbMax, Bool extendSceneBounds)
+	{
+		m_hotData.m_chunk->m_worldBoundsMin[m_hotData.m_idx] = aabbMin;
+		m_hotData.m_chunk->m_worldBoundsMax[m_hotData.m_idx] = aabbMax;
+		if(extendSceneBounds)
+		{
+			m_hotData.m_chunk->m_sceneBoundsMask.fetchOr(1_U64 << m_hotData.m_idx);
+		}
+	}
+
+	/// Where the hot data of the node live. See SceneHotData.
+	ANKI_INTERNAL const SceneHotDataSlot& getHotDataSlot() const
+	{
+		return m_hotData;
 	}
 
 	/// @name Mess with the local transform
@@ -372,7 +405,7 @@ public:
 
 	Bool movedThisFrame() const
 	{
-		return m_transformUpdatedThisFrame;
+		return (m_hotData.m_chunk->m_movedMask.load() & (1_U64 << m_hotData.m_idx)) != 0;
 	}
 
 	ANKI_INTERNAL Bool updateTransform();
@@ -382,29 +415,24 @@ public:
 	TComponent* newComponent();
 
 private:
-	SceneString m_name; ///< A unique name.
+	Name m_name; ///< A unique name.
 	U32 m_uuid;
 
 	SceneComponentTypeMask m_componentTypeMask = SceneComponentTypeMask::kNone;
 
 	GrDynamicArray<SceneComponent*> m_components;
 
-	Timestamp m_maxComponentTimestamp = 0;
-
 	/// The transformation in local space.
 	Transform m_ltrf = Transform::getIdentity();
 
-	/// The transformation in world space (local combined with parent's transformation).
-	Transform m_wtrf = Transform::getIdentity();
-
-	/// Keep the previous transformation for checking if it moved.
-	Transform m_prevWTrf = Transform::getIdentity();
+	/// The world transform (local combined with parent's transformation), the previous world transform, the bounds and the max component
+	/// timestamp. They live in SceneGraph's SceneHotData so the passes that touch them don't drag the rest of the node through the cache.
+	SceneHotDataSlot m_hotData;
 
 	// Flags
 	Bool m_markedForDeletion : 1 = false;
 	Bool m_localTransformDirty : 1 = true;
 	Bool m_ignoreParentNodeTransform : 1 = false;
-	Bool m_transformUpdatedThisFrame : 1 = true;
 
 	void newComponentInternal(SceneComponent* newc);
 };
@@ -12,16 +12,23 @@
 #include <AnKi/Util/BitSet.h>
 #include <AnKi/Util/BitMask.h>
 #include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/SmallDynamicArray.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Util/Enum.h>
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/Filesystem.h>
+#include <AnKi/Util/MemoryMappedFile.h>
 #include <AnKi/Util/Functions.h>
 #include <AnKi/Util/Hash.h>
 #include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Util/List.h>
 #include <AnKi/Util/Logger.h>
+#include <AnKi/Util/BinaryLog.h>
+#include <AnKi/Util/BinaryLogReader.h>
 #include <AnKi/Util/MemoryPool.h>
+#include <AnKi/Util/MemoryPoolTelemetry.h>
+#include <AnKi/Util/FrameArenas.h>
+#include <AnKi/Util/NameTable.h>
 #include <AnKi/Util/Hierarchy.h>
 #include <AnKi/Util/Ptr.h>
 #include <AnKi/Util/Singleton.h>
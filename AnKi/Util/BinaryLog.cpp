@@ -0,0 +1,402 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/BinaryLog.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/NameTable.h>
+#include <AnKi/Util/Logger.h>
+
+namespace anki {
+
+static U64 toNanoseconds(Second s)
+{
+	return U64(s * 1000000000.0);
+}
+
+class BinaryLog::ThreadLocal
+{
+public:
+	static constexpr U32 kBufferSize = 64 * 1024;
+	static constexpr U32 kStringCacheSize = 64;
+
+	/// Maps the pointers of the trace event and counter names to IDs without going to the NameTable.
+	class StringCacheEntry
+	{
+	public:
+		const Char* m_str = nullptr;
+		U32 m_id = 0;
+		U32 m_capture = 0;
+	};
+
+	SpinLock m_lock; ///< The owner holds it while writing a record and flush() holds it while flushing.
+	U16 m_threadIdx = 0;
+	ThreadId m_tid = 0;
+	Array<Char, Thread::kThreadNameMaxLength + 1> m_threadName = {};
+	Array<StringCacheEntry, kStringCacheSize> m_stringCache;
+	U32 m_size = 0;
+	Array<U8, kBufferSize> m_buffer;
+};
+
+Atomic<U32> BinaryLog::m_capturing = {0};
+thread_local BinaryLog::ThreadLocal* BinaryLog::m_threadLocal = nullptr;
+
+BinaryLog::~BinaryLog()
+{
+	endCapture();
+
+	for(U32 i = 0; i < m_threadLocalCount; ++i)
+	{
+		m_threadLocals[i]->~ThreadLocal();
+		freeAligned(m_threadLocals[i]);
+	}
+
+	if(m_stringCaptures)
+	{
+		freeAligned(m_stringCaptures);
+	}
+}
+
+Error BinaryLog::beginCapture(const Char* filename)
+{
+	endCapture();
+
+	{
+		LockGuard<Mutex> lock(m_fileMtx);
+		ANKI_CHECK(openFile(filename));
+	}
+
+	m_capturing.store(1);
+
+	// Log after the lock is released, the message might go to the binary log
+	ANKI_UTIL_LOGI("Binary log capture started: %s", filename);
+
+	return Error::kNone;
+}
+
+Error BinaryLog::openFile(const Char* filename)
+{
+	m_file = new(mallocAligned(sizeof(File), alignof(File))) File();
+	Error err = m_file->open(filename, FileOpenFlag::kWrite | FileOpenFlag::kBinary);
+	if(!err)
+	{
+		err = m_file->write(&kBinaryLogMagic[0], sizeof(kBinaryLogMagic));
+	}
+
+	if(!err)
+	{
+		err = m_file->write(&kBinaryLogVersion, sizeof(kBinaryLogVersion));
+	}
+
+	if(err)
+	{
+		m_file->~File();
+		freeAligned(m_file);
+		m_file = nullptr;
+		return err;
+	}
+
+	// The IDs of the call sites and the strings stay the same between captures but they have to be defined again in every file
+	m_captureIdx.fetchAdd(1);
+
+	for(U32 i = 0; i < m_threadLocalCount; ++i)
+	{
+		writeThreadDefinition(*m_threadLocals[i]);
+	}
+
+	return Error::kNone;
+}
+
+void BinaryLog::endCapture()
+{
+	if(!m_capturing.exchange(0))
+	{
+		return;
+	}
+
+	// Records that are being written finish before the flush and the new ones will see that the capture has ended
+	flush();
+
+	LockGuard<Mutex> lock(m_fileMtx);
+	m_file->~File();
+	freeAligned(m_file);
+	m_file = nullptr;
+}
+
+void BinaryLog::flush()
+{
+	U32 threadLocalCount;
+	{
+		LockGuard<Mutex> lock(m_fileMtx);
+		threadLocalCount = m_threadLocalCount;
+	}
+
+	for(U32 i = 0; i < threadLocalCount; ++i)
+	{
+		ThreadLocal& tlocal = *m_threadLocals[i];
+		LockGuard<SpinLock> lock(tlocal.m_lock);
+		flushThreadLocal(tlocal);
+	}
+
+	LockGuard<Mutex> lock(m_fileMtx);
+	if(m_file)
+	{
+		[[maybe_unused]] const Error err = m_file->flush();
+	}
+}
+
+void BinaryLog::writeToFile(const void* data, PtrSize size)
+{
+	// Can't log the errors, they will end up here again
+	if(m_file)
+	{
+		[[maybe_unused]] const Error err = m_file->write(data, size);
+	}
+}
+
+void BinaryLog::flushThreadLocal(ThreadLocal& tlocal)
+{
+	if(tlocal.m_size)
+	{
+		LockGuard<Mutex> lock(m_fileMtx);
+		writeToFile(&tlocal.m_buffer[0], tlocal.m_size);
+		tlocal.m_size = 0;
+	}
+}
+
+void BinaryLog::writeThreadDefinition(const ThreadLocal& tlocal)
+{
+	Array<U8, BinaryLogRecordHeader::kSize + sizeof(U64) + sizeof(U16) + Thread::kThreadNameMaxLength> record;
+	U8* ptr = &record[0];
+
+	const BinaryLogRecordType type = BinaryLogRecordType::kThread;
+	const U32 id = tlocal.m_threadIdx;
+	const U64 timestamp = toNanoseconds(HighRezTimer::getCurrentTime());
+	const U64 tid = U64(tlocal.m_tid);
+	ptr = writeBytes(ptr, &type, sizeof(type));
+	ptr = writeBytes(ptr, &tlocal.m_threadIdx, sizeof(tlocal.m_threadIdx));
+	ptr = writeBytes(ptr, &id, sizeof(id));
+	ptr = writeBytes(ptr, &timestamp, sizeof(timestamp));
+	ptr = writeBytes(ptr, &tid, sizeof(tid));
+	ptr = writeString(ptr, &tlocal.m_threadName[0], U32(strlen(&tlocal.m_threadName[0])));
+
+	writeToFile(&record[0], ptr - &record[0]);
+}
+
+BinaryLog::ThreadLocal* BinaryLog::getOrCreateThreadLocal()
+{
+	ThreadLocal* tlocal = m_threadLocal;
+	if(tlocal) [[likely]]
+	{
+		return tlocal;
+	}
+
+	LockGuard<Mutex> lock(m_fileMtx);
+
+	if(m_threadLocalCount == kMaxThreads)
+	{
+		return nullptr;
+	}
+
+	tlocal = new(mallocAligned(sizeof(ThreadLocal), alignof(ThreadLocal))) ThreadLocal();
+	tlocal->m_threadIdx = U16(m_threadLocalCount);
+	tlocal->m_tid = Thread::getCurrentThreadId();
+	strncpy(&tlocal->m_threadName[0], Thread::getCurrentThreadName(), Thread::kThreadNameMaxLength);
+
+	m_threadLocals[m_threadLocalCount++] = tlocal;
+	m_threadLocal = tlocal;
+
+	if(m_file)
+	{
+		writeThreadDefinition(*tlocal);
+	}
+
+	return tlocal;
+}
+
+U32 BinaryLog::defineFormat(BinaryLogFormatId& formatId, const Char* file, I32 line, const Char* func, const Char* subsystem, U8 messageType,
+							const Char* fmt)
+{
+	LockGuard<Mutex> lock(m_fileMtx);
+
+	const U32 capture = m_captureIdx.load();
+	U64 idAndCapture = formatId.m_idAndCapture.load();
+	if((idAndCapture >> 32u) == capture)
+	{
+		// Some other thread defined it
+		return U32(idAndCapture);
+	}
+
+	const U32 id = (idAndCapture) ? U32(idAndCapture) : m_nextFormatId++;
+
+	const Char* baseFile = strrchr(file, (ANKI_OS_WINDOWS) ? '\\' : '/');
+	baseFile = (baseFile) ? baseFile + 1 : file;
+
+	const U32 fmtLength = getStringLength(fmt);
+	const U32 fileLength = getStringLength(baseFile);
+	const U32 funcLength = getStringLength(func);
+	const U32 subsystemLength = getStringLength(subsystem);
+
+	Array<U8, BinaryLogRecordHeader::kSize + sizeof(U8) + sizeof(I32) + 4 * (sizeof(U16) + kBinaryLogMaxStringLength)> record;
+	U8* ptr = &record[0];
+
+	const BinaryLogRecordType type = BinaryLogRecordType::kFormat;
+	const U16 threadIdx = 0;
+	const U64 timestamp = 0;
+	ptr = writeBytes(ptr, &type, sizeof(type));
+	ptr = writeBytes(ptr, &threadIdx, sizeof(threadIdx));
+	ptr = writeBytes(ptr, &id, sizeof(id));
+	ptr = writeBytes(ptr, &timestamp, sizeof(timestamp));
+	ptr = writeBytes(ptr, &messageType, sizeof(messageType));
+	ptr = writeBytes(ptr, &line, sizeof(line));
+	ptr = writeString(ptr, fmt, fmtLength);
+	ptr = writeString(ptr, baseFile, fileLength);
+	ptr = writeString(ptr, func, funcLength);
+	ptr = writeString(ptr, subsystem, subsystemLength);
+
+	writeToFile(&record[0], ptr - &record[0]);
+
+	idAndCapture = (U64(capture) << 32u) | id;
+	formatId.m_idAndCapture.store(idAndCapture, AtomicMemoryOrder::kRelease);
+
+	return id;
+}
+
+U32 BinaryLog::defineString(const Char* str)
+{
+	// Search the cache of the thread first
+	ThreadLocal* tlocal = getOrCreateThreadLocal();
+	const U32 capture = m_captureIdx.load();
+	ThreadLocal::StringCacheEntry* cacheEntry = nullptr;
+	if(tlocal) [[likely]]
+	{
+		cacheEntry = &tlocal->m_stringCache[(ptrToNumber(str) >> 3u) % ThreadLocal::kStringCacheSize];
+		if(cacheEntry->m_str == str && cacheEntry->m_capture == capture)
+		{
+			return cacheEntry->m_id;
+		}
+	}
+
+	const Name name(str);
+	const U32 id = name.getId();
+
+	{
+		LockGuard<Mutex> lock(m_fileMtx);
+
+		if(id >= m_stringCaptureCount)
+		{
+			const U32 newCount = max(id + 1, m_stringCaptureCount * 2);
+			U32* newCaptures = static_cast<U32*>(mallocAligned(sizeof(U32) * newCount, alignof(U32)));
+			memset(newCaptures, 0, sizeof(U32) * newCount);
+			if(m_stringCaptures)
+			{
+				memcpy(newCaptures, m_stringCaptures, sizeof(U32) * m_stringCaptureCount);
+				freeAligned(m_stringCaptures);
+			}
+
+			m_stringCaptures = newCaptures;
+			m_stringCaptureCount = newCount;
+		}
+
+		if(m_stringCaptures[id] != capture)
+		{
+			m_stringCaptures[id] = capture;
+
+			Array<U8, BinaryLogRecordHeader::kSize + sizeof(U16) + kBinaryLogMaxStringLength> record;
+			U8* ptr = &record[0];
+
+			const BinaryLogRecordType type = BinaryLogRecordType::kString;
+			const U16 threadIdx = 0;
+			const U64 timestamp = 0;
+			ptr = writeBytes(ptr, &type, sizeof(type));
+			ptr = writeBytes(ptr, &threadIdx, sizeof(threadIdx));
+			ptr = writeBytes(ptr, &id, sizeof(id));
+			ptr = writeBytes(ptr, &timestamp, sizeof(timestamp));
+			ptr = writeString(ptr, str, getStringLength(str));
+
+			writeToFile(&record[0], ptr - &record[0]);
+		}
+	}
+
+	if(cacheEntry)
+	{
+		cacheEntry->m_str = str;
+		cacheEntry->m_id = id;
+		cacheEntry->m_capture = capture;
+	}
+
+	return id;
+}
+
+U8* BinaryLog::beginRecord(BinaryLogRecordType type, U32 id, U32 payloadSize, U64 timestamp)
+{
+	ThreadLocal* tlocal = getOrCreateThreadLocal();
+	if(!tlocal) [[unlikely]]
+	{
+		return nullptr;
+	}
+
+	tlocal->m_lock.lock();
+
+	// Check again now that endCapture() can't flush underneath
+	if(!isCapturing()) [[unlikely]]
+	{
+		tlocal->m_lock.unlock();
+		return nullptr;
+	}
+
+	const U32 recordSize = BinaryLogRecordHeader::kSize + payloadSize;
+	ANKI_ASSERT(recordSize <= ThreadLocal::kBufferSize);
+	if(tlocal->m_size + recordSize > ThreadLocal::kBufferSize)
+	{
+		flushThreadLocal(*tlocal);
+	}
+
+	if(timestamp == 0)
+	{
+		timestamp = toNanoseconds(HighRezTimer::getCurrentTime());
+	}
+
+	U8* ptr = &tlocal->m_buffer[tlocal->m_size];
+	ptr = writeBytes(ptr, &type, sizeof(type));
+	ptr = writeBytes(ptr, &tlocal->m_threadIdx, sizeof(tlocal->m_threadIdx));
+	ptr = writeBytes(ptr, &id, sizeof(id));
+	ptr = writeBytes(ptr, &timestamp, sizeof(timestamp));
+
+	tlocal->m_size += recordSize;
+
+	return ptr;
+}
+
+void BinaryLog::endRecord()
+{
+	ANKI_ASSERT(m_threadLocal);
+	m_threadLocal->m_lock.unlock();
+}
+
+void BinaryLog::writeTraceEvent(const Char* name, Second start, Second duration)
+{
+	const U32 id = defineString(name);
+	U8* ptr = beginRecord(BinaryLogRecordType::kTraceEvent, id, sizeof(U64), max<U64>(toNanoseconds(start), 1));
+	if(ptr)
+	{
+		const U64 durationNs = toNanoseconds(duration);
+		writeBytes(ptr, &durationNs, sizeof(durationNs));
+		endRecord();
+	}
+}
+
+void BinaryLog::writeCounter(const Char* name, U64 value)
+{
+	const U32 id = defineString(name);
+	U8* ptr = beginRecord(BinaryLogRecordType::kCounter, id, sizeof(U64));
+	if(ptr)
+	{
+		writeBytes(ptr, &value, sizeof(value));
+		endRecord();
+	}
+}
+
+} // end namespace anki
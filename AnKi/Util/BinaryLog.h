@@ -0,0 +1,271 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/Thread.h>
+#include <AnKi/Util/Singleton.h>
+#include <cstring>
+
+namespace anki {
+
+// Forward
+class File;
+
+/// @addtogroup util_logging
+/// @{
+
+/// The records of a binary log stream. The stream starts with kBinaryLogMagic and kBinaryLogVersion and then it's a sequence of records. Every
+/// record starts with a BinaryLogRecordHeader. Strings are a U16 length followed by the characters without a null terminator.
+enum class BinaryLogRecordType : U8
+{
+	kFormat, ///< Defines a log call site. Payload: U8 message type, I32 line, format, file, function and subsystem strings.
+	kString, ///< Defines the name of a trace event or a counter. Payload: The string.
+	kThread, ///< Defines a thread. The ID is the thread index. Payload: U64 thread ID and the thread name string.
+	kMessage, ///< A log message. The ID is the format. Payload: U16 size of the arguments and the arguments.
+	kTraceEvent, ///< The ID is the name. Payload: U64 duration in nanoseconds.
+	kCounter, ///< The ID is the name. Payload: U64 value.
+
+	kCount
+};
+
+/// The type tag that precedes every argument of a kMessage record.
+enum class BinaryLogArgType : U8
+{
+	kI64,
+	kU64,
+	kF64,
+	kString, ///< A string like the rest of the strings in the stream.
+	kPointer, ///< U64.
+
+	kCount
+};
+
+inline constexpr Array<Char, 8> kBinaryLogMagic = {'A', 'N', 'K', 'I', 'B', 'L', 'O', 'G'};
+inline constexpr U32 kBinaryLogVersion = 1;
+inline constexpr U32 kBinaryLogMaxStringLength = 1024; ///< Longer strings get truncated.
+
+/// The common part of all records. It's stored unaligned.
+class BinaryLogRecordHeader
+{
+public:
+	BinaryLogRecordType m_type;
+	U16 m_threadIdx; ///< Index of a thread defined by a kThread record.
+	U32 m_id;
+	U64 m_timestamp; ///< In nanoseconds.
+
+	static constexpr U32 kSize = sizeof(m_type) + sizeof(m_threadIdx) + sizeof(m_id) + sizeof(m_timestamp);
+};
+
+/// The ID of a log call site. The log macros keep one in a static variable so the format string and the rest of the call site are written only
+/// once per capture.
+class BinaryLogFormatId
+{
+public:
+	Atomic<U64> m_idAndCapture = {0}; ///< The ID in the low 32 bits and the capture it was defined in in the high.
+};
+
+/// Captures log messages, trace events and counters to a compact binary stream. Messages store the ID of their call site and the raw arguments
+/// instead of the formatted text so logging costs a few memcpys. Every thread writes to its own buffer that gets flushed to the file when it's
+/// full. Use BinaryLogReader or the BinaryLogDecoder tool to get text or Chrome trace JSON out of it.
+/// The names of the trace events and the counters are interned in the NameTable so it needs to be allocated while capturing.
+/// @note It's thread-safe.
+class BinaryLog : public MakeSingletonLazyInit<BinaryLog>
+{
+public:
+	BinaryLog() = default;
+
+	BinaryLog(const BinaryLog&) = delete; // Non-copyable
+
+	~BinaryLog();
+
+	BinaryLog& operator=(const BinaryLog&) = delete; // Non-copyable
+
+	/// Start writing to a new file.
+	Error beginCapture(const Char* filename);
+
+	/// Flush everything and close the file.
+	void endCapture();
+
+	static Bool isCapturing()
+	{
+		return m_capturing.load() != 0;
+	}
+
+	/// Write a log message. The format follows the printf rules.
+	template<typename... TArgs>
+	void writeMessage(BinaryLogFormatId& formatId, const Char* file, I32 line, const Char* func, const Char* subsystem, U8 messageType,
+					  const Char* fmt, const TArgs&... args)
+	{
+		U32 id;
+		const U64 idAndCapture = formatId.m_idAndCapture.load(AtomicMemoryOrder::kAcquire);
+		if((idAndCapture >> 32u) == m_captureIdx.load()) [[likely]]
+		{
+			id = U32(idAndCapture);
+		}
+		else
+		{
+			id = defineFormat(formatId, file, line, func, subsystem, messageType, fmt);
+		}
+
+		const U32 argsSize = (0 + ... + computeArgSize(args));
+		const U32 payloadSize = U32(sizeof(U16)) + min(argsSize, U32(kMaxU16));
+		U8* ptr = beginRecord(BinaryLogRecordType::kMessage, id, payloadSize);
+		if(ptr)
+		{
+			const U16 argsSize16 = U16(payloadSize - sizeof(U16));
+			ptr = writeBytes(ptr, &argsSize16, sizeof(argsSize16));
+			if(argsSize <= kMaxU16) [[likely]]
+			{
+				(..., (ptr = writeArg(ptr, args)));
+			}
+			else
+			{
+				memset(ptr, 0, argsSize16);
+			}
+
+			endRecord();
+		}
+	}
+
+	/// Write a trace event. The name should be a string that outlives the capture.
+	void writeTraceEvent(const Char* name, Second start, Second duration);
+
+	/// Write a counter increment. The name should be a string that outlives the capture.
+	void writeCounter(const Char* name, U64 value);
+
+	/// Flush the buffers of all threads to the file.
+	void flush();
+
+private:
+	static constexpr U32 kMaxThreads = 256;
+
+	class ThreadLocal;
+
+	static Atomic<U32> m_capturing;
+	static thread_local ThreadLocal* m_threadLocal;
+
+	Atomic<U32> m_captureIdx = {0}; ///< Incremented every time a capture begins.
+	File* m_file = nullptr;
+	Mutex m_fileMtx; ///< Protects the file and the definitions.
+	U32 m_nextFormatId = 0;
+
+	Array<ThreadLocal*, kMaxThreads> m_threadLocals = {};
+	U32 m_threadLocalCount = 0;
+
+	U32* m_stringCaptures = nullptr; ///< The capture every name of the NameTable was defined in. Indexed by the Name ID.
+	U32 m_stringCaptureCount = 0;
+
+	Error openFile(const Char* filename);
+
+	U32 defineFormat(BinaryLogFormatId& formatId, const Char* file, I32 line, const Char* func, const Char* subsystem, U8 messageType,
+					 const Char* fmt);
+
+	U32 defineString(const Char* str);
+
+	/// Lock the buffer of the thread and reserve space for a record. Returns the pointer to the payload or nullptr if the record should be
+	/// skipped. If it doesn't return nullptr call endRecord().
+	U8* beginRecord(BinaryLogRecordType type, U32 id, U32 payloadSize, U64 timestamp = 0);
+
+	void endRecord();
+
+	ThreadLocal* getOrCreateThreadLocal();
+
+	void writeThreadDefinition(const ThreadLocal& tlocal);
+	void flushThreadLocal(ThreadLocal& tlocal);
+	void writeToFile(const void* data, PtrSize size);
+
+	static U8* writeBytes(U8* ptr, const void* data, PtrSize size)
+	{
+		memcpy(ptr, data, size);
+		return ptr + size;
+	}
+
+	static U32 getStringLength(const Char* str)
+	{
+		return (str) ? U32(min<PtrSize>(strlen(str), kBinaryLogMaxStringLength)) : 0;
+	}
+
+	static U8* writeString(U8* ptr, const Char* str, U32 length)
+	{
+		const U16 length16 = U16(length);
+		ptr = writeBytes(ptr, &length16, sizeof(length16));
+		return writeBytes(ptr, str, length);
+	}
+
+	template<typename T>
+	static U32 computeArgSize(const T& arg)
+	{
+		using TT = std::decay_t<T>;
+		if constexpr(std::is_same_v<TT, const Char*> || std::is_same_v<TT, Char*>)
+		{
+			return 1 + sizeof(U16) + getStringLength(arg);
+		}
+		else if constexpr(requires { arg.cstr(); })
+		{
+			return 1 + sizeof(U16) + getStringLength(arg.cstr());
+		}
+		else
+		{
+			return 1 + sizeof(U64);
+		}
+	}
+
+	template<typename T>
+	static U8* writeArg(U8* ptr, const T& arg)
+	{
+		using TT = std::decay_t<T>;
+		BinaryLogArgType type;
+		if constexpr(std::is_same_v<TT, const Char*> || std::is_same_v<TT, Char*>)
+		{
+			type = BinaryLogArgType::kString;
+			ptr = writeBytes(ptr, &type, 1);
+			return writeString(ptr, arg, getStringLength(arg));
+		}
+		else if constexpr(requires { arg.cstr(); })
+		{
+			type = BinaryLogArgType::kString;
+			ptr = writeBytes(ptr, &type, 1);
+			return writeString(ptr, arg.cstr(), getStringLength(arg.cstr()));
+		}
+		else
+		{
+			U64 value;
+			if constexpr(std::is_floating_point_v<TT>)
+			{
+				type = BinaryLogArgType::kF64;
+				const F64 f = F64(arg);
+				memcpy(&value, &f, sizeof(value));
+			}
+			else if constexpr(std::is_null_pointer_v<TT>)
+			{
+				type = BinaryLogArgType::kPointer;
+				value = 0;
+			}
+			else if constexpr(std::is_pointer_v<TT>)
+			{
+				type = BinaryLogArgType::kPointer;
+				value = U64(ptrToNumber(arg));
+			}
+			else if constexpr(std::is_enum_v<TT>)
+			{
+				type = (std::is_signed_v<std::underlying_type_t<TT>>) ? BinaryLogArgType::kI64 : BinaryLogArgType::kU64;
+				value = U64(arg);
+			}
+			else
+			{
+				static_assert(std::is_integral_v<TT>, "Unsupported argument");
+				type = (std::is_signed_v<TT>) ? BinaryLogArgType::kI64 : BinaryLogArgType::kU64;
+				value = U64(arg);
+			}
+
+			ptr = writeBytes(ptr, &type, 1);
+			return writeBytes(ptr, &value, sizeof(value));
+		}
+	}
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,436 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/BinaryLogReader.h>
+#include <AnKi/Util/File.h>
+#include <algorithm>
+
+namespace anki {
+
+namespace {
+
+class ByteReader
+{
+public:
+	const U8* m_ptr;
+	const U8* m_end;
+
+	template<typename T>
+	Bool read(T& out)
+	{
+		if(PtrSize(m_end - m_ptr) < sizeof(T))
+		{
+			return false;
+		}
+
+		memcpy(&out, m_ptr, sizeof(T));
+		m_ptr += sizeof(T);
+		return true;
+	}
+
+	Bool readString(String& out)
+	{
+		U16 length;
+		if(!read(length) || PtrSize(m_end - m_ptr) < length)
+		{
+			return false;
+		}
+
+		out.destroy();
+		if(length)
+		{
+			out = String(reinterpret_cast<const Char*>(m_ptr), reinterpret_cast<const Char*>(m_ptr) + length);
+		}
+
+		m_ptr += length;
+		return true;
+	}
+};
+
+} // namespace
+
+static Second toSeconds(U64 ns)
+{
+	return Second(ns) / 1000000000.0;
+}
+
+template<typename T>
+static T& getOrGrow(DynamicArray<T>& arr, U32 idx)
+{
+	if(idx >= arr.getSize())
+	{
+		arr.resize(idx + 1);
+	}
+
+	return arr[idx];
+}
+
+Error BinaryLogReader::formatMessage(CString fmt, ConstWeakArray<U8> args, String& out)
+{
+	ByteReader reader = {args.getBegin(), args.getBegin() + args.getSize()};
+
+	// Read the next argument as an integer. Used for the * of the width and the precision as well
+	auto readNumber = [&](BinaryLogArgType& type, U64& value) -> Bool {
+		if(!reader.read(type))
+		{
+			return false;
+		}
+
+		if(type == BinaryLogArgType::kString)
+		{
+			String tmp;
+			value = 0;
+			return reader.readString(tmp);
+		}
+
+		return reader.read(value);
+	};
+
+	out.destroy();
+	const Char* c = fmt.cstr();
+	while(*c)
+	{
+		if(*c != '%')
+		{
+			const Char* literalEnd = c;
+			while(*literalEnd && *literalEnd != '%')
+			{
+				++literalEnd;
+			}
+
+			out.append(c, literalEnd);
+			c = literalEnd;
+			continue;
+		}
+
+		if(c[1] == '%')
+		{
+			out += "%";
+			c += 2;
+			continue;
+		}
+
+		// Parse the conversion specification and build a new one that matches the type of the argument
+		Array<Char, 64> spec;
+		U32 specLength = 0;
+		auto appendSpec = [&](const Char* str) {
+			while(*str && specLength < spec.getSize() - 8)
+			{
+				spec[specLength++] = *str++;
+			}
+		};
+
+		spec[specLength++] = *c++;
+
+		while(*c && strchr("-+ #0", *c))
+		{
+			const Char flag[2] = {*c++, '\0'};
+			appendSpec(flag);
+		}
+
+		for(U32 part = 0; part < 2; ++part)
+		{
+			// Width and then precision
+			if(part == 1)
+			{
+				if(*c != '.')
+				{
+					break;
+				}
+
+				appendSpec(".");
+				++c;
+			}
+
+			if(*c == '*')
+			{
+				BinaryLogArgType type;
+				U64 value;
+				if(!readNumber(type, value))
+				{
+					return Error::kUserData;
+				}
+
+				Array<Char, 32> number;
+				snprintf(&number[0], number.getSize(), "%d", I32(value));
+				appendSpec(&number[0]);
+				++c;
+			}
+			else
+			{
+				while(*c >= '0' && *c <= '9')
+				{
+					const Char digit[2] = {*c++, '\0'};
+					appendSpec(digit);
+				}
+			}
+		}
+
+		// The integers are always stored as 64bit. Remember the size that the length modifier gives them so they can be truncated like printf()
+		// would do. No modifier means int
+		U32 intBits = 32;
+		U32 hCount = 0;
+		while(*c && strchr("hljztLq", *c))
+		{
+			if(*c == 'h')
+			{
+				++hCount;
+				intBits = (hCount == 1) ? 16 : 8;
+			}
+			else
+			{
+				intBits = 64;
+			}
+			++c;
+		}
+
+		const Char conversion = *c;
+		if(conversion == '\0')
+		{
+			return Error::kUserData;
+		}
+		++c;
+
+		if(conversion == 'n')
+		{
+			continue;
+		}
+
+		BinaryLogArgType type;
+		if(!reader.read(type))
+		{
+			return Error::kUserData;
+		}
+
+		Array<Char, 512> buffer;
+		buffer[0] = '\0';
+		if(type == BinaryLogArgType::kString)
+		{
+			String str;
+			if(!reader.readString(str))
+			{
+				return Error::kUserData;
+			}
+
+			appendSpec("s");
+			spec[specLength] = '\0';
+			String formatted;
+			formatted.sprintf(&spec[0], (str.isEmpty()) ? "" : str.cstr());
+			out += formatted;
+			continue;
+		}
+
+		U64 value;
+		if(!reader.read(value))
+		{
+			return Error::kUserData;
+		}
+
+		if(strchr("fFeEgGaA", conversion))
+		{
+			F64 f;
+			if(type == BinaryLogArgType::kF64)
+			{
+				memcpy(&f, &value, sizeof(f));
+			}
+			else
+			{
+				f = (type == BinaryLogArgType::kI64) ? F64(I64(value)) : F64(value);
+			}
+
+			const Char conv[2] = {conversion, '\0'};
+			appendSpec(conv);
+			spec[specLength] = '\0';
+			snprintf(&buffer[0], buffer.getSize(), &spec[0], f);
+		}
+		else if(conversion == 'p')
+		{
+			appendSpec("p");
+			spec[specLength] = '\0';
+			snprintf(&buffer[0], buffer.getSize(), &spec[0], numberToPtr<void*>(PtrSize(value)));
+		}
+		else if(conversion == 'c')
+		{
+			appendSpec("c");
+			spec[specLength] = '\0';
+			snprintf(&buffer[0], buffer.getSize(), &spec[0], int(value));
+		}
+		else if(conversion == 's')
+		{
+			// The argument is not a string, print the number
+			appendSpec("llu");
+			spec[specLength] = '\0';
+			snprintf(&buffer[0], buffer.getSize(), &spec[0], static_cast<unsigned long long>(value));
+		}
+		else
+		{
+			const Char conv[4] = {'l', 'l', (conversion == 'i') ? 'd' : conversion, '\0'};
+			appendSpec(conv);
+			spec[specLength] = '\0';
+			if(type == BinaryLogArgType::kF64)
+			{
+				F64 f;
+				memcpy(&f, &value, sizeof(f));
+				value = U64(I64(f));
+			}
+
+			if(intBits < 64)
+			{
+				const U64 mask = (1ull << intBits) - 1;
+				value &= mask;
+
+				const Bool isSigned = conversion == 'd' || conversion == 'i';
+				if(isSigned && (value >> (intBits - 1)))
+				{
+					// Sign extend
+					value |= ~mask;
+				}
+			}
+
+			snprintf(&buffer[0], buffer.getSize(), &spec[0], static_cast<long long>(value));
+		}
+
+		out += &buffer[0];
+	}
+
+	return Error::kNone;
+}
+
+Error BinaryLogReader::load(CString filename)
+{
+	File file;
+	ANKI_CHECK(file.open(filename, FileOpenFlag::kRead | FileOpenFlag::kBinary));
+
+	DynamicArray<U8> data;
+	data.resize(U32(file.getSize()));
+	if(data.getSize())
+	{
+		ANKI_CHECK(file.read(&data[0], data.getSize()));
+	}
+
+	ByteReader reader = {data.getBegin(), data.getEnd()};
+
+	Array<Char, 8> magic;
+	U32 version;
+	if(!reader.read(magic) || memcmp(&magic[0], &kBinaryLogMagic[0], sizeof(magic)) != 0 || !reader.read(version)
+	   || version != kBinaryLogVersion)
+	{
+		ANKI_UTIL_LOGE("Not a binary log or wrong version: %s", filename.cstr());
+		return Error::kUserData;
+	}
+
+	while(reader.m_ptr < reader.m_end)
+	{
+		BinaryLogRecordHeader header;
+		if(!reader.read(header.m_type) || !reader.read(header.m_threadIdx) || !reader.read(header.m_id) || !reader.read(header.m_timestamp))
+		{
+			ANKI_UTIL_LOGE("Truncated binary log: %s", filename.cstr());
+			return Error::kUserData;
+		}
+
+		Bool ok = true;
+		switch(header.m_type)
+		{
+		case BinaryLogRecordType::kFormat:
+		{
+			Format& format = getOrGrow(m_formats, header.m_id);
+			U8 type = 0;
+			ok = reader.read(type) && reader.read(format.m_line) && reader.readString(format.m_fmt) && reader.readString(format.m_file)
+				 && reader.readString(format.m_func) && reader.readString(format.m_subsystem);
+			format.m_type = LoggerMessageType(min<U8>(type, U8(LoggerMessageType::kCount) - 1));
+			format.m_defined = true;
+			break;
+		}
+		case BinaryLogRecordType::kString:
+			ok = reader.readString(getOrGrow(m_strings, header.m_id));
+			break;
+		case BinaryLogRecordType::kThread:
+		{
+			ThreadInfo& thread = getOrGrow(m_threads, header.m_id);
+			ok = reader.read(thread.m_tid) && reader.readString(thread.m_name);
+			break;
+		}
+		case BinaryLogRecordType::kMessage:
+		{
+			U16 argsSize;
+			ok = reader.read(argsSize) && PtrSize(reader.m_end - reader.m_ptr) >= argsSize && header.m_id < m_formats.getSize()
+				 && m_formats[header.m_id].m_defined;
+			if(!ok)
+			{
+				break;
+			}
+
+			const Format& format = m_formats[header.m_id];
+			Message& msg = *m_messages.emplaceBack();
+			msg.m_time = toSeconds(header.m_timestamp);
+			msg.m_threadIdx = header.m_threadIdx;
+			msg.m_type = format.m_type;
+			msg.m_line = format.m_line;
+			msg.m_subsystem = format.m_subsystem;
+			msg.m_file = format.m_file;
+			msg.m_func = format.m_func;
+			if(formatMessage(format.m_fmt, ConstWeakArray<U8>(reader.m_ptr, argsSize), msg.m_text))
+			{
+				msg.m_text = format.m_fmt;
+				msg.m_text += " <bad arguments>";
+			}
+
+			reader.m_ptr += argsSize;
+			break;
+		}
+		case BinaryLogRecordType::kTraceEvent:
+		{
+			U64 duration;
+			ok = reader.read(duration) && header.m_id < m_strings.getSize();
+			if(ok)
+			{
+				TraceEvent& event = *m_traceEvents.emplaceBack();
+				event.m_start = toSeconds(header.m_timestamp);
+				event.m_duration = toSeconds(duration);
+				event.m_threadIdx = header.m_threadIdx;
+				event.m_name = m_strings[header.m_id];
+			}
+			break;
+		}
+		case BinaryLogRecordType::kCounter:
+		{
+			U64 value;
+			ok = reader.read(value) && header.m_id < m_strings.getSize();
+			if(ok)
+			{
+				Counter& counter = *m_counters.emplaceBack();
+				counter.m_time = toSeconds(header.m_timestamp);
+				counter.m_threadIdx = header.m_threadIdx;
+				counter.m_name = m_strings[header.m_id];
+				counter.m_value = value;
+			}
+			break;
+		}
+		default:
+			ok = false;
+		}
+
+		if(!ok)
+		{
+			ANKI_UTIL_LOGE("Corrupted binary log: %s", filename.cstr());
+			return Error::kUserData;
+		}
+	}
+
+	// The threads flush their records in chunks so sort everything
+	std::stable_sort(m_messages.getBegin(), m_messages.getEnd(), [](const Message& a, const Message& b) {
+		return a.m_time < b.m_time;
+	});
+	std::stable_sort(m_traceEvents.getBegin(), m_traceEvents.getEnd(), [](const TraceEvent& a, const TraceEvent& b) {
+		return (a.m_start != b.m_start) ? a.m_start < b.m_start : a.m_duration > b.m_duration;
+	});
+	std::stable_sort(m_counters.getBegin(), m_counters.getEnd(), [](const Counter& a, const Counter& b) {
+		return a.m_time < b.m_time;
+	});
+
+	return Error::kNone;
+}
+
+} // end namespace anki
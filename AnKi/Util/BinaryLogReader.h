@@ -0,0 +1,109 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/BinaryLog.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/String.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/WeakArray.h>
+
+namespace anki {
+
+/// @addtogroup util_logging
+/// @{
+
+/// Reads a file written by BinaryLog and formats the messages.
+class BinaryLogReader
+{
+public:
+	class ThreadInfo
+	{
+	public:
+		U64 m_tid = 0;
+		String m_name;
+	};
+
+	class Message
+	{
+	public:
+		Second m_time = 0.0;
+		U32 m_threadIdx = 0;
+		LoggerMessageType m_type = LoggerMessageType::kNormal;
+		I32 m_line = 0;
+		CString m_subsystem;
+		CString m_file;
+		CString m_func;
+		String m_text;
+	};
+
+	class TraceEvent
+	{
+	public:
+		Second m_start = 0.0;
+		Second m_duration = 0.0;
+		U32 m_threadIdx = 0;
+		CString m_name;
+	};
+
+	class Counter
+	{
+	public:
+		Second m_time = 0.0;
+		U32 m_threadIdx = 0;
+		CString m_name;
+		U64 m_value = 0;
+	};
+
+	/// Load and decode a file. The messages, the events and the counters are sorted by time.
+	Error load(CString filename);
+
+	ConstWeakArray<ThreadInfo> getThreads() const
+	{
+		return m_threads;
+	}
+
+	ConstWeakArray<Message> getMessages() const
+	{
+		return m_messages;
+	}
+
+	ConstWeakArray<TraceEvent> getTraceEvents() const
+	{
+		return m_traceEvents;
+	}
+
+	ConstWeakArray<Counter> getCounters() const
+	{
+		return m_counters;
+	}
+
+	/// Format the arguments of a kMessage record using a printf format.
+	static Error formatMessage(CString fmt, ConstWeakArray<U8> args, String& out);
+
+private:
+	class Format
+	{
+	public:
+		LoggerMessageType m_type = LoggerMessageType::kNormal;
+		I32 m_line = 0;
+		String m_fmt;
+		String m_file;
+		String m_func;
+		String m_subsystem;
+		Bool m_defined = false;
+	};
+
+	DynamicArray<Format> m_formats; ///< Indexed by the format ID.
+	DynamicArray<String> m_strings; ///< Indexed by the string ID.
+	DynamicArray<ThreadInfo> m_threads; ///< Indexed by the thread index.
+	DynamicArray<Message> m_messages;
+	DynamicArray<TraceEvent> m_traceEvents;
+	DynamicArray<Counter> m_counters;
+};
+/// @}
+
+} // end namespace anki
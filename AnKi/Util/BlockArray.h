@@ -129,7 +129,9 @@ private:
 	}
 };
 
-/// It's a type of dynamic array that unlike DynamicArray doesn't move elements around when it shrinks or grows the storage.
+/// It's a type of dynamic array that unlike DynamicArray doesn't move elements around when it shrinks or grows the storage. On top of the per
+/// block masks it keeps two summary bitmaps with one bit per block (blocks that have free slots and blocks that have live elements) so emplace
+/// and iteration skip 64 blocks at a time.
 template<typename T, typename TMemoryPool = SingletonMemoryPoolWrapper<DefaultMemoryPool>, typename TConfig = BlockArrayDefaultConfig<T>>
 class BlockArray
 {
@@ -150,6 +152,8 @@ public:
 	BlockArray(const TMemoryPool& pool = TMemoryPool())
 		: m_blockStorages(pool)
 		, m_blockMetadatas(pool)
+		, m_nonFullBlocks(pool)
+		, m_nonEmptyBlocks(pool)
 	{
 	}
 
@@ -180,6 +184,8 @@ public:
 		destroy();
 		m_blockStorages = std::move(b.m_blockStorages);
 		m_blockMetadatas = std::move(b.m_blockMetadatas);
+		m_nonFullBlocks = std::move(b.m_nonFullBlocks);
+		m_nonEmptyBlocks = std::move(b.m_nonEmptyBlocks);
 		m_elementCount = b.m_elementCount;
 		b.m_elementCount = 0;
 		m_firstIndex = b.m_firstIndex;
@@ -281,6 +287,12 @@ public:
 		erase(indexToIterator(index));
 	}
 
+	/// Move the live elements to the lowest free slots so they are packed at the start of the array and free the blocks that end up empty.
+	/// Iterators and indices are invalidated.
+	/// @param relocated A functor with signature void(U32 oldIndex, U32 newIndex) that will be called for every element that was moved.
+	template<typename TFunc>
+	void compact(TFunc relocated);
+
 	Iterator indexToIterator(U32 idx)
 	{
 		ANKI_ASSERT(indexExists(idx));
@@ -331,41 +343,89 @@ private:
 
 	DynamicArray<BlockStorage*, TMemoryPool> m_blockStorages;
 	DynamicArray<BlockMetadata, TMemoryPool> m_blockMetadatas;
+	DynamicArray<U64, TMemoryPool> m_nonFullBlocks; ///< One bit per block. Set if the block has free slots.
+	DynamicArray<U64, TMemoryPool> m_nonEmptyBlocks; ///< One bit per block. Set if the block has live elements.
 	U32 m_elementCount = 0;
 	U32 m_firstIndex = 0;
 	U32 m_endIndex = 0; ///< The index after the last.
 
 	U32 getFirstElementIndex() const
 	{
-		for(U32 blockIdx = 0; blockIdx < m_blockMetadatas.getSize(); ++blockIdx)
+		const U32 blockIdx = findFirstSetBlock(m_nonEmptyBlocks, 0);
+		ANKI_ASSERT(blockIdx != kMaxU32);
+		return m_blockMetadatas[blockIdx].m_elementsInUseMask.getLeastSignificantBit() + blockIdx * kElementCountPerBlock;
+	}
+
+	U32 getLastElementIndex() const
+	{
+		const U32 blockIdx = findLastSetBlock(m_nonEmptyBlocks);
+		ANKI_ASSERT(blockIdx != kMaxU32);
+		return m_blockMetadatas[blockIdx].m_elementsInUseMask.getMostSignificantBit() + blockIdx * kElementCountPerBlock;
+	}
+
+	/// Find the first block that is equal or after fromBlock and has its bit set in a summary bitmap.
+	static U32 findFirstSetBlock(const DynamicArray<U64, TMemoryPool>& summary, U32 fromBlock)
+	{
+		U32 wordIdx = fromBlock / 64;
+		if(wordIdx >= summary.getSize())
+		{
+			return kMaxU32;
+		}
+
+		U64 word = summary[wordIdx] & (kMaxU64 << (fromBlock % 64));
+		while(word == 0)
 		{
-			U32 localIdx;
-			if((localIdx = m_blockMetadatas[blockIdx].m_elementsInUseMask.getLeastSignificantBit()) != kMaxU32)
+			if(++wordIdx == summary.getSize())
 			{
-				return localIdx + blockIdx * kElementCountPerBlock;
+				return kMaxU32;
 			}
+
+			word = summary[wordIdx];
 		}
 
-		ANKI_ASSERT(0);
-		return 0;
+		return wordIdx * 64 + U32(__builtin_ctzll(word));
 	}
 
-	U32 getLastElementIndex() const
+	/// Find the last block that has its bit set in a summary bitmap.
+	static U32 findLastSetBlock(const DynamicArray<U64, TMemoryPool>& summary)
 	{
-		U32 blockIdx = m_blockMetadatas.getSize();
-		while(blockIdx--)
+		U32 wordIdx = summary.getSize();
+		while(wordIdx--)
 		{
-			U32 localIdx;
-			if((localIdx = m_blockMetadatas[blockIdx].m_elementsInUseMask.getMostSignificantBit()) != kMaxU32)
+			if(summary[wordIdx])
 			{
-				return localIdx + blockIdx * kElementCountPerBlock;
+				return wordIdx * 64 + (63 - U32(__builtin_clzll(summary[wordIdx])));
 			}
 		}
 
-		ANKI_ASSERT(0);
-		return 0;
+		return kMaxU32;
+	}
+
+	static void setSummaryBit(DynamicArray<U64, TMemoryPool>& summary, U32 blockIdx, Bool set)
+	{
+		const U64 bit = 1_U64 << (blockIdx % 64);
+		U64& word = summary[blockIdx / 64];
+		word = (set) ? (word | bit) : (word & ~bit);
+	}
+
+	/// Get the slot that the next emplace will use. It might be past the last block.
+	U32 getFirstFreeIndex() const
+	{
+		const U32 blockIdx = findFirstSetBlock(m_nonFullBlocks, 0);
+		if(blockIdx == kMaxU32)
+		{
+			return m_blockMetadatas.getSize() * kElementCountPerBlock;
+		}
+
+		return (~m_blockMetadatas[blockIdx].m_elementsInUseMask).getLeastSignificantBit() + blockIdx * kElementCountPerBlock;
 	}
 
+	/// Allocate the storage of a slot and mark it as in use. The element needs to be constructed by the caller.
+	Value* acquireSlot(U32 idx);
+
+	/// Mark a slot as free and release its block if it's empty. The element needs to be destroyed by the caller.
+	void releaseSlot(U32 idx);
+
 	U32 getNextElementIndex(U32 crnt) const;
 };
 /// @}
@@ -27,85 +27,77 @@ void BlockArray<T, TMemoryPool, TConfig>::destroy()
 
 	m_blockMetadatas.destroy();
 	m_blockStorages.destroy();
+	m_nonFullBlocks.destroy();
+	m_nonEmptyBlocks.destroy();
 	m_elementCount = 0;
 	m_firstIndex = 0;
 	m_endIndex = 0;
 }
 
 template<typename T, typename TMemoryPool, typename TConfig>
-template<typename... TArgs>
-typename BlockArray<T, TMemoryPool, TConfig>::Iterator BlockArray<T, TMemoryPool, TConfig>::emplace(TArgs&&... args)
+typename BlockArray<T, TMemoryPool, TConfig>::Value* BlockArray<T, TMemoryPool, TConfig>::acquireSlot(U32 idx)
 {
-	U32 localIdx = kMaxU32;
-	U32 blockIdx = kMaxU32;
+	const U32 localIdx = idx % kElementCountPerBlock;
+	const U32 blockIdx = idx / kElementCountPerBlock;
 
-	// Search for a block with free elements
-	for(U32 i = 0; i < m_blockStorages.getSize(); ++i)
+	if(blockIdx == m_blockMetadatas.getSize())
 	{
-		if(m_blockMetadatas[i].m_elementsInUseMask.getSetBitCount() < kElementCountPerBlock)
-		{
-			// Found a block, allocate from it
-			auto unsetBits = ~m_blockMetadatas[i].m_elementsInUseMask;
-			localIdx = unsetBits.getLeastSignificantBit();
-			blockIdx = i;
-
-			if(m_blockStorages[blockIdx] == nullptr)
-			{
-				m_blockStorages[blockIdx] = newInstance<BlockStorage>(getMemoryPool());
-			}
+		// Block not found, crate new
+		m_blockMetadatas.emplaceBack(false);
+		m_blockStorages.emplaceBack(nullptr);
 
-			break;
+		if(blockIdx / 64 == m_nonFullBlocks.getSize())
+		{
+			m_nonFullBlocks.emplaceBack(0);
+			m_nonEmptyBlocks.emplaceBack(0);
 		}
+
+		setSummaryBit(m_nonFullBlocks, blockIdx, true);
 	}
 
-	// Block not found, crate new
-	if(blockIdx == kMaxU32)
+	ANKI_ASSERT(blockIdx < m_blockMetadatas.getSize());
+	if(m_blockStorages[blockIdx] == nullptr)
 	{
-		m_blockMetadatas.emplaceBack(false);
-		m_blockStorages.emplaceBack(newInstance<BlockStorage>(getMemoryPool()));
-
-		localIdx = 0;
-		blockIdx = m_blockMetadatas.getSize() - 1;
+		m_blockStorages[blockIdx] = newInstance<BlockStorage>(getMemoryPool());
 	}
 
-	// Finalize and return
-	ANKI_ASSERT(localIdx < kElementCountPerBlock);
-
-	::new(&m_blockStorages[blockIdx]->m_storage[localIdx * sizeof(T)]) T(std::forward<TArgs>(args)...);
+	Mask& inUseMask = m_blockMetadatas[blockIdx].m_elementsInUseMask;
+	ANKI_ASSERT(inUseMask.get(localIdx) == false);
+	inUseMask.set(localIdx);
 
-	ANKI_ASSERT(m_blockMetadatas[blockIdx].m_elementsInUseMask.get(localIdx) == false);
-	m_blockMetadatas[blockIdx].m_elementsInUseMask.set(localIdx);
+	setSummaryBit(m_nonEmptyBlocks, blockIdx, true);
+	if(!(~inUseMask).getAnySet())
+	{
+		setSummaryBit(m_nonFullBlocks, blockIdx, false);
+	}
 
 	++m_elementCount;
-	const U32 idx = blockIdx * kElementCountPerBlock + localIdx;
-	m_firstIndex = min(m_firstIndex, idx);
+	m_firstIndex = (m_elementCount == 1) ? idx : min(m_firstIndex, idx);
 	m_endIndex = max(m_endIndex, idx + 1);
 
-	return Iterator(this, idx);
+	return reinterpret_cast<Value*>(&m_blockStorages[blockIdx]->m_storage[localIdx * sizeof(T)]);
 }
 
 template<typename T, typename TMemoryPool, typename TConfig>
-void BlockArray<T, TMemoryPool, TConfig>::erase(Iterator it)
+void BlockArray<T, TMemoryPool, TConfig>::releaseSlot(U32 idx)
 {
-	const U32 idx = it.getArrayIndex();
 	const U32 localIdx = idx % kElementCountPerBlock;
 	const U32 blockIdx = idx / kElementCountPerBlock;
 
 	ANKI_ASSERT(blockIdx < m_blockStorages.getSize());
-	BlockStorage* block = m_blockStorages[blockIdx];
-	ANKI_ASSERT(block);
+	ANKI_ASSERT(m_blockStorages[blockIdx]);
 
 	Mask& inUseMask = m_blockMetadatas[blockIdx].m_elementsInUseMask;
 	ANKI_ASSERT(inUseMask.get(localIdx) == true);
-
-	reinterpret_cast<T*>(&block->m_storage[localIdx * sizeof(T)])->~T();
-
 	inUseMask.unset(localIdx);
-	if(inUseMask.getSetBitCount() == 0)
+
+	setSummaryBit(m_nonFullBlocks, blockIdx, true);
+	if(!inUseMask.getAnySet())
 	{
 		// Block is empty, delete it
-		getMemoryPool().free(block);
+		getMemoryPool().free(m_blockStorages[blockIdx]);
 		m_blockStorages[blockIdx] = nullptr;
+		setSummaryBit(m_nonEmptyBlocks, blockIdx, false);
 	}
 
 	ANKI_ASSERT(m_elementCount > 0);
@@ -130,6 +122,68 @@ void BlockArray<T, TMemoryPool, TConfig>::erase(Iterator it)
 	}
 }
 
+template<typename T, typename TMemoryPool, typename TConfig>
+template<typename... TArgs>
+typename BlockArray<T, TMemoryPool, TConfig>::Iterator BlockArray<T, TMemoryPool, TConfig>::emplace(TArgs&&... args)
+{
+	const U32 idx = getFirstFreeIndex();
+	::new(acquireSlot(idx)) T(std::forward<TArgs>(args)...);
+	return Iterator(this, idx);
+}
+
+template<typename T, typename TMemoryPool, typename TConfig>
+void BlockArray<T, TMemoryPool, TConfig>::erase(Iterator it)
+{
+	const U32 idx = it.getArrayIndex();
+	(*this)[idx].~T();
+	releaseSlot(idx);
+}
+
+template<typename T, typename TMemoryPool, typename TConfig>
+template<typename TFunc>
+void BlockArray<T, TMemoryPool, TConfig>::compact(TFunc relocated)
+{
+	// Move the last element to the first hole until there are no holes before the last element
+	while(m_elementCount > 0)
+	{
+		const U32 oldIdx = m_endIndex - 1;
+		const U32 newIdx = getFirstFreeIndex();
+		if(newIdx > oldIdx)
+		{
+			break;
+		}
+
+		T& oldElement = (*this)[oldIdx];
+		::new(acquireSlot(newIdx)) T(std::move(oldElement));
+		oldElement.~T();
+		releaseSlot(oldIdx);
+
+		relocated(oldIdx, newIdx);
+	}
+
+	// Drop the trailing empty blocks
+	const U32 blockCount = (m_endIndex + kElementCountPerBlock - 1) / kElementCountPerBlock;
+	if(blockCount == 0)
+	{
+		destroy();
+	}
+	else if(blockCount < m_blockMetadatas.getSize())
+	{
+		m_blockMetadatas.resize(blockCount);
+		m_blockStorages.resize(blockCount);
+
+		const U32 summaryWordCount = (blockCount + 63) / 64;
+		m_nonFullBlocks.resize(summaryWordCount);
+		m_nonEmptyBlocks.resize(summaryWordCount);
+		if(blockCount % 64)
+		{
+			const U64 validBlocksMask = (1_U64 << (blockCount % 64)) - 1;
+			m_nonFullBlocks.getBack() &= validBlocksMask;
+			m_nonEmptyBlocks.getBack() &= validBlocksMask;
+		}
+	}
+}
+
 template<typename T, typename TMemoryPool, typename TConfig>
 BlockArray<T, TMemoryPool, TConfig>& BlockArray<T, TMemoryPool, TConfig>::operator=(const BlockArray& b)
 {
@@ -144,6 +198,8 @@ BlockArray<T, TMemoryPool, TConfig>& BlockArray<T, TMemoryPool, TConfig>::operat
 	m_firstIndex = b.m_firstIndex;
 	m_endIndex = b.m_endIndex;
 	m_blockMetadatas = b.m_blockMetadatas;
+	m_nonFullBlocks = b.m_nonFullBlocks;
+	m_nonEmptyBlocks = b.m_nonEmptyBlocks;
 	m_blockStorages.resize(b.m_blockStorages.getSize());
 
 	for(U32 blockIdx = 0; blockIdx < b.m_blockMetadatas.getSize(); ++blockIdx)
@@ -175,25 +231,38 @@ U32 BlockArray<T, TMemoryPool, TConfig>::getNextElementIndex(U32 crnt) const
 {
 	ANKI_ASSERT(crnt < m_endIndex);
 
-	++crnt;
-	for(; crnt < m_endIndex; ++crnt)
+	// Search the rest of the current block
+	U32 blockIdx = crnt / kElementCountPerBlock;
+	const U32 localIdx = crnt % kElementCountPerBlock;
+	if(localIdx + 1 < kElementCountPerBlock)
 	{
-		const U32 localIdx = crnt % kElementCountPerBlock;
-		const U32 blockIdx = crnt / kElementCountPerBlock;
-
-		if(m_blockMetadatas[blockIdx].m_elementsInUseMask.get(localIdx))
+		Mask mask = m_blockMetadatas[blockIdx].m_elementsInUseMask;
+		mask.unsetNLeastSignificantBits(localIdx + 1);
+		const U32 nextLocalIdx = mask.getLeastSignificantBit();
+		if(nextLocalIdx != kMaxU32)
 		{
-			return crnt;
+			return nextLocalIdx + blockIdx * kElementCountPerBlock;
 		}
 	}
 
-	return m_endIndex;
+	// Jump to the next block with live elements
+	blockIdx = findFirstSetBlock(m_nonEmptyBlocks, blockIdx + 1);
+	if(blockIdx == kMaxU32)
+	{
+		return m_endIndex;
+	}
+
+	const U32 next = m_blockMetadatas[blockIdx].m_elementsInUseMask.getLeastSignificantBit() + blockIdx * kElementCountPerBlock;
+	ANKI_ASSERT(next < m_endIndex);
+	return next;
 }
 
 template<typename T, typename TMemoryPool, typename TConfig>
 void BlockArray<T, TMemoryPool, TConfig>::validate() const
 {
 	ANKI_ASSERT(m_blockStorages.getSize() == m_blockMetadatas.getSize());
+	ANKI_ASSERT(m_nonFullBlocks.getSize() == (m_blockMetadatas.getSize() + 63) / 64);
+	ANKI_ASSERT(m_nonEmptyBlocks.getSize() == m_nonFullBlocks.getSize());
 
 	[[maybe_unused]] U32 count = 0;
 	U32 first = 0;
@@ -202,6 +271,9 @@ void BlockArray<T, TMemoryPool, TConfig>::validate() const
 	{
 		const Mask& mask = m_blockMetadatas[i].m_elementsInUseMask;
 		const U32 lcount = mask.getSetBitCount();
+		[[maybe_unused]] const U64 summaryBit = 1_U64 << (i % 64);
+		ANKI_ASSERT(!!(m_nonFullBlocks[i / 64] & summaryBit) == (lcount < kElementCountPerBlock));
+		ANKI_ASSERT(!!(m_nonEmptyBlocks[i / 64] & summaryBit) == (lcount > 0));
 		if(lcount == 0)
 		{
 			ANKI_ASSERT(m_blockStorages[i] == nullptr);
@@ -0,0 +1,271 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/Atomic.h>
+#include <AnKi/Util/Thread.h>
+
+namespace anki {
+
+/// @addtogroup util_containers
+/// @{
+
+/// A hash map for read-mostly caches that are hit from many threads. find() is wait-free: it never takes a lock, never writes shared
+/// memory and finishes in a bounded number of steps. emplace() is serialized with a mutex.
+///
+/// The map is insert-only, elements can't be erased or replaced. This is what makes the lock-free reads simple: a published slot never
+/// changes. When the table grows the new table is published atomically and the old one is retired. Readers might still be looking at a
+/// retired table so the retired tables are freed in destroy() (the grace period is the lifetime of the map). Their total size is less than
+/// the size of the current table.
+///
+/// Like HashMap the elements are identified by the 64bit hash of the key. TValue needs to be trivially copyable (typically a pointer).
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>, typename TMemoryPool = SingletonMemoryPoolWrapper<DefaultMemoryPool>>
+class ConcurrentHashMap
+{
+	static_assert(std::is_trivially_copyable_v<TValue> && std::is_trivially_destructible_v<TValue>, "TValue should be something like a pointer");
+
+public:
+	using Value = TValue;
+	using Key = TKey;
+	using Hasher = THasher;
+
+	ConcurrentHashMap(const TMemoryPool& pool = TMemoryPool())
+		: m_pool(pool)
+	{
+	}
+
+	ConcurrentHashMap(const ConcurrentHashMap&) = delete; // Non-copyable
+
+	~ConcurrentHashMap()
+	{
+		destroy();
+	}
+
+	ConcurrentHashMap& operator=(const ConcurrentHashMap&) = delete; // Non-copyable
+
+	/// @note It's not thread-safe.
+	void destroy()
+	{
+		Table* table = m_table.exchange(nullptr);
+		while(table)
+		{
+			Table* retired = table->m_retired;
+			m_pool.free(table);
+			table = retired;
+		}
+
+		m_elementCount = 0;
+		m_hasEmptyHashValue.setNonAtomically(false);
+	}
+
+	/// Find a value using a key or anything else that THasher accepts.
+	/// @note It's thread-safe and wait-free.
+	template<typename TOtherKey>
+	Bool find(const TOtherKey& key, TValue& value) const
+	{
+		return findHash(THasher()(key), value);
+	}
+
+	/// Same as find() but using the hash of the key.
+	Bool findHash(U64 hash, TValue& value) const
+	{
+		if(hash == kEmptyHash) [[unlikely]]
+		{
+			if(m_hasEmptyHashValue.load(AtomicMemoryOrder::kAcquire))
+			{
+				value = m_emptyHashValue;
+				return true;
+			}
+			return false;
+		}
+
+		const Table* table = m_table.load(AtomicMemoryOrder::kAcquire);
+		if(!table)
+		{
+			return false;
+		}
+
+		const U32 mask = table->m_capacity - 1;
+		U32 slot = U32(hash) & mask;
+		while(true)
+		{
+			const Slot& s = table->m_slots[slot];
+			const U64 slotHash = s.m_hash.load(AtomicMemoryOrder::kAcquire);
+			if(slotHash == hash)
+			{
+				value = s.m_value;
+				return true;
+			}
+			else if(slotHash == kEmptyHash)
+			{
+				// The map is insert-only with linear probing so an empty slot terminates the search
+				return false;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+	}
+
+	/// Insert a value if the key is not present.
+	/// @note It's thread-safe.
+	/// @return True if the value got inserted and false if the key was already there.
+	Bool emplace(const TKey& key, const TValue& value)
+	{
+		return emplaceHash(THasher()(key), value);
+	}
+
+	/// Same as emplace() but using the hash of the key.
+	Bool emplaceHash(U64 hash, const TValue& value)
+	{
+		LockGuard<Mutex> lock(m_insertMtx);
+
+		if(hash == kEmptyHash) [[unlikely]]
+		{
+			if(m_hasEmptyHashValue.load(AtomicMemoryOrder::kRelaxed))
+			{
+				return false;
+			}
+
+			m_emptyHashValue = value;
+			m_hasEmptyHashValue.store(true, AtomicMemoryOrder::kRelease);
+			++m_elementCount;
+			return true;
+		}
+
+		Table* table = m_table.load(AtomicMemoryOrder::kRelaxed);
+
+		// Max load factor is 1/2 to keep the probe sequences of the readers short
+		if(!table || (m_elementCount + 1) * 2 > table->m_capacity)
+		{
+			table = grow(table);
+		}
+
+		const U32 mask = table->m_capacity - 1;
+		U32 slot = U32(hash) & mask;
+		while(true)
+		{
+			Slot& s = table->m_slots[slot];
+			const U64 slotHash = s.m_hash.load(AtomicMemoryOrder::kRelaxed);
+			if(slotHash == hash)
+			{
+				return false;
+			}
+			else if(slotHash == kEmptyHash)
+			{
+				// Write the value first and then publish it by writing the hash
+				s.m_value = value;
+				s.m_hash.store(hash, AtomicMemoryOrder::kRelease);
+				++m_elementCount;
+				return true;
+			}
+
+			slot = (slot + 1) & mask;
+		}
+	}
+
+	/// @note It's thread-safe.
+	U32 getSize() const
+	{
+		LockGuard<Mutex> lock(m_insertMtx);
+		return m_elementCount;
+	}
+
+	/// @note It's not thread-safe.
+	Bool isEmpty() const
+	{
+		return m_elementCount == 0;
+	}
+
+	/// Visit all the elements. TFunc's signature is void(U64 hash, const TValue& value).
+	/// @note It's not thread-safe.
+	template<typename TFunc>
+	void iterate(TFunc func) const
+	{
+		if(m_hasEmptyHashValue.load(AtomicMemoryOrder::kRelaxed))
+		{
+			func(kEmptyHash, m_emptyHashValue);
+		}
+
+		const Table* table = m_table.load(AtomicMemoryOrder::kRelaxed);
+		for(U32 i = 0; table && i < table->m_capacity; ++i)
+		{
+			const U64 hash = table->m_slots[i].m_hash.load(AtomicMemoryOrder::kRelaxed);
+			if(hash != kEmptyHash)
+			{
+				func(hash, table->m_slots[i].m_value);
+			}
+		}
+	}
+
+private:
+	static constexpr U64 kEmptyHash = 0;
+	static constexpr U32 kMinCapacity = 32;
+
+	class Slot
+	{
+	public:
+		Atomic<U64> m_hash;
+		TValue m_value;
+	};
+
+	class Table
+	{
+	public:
+		Table* m_retired;
+		U32 m_capacity;
+		Slot m_slots[1]; ///< The allocation is large enough to hold m_capacity slots.
+	};
+
+	mutable TMemoryPool m_pool;
+	Atomic<Table*> m_table = {nullptr};
+	mutable Mutex m_insertMtx;
+	U32 m_elementCount = 0;
+
+	/// The slots use kEmptyHash to mark empty slots. An element with that hash is stored on the side.
+	TValue m_emptyHashValue = {};
+	Atomic<Bool> m_hasEmptyHashValue = {false};
+
+	Table* grow(Table* oldTable)
+	{
+		const U32 capacity = (oldTable) ? oldTable->m_capacity * 2 : kMinCapacity;
+		Table* table = static_cast<Table*>(m_pool.allocate(sizeof(Table) + sizeof(Slot) * (capacity - 1), alignof(Table)));
+		table->m_retired = oldTable;
+		table->m_capacity = capacity;
+		for(U32 i = 0; i < capacity; ++i)
+		{
+			::new(&table->m_slots[i]) Slot();
+			table->m_slots[i].m_hash.setNonAtomically(kEmptyHash);
+		}
+
+		if(oldTable)
+		{
+			const U32 mask = capacity - 1;
+			for(U32 i = 0; i < oldTable->m_capacity; ++i)
+			{
+				const U64 hash = oldTable->m_slots[i].m_hash.load(AtomicMemoryOrder::kRelaxed);
+				if(hash != kEmptyHash)
+				{
+					U32 slot = U32(hash) & mask;
+					while(table->m_slots[slot].m_hash.getNonAtomically() != kEmptyHash)
+					{
+						slot = (slot + 1) & mask;
+					}
+
+					table->m_slots[slot].m_value = oldTable->m_slots[i].m_value;
+					table->m_slots[slot].m_hash.setNonAtomically(hash);
+				}
+			}
+		}
+
+		// Publish. Readers that already got the old table will keep using it and they will see a complete set of elements
+		m_table.store(table, AtomicMemoryOrder::kRelease);
+		return table;
+	}
+};
+/// @}
+
+} // end namespace anki
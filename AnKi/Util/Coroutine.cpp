@@ -0,0 +1,143 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/Coroutine.h>
+
+namespace anki {
+
+void ResumeOnAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	m_manager.dispatchTask([handle]([[maybe_unused]] U32 threadId) {
+		handle.resume();
+	});
+}
+
+void JobAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	// The job manager will run the continuation when the job finishes
+	m_manager.dispatchTask(
+		[handle]([[maybe_unused]] U32 threadId) {
+			handle.resume();
+		},
+		ConstWeakArray<ThreadJobHandle>(&m_job, 1));
+}
+
+Bool EventAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+	m_handle = handle;
+
+	LockGuard lock(m_event.m_mtx);
+	if(m_event.m_signaled.load())
+	{
+		// Signaled after await_ready(), don't suspend
+		return false;
+	}
+
+	m_next = m_event.m_waiters;
+	m_event.m_waiters = this;
+	return true;
+}
+
+void CoroutineEvent::signal()
+{
+	EventAwaiter* waiters;
+	{
+		LockGuard lock(m_mtx);
+		ANKI_ASSERT(!m_signaled.load() && "Already signaled");
+		m_signaled.store(true, AtomicMemoryOrder::kRelease);
+		waiters = m_waiters;
+		m_waiters = nullptr;
+	}
+
+	while(waiters)
+	{
+		// Read everything before dispatching because the coroutine might resume and destroy the awaiter immediately
+		EventAwaiter* next = waiters->m_next;
+		std::coroutine_handle<> handle = waiters->m_handle;
+		waiters->m_manager.dispatchTask([handle]([[maybe_unused]] U32 threadId) {
+			handle.resume();
+		});
+		waiters = next;
+	}
+}
+
+CoroutineWaitThread::CoroutineWaitThread(ThreadJobManager& manager, const Char* threadName)
+	: m_manager(manager)
+	, m_thread(threadName)
+{
+	m_thread.start(this, threadCallback);
+}
+
+CoroutineWaitThread::~CoroutineWaitThread()
+{
+	{
+		LockGuard lock(m_mtx);
+		m_quit = true;
+		m_cvar.notifyOne();
+	}
+
+	[[maybe_unused]] const Error err = m_thread.join();
+	ANKI_ASSERT(m_head == nullptr);
+}
+
+void CoroutineWaitThread::submit(std::coroutine_handle<> handle, detail::CoroutineBlockingCall& call)
+{
+	call.m_handle = handle;
+	call.m_next = nullptr;
+
+	LockGuard lock(m_mtx);
+	ANKI_ASSERT(!m_quit);
+	if(m_tail)
+	{
+		m_tail->m_next = &call;
+	}
+	else
+	{
+		m_head = &call;
+	}
+	m_tail = &call;
+	m_cvar.notifyOne();
+}
+
+Error CoroutineWaitThread::threadCallback(ThreadCallbackInfo& info)
+{
+	CoroutineWaitThread& self = *static_cast<CoroutineWaitThread*>(info.m_userData);
+
+	while(true)
+	{
+		detail::CoroutineBlockingCall* call;
+		{
+			LockGuard lock(self.m_mtx);
+			while(self.m_head == nullptr && !self.m_quit)
+			{
+				self.m_cvar.wait(self.m_mtx);
+			}
+
+			if(self.m_head == nullptr)
+			{
+				break;
+			}
+
+			call = self.m_head;
+			self.m_head = call->m_next;
+			if(self.m_head == nullptr)
+			{
+				self.m_tail = nullptr;
+			}
+		}
+
+		call->run();
+
+		// The call lives in the coroutine frame and it's gone as soon as the coroutine continues, read the handle before that
+		const std::coroutine_handle<> handle = call->m_handle;
+		self.m_manager.dispatchTask([handle]([[maybe_unused]] U32 threadId) {
+			handle.resume();
+		});
+	}
+
+	return Error::kNone;
+}
+
+} // end namespace anki
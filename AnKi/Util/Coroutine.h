@@ -0,0 +1,686 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/MemoryPool.h>
+#include <AnKi/Util/File.h>
+#include <coroutine>
+
+namespace anki {
+
+// Forward
+template<typename T>
+class CoroutineTask;
+class CoroutineWaitThread;
+
+/// @addtogroup util_thread
+/// @{
+
+/// Like ANKI_CHECK but for coroutines that return CoroutineTask<Error>.
+#define ANKI_CO_CHECK(x_) \
+	do \
+	{ \
+		const Error retError = x_; \
+		if(retError) \
+		{ \
+			co_return retError; \
+		} \
+	} while(0)
+
+namespace detail {
+
+/// The common part of the promises of all CoroutineTask types.
+class CoroutineTaskPromiseBase
+{
+public:
+	/// The coroutine that awaits the task. It's resumed when the task completes.
+	std::coroutine_handle<> m_continuation;
+
+	/// Resumes the continuation (if any) when the coroutine completes.
+	class FinalAwaiter
+	{
+	public:
+		Bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		template<typename TPromise>
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> handle) noexcept
+		{
+			std::coroutine_handle<> continuation = handle.promise().m_continuation;
+			return (continuation) ? continuation : std::noop_coroutine();
+		}
+
+		void await_resume() noexcept
+		{
+		}
+	};
+
+	/// Tasks are lazy. They start when someone awaits them.
+	std::suspend_always initial_suspend() noexcept
+	{
+		return {};
+	}
+
+	FinalAwaiter final_suspend() noexcept
+	{
+		return {};
+	}
+
+	void unhandled_exception()
+	{
+		ANKI_ASSERT(!"Exceptions are not supported");
+	}
+
+	/// The coroutine frames are allocated from the DefaultMemoryPool.
+	static void* operator new(size_t size)
+	{
+		return DefaultMemoryPool::getSingleton().allocate(size, ANKI_SAFE_ALIGNMENT);
+	}
+
+	static void operator delete(void* ptr)
+	{
+		DefaultMemoryPool::getSingleton().free(ptr);
+	}
+};
+
+template<typename T>
+class CoroutineTaskPromise : public CoroutineTaskPromiseBase
+{
+public:
+	CoroutineTaskPromise()
+	{
+	}
+
+	~CoroutineTaskPromise()
+	{
+		if(m_hasValue)
+		{
+			m_value.~T();
+		}
+	}
+
+	CoroutineTask<T> get_return_object() noexcept;
+
+	template<typename Y>
+	void return_value(Y&& value)
+	{
+		ANKI_ASSERT(!m_hasValue);
+		::new(&m_value) T(std::forward<Y>(value));
+		m_hasValue = true;
+	}
+
+	T&& getValue()
+	{
+		ANKI_ASSERT(m_hasValue);
+		return std::move(m_value);
+	}
+
+private:
+	union
+	{
+		T m_value;
+	};
+
+	Bool m_hasValue = false;
+};
+
+template<>
+class CoroutineTaskPromise<void> : public CoroutineTaskPromiseBase
+{
+public:
+	CoroutineTask<void> get_return_object() noexcept;
+
+	void return_void() noexcept
+	{
+	}
+
+	void getValue()
+	{
+	}
+};
+
+} // end namespace detail
+
+/// A lazy coroutine that returns T. It starts executing when it's awaited with co_await or when syncWait() is called on it and it runs on the
+/// thread that awaits it until it awaits something that switches threads (for example resumeOn()).
+/// @code
+/// CoroutineTask<Error> loadAndUpload(ThreadJobManager& jobs, File& file, ...)
+/// {
+/// 	co_await resumeOn(jobs); // Now running on a worker
+/// 	ANKI_CO_CHECK(co_await readFile(waitThread, file, buff, size));
+/// 	ThreadJobHandle decodeJob = jobs.dispatchTask(...);
+/// 	co_await awaitJob(jobs, decodeJob); // Don't block the worker while decoding
+/// 	co_await awaitFence(waitThread, uploadFence);
+/// 	co_return Error::kNone;
+/// }
+/// @endcode
+template<typename T>
+class CoroutineTask
+{
+	friend class detail::CoroutineTaskPromise<T>;
+
+public:
+	using promise_type = detail::CoroutineTaskPromise<T>;
+
+	CoroutineTask() = default;
+
+	CoroutineTask(const CoroutineTask&) = delete; // Non-copyable
+
+	CoroutineTask(CoroutineTask&& b)
+	{
+		*this = std::move(b);
+	}
+
+	~CoroutineTask()
+	{
+		destroy();
+	}
+
+	CoroutineTask& operator=(const CoroutineTask&) = delete; // Non-copyable
+
+	CoroutineTask& operator=(CoroutineTask&& b)
+	{
+		destroy();
+		m_handle = b.m_handle;
+		b.m_handle = {};
+		return *this;
+	}
+
+	Bool isValid() const
+	{
+		return bool(m_handle);
+	}
+
+	/// Check if the coroutine run to completion.
+	Bool isDone() const
+	{
+		ANKI_ASSERT(m_handle);
+		return m_handle.done();
+	}
+
+	/// Start the task and suspend the awaiting coroutine until it completes. A CoroutineTask can be awaited only once.
+	auto operator co_await() noexcept
+	{
+		class Awaiter
+		{
+		public:
+			std::coroutine_handle<promise_type> m_handle;
+
+			Bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+			{
+				m_handle.promise().m_continuation = awaiting;
+				return m_handle; // Start the task
+			}
+
+			T await_resume()
+			{
+				return m_handle.promise().getValue();
+			}
+		};
+
+		ANKI_ASSERT(m_handle && !m_handle.done());
+		return Awaiter{m_handle};
+	}
+
+	/// @note Don't call it directly. Use syncWait().
+	std::coroutine_handle<promise_type> getHandle() const
+	{
+		return m_handle;
+	}
+
+private:
+	std::coroutine_handle<promise_type> m_handle;
+
+	explicit CoroutineTask(std::coroutine_handle<promise_type> handle)
+		: m_handle(handle)
+	{
+	}
+
+	void destroy()
+	{
+		if(m_handle)
+		{
+			m_handle.destroy();
+			m_handle = {};
+		}
+	}
+};
+
+template<typename T>
+CoroutineTask<T> detail::CoroutineTaskPromise<T>::get_return_object() noexcept
+{
+	return CoroutineTask<T>(std::coroutine_handle<CoroutineTaskPromise<T>>::from_promise(*this));
+}
+
+inline CoroutineTask<void> detail::CoroutineTaskPromise<void>::get_return_object() noexcept
+{
+	return CoroutineTask<void>(std::coroutine_handle<CoroutineTaskPromise<void>>::from_promise(*this));
+}
+
+namespace detail {
+
+/// Used by syncWait() to block until a CoroutineTask completes.
+class SyncWaitEvent
+{
+public:
+	void signal()
+	{
+		LockGuard lock(m_mtx);
+		m_done = true;
+		m_cvar.notifyAll();
+	}
+
+	void wait()
+	{
+		LockGuard lock(m_mtx);
+		while(!m_done)
+		{
+			m_cvar.wait(m_mtx);
+		}
+	}
+
+private:
+	Mutex m_mtx;
+	ConditionVariable m_cvar;
+	Bool m_done = false;
+};
+
+/// A coroutine that awaits a CoroutineTask and signals a SyncWaitEvent when done.
+class SyncWaitTask
+{
+public:
+	class promise_type : public CoroutineTaskPromiseBase
+	{
+	public:
+		SyncWaitEvent* m_event = nullptr;
+
+		class FinalAwaiter
+		{
+		public:
+			Bool await_ready() const noexcept
+			{
+				return false;
+			}
+
+			void await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+			{
+				handle.promise().m_event->signal();
+			}
+
+			void await_resume() noexcept
+			{
+			}
+		};
+
+		SyncWaitTask get_return_object() noexcept
+		{
+			return SyncWaitTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+		}
+
+		FinalAwaiter final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void() noexcept
+		{
+		}
+	};
+
+	std::coroutine_handle<promise_type> m_handle;
+};
+
+/// Starts a CoroutineTask and resumes the awaiting coroutine when it completes. Unlike CoroutineTask's co_await it leaves the result in the promise.
+template<typename TPromise>
+class CoroutineTaskStartAwaiter
+{
+public:
+	std::coroutine_handle<TPromise> m_handle;
+
+	Bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+	{
+		m_handle.promise().m_continuation = awaiting;
+		return m_handle;
+	}
+
+	void await_resume() noexcept
+	{
+	}
+};
+
+template<typename TPromise>
+SyncWaitTask makeSyncWaitTask(std::coroutine_handle<TPromise> handle)
+{
+	co_await CoroutineTaskStartAwaiter<TPromise>{handle};
+}
+
+} // end namespace detail
+
+/// Start a CoroutineTask and block the calling thread until it completes. Don't call it from a thread that the task needs in order to make progress
+/// (for example the only worker of a ThreadJobManager that the task resumes on).
+/// @return The value that the task co_returned.
+template<typename T>
+T syncWait(CoroutineTask<T>& task)
+{
+	ANKI_ASSERT(task.isValid() && !task.isDone());
+
+	detail::SyncWaitEvent event;
+	detail::SyncWaitTask waitTask = detail::makeSyncWaitTask(task.getHandle());
+	waitTask.m_handle.promise().m_event = &event;
+	waitTask.m_handle.resume();
+	event.wait();
+	waitTask.m_handle.destroy();
+
+	return task.getHandle().promise().getValue();
+}
+
+/// @memberof CoroutineTask
+template<typename T>
+T syncWait(CoroutineTask<T>&& task)
+{
+	CoroutineTask<T> t = std::move(task);
+	return syncWait(t);
+}
+
+/// Awaitable that continues the coroutine in a worker of a ThreadJobManager.
+class ResumeOnAwaiter
+{
+public:
+	ResumeOnAwaiter(ThreadJobManager& manager)
+		: m_manager(manager)
+	{
+	}
+
+	Bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle);
+
+	void await_resume() noexcept
+	{
+	}
+
+private:
+	ThreadJobManager& m_manager;
+};
+
+/// co_await it to move the rest of the coroutine to a worker of the ThreadJobManager.
+inline ResumeOnAwaiter resumeOn(ThreadJobManager& manager)
+{
+	return ResumeOnAwaiter(manager);
+}
+
+/// Awaitable that suspends the coroutine until a ThreadJobManager job finishes. The coroutine continues in a worker.
+class JobAwaiter
+{
+public:
+	JobAwaiter(ThreadJobManager& manager, ThreadJobHandle job)
+		: m_manager(manager)
+		, m_job(std::move(job))
+	{
+		ANKI_ASSERT(m_job);
+	}
+
+	Bool await_ready() const noexcept
+	{
+		return m_job->isFinished();
+	}
+
+	void await_suspend(std::coroutine_handle<> handle);
+
+	void await_resume() noexcept
+	{
+	}
+
+private:
+	ThreadJobManager& m_manager;
+	ThreadJobHandle m_job;
+};
+
+/// co_await it to wait for a job without blocking the thread.
+inline JobAwaiter awaitJob(ThreadJobManager& manager, ThreadJobHandle job)
+{
+	return JobAwaiter(manager, std::move(job));
+}
+
+// Forward
+class CoroutineEvent;
+
+/// Awaitable that suspends the coroutine until a CoroutineEvent is signaled. The coroutine continues in a worker.
+class EventAwaiter
+{
+	friend class CoroutineEvent;
+
+public:
+	EventAwaiter(ThreadJobManager& manager, CoroutineEvent& event)
+		: m_manager(manager)
+		, m_event(event)
+	{
+	}
+
+	Bool await_ready() const noexcept;
+
+	Bool await_suspend(std::coroutine_handle<> handle);
+
+	void await_resume() noexcept
+	{
+	}
+
+private:
+	ThreadJobManager& m_manager;
+	CoroutineEvent& m_event;
+	std::coroutine_handle<> m_handle;
+	EventAwaiter* m_next = nullptr; ///< The next awaiter in CoroutineEvent's list. The awaiters live in the suspended coroutine frames.
+};
+
+/// A one-shot event that coroutines can await without blocking a thread. Use it for things that are signaled by the CPU.
+class CoroutineEvent
+{
+	friend class EventAwaiter;
+
+public:
+	CoroutineEvent() = default;
+
+	CoroutineEvent(const CoroutineEvent&) = delete; // Non-copyable
+
+	~CoroutineEvent()
+	{
+		ANKI_ASSERT(m_waiters == nullptr && "Coroutines are still waiting");
+	}
+
+	CoroutineEvent& operator=(const CoroutineEvent&) = delete; // Non-copyable
+
+	/// Dispatch the awaiting coroutines to the workers of their ThreadJobManager. Thread-safe.
+	void signal();
+
+	Bool isSignaled() const
+	{
+		return m_signaled.load(AtomicMemoryOrder::kAcquire);
+	}
+
+private:
+	SpinLock m_mtx;
+	EventAwaiter* m_waiters = nullptr;
+	Atomic<Bool> m_signaled = {false};
+};
+
+inline Bool EventAwaiter::await_ready() const noexcept
+{
+	return m_event.isSignaled();
+}
+
+/// co_await it to wait for an event without blocking the thread.
+inline EventAwaiter awaitEvent(ThreadJobManager& manager, CoroutineEvent& event)
+{
+	return EventAwaiter(manager, event);
+}
+
+namespace detail {
+
+/// A blocking call that CoroutineWaitThread makes for a suspended coroutine.
+class CoroutineBlockingCall
+{
+	friend class anki::CoroutineWaitThread;
+
+public:
+	/// Make the blocking call.
+	virtual void run() = 0;
+
+protected:
+	std::coroutine_handle<> m_handle;
+
+	~CoroutineBlockingCall() = default;
+
+private:
+	CoroutineBlockingCall* m_next = nullptr;
+};
+
+} // end namespace detail
+
+/// A thread that makes the blocking calls of coroutines (fence waits and file reads) so they don't occupy the workers of a ThreadJobManager. The
+/// calls run one after the other in the order they were submitted. When a call returns its coroutine continues in a worker of the
+/// ThreadJobManager.
+class CoroutineWaitThread
+{
+	template<typename>
+	friend class FenceAwaiter;
+	friend class ReadFileAwaiter;
+
+public:
+	CoroutineWaitThread(ThreadJobManager& manager, const Char* threadName = "CoroWait");
+
+	CoroutineWaitThread(const CoroutineWaitThread&) = delete; // Non-copyable
+
+	/// It makes the calls that are still pending before it returns.
+	~CoroutineWaitThread();
+
+	CoroutineWaitThread& operator=(const CoroutineWaitThread&) = delete; // Non-copyable
+
+private:
+	ThreadJobManager& m_manager;
+	Thread m_thread;
+	Mutex m_mtx;
+	ConditionVariable m_cvar;
+	detail::CoroutineBlockingCall* m_head = nullptr; ///< The calls that are pending. Protected by m_mtx.
+	detail::CoroutineBlockingCall* m_tail = nullptr;
+	Bool m_quit = false;
+
+	void submit(std::coroutine_handle<> handle, detail::CoroutineBlockingCall& call);
+
+	static Error threadCallback(ThreadCallbackInfo& info);
+};
+
+/// Awaitable that suspends the coroutine until a fence is signaled. A GPU fence can't wake a coroutine so the CoroutineWaitThread sleeps in the
+/// fence's clientWait() and the coroutine continues in a worker when it returns.
+/// @tparam TFencePtr A pointer to an object that has a Bool clientWait(Second) method (for example FencePtr).
+template<typename TFencePtr>
+class FenceAwaiter : public detail::CoroutineBlockingCall
+{
+public:
+	FenceAwaiter(CoroutineWaitThread& waitThread, TFencePtr fence)
+		: m_waitThread(waitThread)
+		, m_fence(std::move(fence))
+	{
+		ANKI_ASSERT(m_fence);
+	}
+
+	Bool await_ready()
+	{
+		return m_fence->clientWait(0.0);
+	}
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		m_waitThread.submit(handle, *this);
+	}
+
+	/// @return False if the wait timed out.
+	Bool await_resume() noexcept
+	{
+		return m_signaled;
+	}
+
+	void run() override
+	{
+		m_signaled = m_fence->clientWait(kMaxSecond);
+	}
+
+private:
+	CoroutineWaitThread& m_waitThread;
+	TFencePtr m_fence;
+	Bool m_signaled = true;
+};
+
+/// co_await it to wait for a fence without blocking a thread of the ThreadJobManager.
+template<typename TFencePtr>
+FenceAwaiter<TFencePtr> awaitFence(CoroutineWaitThread& waitThread, TFencePtr fence)
+{
+	return FenceAwaiter<TFencePtr>(waitThread, std::move(fence));
+}
+
+/// Awaitable that reads from a file in the CoroutineWaitThread. The coroutine continues in a worker of the ThreadJobManager.
+class ReadFileAwaiter : public detail::CoroutineBlockingCall
+{
+public:
+	ReadFileAwaiter(CoroutineWaitThread& waitThread, File& file, void* buff, PtrSize size)
+		: m_waitThread(waitThread)
+		, m_file(file)
+		, m_buff(buff)
+		, m_size(size)
+	{
+	}
+
+	Bool await_ready() const noexcept
+	{
+		return false;
+	}
+
+	void await_suspend(std::coroutine_handle<> handle)
+	{
+		m_waitThread.submit(handle, *this);
+	}
+
+	Error await_resume() noexcept
+	{
+		return m_err;
+	}
+
+	void run() override
+	{
+		m_err = m_file.read(m_buff, m_size);
+	}
+
+private:
+	CoroutineWaitThread& m_waitThread;
+	File& m_file;
+	void* m_buff;
+	PtrSize m_size;
+	Error m_err = Error::kNone;
+};
+
+/// co_await it to read from a file without blocking a thread of the ThreadJobManager. The result of the co_await is the Error of File::read().
+inline ReadFileAwaiter readFile(CoroutineWaitThread& waitThread, File& file, void* buff, PtrSize size)
+{
+	return ReadFileAwaiter(waitThread, file, buff, size);
+}
+/// @}
+
+} // end namespace anki
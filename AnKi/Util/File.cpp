@@ -7,6 +7,7 @@
 #include <AnKi/Util/Filesystem.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/Assert.h>
+#include <AnKi/Util/MemoryPool.h>
 #include <cstring>
 #include <cstdarg>
 #if ANKI_OS_ANDROID
@@ -15,6 +16,7 @@
 #endif
 #if ANKI_POSIX
 #	include <sys/stat.h>
+#	include <unistd.h>
 #endif
 
 namespace anki {
@@ -34,6 +36,7 @@ File& File::operator=(File&& b)
 		m_file = b.m_file;
 		m_flags = b.m_flags;
 		m_size = b.m_size;
+		m_buffer = b.m_buffer;
 	}
 
 	b.zero();
@@ -209,9 +212,39 @@ void File::close()
 		}
 	}
 
+	if(m_buffer)
+	{
+		// After the fclose() because it flushes the buffer
+		freeAligned(m_buffer);
+	}
+
 	zero();
 }
 
+Error File::setBufferSize(PtrSize size)
+{
+	ANKI_ASSERT(m_file && size > 0);
+	ANKI_ASSERT(m_buffer == nullptr && "Can only be set once");
+
+#if ANKI_OS_ANDROID
+	if(!!(m_flags & FileOpenFlag::kSpecial))
+	{
+		return Error::kNone;
+	}
+#endif
+
+	m_buffer = mallocAligned(size, alignof(U64));
+	if(setvbuf(ANKI_CFILE, static_cast<char*>(m_buffer), _IOFBF, size))
+	{
+		ANKI_UTIL_LOGE("setvbuf() failed");
+		freeAligned(m_buffer);
+		m_buffer = nullptr;
+		return Error::kFunctionFailed;
+	}
+
+	return Error::kNone;
+}
+
 Error File::flush()
 {
 	ANKI_ASSERT(m_file);
@@ -454,6 +487,50 @@ PtrSize File::tell()
 	}
 }
 
+#if ANKI_POSIX
+I32 File::getFileDescriptor() const
+{
+	ANKI_ASSERT(m_file);
+
+#	if ANKI_OS_ANDROID
+	if(!!(m_flags & FileOpenFlag::kSpecial))
+	{
+		return -1;
+	}
+#	endif
+
+	return fileno(ANKI_CFILE);
+}
+
+Error File::readAt(PtrSize offset, void* buff, PtrSize size) const
+{
+	const I32 fd = getFileDescriptor();
+	ANKI_ASSERT(fd >= 0);
+
+	U8* out = static_cast<U8*>(buff);
+	while(size)
+	{
+		const ssize_t readSize = pread(fd, out, size, off_t(offset));
+		if(readSize < 0 && errno == EINTR)
+		{
+			continue;
+		}
+
+		if(readSize <= 0)
+		{
+			ANKI_UTIL_LOGE("pread() failed: %s", (readSize < 0) ? strerror(errno) : "Unexpected end of file");
+			return Error::kFileAccess;
+		}
+
+		out += readSize;
+		offset += PtrSize(readSize);
+		size -= PtrSize(readSize);
+	}
+
+	return Error::kNone;
+}
+#endif
+
 FileOpenFlag File::getMachineEndianness()
 {
 	I32 num = 1;
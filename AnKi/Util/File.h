@@ -82,6 +82,10 @@ public:
 	/// Flush pending operations
 	Error flush();
 
+	/// Replace the buffer of a C file with one of a custom size. The file owns the buffer.
+	/// @note Call it before any other operation on the file.
+	Error setBufferSize(PtrSize size);
+
 	/// Read data from the file
 	Error read(void* buff, PtrSize size);
 
@@ -129,6 +133,14 @@ public:
 	/// Return the position indicator inside the file.
 	PtrSize tell();
 
+#if ANKI_POSIX
+	/// Get the file descriptor of the underlying C file. It's -1 for special files.
+	I32 getFileDescriptor() const;
+
+	/// Read from an offset of the file using the file descriptor. It doesn't touch the position indicator and it's thread-safe.
+	Error readAt(PtrSize offset, void* buff, PtrSize size) const;
+#endif
+
 	/// The the size of the file.
 	PtrSize getSize() const
 	{
@@ -140,6 +152,7 @@ private:
 	void* m_file = nullptr; ///< A native file type
 	FileOpenFlag m_flags = FileOpenFlag::kNone; ///< All the flags. Set on open
 	PtrSize m_size = 0;
+	void* m_buffer = nullptr; ///< Set by setBufferSize().
 
 	/// Get the current machine's endianness
 	static FileOpenFlag getMachineEndianness();
@@ -157,6 +170,7 @@ private:
 		m_file = nullptr;
 		m_flags = FileOpenFlag::kNone;
 		m_size = 0;
+		m_buffer = nullptr;
 	}
 };
 /// @}
@@ -25,6 +25,12 @@ class BitMask;
 template<typename, typename, typename, typename, typename>
 class HashMap;
 
+template<typename, typename, typename, typename>
+class ConcurrentHashMap;
+
+template<typename, typename, typename, typename>
+class SwissHashMap;
+
 template<typename TKey>
 class DefaultHasher;
 
@@ -71,6 +77,9 @@ class ConstWeakArray;
 template<typename T, typename TMemoryPool, typename TSize>
 class DynamicArray;
 
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+class SmallDynamicArray;
+
 class F16;
 
 template<typename TMemoryPool>
@@ -85,8 +94,14 @@ class XmlDocument;
 	using submoduleName##DynamicArray = DynamicArray<T, submoduleName##MemPoolWrapper, TSize>; \
 	template<typename T, typename TSize = PtrSize> \
 	using submoduleName##DynamicArrayLarge = DynamicArray<T, submoduleName##MemPoolWrapper, TSize>; \
+	template<typename T, U32 kInlineCount, typename TSize = U32> \
+	using submoduleName##SmallDynamicArray = SmallDynamicArray<T, kInlineCount, submoduleName##MemPoolWrapper, TSize>; \
 	template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>> \
 	using submoduleName##HashMap = HashMap<TKey, TValue, THasher, submoduleName##MemPoolWrapper, HashMapSparseArrayConfig>; \
+	template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>> \
+	using submoduleName##SwissHashMap = SwissHashMap<TKey, TValue, THasher, submoduleName##MemPoolWrapper>; \
+	template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>> \
+	using submoduleName##ConcurrentHashMap = ConcurrentHashMap<TKey, TValue, THasher, submoduleName##MemPoolWrapper>; \
 	template<typename T> \
 	using submoduleName##List = List<T, submoduleName##MemPoolWrapper>; \
 	using submoduleName##StringList = BaseStringList<submoduleName##MemPoolWrapper>; \
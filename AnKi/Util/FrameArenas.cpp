@@ -0,0 +1,85 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/FrameArenas.h>
+#include <AnKi/Util/Functions.h>
+#include <AnKi/Util/Logger.h>
+
+namespace anki {
+
+void FrameArenas::init(AllocAlignedCallback allocCb, void* allocCbUserData, U32 threadCount, PtrSize initialChunkSize, const Char* name)
+{
+	ANKI_ASSERT(allocCb && threadCount > 0 && initialChunkSize > 0);
+	ANKI_ASSERT(m_arenas == nullptr && "Already initialized");
+
+	m_allocCb = allocCb;
+	m_allocCbUserData = allocCbUserData;
+	m_threadCount = threadCount;
+
+	m_arenas = static_cast<Arena*>(allocCb(allocCbUserData, nullptr, sizeof(Arena) * threadCount, alignof(Arena)));
+	if(!m_arenas) [[unlikely]]
+	{
+		ANKI_UTIL_LOGF("Out of memory");
+	}
+
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		callConstructor(m_arenas[i]);
+		m_arenas[i].m_pool.init(allocCb, allocCbUserData, initialChunkSize, 2.0, 0, true, ANKI_SAFE_ALIGNMENT, name);
+	}
+}
+
+void FrameArenas::destroy()
+{
+	if(m_arenas)
+	{
+		for(U32 i = 0; i < m_threadCount; ++i)
+		{
+			callDestructor(m_arenas[i]);
+		}
+
+		m_allocCb(m_allocCbUserData, m_arenas, 0, 0);
+		m_arenas = nullptr;
+	}
+
+	m_allocCb = nullptr;
+	m_allocCbUserData = nullptr;
+	m_threadCount = 0;
+}
+
+void FrameArenas::resetArena(Arena& arena)
+{
+	// The arena has memory of an older frame. Remember how much it used and rewind it
+	arena.m_highWaterMark = max(arena.m_highWaterMark, arena.m_pool.getMemoryUsage());
+	arena.m_pool.reset();
+	arena.m_frame = m_frame;
+}
+
+PtrSize FrameArenas::getMemoryUsage() const
+{
+	PtrSize usage = 0;
+	for(U32 i = 0; i < m_threadCount; ++i)
+	{
+		if(m_arenas[i].m_frame == m_frame)
+		{
+			usage += m_arenas[i].m_pool.getMemoryUsage();
+		}
+	}
+
+	return usage;
+}
+
+PtrSize FrameArenas::getMemoryCapacity() const
+{
+	PtrSize capacity = 0;
+	for(U32 i = 0; i < m_threadCount; ++i)
+	{
+		capacity += m_arenas[i].m_pool.getMemoryCapacity();
+	}
+
+	return capacity;
+}
+
+} // end namespace anki
@@ -0,0 +1,106 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/MemoryPool.h>
+
+namespace anki {
+
+/// @addtogroup util_memory
+/// @{
+
+/// A set of StackMemoryPools, one for every thread, that hold memory that lives for a single frame. Threads that allocate per-frame memory in
+/// parallel use their own arena so they don't contend on the atomic offset and the chunk list of a shared StackMemoryPool.
+/// newFrame() is O(1). Every arena is reset the first time its thread asks for it in the new frame.
+class FrameArenas
+{
+public:
+	FrameArenas() = default;
+
+	FrameArenas(const FrameArenas&) = delete; // Non-copyable
+
+	~FrameArenas()
+	{
+		destroy();
+	}
+
+	FrameArenas& operator=(const FrameArenas&) = delete; // Non-copyable
+
+	/// Init.
+	/// @param allocCb The allocation function callback.
+	/// @param allocCbUserData The user data to pass to the allocation function.
+	/// @param threadCount The number of arenas. Threads will index them with their thread ID.
+	/// @param initialChunkSize The size of the first chunk of every arena.
+	/// @param name An optional name.
+	void init(AllocAlignedCallback allocCb, void* allocCbUserData, U32 threadCount, PtrSize initialChunkSize, const Char* name = nullptr);
+
+	/// Manual destroy. The destructor calls that as well.
+	void destroy();
+
+	/// Start a new frame. All memory allocated from the arenas in the previous frame is invalidated.
+	/// @note It's not thread safe with other methods.
+	void newFrame()
+	{
+		++m_frame;
+	}
+
+	/// Get the arena of a thread. Only that thread should be using it until the next newFrame().
+	/// @note It's thread safe as long as every thread asks for its own arena.
+	StackMemoryPool& getArena(U32 threadId)
+	{
+		Arena& arena = m_arenas[threadId];
+		if(arena.m_frame != m_frame) [[unlikely]]
+		{
+			resetArena(arena);
+		}
+
+		return arena.m_pool;
+	}
+
+	U32 getThreadCount() const
+	{
+		return m_threadCount;
+	}
+
+	/// Get the max memory a thread allocated in a single frame.
+	/// @note It's not thread safe with the allocations of that thread.
+	PtrSize getHighWaterMark(U32 threadId) const
+	{
+		ANKI_ASSERT(threadId < m_threadCount);
+		// The pool keeps the usage of the last frame it was used in until the next reset so count it even if it's an older frame
+		const Arena& arena = m_arenas[threadId];
+		return max(arena.m_highWaterMark, arena.m_pool.getMemoryUsage());
+	}
+
+	/// Get the memory all threads allocated in the current frame.
+	/// @note It's not thread safe with allocations.
+	PtrSize getMemoryUsage() const;
+
+	/// Get the physical memory allocated by all arenas.
+	/// @note It's not thread safe with allocations.
+	PtrSize getMemoryCapacity() const;
+
+private:
+	/// Every arena lives in its own cache line so threads don't write to each other's lines.
+	class alignas(ANKI_CACHE_LINE_SIZE) Arena
+	{
+	public:
+		StackMemoryPool m_pool;
+		U64 m_frame = 0;
+		PtrSize m_highWaterMark = 0;
+	};
+
+	AllocAlignedCallback m_allocCb = nullptr;
+	void* m_allocCbUserData = nullptr;
+	Arena* m_arenas = nullptr;
+	U32 m_threadCount = 0;
+	U64 m_frame = 1;
+
+	void resetArena(Arena& arena);
+};
+/// @}
+
+} // end namespace anki
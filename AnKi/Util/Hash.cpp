@@ -5,62 +5,306 @@
 
 #include <AnKi/Util/Hash.h>
 #include <AnKi/Util/Assert.h>
+#if ANKI_SIMD_SSE
+#	include <immintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+#if ANKI_COMPILER_MSVC
+#	include <intrin.h>
+#endif
 
 namespace anki {
 
-constexpr U64 kHashM = 0xc6a4a7935bd1e995;
-constexpr U64 kHashR = 47;
+// The long input path is the accumulate/scramble/merge of XXH3 by Yann Collet and the short input path is the mixer of wyhash by Wang Yi.
+// The constants are different so the hashes are not compatible with either.
 
-U64 appendHash(const void* buffer, PtrSize bufferSize, U64 h)
+constexpr U32 kStripeSize = StreamingHasher::kStripeSize;
+constexpr U32 kStripesPerBlock = 16;
+constexpr U64 kPrime32 = 0x9E3779B1;
+constexpr U64 kPrime64 = 0x9E3779B185EBCA87;
+constexpr U64 kWyP0 = 0xa0761d6478bd642f;
+constexpr U64 kWyP1 = 0xe7037ed1a0b428db;
+
+/// The hex digits of pi.
+alignas(64) constexpr U64 kSecret[16] = {0x243F6A8885A308D3, 0x13198A2E03707344, 0xA4093822299F31D0, 0x082EFA98EC4E6C89,
+										 0x452821E638D01377, 0xBE5466CF34E90C6C, 0xC0AC29B7C97C50DD, 0x3F84D5B5B5470917,
+										 0x9216D5D98979FB1B, 0xD1310BA698DFB5AC, 0x2FFD72DBD01ADFB7, 0xB8E1AFED6A267E96,
+										 0xBA7C9045F12C7F99, 0x24A19947B3916CF7, 0x0801F2E2858EFC16, 0x636920D871574E69};
+
+static ANKI_FORCE_INLINE U64 read64(const U8* p)
+{
+	U64 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+static ANKI_FORCE_INLINE U64 read32(const U8* p)
+{
+	U32 v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+/// 64x64 to 128 multiplication. The low part goes to a and the high to b.
+static ANKI_FORCE_INLINE void multiply128(U64& a, U64& b)
+{
+#if ANKI_COMPILER_MSVC && defined(_M_ARM64)
+	const U64 lo = a * b;
+	b = __umulh(a, b);
+	a = lo;
+#elif ANKI_COMPILER_MSVC
+	a = _umul128(a, b, &b);
+#else
+	const __uint128_t r = __uint128_t(a) * b;
+	a = U64(r);
+	b = U64(r >> 64);
+#endif
+}
+
+static ANKI_FORCE_INLINE U64 mix(U64 a, U64 b)
 {
-	const U64* data = static_cast<const U64*>(buffer);
-	const U64* const end = data + (bufferSize / sizeof(U64));
+	multiply128(a, b);
+	return a ^ b;
+}
+
+/// Hash less than kStripeSize bytes.
+static ANKI_FORCE_INLINE U64 hashSmall(const U8* p, PtrSize size, U64 seed)
+{
+	ANKI_ASSERT(size < kStripeSize);
+
+	U64 a, b;
+	if(size <= 16) [[likely]]
+	{
+		// The reads might overlap. The size is mixed in the end so that's fine
+		if(size >= 8)
+		{
+			a = read64(p);
+			b = read64(p + size - 8);
+		}
+		else if(size >= 4)
+		{
+			a = read32(p);
+			b = read32(p + size - 4);
+		}
+		else if(size > 0)
+		{
+			a = (U64(p[0]) << 16) | (U64(p[size >> 1]) << 8) | U64(p[size - 1]);
+			b = 0;
+		}
+		else
+		{
+			a = b = 0;
+		}
+	}
+	else
+	{
+		PtrSize i = size;
+		while(i > 16)
+		{
+			seed = mix(read64(p) ^ kWyP1, read64(p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+
+		// The last 16 bytes. They might overlap with the previous ones
+		a = read64(p + i - 16);
+		b = read64(p + i - 8);
+	}
+
+	a ^= kWyP1;
+	b ^= seed ^ kWyP0;
+	multiply128(a, b);
+	return mix(a ^ kWyP0 ^ size, b ^ kWyP1);
+}
 
-	while(data != end)
+static void initAccumulators(U64* acc, U64 seed)
+{
+	constexpr Array<U64, 8> kInit = {0xC2B2AE3D, 0x9E3779B185EBCA87, 0xC2B2AE3D27D4EB4F, 0x165667B19E3779F9,
+									 0x85EBCA77C2B2AE63, 0x85EBCA77,         0x27D4EB2F165667C5, 0x9E3779B1};
+	for(U32 i = 0; i < 8; ++i)
 	{
-		U64 k = *data++;
+		acc[i] = kInit[i] ^ seed;
+	}
+}
 
-		k *= kHashM;
-		k ^= k >> kHashR;
-		k *= kHashM;
+/// For every 64bit lane: acc[i ^ 1] += data[i] and acc[i] += lo32(data[i] ^ secret[i]) * hi32(data[i] ^ secret[i]).
+static ANKI_FORCE_INLINE void accumulateStripe(U64* ANKI_RESTRICT acc, const U8* ANKI_RESTRICT data)
+{
+#if ANKI_SIMD_SSE && defined(__AVX2__)
+	for(U32 i = 0; i < 2; ++i)
+	{
+		const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data) + i);
+		const __m256i dk = _mm256_xor_si256(d, _mm256_load_si256(reinterpret_cast<const __m256i*>(kSecret) + i));
+		const __m256i product = _mm256_mul_epu32(dk, _mm256_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1)));
+		const __m256i dswap = _mm256_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+		__m256i* a = reinterpret_cast<__m256i*>(acc) + i;
+		_mm256_storeu_si256(a, _mm256_add_epi64(_mm256_add_epi64(_mm256_loadu_si256(a), dswap), product));
+	}
+#elif ANKI_SIMD_SSE
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data) + i);
+		const __m128i dk = _mm_xor_si128(d, _mm_load_si128(reinterpret_cast<const __m128i*>(kSecret) + i));
+		const __m128i product = _mm_mul_epu32(dk, _mm_shuffle_epi32(dk, _MM_SHUFFLE(0, 3, 0, 1)));
+		const __m128i dswap = _mm_shuffle_epi32(d, _MM_SHUFFLE(1, 0, 3, 2));
+		__m128i* a = reinterpret_cast<__m128i*>(acc) + i;
+		_mm_storeu_si128(a, _mm_add_epi64(_mm_add_epi64(_mm_loadu_si128(a), dswap), product));
+	}
+#elif ANKI_SIMD_NEON
+	for(U32 i = 0; i < 4; ++i)
+	{
+		const uint64x2_t d = vreinterpretq_u64_u8(vld1q_u8(data + i * 16));
+		const uint64x2_t dk = veorq_u64(d, vld1q_u64(&kSecret[i * 2]));
+		uint64x2_t a = vaddq_u64(vld1q_u64(acc + i * 2), vextq_u64(d, d, 1));
+		a = vmlal_u32(a, vmovn_u64(dk), vshrn_n_u64(dk, 32));
+		vst1q_u64(acc + i * 2, a);
+	}
+#else
+	for(U32 i = 0; i < 8; ++i)
+	{
+		const U64 d = read64(data + i * 8);
+		const U64 dk = d ^ kSecret[i];
+		acc[i ^ 1] += d;
+		acc[i] += (dk & kMaxU32) * (dk >> 32);
+	}
+#endif
+}
 
-		h ^= k;
-		h *= kHashM;
+/// Called once every kStripesPerBlock stripes so the high bits of the accumulators get back into the multiplications.
+static void scrambleAccumulators(U64* acc)
+{
+	for(U32 i = 0; i < 8; ++i)
+	{
+		U64 a = acc[i];
+		a ^= a >> 47;
+		a ^= kSecret[i + 8];
+		acc[i] = a * kPrime32;
 	}
+}
 
-	const U8* data2 = reinterpret_cast<const U8*>(data);
+/// Hash the remaining bytes and merge the accumulators.
+static U64 finalizeLong(U64* acc, const U8* tail, U32 tailSize, U64 totalSize, U64 seed)
+{
+	ANKI_ASSERT(tailSize < kStripeSize);
 
-	switch(bufferSize & (sizeof(U64) - 1))
+	if(tailSize)
 	{
-	case 7:
-		h ^= U64(data2[6]) << 48;
-	case 6:
-		h ^= U64(data2[5]) << 40;
-	case 5:
-		h ^= U64(data2[4]) << 32;
-	case 4:
-		h ^= U64(data2[3]) << 24;
-	case 3:
-		h ^= U64(data2[2]) << 16;
-	case 2:
-		h ^= U64(data2[1]) << 8;
-	case 1:
-		h ^= U64(data2[0]);
-		h *= kHashM;
-	};
+		alignas(16) Array<U8, kStripeSize> lastStripe = {};
+		memcpy(&lastStripe[0], tail, tailSize);
+		accumulateStripe(acc, &lastStripe[0]);
+	}
 
-	h ^= h >> kHashR;
-	h *= kHashM;
-	h ^= h >> kHashR;
+	U64 h = (totalSize * kPrime64) ^ seed;
+	for(U32 i = 0; i < 8; i += 2)
+	{
+		h += mix(acc[i] ^ kSecret[i + 8], acc[i + 1] ^ kSecret[i + 9]);
+	}
 
-	ANKI_ASSERT(h != 0);
+	h ^= h >> 37;
+	h *= 0x165667919E3779F9;
+	h ^= h >> 32;
 	return h;
 }
 
+/// Not inlined so that computeHash stays lean for small inputs.
+ANKI_DONT_INLINE static U64 hashLong(const U8* p, PtrSize size, U64 seed)
+{
+	alignas(32) Array<U64, 8> acc;
+	initAccumulators(&acc[0], seed);
+
+	const PtrSize stripeCount = size / kStripeSize;
+	PtrSize stripe = 0;
+
+	// Full blocks
+	for(; stripe + kStripesPerBlock <= stripeCount; stripe += kStripesPerBlock)
+	{
+		for(U32 i = 0; i < kStripesPerBlock; ++i)
+		{
+			accumulateStripe(&acc[0], p + (stripe + i) * kStripeSize);
+		}
+		scrambleAccumulators(&acc[0]);
+	}
+
+	// The stripes of the last block
+	for(; stripe < stripeCount; ++stripe)
+	{
+		accumulateStripe(&acc[0], p + stripe * kStripeSize);
+	}
+
+	return finalizeLong(&acc[0], p + stripeCount * kStripeSize, U32(size % kStripeSize), size, seed);
+}
+
 U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed)
 {
-	const U64 h = seed ^ (bufferSize * kHashM);
-	return appendHash(buffer, bufferSize, h);
+	ANKI_ASSERT(buffer || bufferSize == 0);
+	const U8* p = static_cast<const U8*>(buffer);
+	const U64 h = (bufferSize < kStripeSize) ? hashSmall(p, bufferSize, seed) : hashLong(p, bufferSize, seed);
+
+	ANKI_ASSERT(h != 0);
+	return h;
+}
+
+U64 appendHash(const void* buffer, PtrSize bufferSize, U64 prevHash)
+{
+	return computeHash(buffer, bufferSize, prevHash);
+}
+
+void StreamingHasher::hashStripe(const U8* stripe)
+{
+	if(m_hashedSize == 0)
+	{
+		initAccumulators(&m_accumulators[0], m_seed);
+	}
+
+	accumulateStripe(&m_accumulators[0], stripe);
+	m_hashedSize += kStripeSize;
+
+	if((m_hashedSize / kStripeSize) % kStripesPerBlock == 0)
+	{
+		scrambleAccumulators(&m_accumulators[0]);
+	}
+}
+
+void StreamingHasher::appendLarge(const void* buffer, PtrSize bufferSize)
+{
+	const U8* p = static_cast<const U8*>(buffer);
+	ANKI_ASSERT(m_stripeSize + bufferSize >= kStripeSize);
+
+	// Complete the pending stripe
+	const U32 fill = kStripeSize - m_stripeSize;
+	memcpy(&m_stripe[m_stripeSize], p, fill);
+	hashStripe(&m_stripe[0]);
+	p += fill;
+	bufferSize -= fill;
+
+	// Hash the full stripes in place
+	while(bufferSize >= kStripeSize)
+	{
+		hashStripe(p);
+		p += kStripeSize;
+		bufferSize -= kStripeSize;
+	}
+
+	memcpy(&m_stripe[0], p, bufferSize);
+	m_stripeSize = U32(bufferSize);
+}
+
+U64 StreamingHasher::getHash() const
+{
+	U64 h;
+	if(m_hashedSize == 0)
+	{
+		h = hashSmall(&m_stripe[0], m_stripeSize, m_seed);
+	}
+	else
+	{
+		alignas(32) Array<U64, 8> acc = m_accumulators;
+		h = finalizeLong(&acc[0], &m_stripe[0], m_stripeSize, m_hashedSize + m_stripeSize, m_seed);
+	}
+
+	ANKI_ASSERT(h != 0);
+	return h;
 }
 
 } // end namespace anki
@@ -5,21 +5,22 @@
 
 #pragma once
 
-#include <AnKi/Util/StdTypes.h>
+#include <AnKi/Util/Array.h>
 
 namespace anki {
 
 /// @addtogroup util_other
 /// @{
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// Computes a hash of a buffer. Small buffers are hashed with a wyhash-style mixer (one 128bit multiply per 16 bytes). Buffers larger than
+/// 64 bytes go through an xxh3-style loop that keeps 8 lanes of accumulators and it's vectorized with SSE2/AVX2/NEON.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param seed A unique seed.
 /// @return The hash.
 [[nodiscard]] ANKI_PURE U64 computeHash(const void* buffer, PtrSize bufferSize, U64 seed = 123);
 
-/// Computes a hash of a buffer. This function implements the MurmurHash2 algorithm by Austin Appleby.
+/// Computes a hash of a buffer using a previous hash as seed. See computeHash. To hash many small fields prefer StreamingHasher.
 /// @param[in] buffer The buffer to hash.
 /// @param bufferSize The size of the buffer.
 /// @param prevHash The hash to append to.
@@ -39,6 +40,53 @@ template<typename T>
 {
 	return appendHash(&obj, sizeof(obj), prevHash);
 }
+
+/// Computes a hash incrementally. The result is the same as calling computeHash on the concatenation of all the appended buffers. Small
+/// appends are just a memcpy into an internal buffer that gets hashed when it fills up.
+class StreamingHasher
+{
+public:
+	static constexpr U32 kStripeSize = 64;
+
+	explicit StreamingHasher(U64 seed = 123)
+		: m_seed(seed)
+	{
+	}
+
+	void append(const void* buffer, PtrSize bufferSize)
+	{
+		ANKI_ASSERT(buffer || bufferSize == 0);
+		if(m_stripeSize + bufferSize < kStripeSize) [[likely]]
+		{
+			memcpy(&m_stripe[m_stripeSize], buffer, bufferSize);
+			m_stripeSize += U32(bufferSize);
+		}
+		else
+		{
+			appendLarge(buffer, bufferSize);
+		}
+	}
+
+	template<typename T>
+	void appendObject(const T& obj)
+	{
+		append(&obj, sizeof(obj));
+	}
+
+	/// Get the hash of everything that was appended so far. Appending can continue after that.
+	[[nodiscard]] U64 getHash() const;
+
+private:
+	Array<U64, 8> m_accumulators;
+	Array<U8, kStripeSize> m_stripe;
+	U64 m_seed;
+	U64 m_hashedSize = 0; ///< The size of all the stripes that got hashed.
+	U32 m_stripeSize = 0;
+
+	void appendLarge(const void* buffer, PtrSize bufferSize);
+
+	void hashStripe(const U8* stripe);
+};
 /// @}
 
 } // end namespace anki
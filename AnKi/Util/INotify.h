@@ -12,6 +12,24 @@ namespace anki {
 /// @addtogroup util_file
 /// @{
 
+/// What happened to a file or a directory that INotify watches.
+enum class INotifyEventType : U8
+{
+	kModified,
+	kCreated, ///< Created or moved inside the watched path.
+	kDeleted, ///< Deleted or moved out of the watched path.
+	kOverflow ///< Events were lost or the watched path itself was replaced. Everything needs to be checked again.
+};
+
+/// @memberof INotify
+class INotifyEvent
+{
+public:
+	String m_path; ///< Relative to the watched path. It's empty if the event is about the watched path itself.
+	INotifyEventType m_type = INotifyEventType::kModified;
+	Bool m_isDirectory = false;
+};
+
 /// A wrapper on top of inotify. Check for filesystem updates.
 class INotify
 {
@@ -30,24 +48,52 @@ public:
 	INotify& operator=(const INotify&) = delete;
 
 	/// @param path Path to file or directory.
-	Error init(CString path)
+	/// @param recursive If the path is a directory watch all its subdirectories as well.
+	Error init(CString path, Bool recursive = false)
 	{
 		m_path = path;
+		m_recursive = recursive;
 		return initInternal();
 	}
 
-	/// Check if the file was modified in any way.
-	Error pollEvents(Bool& modified);
+	/// Check if the file was modified in any way. In recursive mode it also checks the files of the subdirectories.
+	Error pollEvents(Bool& modified)
+	{
+		DynamicArray<INotifyEvent> events;
+		const Error err = pollEvents(events);
+		modified = !events.isEmpty();
+		return err;
+	}
+
+	/// Get what changed since the last call, in the order it happened. In recursive mode it also checks the files of the subdirectories.
+	Error pollEvents(DynamicArray<INotifyEvent>& events);
 
 private:
 	String m_path;
 #if ANKI_POSIX
+	class Watch
+	{
+	public:
+		String m_path; ///< Relative to m_path.
+		int m_descriptor = -1;
+	};
+
 	int m_fd = -1;
-	int m_watch = -1;
+	DynamicArray<Watch> m_watches; ///< The 1st is the watch of m_path.
 #endif
+	Bool m_recursive = false;
 
 	void destroyInternal();
 	Error initInternal();
+
+#if ANKI_POSIX
+	/// Watch a directory. In recursive mode its subdirectories as well.
+	/// @param relativePath Relative to m_path. Empty for m_path itself.
+	Error addWatches(CString relativePath);
+
+	/// Stop watching a directory and its subdirectories.
+	void removeWatches(CString relativePath);
+#endif
 };
 /// @}
 
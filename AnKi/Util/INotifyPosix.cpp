@@ -5,6 +5,7 @@
 
 #include <AnKi/Util/INotify.h>
 #include <AnKi/Util/Logger.h>
+#include <AnKi/Util/Filesystem.h>
 #include <sys/inotify.h>
 #include <poll.h>
 #include <unistd.h>
@@ -13,7 +14,7 @@ namespace anki {
 
 Error INotify::initInternal()
 {
-	ANKI_ASSERT(m_fd < 0 && m_watch < 0);
+	ANKI_ASSERT(m_fd < 0 && m_watches.getSize() == 0);
 
 	Error err = Error::kNone;
 
@@ -26,12 +27,7 @@ Error INotify::initInternal()
 
 	if(!err)
 	{
-		m_watch = inotify_add_watch(m_fd, &m_path[0], IN_MODIFY | IN_CREATE | IN_DELETE | IN_IGNORED | IN_DELETE_SELF);
-		if(m_watch < 0)
-		{
-			ANKI_UTIL_LOGE("inotify_add_watch() failed: %s", strerror(errno));
-			err = Error::kFunctionFailed;
-		}
+		err = addWatches("");
 	}
 
 	if(err)
@@ -44,33 +40,127 @@ Error INotify::initInternal()
 
 void INotify::destroyInternal()
 {
-	if(m_watch >= 0)
+	// Closing the descriptor removes all the watches. Some of them might already be removed implicitly
+	if(m_fd >= 0)
 	{
-		int err = inotify_rm_watch(m_fd, m_watch);
+		int err = close(m_fd);
 		if(err < 0)
 		{
-			ANKI_UTIL_LOGE("inotify_rm_watch() failed: %s\n", strerror(errno));
+			ANKI_UTIL_LOGE("close() failed: %s\n", strerror(errno));
 		}
-		m_watch = -1;
+		m_fd = -1;
 	}
 
-	if(m_fd >= 0)
+	m_watches.destroy();
+}
+
+Error INotify::addWatches(CString relativePath)
+{
+	String fullPath;
+	if(relativePath.isEmpty())
 	{
-		int err = close(m_fd);
-		if(err < 0)
+		fullPath = m_path;
+	}
+	else
+	{
+		fullPath.sprintf("%s/%s", m_path.cstr(), relativePath.cstr());
+	}
+
+	auto addWatch = [this](CString path, CString relativePath) -> Error {
+		const int descriptor = inotify_add_watch(m_fd, path.cstr(), IN_MODIFY | IN_CREATE | IN_DELETE | IN_MOVE | IN_IGNORED | IN_DELETE_SELF);
+		if(descriptor < 0)
 		{
-			ANKI_UTIL_LOGE("close() failed: %s\n", strerror(errno));
+			ANKI_UTIL_LOGE("inotify_add_watch() failed: %s: %s", path.cstr(), strerror(errno));
+			return Error::kFunctionFailed;
+		}
+
+		// The same directory gives the same descriptor. It happens if it's renamed
+		for(Watch& watch : m_watches)
+		{
+			if(watch.m_descriptor == descriptor)
+			{
+				watch.m_path = relativePath;
+				return Error::kNone;
+			}
+		}
+
+		Watch& watch = *m_watches.emplaceBack();
+		watch.m_path = relativePath;
+		watch.m_descriptor = descriptor;
+		return Error::kNone;
+	};
+
+	ANKI_CHECK(addWatch(fullPath, relativePath));
+
+	if(m_recursive && directoryExists(fullPath))
+	{
+		// One inotify instance can have many watches, add one for every subdirectory
+		ANKI_CHECK(walkDirectoryTree(fullPath, [&](CString fname, Bool isDir) -> Error {
+			if(isDir)
+			{
+				String subdir;
+				subdir.sprintf("%s/%s", fullPath.cstr(), fname.cstr());
+				String relativeSubdir;
+				if(relativePath.isEmpty())
+				{
+					relativeSubdir = fname;
+				}
+				else
+				{
+					relativeSubdir.sprintf("%s/%s", relativePath.cstr(), fname.cstr());
+				}
+
+				ANKI_CHECK(addWatch(subdir, relativeSubdir));
+			}
+
+			return Error::kNone;
+		}));
+	}
+
+	return Error::kNone;
+}
+
+void INotify::removeWatches(CString relativePath)
+{
+	String prefix;
+	prefix.sprintf("%s/", relativePath.cstr());
+
+	// Never remove the 1st, it's m_path
+	for(U32 i = m_watches.getSize() - 1; i > 0; --i)
+	{
+		if(m_watches[i].m_path == relativePath || m_watches[i].m_path.find(prefix) == 0)
+		{
+			// It might be gone already. The IN_IGNORED that follows will be skipped
+			inotify_rm_watch(m_fd, m_watches[i].m_descriptor);
+
+			if(i != m_watches.getSize() - 1)
+			{
+				m_watches[i] = std::move(m_watches.getBack());
+			}
+			m_watches.popBack();
 		}
-		m_fd = -1;
 	}
 }
 
-Error INotify::pollEvents(Bool& modified)
+Error INotify::pollEvents(DynamicArray<INotifyEvent>& events)
 {
-	ANKI_ASSERT(m_fd >= 0 && m_watch >= 0);
+	ANKI_ASSERT(m_fd >= 0 && m_watches.getSize() > 0);
 
 	Error err = Error::kNone;
-	modified = false;
+	events.destroy();
+	Bool reinit = false;
+
+	auto findWatch = [this](int descriptor) -> U32 {
+		for(U32 i = 0; i < m_watches.getSize(); ++i)
+		{
+			if(m_watches[i].m_descriptor == descriptor)
+			{
+				return i;
+			}
+		}
+
+		return kMaxU32;
+	};
 
 	while(true)
 	{
@@ -90,41 +180,107 @@ Error INotify::pollEvents(Bool& modified)
 		}
 		else
 		{
-			// Process the new event
+			// Process the new events. A read might return many of them
+			alignas(inotify_event) Array<U8, 2_KB> readBuff;
+			const ssize_t nbytes = read(m_fd, &readBuff[0], sizeof(readBuff));
+			if(nbytes <= 0)
+			{
+				ANKI_UTIL_LOGE("read() failed to read the expected size of data: %s", strerror(errno));
+				err = Error::kFunctionFailed;
+				break;
+			}
 
-			Array<U8, 2_KB> readBuff;
-			PtrSize nbytes = read(m_fd, &readBuff[0], sizeof(readBuff));
-			if(nbytes > 0)
+			for(PtrSize offset = 0; offset < PtrSize(nbytes);)
 			{
-				inotify_event* event = reinterpret_cast<inotify_event*>(&readBuff[0]);
+				const inotify_event* event = reinterpret_cast<const inotify_event*>(&readBuff[offset]);
+				offset += sizeof(inotify_event) + event->len;
+
+				if(event->mask & IN_Q_OVERFLOW)
+				{
+					events.emplaceBack()->m_type = INotifyEventType::kOverflow;
+					continue;
+				}
 
-				if(event->mask & IN_IGNORED)
+				const U32 watchIdx = findWatch(event->wd);
+				if(watchIdx == kMaxU32)
 				{
-					// File was moved or deleted. Some editors on save they delete the file and move another file to
-					// its place. In that case the m_fd and the m_watch need to be re-created.
+					// Removed by removeWatches()
+					continue;
+				}
 
-					m_watch = -1; // Watch descriptor was removed implicitly
-					destroyInternal();
-					err = initInternal();
-					if(err)
+				if(event->mask & (IN_IGNORED | IN_DELETE_SELF))
+				{
+					if(watchIdx == 0)
+					{
+						// File was moved or deleted. Some editors on save they delete the file and move another file to
+						// its place. In that case the m_fd and the m_watches need to be re-created.
+						reinit = reinit || !!(event->mask & IN_IGNORED);
+					}
+					else if(event->mask & IN_IGNORED)
 					{
-						break;
+						// A subdirectory was removed. Its parent reported it already
+						if(watchIdx != m_watches.getSize() - 1)
+						{
+							m_watches[watchIdx] = std::move(m_watches.getBack());
+						}
+						m_watches.popBack();
 					}
+
+					continue;
+				}
+
+				INotifyEvent& out = *events.emplaceBack();
+				const String& watchPath = m_watches[watchIdx].m_path;
+				if(event->len == 0)
+				{
+					out.m_path = watchPath;
+				}
+				else if(watchPath.isEmpty())
+				{
+					out.m_path = &event->name[0];
 				}
 				else
 				{
-					modified = true;
+					out.m_path.sprintf("%s/%s", watchPath.cstr(), &event->name[0]);
+				}
+
+				out.m_isDirectory = !!(event->mask & IN_ISDIR);
+				if(event->mask & IN_MODIFY)
+				{
+					out.m_type = INotifyEventType::kModified;
+				}
+				else if(event->mask & (IN_CREATE | IN_MOVED_TO))
+				{
+					out.m_type = INotifyEventType::kCreated;
+				}
+				else
+				{
+					out.m_type = INotifyEventType::kDeleted;
+				}
+
+				// Keep watching the subdirectories that come and go
+				if(m_recursive && out.m_isDirectory)
+				{
+					if(out.m_type == INotifyEventType::kCreated)
+					{
+						reinit = reinit || addWatches(out.m_path);
+					}
+					else
+					{
+						removeWatches(out.m_path);
+					}
 				}
-			}
-			else
-			{
-				ANKI_UTIL_LOGE("read() failed to read the expected size of data: %s", strerror(errno));
-				err = Error::kFunctionFailed;
-				break;
 			}
 		}
 	}
 
+	if(!err && reinit)
+	{
+		destroyInternal();
+		err = initInternal();
+		events.emplaceBack()->m_type = INotifyEventType::kOverflow;
+	}
+
 	return err;
 }
 
@@ -18,10 +18,10 @@ void INotify::destroyInternal()
 	// TODO
 }
 
-Error INotify::pollEvents(Bool& modified)
+Error INotify::pollEvents(DynamicArray<INotifyEvent>& events)
 {
 	// TODO
-	modified = false;
+	events.destroy();
 	return Error::kNone;
 }
 
@@ -6,6 +6,7 @@
 #include <AnKi/Util/File.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/System.h>
+#include <AnKi/Util/MemoryPool.h>
 #include <cstdarg>
 #include <cstdio>
 #include <cstdlib>
@@ -21,7 +22,61 @@ namespace anki {
 
 inline constexpr Array<const Char*, U(LoggerMessageType::kCount)> kMessageTypeTxt = {"I", "V", "E", "W", "F"};
 
+/// A single producer single consumer ring of AsyncRecords. Only the thread that owns the ring writes the head and only the drain thread
+/// writes the tail.
+class Logger::AsyncRing
+{
+public:
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U32> m_head = {0};
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U32> m_tail = {0};
+	Atomic<U32, AtomicMemoryOrder::kSeqCst> m_writing = {0}; ///< The owner is writing a record. See enableAsync().
+	Atomic<U32> m_owned = {1}; ///< Zero after the owner thread exits. Another thread can take the ring then.
+	U8* m_buffer = nullptr;
+	U32 m_size = 0; ///< Power of two.
+};
+
+/// The header of a message in an AsyncRing. The message string follows it.
+class Logger::AsyncRecord
+{
+public:
+	static constexpr U32 kPaddingBit = 1u << 31u; ///< Set in m_size of the records that fill the end of the ring.
+
+	U32 m_size; ///< It has to be the 1st member. See writeAsync().
+	I32 m_line;
+	U64 m_seq;
+	const Char* m_file;
+	const Char* m_func;
+	const Char* m_subsystem;
+	LoggerMessageType m_type;
+	Array<Char, Thread::kThreadNameMaxLength + 1> m_threadName;
+
+	const Char* getMessage() const
+	{
+		return reinterpret_cast<const Char*>(this + 1);
+	}
+};
+
+/// Gives the ring of a thread back to the logger when the thread exits.
+class Logger::AsyncRingReleaser
+{
+public:
+	~AsyncRingReleaser()
+	{
+		if(m_asyncRingTls)
+		{
+			// The thread won't write again. The messages that are still in the ring stay there until the drain thread gets them
+			m_asyncRingTls->m_owned.store(0, AtomicMemoryOrder::kRelease);
+			m_asyncRingTls = nullptr;
+		}
+	}
+};
+
+thread_local Logger::AsyncRing* Logger::m_asyncRingTls = nullptr;
+thread_local Logger::AsyncRingReleaser Logger::m_asyncRingReleaser;
+thread_local Bool Logger::m_asyncDrainThread = false;
+
 Logger::Logger()
+	: m_asyncThread("AnKiLogger")
 {
 	addMessageHandler(this, &defaultSystemMessageHandler);
 
@@ -34,6 +89,13 @@ Logger::Logger()
 
 Logger::~Logger()
 {
+	enableAsync(false);
+
+	for(U32 i = 0; i < m_asyncRingCount.load(); ++i)
+	{
+		freeAligned(m_asyncRings[i]->m_buffer);
+		freeAligned(m_asyncRings[i]);
+	}
 }
 
 void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback)
@@ -42,6 +104,16 @@ void Logger::addMessageHandler(void* data, LoggerMessageHandlerCallback callback
 	m_handlers[m_handlersCount++] = Handler{data, callback};
 }
 
+void Logger::addFileMessageHandler(File* file)
+{
+	ANKI_ASSERT(file && file->isOpen());
+
+	// The synchronous messages flush anyway so the buffer only matters for the drain thread
+	[[maybe_unused]] const Error err = file->setBufferSize(kFileBufferSize);
+
+	addMessageHandler(file, &fileMessageHandler);
+}
+
 void Logger::removeMessageHandler(void* data, LoggerMessageHandlerCallback callback)
 {
 	LockGuard<Mutex> lock(m_mutex);
@@ -79,15 +151,23 @@ void Logger::write(const Char* file, int line, const Char* func, const Char* sub
 
 	LoggerMessageInfo inf = {baseFile, line, func, type, msg, subsystem, threadName};
 
-	m_mutex.lock();
+	if(type != LoggerMessageType::kFatal && m_asyncEnabled.load(AtomicMemoryOrder::kRelaxed) && writeAsync(inf))
+	{
+		return;
+	}
 
-	U count = m_handlersCount;
-	while(count-- != 0)
+	if(type == LoggerMessageType::kFatal)
 	{
-		m_handlers[count].m_callback(m_handlers[count].m_data, inf);
+		// Don't lose the messages that lead to the fatal one
+		flushAsync();
+
+		if(BinaryLog::isCapturing())
+		{
+			BinaryLog::getSingleton().flush();
+		}
 	}
 
-	m_mutex.unlock();
+	dispatch(inf);
 
 	if(type == LoggerMessageType::kFatal)
 	{
@@ -104,14 +184,342 @@ void Logger::write(const Char* file, int line, const Char* func, const Char* sub
 	}
 }
 
+void Logger::dispatch(const LoggerMessageInfo& info)
+{
+	LockGuard<Mutex> lock(m_mutex);
+
+	U count = m_handlersCount;
+	while(count-- != 0)
+	{
+		m_handlers[count].m_callback(m_handlers[count].m_data, info);
+	}
+}
+
+void Logger::enableAsync(Bool enable, U32 ringSize)
+{
+	LockGuard<Mutex> lock(m_asyncRingsMtx);
+
+	if(enable == isAsyncEnabled())
+	{
+		return;
+	}
+
+	if(enable)
+	{
+		if(m_asyncRingSize == 0)
+		{
+			m_asyncRingSize = max(nextPowerOfTwo(ringSize), 4096u);
+		}
+
+		m_asyncThreadQuit.store(0);
+		m_asyncThread.start(this, asyncThreadMain);
+		m_asyncEnabled.store(1);
+	}
+	else
+	{
+		m_asyncEnabled.store(0);
+
+		// Some threads might have seen the old value. Wait for them to finish writing their records
+		for(U32 i = 0; i < m_asyncRingCount.load(AtomicMemoryOrder::kAcquire); ++i)
+		{
+			while(m_asyncRings[i]->m_writing.load())
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		// The thread will drain everything before it quits
+		m_asyncThreadQuit.store(1);
+		m_asyncFutex.getValue().fetchAdd(1);
+		m_asyncFutex.wakeAll();
+		[[maybe_unused]] const Error err = m_asyncThread.join();
+	}
+}
+
+void Logger::flushAsync()
+{
+	if(!isAsyncEnabled() || m_asyncDrainThread)
+	{
+		// A handler that logs runs in the drain thread. It can't wait for itself
+		return;
+	}
+
+	// Wait until the drain thread consumed everything that was written before the call
+	for(U32 i = 0; i < m_asyncRingCount.load(AtomicMemoryOrder::kAcquire); ++i)
+	{
+		AsyncRing& ring = *m_asyncRings[i];
+		const U32 head = ring.m_head.load(AtomicMemoryOrder::kAcquire);
+
+		m_asyncFutex.getValue().fetchAdd(1);
+		m_asyncFutex.wake(1);
+
+		while(I32(head - ring.m_tail.load(AtomicMemoryOrder::kAcquire)) > 0 && isAsyncEnabled())
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+Logger::AsyncRing* Logger::getOrCreateAsyncRing()
+{
+	AsyncRing* ring = m_asyncRingTls;
+	if(ring) [[likely]]
+	{
+		return ring;
+	}
+
+	LockGuard<Mutex> lock(m_asyncRingsMtx);
+
+	// Register the releaser of this thread. Touching the thread_local constructs it and its destructor will run when the thread exits
+	[[maybe_unused]] AsyncRingReleaser& releaser = m_asyncRingReleaser;
+
+	// Take the ring of a thread that exited. It's single producer so it's fine as long as the previous owner doesn't write anymore
+	const U32 ringCount = m_asyncRingCount.load(AtomicMemoryOrder::kRelaxed);
+	for(U32 i = 0; i < ringCount; ++i)
+	{
+		if(m_asyncRings[i]->m_owned.load(AtomicMemoryOrder::kAcquire) == 0)
+		{
+			ring = m_asyncRings[i];
+			ring->m_owned.store(1, AtomicMemoryOrder::kRelaxed);
+			m_asyncRingTls = ring;
+			return ring;
+		}
+	}
+
+	if(ringCount == kMaxAsyncRings)
+	{
+		return nullptr;
+	}
+
+	ring = new(mallocAligned(sizeof(AsyncRing), alignof(AsyncRing))) AsyncRing();
+	ring->m_size = m_asyncRingSize;
+	ring->m_buffer = static_cast<U8*>(mallocAligned(m_asyncRingSize, alignof(AsyncRecord)));
+
+	m_asyncRings[ringCount] = ring;
+	m_asyncRingCount.store(ringCount + 1, AtomicMemoryOrder::kRelease);
+
+	m_asyncRingTls = ring;
+	return ring;
+}
+
+Bool Logger::writeAsync(const LoggerMessageInfo& info)
+{
+	AsyncRing* ring = getOrCreateAsyncRing();
+	if(!ring) [[unlikely]]
+	{
+		return false;
+	}
+
+	// Tell enableAsync() that a record is in flight and then check if async is still enabled
+	ring->m_writing.store(1);
+	if(!m_asyncEnabled.load()) [[unlikely]]
+	{
+		ring->m_writing.store(0);
+		return false;
+	}
+
+	// Long messages get truncated
+	const U32 msgLength = min<U32>(U32(strlen(info.m_msg)), ring->m_size / 4);
+	const U32 recordSize = getAlignedRoundUp(alignof(AsyncRecord), U32(sizeof(AsyncRecord)) + msgLength + 1);
+
+	U32 head = ring->m_head.load(AtomicMemoryOrder::kRelaxed);
+	const U32 tail = ring->m_tail.load(AtomicMemoryOrder::kAcquire);
+	U32 offset = head & (ring->m_size - 1);
+	const U32 paddingSize = (ring->m_size - offset < recordSize) ? ring->m_size - offset : 0;
+
+	if(head - tail + paddingSize + recordSize > ring->m_size)
+	{
+		// Full
+		ring->m_writing.store(0);
+		m_droppedMessageCount.fetchAdd(1);
+		return true;
+	}
+
+	if(paddingSize)
+	{
+		// The record doesn't fit at the end of the ring, skip to the start
+		const U32 paddingSizeAndBit = paddingSize | AsyncRecord::kPaddingBit;
+		memcpy(ring->m_buffer + offset, &paddingSizeAndBit, sizeof(U32));
+		head += paddingSize;
+		offset = 0;
+	}
+
+	AsyncRecord* record = reinterpret_cast<AsyncRecord*>(ring->m_buffer + offset);
+	record->m_size = recordSize;
+	record->m_line = info.m_line;
+	record->m_seq = m_asyncSeq.fetchAdd(1);
+	record->m_file = info.m_file;
+	record->m_func = info.m_func;
+	record->m_subsystem = info.m_subsystem;
+	record->m_type = info.m_type;
+	strncpy(record->m_threadName.getBegin(), info.m_threadName, record->m_threadName.getSize() - 1);
+	record->m_threadName.getBack() = '\0';
+	Char* msg = const_cast<Char*>(record->getMessage());
+	memcpy(msg, info.m_msg, msgLength);
+	msg[msgLength] = '\0';
+
+	ring->m_head.store(head + recordSize, AtomicMemoryOrder::kSeqCst);
+	ring->m_writing.store(0);
+
+	// Wake the drain thread only if it sleeps
+	if(m_asyncThreadSleeping.load())
+	{
+		m_asyncFutex.getValue().fetchAdd(1);
+		m_asyncFutex.wake(1);
+	}
+
+	return true;
+}
+
+U32 Logger::drainAsyncRings()
+{
+	const U32 ringCount = m_asyncRingCount.load(AtomicMemoryOrder::kAcquire);
+	U32 messageCount = 0;
+
+	while(true)
+	{
+		// Find the oldest message of all rings
+		AsyncRing* oldestRing = nullptr;
+		const AsyncRecord* oldestRecord = nullptr;
+		for(U32 i = 0; i < ringCount; ++i)
+		{
+			AsyncRing& ring = *m_asyncRings[i];
+			const U32 head = ring.m_head.load(AtomicMemoryOrder::kAcquire);
+			U32 tail = ring.m_tail.load(AtomicMemoryOrder::kRelaxed);
+
+			while(tail != head)
+			{
+				const U8* ptr = ring.m_buffer + (tail & (ring.m_size - 1));
+				U32 size;
+				memcpy(&size, ptr, sizeof(U32));
+				if(size & AsyncRecord::kPaddingBit)
+				{
+					tail += size & ~AsyncRecord::kPaddingBit;
+					ring.m_tail.store(tail, AtomicMemoryOrder::kRelease);
+					continue;
+				}
+
+				const AsyncRecord* record = reinterpret_cast<const AsyncRecord*>(ptr);
+				if(!oldestRecord || record->m_seq < oldestRecord->m_seq)
+				{
+					oldestRing = &ring;
+					oldestRecord = record;
+				}
+				break;
+			}
+		}
+
+		if(!oldestRecord)
+		{
+			break;
+		}
+
+		const AsyncRecord& r = *oldestRecord;
+		const LoggerMessageInfo info = {r.m_file, r.m_line, r.m_func, r.m_type, r.getMessage(), r.m_subsystem, &r.m_threadName[0]};
+		dispatch(info);
+		++messageCount;
+
+		oldestRing->m_tail.store(oldestRing->m_tail.load(AtomicMemoryOrder::kRelaxed) + oldestRecord->m_size, AtomicMemoryOrder::kRelease);
+	}
+
+	const U64 droppedCount = m_droppedMessageCount.load();
+	if(droppedCount != m_reportedDroppedMessageCount)
+	{
+		Array<Char, 128> msg;
+		snprintf(msg.getBegin(), msg.getSize(), "%" PRIu64 " log messages were dropped because the ring buffers were full",
+				 droppedCount - m_reportedDroppedMessageCount);
+		m_reportedDroppedMessageCount = droppedCount;
+
+		const LoggerMessageInfo info = {"Logger.cpp", __LINE__, ANKI_FUNC, LoggerMessageType::kWarning, msg.getBegin(), "UTIL", "AnKiLogger"};
+		dispatch(info);
+		++messageCount;
+	}
+
+	if(messageCount)
+	{
+		// The file handlers don't flush every message in async mode
+		LockGuard<Mutex> lock(m_mutex);
+		for(U32 i = 0; i < m_handlersCount; ++i)
+		{
+			if(m_handlers[i].m_callback == &fileMessageHandler)
+			{
+				[[maybe_unused]] const Error err = static_cast<File*>(m_handlers[i].m_data)->flush();
+			}
+		}
+	}
+
+	return messageCount;
+}
+
+Error Logger::asyncThreadMain(ThreadCallbackInfo& info)
+{
+	Logger& self = *static_cast<Logger*>(info.m_userData);
+	m_asyncDrainThread = true;
+
+	while(true)
+	{
+		if(self.drainAsyncRings())
+		{
+			continue;
+		}
+
+		if(self.m_asyncThreadQuit.load())
+		{
+			// enableAsync() made sure that no-one writes anymore, drain one last time
+			self.drainAsyncRings();
+			break;
+		}
+
+		// Sleep until a thread writes. Announce it first and then check the rings one last time so writers can't miss it
+		self.m_asyncThreadSleeping.store(1);
+		const U32 futexValue = self.m_asyncFutex.getValue().load();
+
+		Bool empty = true;
+		const U32 ringCount = self.m_asyncRingCount.load(AtomicMemoryOrder::kAcquire);
+		for(U32 i = 0; i < ringCount && empty; ++i)
+		{
+			empty = self.m_asyncRings[i]->m_head.load(AtomicMemoryOrder::kSeqCst) == self.m_asyncRings[i]->m_tail.load(AtomicMemoryOrder::kRelaxed);
+		}
+
+		if(empty && !self.m_asyncThreadQuit.load())
+		{
+			self.m_asyncFutex.wait(futexValue);
+		}
+
+		self.m_asyncThreadSleeping.store(0);
+	}
+
+	return Error::kNone;
+}
+
 void Logger::writeFormated(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
 						   const Char* fmt, ...)
 {
-	Array<Char, 256> buffer;
 	va_list args;
+	va_start(args, fmt);
+	writeFormatedInternal(file, line, func, subsystem, type, threadName, fmt, args);
+	va_end(args);
+}
 
+void Logger::writeFormatedUnchecked(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type,
+									const Char* threadName, const Char* fmt, ...)
+{
+	va_list args;
 	va_start(args, fmt);
-	I len = vsnprintf(&buffer[0], sizeof(buffer), fmt, args);
+	writeFormatedInternal(file, line, func, subsystem, type, threadName, fmt, args);
+	va_end(args);
+}
+
+void Logger::writeFormatedInternal(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type,
+								   const Char* threadName, const Char* fmt, va_list args)
+{
+	Array<Char, 256> buffer;
+
+	va_list argsCopy;
+	va_copy(argsCopy, args);
+	I len = vsnprintf(&buffer[0], sizeof(buffer), fmt, argsCopy);
+	va_end(argsCopy);
+
 	if(len < 0)
 	{
 		fprintf(stderr, "Logger::writeFormated() failed. Will not recover");
@@ -120,15 +528,11 @@ void Logger::writeFormated(const Char* file, int line, const Char* func, const C
 	else if(len < I(sizeof(buffer)))
 	{
 		write(file, line, func, subsystem, type, threadName, &buffer[0]);
-		va_end(args);
 	}
 	else
 	{
 		// Not enough space.
 
-		va_end(args);
-		va_start(args, fmt);
-
 		const PtrSize newSize = len + 1;
 		Char* newBuffer = static_cast<Char*>(malloc(newSize));
 		len = vsnprintf(newBuffer, newSize, fmt, args);
@@ -136,7 +540,6 @@ void Logger::writeFormated(const Char* file, int line, const Char* func, const C
 		write(file, line, func, subsystem, type, threadName, newBuffer);
 
 		free(newBuffer);
-		va_end(args);
 	}
 }
 
@@ -278,7 +681,9 @@ void Logger::fileMessageHandler(void* pfile, const LoggerMessageInfo& info)
 
 	Error err = file->writeTextf("[%s] %s (%s:%d %s)\n", kMessageTypeTxt[info.m_type], info.m_msg, info.m_file, info.m_line, info.m_func);
 
-	if(!err)
+	// The drain thread flushes once per batch. The rest of the messages are written synchronously (fatal messages, threads without a ring or async
+	// disabled) and they have to reach the file now, the next thing might be an abort()
+	if(!err && !m_asyncDrainThread)
 	{
 		err = file->flush();
 	}
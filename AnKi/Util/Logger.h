@@ -8,6 +8,8 @@
 #include <AnKi/Config.h>
 #include <AnKi/Util/Singleton.h>
 #include <AnKi/Util/Thread.h>
+#include <AnKi/Util/BinaryLog.h>
+#include <cstdarg>
 
 namespace anki {
 
@@ -51,6 +53,9 @@ using LoggerMessageHandlerCallback = void (*)(void*, const LoggerMessageInfo& in
 /// thread safe.
 /// To add a new signal:
 /// @code logger.addMessageHandler((void*)obj, &function) @endcode
+/// In async mode the threads that log copy the formatted messages into their own lock-free ring buffers and a background thread drains the
+/// rings to the handlers. The memory is bounded by the ring size and messages that don't fit are dropped and counted. Fatal messages are
+/// always written synchronously after the pending messages are flushed.
 class Logger : public MakeSingleton<Logger>
 {
 	template<typename>
@@ -63,9 +68,16 @@ public:
 	/// Remove a message handler.
 	void removeMessageHandler(void* data, LoggerMessageHandlerCallback callback);
 
-	/// Add file message handler.
+	/// Add file message handler. It gives the file a large buffer so the batches of the async mode turn into a few writes.
+	/// @note Call it before writing to the file.
 	void addFileMessageHandler(File* file);
 
+	/// Remove a file message handler.
+	void removeFileMessageHandler(File* file)
+	{
+		removeMessageHandler(file, &fileMessageHandler);
+	}
+
 	/// Send a message.
 	void write(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName, const Char* msg);
 
@@ -74,13 +86,62 @@ public:
 	void writeFormated(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
 					   const Char* fmt, ...);
 
+	/// Send a message while a BinaryLog capture is running. Normal and verbose messages go only to the capture, the rest go to the handlers as
+	/// well.
+	template<typename... TArgs>
+	void writeCaptured(BinaryLogFormatId& formatId, const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type,
+					   const Char* fmt, const TArgs&... args)
+	{
+		if(type != LoggerMessageType::kVerbose || m_verbosityEnabled)
+		{
+			BinaryLog::getSingleton().writeMessage(formatId, file, line, func, subsystem, U8(type), fmt, args...);
+		}
+
+		if(type != LoggerMessageType::kNormal && type != LoggerMessageType::kVerbose)
+		{
+			// The format was checked at the call site by writeFormated()
+			writeFormatedUnchecked(file, line, func, subsystem, type, Thread::getCurrentThreadName(), fmt, args...);
+		}
+	}
+
 	/// Enable or disable logger verbosity.
 	void enableVerbosity(Bool enable)
 	{
 		m_verbosityEnabled = enable;
 	}
 
+	Bool getVerbosityEnabled() const
+	{
+		return m_verbosityEnabled;
+	}
+
+	/// Enable or disable async logging. Disabling it flushes all pending messages.
+	/// @param ringSize The size of the ring buffer of every thread that logs. Used only the first time async logging is enabled.
+	void enableAsync(Bool enable, U32 ringSize = kDefaultAsyncRingSize);
+
+	Bool isAsyncEnabled() const
+	{
+		return m_asyncEnabled.load() != 0;
+	}
+
+	/// Block until all the messages that were logged asynchronously so far reach the handlers.
+	void flushAsync();
+
+	/// The number of messages that were dropped because a ring buffer was full.
+	U64 getDroppedMessageCount() const
+	{
+		return m_droppedMessageCount.load();
+	}
+
 private:
+	static constexpr U32 kDefaultAsyncRingSize = 64 * 1024;
+	static constexpr U32 kFileBufferSize = 64 * 1024;
+	static constexpr U32 kMaxAsyncRings = 64; ///< Threads that log while that many threads own rings fall back to synchronous logging.
+
+	class AsyncRing;
+	class AsyncRecord;
+	class AsyncRingReleaser;
+
 	class Handler
 	{
 	public:
@@ -93,20 +154,66 @@ private:
 	U32 m_handlersCount = 0;
 	Bool m_verbosityEnabled = false;
 
+	Array<AsyncRing*, kMaxAsyncRings> m_asyncRings = {};
+	Atomic<U32> m_asyncRingCount = {0};
+	U32 m_asyncRingSize = 0;
+	Mutex m_asyncRingsMtx; ///< Protects the creation of the rings and enableAsync().
+	static thread_local AsyncRing* m_asyncRingTls;
+	static thread_local AsyncRingReleaser m_asyncRingReleaser;
+	static thread_local Bool m_asyncDrainThread;
+
+	Atomic<U32, AtomicMemoryOrder::kSeqCst> m_asyncEnabled = {0};
+	Atomic<U64> m_asyncSeq = {0}; ///< Used to drain the messages of all threads in the order they were logged.
+	Atomic<U64> m_droppedMessageCount = {0};
+	U64 m_reportedDroppedMessageCount = 0;
+
+	Thread m_asyncThread;
+	Futex m_asyncFutex; ///< The drain thread sleeps on it.
+	Atomic<U32, AtomicMemoryOrder::kSeqCst> m_asyncThreadSleeping = {0};
+	Atomic<U32, AtomicMemoryOrder::kSeqCst> m_asyncThreadQuit = {0};
+
 	/// Initialize the logger and add the default message handler
 	Logger();
 
 	~Logger();
 
+	void dispatch(const LoggerMessageInfo& info);
+
+	AsyncRing* getOrCreateAsyncRing();
+
+	/// Returns false if the message has to be written synchronously.
+	Bool writeAsync(const LoggerMessageInfo& info);
+
+	/// Dispatch all messages that are in the rings. Returns the number of messages.
+	U32 drainAsyncRings();
+
+	static Error asyncThreadMain(ThreadCallbackInfo& info);
+
+	void writeFormatedUnchecked(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
+								const Char* fmt, ...);
+
+	void writeFormatedInternal(const Char* file, int line, const Char* func, const Char* subsystem, LoggerMessageType type, const Char* threadName,
+							   const Char* fmt, va_list args);
+
 	static void defaultSystemMessageHandler(void*, const LoggerMessageInfo& info);
 	static void fileMessageHandler(void* file, const LoggerMessageInfo& info);
 };
 
+/// While a BinaryLog capture is running the normal and verbose messages go only to the binary log. The rest go to both. Only one of the branches
+/// runs so the arguments are evaluated once.
 #define ANKI_LOG(subsystem_, t, ...) \
 	do \
 	{ \
-		Logger::getSingleton().writeFormated(ANKI_FILE, __LINE__, ANKI_FUNC, subsystem_, LoggerMessageType::t, Thread::getCurrentThreadName(), \
-											 __VA_ARGS__); \
+		if(BinaryLog::isCapturing()) [[unlikely]] \
+		{ \
+			static BinaryLogFormatId binaryLogFormatId_; \
+			Logger::getSingleton().writeCaptured(binaryLogFormatId_, ANKI_FILE, __LINE__, ANKI_FUNC, subsystem_, LoggerMessageType::t, __VA_ARGS__); \
+		} \
+		else \
+		{ \
+			Logger::getSingleton().writeFormated(ANKI_FILE, __LINE__, ANKI_FUNC, subsystem_, LoggerMessageType::t, Thread::getCurrentThreadName(), \
+												 __VA_ARGS__); \
+		} \
 	} while(false)
 /// @}
 
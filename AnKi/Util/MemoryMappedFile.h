@@ -0,0 +1,92 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/String.h>
+#include <AnKi/Util/Enum.h>
+
+namespace anki {
+
+/// @addtogroup util_file
+/// @{
+
+/// Hints about how a range of a file will be accessed.
+enum class FileAccessHint : U8
+{
+	kNormal,
+	kSequential, ///< The range will be read once from start to end.
+	kRandom,
+	kWillNeed, ///< The range will be read soon. Start reading it from the disk.
+	kDontNeed ///< The range won't be read again. The OS can drop its pages.
+};
+
+/// A read-only memory mapping of a whole file. The contents are accessed directly from the page cache of the OS.
+class MemoryMappedFile
+{
+public:
+	MemoryMappedFile() = default;
+
+	// Non-copyable
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+
+	~MemoryMappedFile()
+	{
+		close();
+	}
+
+	// Non-copyable
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	/// Open and map a file for reading.
+	Error open(CString filename);
+
+	/// Unmap and close the file.
+	void close();
+
+	Bool isOpen() const
+	{
+		return m_open;
+	}
+
+	/// Get the contents of the file. It's nullptr if the file is empty.
+	const U8* getData() const
+	{
+		ANKI_ASSERT(m_open);
+		return static_cast<const U8*>(m_data);
+	}
+
+	PtrSize getSize() const
+	{
+		ANKI_ASSERT(m_open);
+		return m_size;
+	}
+
+#if ANKI_POSIX
+	/// Get the file descriptor of the mapped file. It can be used for reads that bypass the mapping.
+	I32 getFileDescriptor() const
+	{
+		ANKI_ASSERT(m_open);
+		return m_fd;
+	}
+#endif
+
+	/// Give a hint to the OS about how a range of the file will be accessed. It's only a hint so it can't fail.
+	void adviseAccess(PtrSize offset, PtrSize size, FileAccessHint hint) const;
+
+private:
+	void* m_data = nullptr;
+	PtrSize m_size = 0;
+#if ANKI_POSIX
+	I32 m_fd = -1;
+#elif ANKI_OS_WINDOWS
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+#endif
+	Bool m_open = false;
+};
+/// @}
+
+} // end namespace anki
@@ -0,0 +1,128 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/MemoryMappedFile.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/Functions.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace anki {
+
+Error MemoryMappedFile::open(CString filename)
+{
+	ANKI_ASSERT(!m_open);
+
+	const int fd = ::open(filename.cstr(), O_RDONLY);
+	if(fd < 0)
+	{
+		ANKI_UTIL_LOGE("open() failed: %s: %s", filename.cstr(), strerror(errno));
+		return Error::kFileNotFound;
+	}
+
+	Error err = Error::kNone;
+
+	struct stat st;
+	if(fstat(fd, &st) < 0)
+	{
+		ANKI_UTIL_LOGE("fstat() failed: %s: %s", filename.cstr(), strerror(errno));
+		err = Error::kFileAccess;
+	}
+
+	// Zero sized files can't be mapped
+	if(!err && st.st_size > 0)
+	{
+		void* data = mmap(nullptr, PtrSize(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+		if(data == MAP_FAILED)
+		{
+			ANKI_UTIL_LOGE("mmap() failed: %s: %s", filename.cstr(), strerror(errno));
+			err = Error::kFileAccess;
+		}
+		else
+		{
+			m_data = data;
+			m_size = PtrSize(st.st_size);
+		}
+	}
+
+	// Keep the descriptor open for reads that don't go through the mapping
+	if(err)
+	{
+		::close(fd);
+	}
+	else
+	{
+		m_fd = fd;
+	}
+
+	m_open = !err;
+	return err;
+}
+
+void MemoryMappedFile::close()
+{
+	if(m_data)
+	{
+		if(munmap(m_data, m_size) < 0)
+		{
+			ANKI_UTIL_LOGE("munmap() failed: %s", strerror(errno));
+		}
+	}
+
+	if(m_fd >= 0)
+	{
+		::close(m_fd);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_fd = -1;
+	m_open = false;
+}
+
+void MemoryMappedFile::adviseAccess(PtrSize offset, PtrSize size, FileAccessHint hint) const
+{
+	ANKI_ASSERT(m_open);
+	ANKI_ASSERT(offset + size <= m_size);
+
+	if(size == 0)
+	{
+		return;
+	}
+
+	int advice;
+	switch(hint)
+	{
+	case FileAccessHint::kSequential:
+		advice = MADV_SEQUENTIAL;
+		break;
+	case FileAccessHint::kRandom:
+		advice = MADV_RANDOM;
+		break;
+	case FileAccessHint::kWillNeed:
+		advice = MADV_WILLNEED;
+		break;
+	case FileAccessHint::kDontNeed:
+		advice = MADV_DONTNEED;
+		break;
+	default:
+		advice = MADV_NORMAL;
+	}
+
+	// madvise wants the address aligned to the page size
+	static const PtrSize pageSize = PtrSize(sysconf(_SC_PAGESIZE));
+	const PtrSize alignedOffset = getAlignedRoundDown(pageSize, offset);
+	U8* addr = static_cast<U8*>(m_data) + alignedOffset;
+	const PtrSize alignedSize = size + (offset - alignedOffset);
+
+	if(madvise(addr, alignedSize, advice) < 0)
+	{
+		ANKI_UTIL_LOGW("madvise() failed: %s", strerror(errno));
+	}
+}
+
+} // end namespace anki
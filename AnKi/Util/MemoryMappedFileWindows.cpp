@@ -0,0 +1,116 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/MemoryMappedFile.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/Win32Minimal.h>
+
+namespace anki {
+
+Error MemoryMappedFile::open(CString filename)
+{
+	ANKI_ASSERT(!m_open);
+
+	const HANDLE file = CreateFileA(filename.cstr(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if(file == INVALID_HANDLE_VALUE)
+	{
+		ANKI_UTIL_LOGE("CreateFileA() failed: %s: %lu", filename.cstr(), GetLastError());
+		return Error::kFileNotFound;
+	}
+
+	Error err = Error::kNone;
+
+	LARGE_INTEGER size;
+	if(!GetFileSizeEx(file, &size))
+	{
+		ANKI_UTIL_LOGE("GetFileSizeEx() failed: %s: %lu", filename.cstr(), GetLastError());
+		err = Error::kFileAccess;
+	}
+
+	// Zero sized files can't be mapped
+	HANDLE mapping = nullptr;
+	if(!err && size.QuadPart > 0)
+	{
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		void* data = (mapping) ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+		if(!data)
+		{
+			ANKI_UTIL_LOGE("Mapping the file failed: %s: %lu", filename.cstr(), GetLastError());
+			err = Error::kFileAccess;
+		}
+		else
+		{
+			m_data = data;
+			m_size = PtrSize(size.QuadPart);
+		}
+	}
+
+	if(err)
+	{
+		if(mapping)
+		{
+			CloseHandle(mapping);
+		}
+
+		CloseHandle(file);
+	}
+	else
+	{
+		m_fileHandle = file;
+		m_mappingHandle = mapping;
+	}
+
+	m_open = !err;
+	return err;
+}
+
+void MemoryMappedFile::close()
+{
+	if(m_data)
+	{
+		if(!UnmapViewOfFile(m_data))
+		{
+			ANKI_UTIL_LOGE("UnmapViewOfFile() failed: %lu", GetLastError());
+		}
+	}
+
+	if(m_mappingHandle)
+	{
+		CloseHandle(m_mappingHandle);
+	}
+
+	if(m_fileHandle)
+	{
+		CloseHandle(m_fileHandle);
+	}
+
+	m_data = nullptr;
+	m_size = 0;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+	m_open = false;
+}
+
+void MemoryMappedFile::adviseAccess(PtrSize offset, PtrSize size, FileAccessHint hint) const
+{
+	ANKI_ASSERT(m_open);
+	ANKI_ASSERT(offset + size <= m_size);
+
+	// Windows only has an equivalent for the prefetch hint
+	if(size == 0 || hint != FileAccessHint::kWillNeed)
+	{
+		return;
+	}
+
+	WIN32_MEMORY_RANGE_ENTRY range;
+	range.VirtualAddress = static_cast<U8*>(m_data) + offset;
+	range.NumberOfBytes = size;
+	if(!PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0))
+	{
+		ANKI_UTIL_LOGW("PrefetchVirtualMemory() failed: %lu", GetLastError());
+	}
+}
+
+} // end namespace anki
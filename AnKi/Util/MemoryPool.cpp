@@ -4,12 +4,14 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Util/MemoryPool.h>
+#include <AnKi/Util/MemoryPoolTelemetry.h>
 #include <AnKi/Util/Functions.h>
 #include <AnKi/Util/Assert.h>
 #include <AnKi/Util/Thread.h>
 #include <AnKi/Util/Atomic.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/Tracer.h>
+#include <bit>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
@@ -152,6 +154,11 @@ void BaseMemoryPool::init(AllocAlignedCallback allocCb, void* allocCbUserData, c
 	}
 }
 
+const MemoryPoolTelemetry* BaseMemoryPool::getTelemetry() const
+{
+	return (m_allocCb == MemoryPoolTelemetry::allocCallback) ? static_cast<const MemoryPoolTelemetry*>(m_allocCbUserData) : nullptr;
+}
+
 void BaseMemoryPool::destroy()
 {
 	if(m_name != nullptr)
@@ -163,27 +170,721 @@ void BaseMemoryPool::destroy()
 	m_allocationCount.setNonAtomically(0);
 }
 
-void HeapMemoryPool::init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name)
+/// The size class allocator of HeapMemoryPoolMode::kThreadCached. Small allocations are carved out of spans. Every span belongs to a thread
+/// cache and only that thread carves blocks from it and keeps its free blocks. Other threads that free blocks of the span push them to a
+/// lock-free queue of the owner and the owner takes them back when its free list runs dry. That way the common allocate() and free() only touch
+/// memory of the calling thread.
+///
+/// The spans start with a header and they are aligned to kSpanSize so free() masks the pointer to get to the header and the owner thread cache of
+/// the span. Large allocations come straight from the AllocAlignedCallback with a small header in front of them. To tell them apart free() looks
+/// the pointer up in the span map, a radix tree with a bit for every kSpanSize of the address space.
+///
+/// The spans are never returned to the AllocAlignedCallback before the pool gets destroyed. When a thread exits its thread caches become orphans
+/// and the next thread that needs a cache adopts one of them, together with its spans and free blocks.
+class HeapMemoryPool::ThreadCachedAllocator
+{
+public:
+	static constexpr PtrSize kSpanSize = 64_KB;
+	static constexpr U32 kSpanHeaderSize = 64;
+	static constexpr PtrSize kMaxSmallSize = 1024;
+	static constexpr PtrSize kMaxSmallAlignment = 64;
+	static constexpr U32 kMinSmallAlignment = 16;
+
+	/// The max number of pools in kThreadCached mode that can be alive at the same time. It's the size of the thread local table.
+	static constexpr U32 kMaxPools = 32;
+
+	ThreadCachedAllocator(AllocAlignedCallback allocCb, void* allocCbUserData, U32 slot)
+		: m_allocCb(allocCb)
+		, m_allocCbUserData(allocCbUserData)
+		, m_slot(slot)
+		, m_uuid(m_nextUuid.fetchAdd(1))
+	{
+		for(Atomic<SpanMapNode*>& node : m_spanMap)
+		{
+			node.setNonAtomically(nullptr);
+		}
+
+		LockGuard<SpinLock> lock(m_liveAllocatorsLock);
+		m_liveAllocators[slot] = this;
+	}
+
+	~ThreadCachedAllocator();
+
+	/// Try to find a free slot in the thread local table.
+	static Bool acquireSlot(U32& slot);
+
+	static void releaseSlot(U32 slot)
+	{
+		m_slots.fetchAnd(~(1u << slot));
+	}
+
+	static Bool isSmall(PtrSize size, PtrSize alignment)
+	{
+		return size <= kMaxSmallSize && alignment <= kMaxSmallAlignment;
+	}
+
+	void* allocate(PtrSize size, PtrSize alignment)
+	{
+		ANKI_ASSERT(isSmall(size, alignment));
+
+		// The size classes are multiples of the alignment if the size is
+		if(alignment > kMinSmallAlignment) [[unlikely]]
+		{
+			size = getAlignedRoundUp(alignment, size);
+		}
+
+		const U32 sizeClass = getSizeClass(size);
+		ThreadCache& cache = getThreadCache();
+		Bin& bin = cache.m_bins[sizeClass];
+
+		void* out;
+		if(bin.m_freeList) [[likely]]
+		{
+			out = bin.m_freeList;
+			bin.m_freeList = bin.m_freeList->m_next;
+			ownerAdd(cache.m_cacheHits, 1);
+		}
+		else
+		{
+			out = allocateSlow(cache, sizeClass);
+			ownerAdd(cache.m_cacheMisses, 1);
+		}
+
+		ownerAdd(cache.m_allocationCount, 1);
+		ownerAdd(cache.m_allocatedBytes, kSizeClassSizes[sizeClass]);
+
+		ANKI_ASSERT(isAligned(alignment, out));
+		return out;
+	}
+
+	/// Allocate something that doesn't fit the size classes. It gets a block of its own with a LargeBlockHeader in front.
+	void* allocateLarge(PtrSize size, PtrSize alignment);
+
+	void free(void* ptr)
+	{
+		if(!isInSmallSpan(ptr)) [[unlikely]]
+		{
+			freeLarge(ptr);
+			return;
+		}
+
+		Span& span = getSpan(ptr);
+#if ANKI_MEM_EXTRA_CHECKS
+		if(span.m_allocator != this)
+		{
+			ANKI_UTIL_LOGF("The memory doesn't belong to this pool");
+		}
+#endif
+
+		const U32 blockSize = kSizeClassSizes[span.m_sizeClass];
+		FreeBlock* block = static_cast<FreeBlock*>(ptr);
+#if ANKI_MEM_EXTRA_CHECKS
+		invalidateMemory(block, blockSize);
+#endif
+
+		const ThreadCacheTlsEntry& entry = m_threadCacheTable[m_slot];
+		ThreadCache* cache = (entry.m_poolUuid == m_uuid) ? entry.m_cache : nullptr;
+		ThreadCache& owner = *span.m_owner;
+		if(&owner == cache) [[likely]]
+		{
+			Bin& bin = owner.m_bins[span.m_sizeClass];
+			block->m_next = bin.m_freeList;
+			bin.m_freeList = block;
+
+			ownerAdd(owner.m_freeCount, 1);
+			ownerAdd(owner.m_freedBytes, blockSize);
+		}
+		else
+		{
+			// Give it back to the owner. The owner takes the whole list at once so there is no ABA problem
+			FreeBlock* head = owner.m_remoteFrees.load(AtomicMemoryOrder::kRelaxed);
+			do
+			{
+				block->m_next = head;
+			} while(!owner.m_remoteFrees.compareExchange(head, block, AtomicMemoryOrder::kRelease, AtomicMemoryOrder::kRelaxed));
+
+			owner.m_remoteFreeCount.fetchAdd(1, AtomicMemoryOrder::kRelaxed);
+			owner.m_remoteFreedBytes.fetchAdd(blockSize, AtomicMemoryOrder::kRelaxed);
+		}
+	}
+
+	U32 getSlot() const
+	{
+		return m_slot;
+	}
+
+	/// The number of the allocations that are not freed yet.
+	U32 getAllocationCount() const;
+
+	void getStats(HeapMemoryPoolStats& stats) const;
+
+private:
+	static constexpr U32 kSizeClassCount = 20;
+
+	/// Steps of 16 up to 128 and then 4 steps for every power of two.
+	static constexpr Array<U32, kSizeClassCount> kSizeClassSizes = {16,  32,  48,  64,  80,  96,  112, 128, 160, 192,
+																	224, 256, 320, 384, 448, 512, 640, 768, 896, 1024};
+
+	class ThreadCache;
+
+	class FreeBlock
+	{
+	public:
+		FreeBlock* m_next;
+	};
+
+	/// The header of a span. The blocks follow.
+	class alignas(kSpanHeaderSize) Span
+	{
+	public:
+		ThreadCache* m_owner;
+		Span* m_next; ///< The next span of the owner.
+#if ANKI_MEM_EXTRA_CHECKS
+		const ThreadCachedAllocator* m_allocator;
+#endif
+		U32 m_sizeClass;
+	};
+
+	static_assert(sizeof(Span) == kSpanHeaderSize);
+
+	/// It's right before the pointer of a large allocation.
+	class LargeBlockHeader
+	{
+	public:
+		void* m_block; ///< What the AllocAlignedCallback returned.
+#if ANKI_MEM_EXTRA_CHECKS
+		const ThreadCachedAllocator* m_allocator;
+#else
+		void* m_padding;
+#endif
+	};
+
+	static_assert(sizeof(LargeBlockHeader) == 16);
+
+	/// The span map covers 48 bits of address space. It has 2 levels of nodes and the leaves have a bit for every span.
+	static constexpr U32 kSpanMapAddressBits = 48;
+	static constexpr U32 kSpanMapNodeBits = 10;
+	static constexpr U32 kSpanMapLeafBits = kSpanMapAddressBits - std::bit_width(kSpanSize - 1) - 2 * kSpanMapNodeBits;
+
+	class SpanMapLeaf
+	{
+	public:
+		Array<Atomic<U64>, (1u << kSpanMapLeafBits) / 64> m_bits;
+
+		SpanMapLeaf()
+		{
+			for(Atomic<U64>& bits : m_bits)
+			{
+				bits.setNonAtomically(0);
+			}
+		}
+	};
+
+	class SpanMapNode
+	{
+	public:
+		Array<Atomic<SpanMapLeaf*>, 1u << kSpanMapNodeBits> m_leaves;
+
+		SpanMapNode()
+		{
+			for(Atomic<SpanMapLeaf*>& leaf : m_leaves)
+			{
+				leaf.setNonAtomically(nullptr);
+			}
+		}
+	};
+
+	class Bin
+	{
+	public:
+		FreeBlock* m_freeList = nullptr;
+		Span* m_span = nullptr; ///< The span to carve new blocks from.
+		U32 m_carveOffset = kSpanSize;
+	};
+
+	class alignas(ANKI_CACHE_LINE_SIZE) ThreadCache
+	{
+	public:
+		Array<Bin, kSizeClassCount> m_bins;
+		ThreadCache* m_next = nullptr;
+		Span* m_spans = nullptr;
+
+		/// It's zero when the thread exited and the cache can be adopted. Protected by m_threadCachesMtx when adopting.
+		Atomic<U32> m_owned = {1};
+
+		// Written only by the owner thread with ownerAdd(). getStats() reads them
+		Atomic<U64> m_cacheHits = {0};
+		Atomic<U64> m_cacheMisses = {0};
+		Atomic<U64> m_allocationCount = {0};
+		Atomic<U64> m_freeCount = {0};
+		Atomic<U64> m_allocatedBytes = {0};
+		Atomic<U64> m_freedBytes = {0};
+		Atomic<U64> m_reservedBytes = {0};
+
+		// Written by the other threads
+		alignas(ANKI_CACHE_LINE_SIZE) Atomic<FreeBlock*> m_remoteFrees = {nullptr};
+		Atomic<U64> m_remoteFreeCount = {0};
+		Atomic<U64> m_remoteFreedBytes = {0};
+	};
+
+	class ThreadCacheTlsEntry
+	{
+	public:
+		U64 m_poolUuid = 0;
+		ThreadCache* m_cache = nullptr;
+	};
+
+	/// Its destructor runs when a thread exits and orphans the thread caches of the thread.
+	class ThreadCacheReleaser
+	{
+	public:
+		~ThreadCacheReleaser();
+	};
+
+	AllocAlignedCallback m_allocCb;
+	void* m_allocCbUserData;
+	U32 m_slot;
+	U64 m_uuid; ///< Never reused so stale entries in the thread local table of dead pools are harmless.
+
+	Atomic<U32> m_largeAllocationCount = {0};
+
+	/// The root of the span map. The bits are only set since the spans are never freed before the allocator.
+	Array<Atomic<SpanMapNode*>, 1u << kSpanMapNodeBits> m_spanMap;
+
+	mutable Mutex m_threadCachesMtx;
+	ThreadCache* m_threadCaches = nullptr;
+
+	static Atomic<U32> m_slots;
+	static Atomic<U64> m_nextUuid;
+	static thread_local Array<ThreadCacheTlsEntry, kMaxPools> m_threadCacheTable;
+	static thread_local ThreadCacheReleaser m_threadCacheReleaser;
+
+	/// The live allocator of every slot. The lock keeps the allocators alive while exiting threads orphan their caches.
+	static SpinLock m_liveAllocatorsLock;
+	static Array<ThreadCachedAllocator*, kMaxPools> m_liveAllocators;
+
+	static U32 getSizeClass(PtrSize size)
+	{
+		ANKI_ASSERT(size > 0 && size <= kMaxSmallSize);
+		if(size <= 128)
+		{
+			return U32((size + 15) >> 4) - 1;
+		}
+
+		// 4 classes for every power of two
+		const U32 log2 = U32(std::bit_width(size - 1)) - 1;
+		const U32 sizeClass = 8 + (log2 - 7) * 4 + U32((size - 1) >> (log2 - 2)) - 4;
+		ANKI_ASSERT(kSizeClassSizes[sizeClass] >= size && kSizeClassSizes[sizeClass - 1] < size);
+		return sizeClass;
+	}
+
+	static Span& getSpan(void* ptr)
+	{
+		return *numberToPtr<Span*>(ptrToNumber(ptr) & ~(kSpanSize - 1));
+	}
+
+	/// Check the span map. It doesn't touch the memory of the pointer so it works for the large allocations as well.
+	Bool isInSmallSpan(const void* ptr) const
+	{
+		const PtrSize spanIdx = ptrToNumber(ptr) / kSpanSize;
+		if(spanIdx >> (2 * kSpanMapNodeBits + kSpanMapLeafBits)) [[unlikely]]
+		{
+			return false;
+		}
+
+		const SpanMapNode* node = m_spanMap[spanIdx >> (kSpanMapNodeBits + kSpanMapLeafBits)].load(AtomicMemoryOrder::kAcquire);
+		if(!node) [[unlikely]]
+		{
+			return false;
+		}
+
+		const SpanMapLeaf* leaf = node->m_leaves[(spanIdx >> kSpanMapLeafBits) & ((1u << kSpanMapNodeBits) - 1)].load(AtomicMemoryOrder::kAcquire);
+		if(!leaf) [[unlikely]]
+		{
+			return false;
+		}
+
+		const U32 bit = U32(spanIdx & ((1u << kSpanMapLeafBits) - 1));
+		return (leaf->m_bits[bit / 64].load(AtomicMemoryOrder::kRelaxed) & (1_U64 << (bit % 64))) != 0;
+	}
+
+	void addToSpanMap(const Span& span);
+
+	template<typename TNode>
+	TNode& getOrCreateSpanMapNode(Atomic<TNode*>& slot);
+
+	void freeLarge(void* ptr);
+
+	/// Only the owner thread writes those counters so there is no need for an atomic read-modify-write.
+	static void ownerAdd(Atomic<U64>& counter, U64 value)
+	{
+		counter.store(counter.load(AtomicMemoryOrder::kRelaxed) + value, AtomicMemoryOrder::kRelaxed);
+	}
+
+	ThreadCache& getThreadCache()
+	{
+		ThreadCacheTlsEntry& entry = m_threadCacheTable[m_slot];
+		if(entry.m_poolUuid == m_uuid) [[likely]]
+		{
+			return *entry.m_cache;
+		}
+
+		return newThreadCache(entry);
+	}
+
+	ANKI_DONT_INLINE ThreadCache& newThreadCache(ThreadCacheTlsEntry& entry);
+
+	ANKI_DONT_INLINE void* allocateSlow(ThreadCache& cache, U32 sizeClass);
+};
+
+Atomic<U32> HeapMemoryPool::ThreadCachedAllocator::m_slots = {0};
+Atomic<U64> HeapMemoryPool::ThreadCachedAllocator::m_nextUuid = {1};
+thread_local Array<HeapMemoryPool::ThreadCachedAllocator::ThreadCacheTlsEntry, HeapMemoryPool::ThreadCachedAllocator::kMaxPools>
+	HeapMemoryPool::ThreadCachedAllocator::m_threadCacheTable;
+thread_local HeapMemoryPool::ThreadCachedAllocator::ThreadCacheReleaser HeapMemoryPool::ThreadCachedAllocator::m_threadCacheReleaser;
+SpinLock HeapMemoryPool::ThreadCachedAllocator::m_liveAllocatorsLock;
+Array<HeapMemoryPool::ThreadCachedAllocator*, HeapMemoryPool::ThreadCachedAllocator::kMaxPools>
+	HeapMemoryPool::ThreadCachedAllocator::m_liveAllocators = {};
+
+HeapMemoryPool::ThreadCachedAllocator::ThreadCacheReleaser::~ThreadCacheReleaser()
+{
+	LockGuard<SpinLock> lock(m_liveAllocatorsLock);
+	for(U32 slot = 0; slot < kMaxPools; ++slot)
+	{
+		const ThreadCacheTlsEntry& entry = m_threadCacheTable[slot];
+		const ThreadCachedAllocator* allocator = m_liveAllocators[slot];
+		if(entry.m_poolUuid != 0 && allocator && allocator->m_uuid == entry.m_poolUuid)
+		{
+			// The thread won't touch the cache again. The release pairs with the acquire of the thread that adopts it
+			entry.m_cache->m_owned.store(0, AtomicMemoryOrder::kRelease);
+		}
+	}
+}
+
+HeapMemoryPool::ThreadCachedAllocator::~ThreadCachedAllocator()
+{
+	{
+		// Wait for the exiting threads that might be orphaning caches of this allocator
+		LockGuard<SpinLock> lock(m_liveAllocatorsLock);
+		m_liveAllocators[m_slot] = nullptr;
+	}
+
+	for(Atomic<SpanMapNode*>& nodeSlot : m_spanMap)
+	{
+		SpanMapNode* node = nodeSlot.load();
+		if(!node)
+		{
+			continue;
+		}
+
+		for(Atomic<SpanMapLeaf*>& leafSlot : node->m_leaves)
+		{
+			SpanMapLeaf* leaf = leafSlot.load();
+			if(leaf)
+			{
+				leaf->~SpanMapLeaf();
+				m_allocCb(m_allocCbUserData, leaf, 0, 0);
+			}
+		}
+
+		node->~SpanMapNode();
+		m_allocCb(m_allocCbUserData, node, 0, 0);
+	}
+
+	ThreadCache* cache = m_threadCaches;
+	while(cache)
+	{
+		Span* span = cache->m_spans;
+		while(span)
+		{
+			Span* nextSpan = span->m_next;
+			m_allocCb(m_allocCbUserData, span, 0, 0);
+			span = nextSpan;
+		}
+
+		ThreadCache* next = cache->m_next;
+		cache->~ThreadCache();
+		m_allocCb(m_allocCbUserData, cache, 0, 0);
+		cache = next;
+	}
+}
+
+Bool HeapMemoryPool::ThreadCachedAllocator::acquireSlot(U32& slot)
+{
+	U32 slots = m_slots.load();
+	do
+	{
+		if(slots == kMaxU32)
+		{
+			return false;
+		}
+
+		slot = U32(std::countr_one(slots));
+	} while(!m_slots.compareExchange(slots, slots | (1u << slot)));
+
+	return true;
+}
+
+HeapMemoryPool::ThreadCachedAllocator::ThreadCache& HeapMemoryPool::ThreadCachedAllocator::newThreadCache(ThreadCacheTlsEntry& entry)
+{
+	// Make sure the releaser runs when the thread exits
+	[[maybe_unused]] ThreadCacheReleaser& releaser = m_threadCacheReleaser;
+
+	ThreadCache* cache = nullptr;
+	{
+		// Adopt the cache of a thread that exited
+		LockGuard<Mutex> lock(m_threadCachesMtx);
+		for(ThreadCache* it = m_threadCaches; it; it = it->m_next)
+		{
+			if(it->m_owned.load(AtomicMemoryOrder::kAcquire) == 0)
+			{
+				it->m_owned.store(1, AtomicMemoryOrder::kRelaxed);
+				cache = it;
+				break;
+			}
+		}
+	}
+
+	if(!cache)
+	{
+		cache = static_cast<ThreadCache*>(m_allocCb(m_allocCbUserData, nullptr, sizeof(ThreadCache), alignof(ThreadCache)));
+		if(!cache) [[unlikely]]
+		{
+			ANKI_OOM_ACTION();
+		}
+		::new(cache) ThreadCache();
+
+		LockGuard<Mutex> lock(m_threadCachesMtx);
+		cache->m_next = m_threadCaches;
+		m_threadCaches = cache;
+	}
+
+	entry.m_poolUuid = m_uuid;
+	entry.m_cache = cache;
+	return *cache;
+}
+
+void* HeapMemoryPool::ThreadCachedAllocator::allocateSlow(ThreadCache& cache, U32 sizeClass)
+{
+	Bin& bin = cache.m_bins[sizeClass];
+	ANKI_ASSERT(bin.m_freeList == nullptr);
+
+	// Take back what the other threads freed
+	if(cache.m_remoteFrees.load(AtomicMemoryOrder::kRelaxed))
+	{
+		FreeBlock* block = cache.m_remoteFrees.exchange(nullptr, AtomicMemoryOrder::kAcquire);
+		while(block)
+		{
+			FreeBlock* next = block->m_next;
+			const Span& span = getSpan(block);
+			ANKI_ASSERT(span.m_owner == &cache);
+			Bin& otherBin = cache.m_bins[span.m_sizeClass];
+			block->m_next = otherBin.m_freeList;
+			otherBin.m_freeList = block;
+			block = next;
+		}
+
+		if(bin.m_freeList)
+		{
+			void* out = bin.m_freeList;
+			bin.m_freeList = bin.m_freeList->m_next;
+			return out;
+		}
+	}
+
+	// Carve a new block
+	const U32 blockSize = kSizeClassSizes[sizeClass];
+	if(bin.m_carveOffset + blockSize > kSpanSize)
+	{
+		Span* span = static_cast<Span*>(m_allocCb(m_allocCbUserData, nullptr, kSpanSize, kSpanSize));
+		if(!span) [[unlikely]]
+		{
+			ANKI_OOM_ACTION();
+			return nullptr;
+		}
+
+		ANKI_ASSERT(isAligned(kSpanSize, span));
+		span->m_owner = &cache;
+		span->m_next = cache.m_spans;
+#if ANKI_MEM_EXTRA_CHECKS
+		span->m_allocator = this;
+#endif
+		span->m_sizeClass = sizeClass;
+		cache.m_spans = span;
+		addToSpanMap(*span);
+		ownerAdd(cache.m_reservedBytes, kSpanSize);
+
+		bin.m_span = span;
+		bin.m_carveOffset = kSpanHeaderSize;
+	}
+
+	void* out = reinterpret_cast<U8*>(bin.m_span) + bin.m_carveOffset;
+	bin.m_carveOffset += blockSize;
+	return out;
+}
+
+void* HeapMemoryPool::ThreadCachedAllocator::allocateLarge(PtrSize size, PtrSize alignment)
+{
+	alignment = max<PtrSize>(alignment, alignof(LargeBlockHeader));
+	const PtrSize offset = getAlignedRoundUp(alignment, sizeof(LargeBlockHeader));
+	U8* block = static_cast<U8*>(m_allocCb(m_allocCbUserData, nullptr, offset + size, alignment));
+	if(!block) [[unlikely]]
+	{
+		ANKI_OOM_ACTION();
+		return nullptr;
+	}
+
+	U8* out = block + offset;
+	LargeBlockHeader& header = *(reinterpret_cast<LargeBlockHeader*>(out) - 1);
+	header.m_block = block;
+#if ANKI_MEM_EXTRA_CHECKS
+	header.m_allocator = this;
+#endif
+	m_largeAllocationCount.fetchAdd(1);
+
+	ANKI_ASSERT(!isInSmallSpan(out));
+	return out;
+}
+
+void HeapMemoryPool::ThreadCachedAllocator::freeLarge(void* ptr)
+{
+	const LargeBlockHeader& header = *(static_cast<const LargeBlockHeader*>(ptr) - 1);
+#if ANKI_MEM_EXTRA_CHECKS
+	if(header.m_allocator != this)
+	{
+		ANKI_UTIL_LOGF("The memory doesn't belong to this pool");
+	}
+#endif
+
+	m_largeAllocationCount.fetchSub(1);
+	m_allocCb(m_allocCbUserData, header.m_block, 0, 0);
+}
+
+void HeapMemoryPool::ThreadCachedAllocator::addToSpanMap(const Span& span)
+{
+	const PtrSize spanIdx = ptrToNumber(&span) / kSpanSize;
+	if(spanIdx >> (2 * kSpanMapNodeBits + kSpanMapLeafBits)) [[unlikely]]
+	{
+		ANKI_UTIL_LOGF("The address of the span is outside of the span map");
+	}
+
+	SpanMapNode& node = getOrCreateSpanMapNode(m_spanMap[spanIdx >> (kSpanMapNodeBits + kSpanMapLeafBits)]);
+	SpanMapLeaf& leaf = getOrCreateSpanMapNode(node.m_leaves[(spanIdx >> kSpanMapLeafBits) & ((1u << kSpanMapNodeBits) - 1)]);
+
+	const U32 bit = U32(spanIdx & ((1u << kSpanMapLeafBits) - 1));
+	leaf.m_bits[bit / 64].fetchOr(1_U64 << (bit % 64), AtomicMemoryOrder::kRelaxed);
+}
+
+template<typename TNode>
+TNode& HeapMemoryPool::ThreadCachedAllocator::getOrCreateSpanMapNode(Atomic<TNode*>& slot)
+{
+	TNode* node = slot.load(AtomicMemoryOrder::kAcquire);
+	if(node) [[likely]]
+	{
+		return *node;
+	}
+
+	TNode* newNode = static_cast<TNode*>(m_allocCb(m_allocCbUserData, nullptr, sizeof(TNode), alignof(TNode)));
+	if(!newNode) [[unlikely]]
+	{
+		ANKI_OOM_ACTION();
+	}
+	::new(newNode) TNode();
+
+	// Other threads might be adding spans of the same range
+	if(slot.compareExchange(node, newNode, AtomicMemoryOrder::kAcqRel, AtomicMemoryOrder::kAcquire))
+	{
+		return *newNode;
+	}
+
+	newNode->~TNode();
+	m_allocCb(m_allocCbUserData, newNode, 0, 0);
+	return *node;
+}
+
+U32 HeapMemoryPool::ThreadCachedAllocator::getAllocationCount() const
+{
+	U64 count = m_largeAllocationCount.load();
+	LockGuard<Mutex> lock(m_threadCachesMtx);
+	for(const ThreadCache* cache = m_threadCaches; cache; cache = cache->m_next)
+	{
+		count += cache->m_allocationCount.load(AtomicMemoryOrder::kRelaxed) - cache->m_freeCount.load(AtomicMemoryOrder::kRelaxed)
+				 - cache->m_remoteFreeCount.load(AtomicMemoryOrder::kRelaxed);
+	}
+
+	return U32(count);
+}
+
+void HeapMemoryPool::ThreadCachedAllocator::getStats(HeapMemoryPoolStats& stats) const
+{
+	stats.m_largeAllocations = m_largeAllocationCount.load();
+
+	LockGuard<Mutex> lock(m_threadCachesMtx);
+	for(const ThreadCache* cache = m_threadCaches; cache; cache = cache->m_next)
+	{
+		stats.m_cacheHits += cache->m_cacheHits.load(AtomicMemoryOrder::kRelaxed);
+		stats.m_cacheMisses += cache->m_cacheMisses.load(AtomicMemoryOrder::kRelaxed);
+		stats.m_remoteFrees += cache->m_remoteFreeCount.load(AtomicMemoryOrder::kRelaxed);
+		stats.m_reservedBytes += cache->m_reservedBytes.load(AtomicMemoryOrder::kRelaxed);
+		stats.m_usedBytes += cache->m_allocatedBytes.load(AtomicMemoryOrder::kRelaxed) - cache->m_freedBytes.load(AtomicMemoryOrder::kRelaxed)
+							 - cache->m_remoteFreedBytes.load(AtomicMemoryOrder::kRelaxed);
+		++stats.m_threadCacheCount;
+	}
+}
+
+void HeapMemoryPool::init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name, HeapMemoryPoolMode mode)
 {
 	BaseMemoryPool::init(allocCb, allocCbUserData, name);
 #if ANKI_MEM_EXTRA_CHECKS
 	m_signature = computePoolSignature(this);
 #endif
+
+	if(mode == HeapMemoryPoolMode::kThreadCached)
+	{
+		U32 slot;
+		if(ThreadCachedAllocator::acquireSlot(slot))
+		{
+			m_threadCache = static_cast<ThreadCachedAllocator*>(
+				m_allocCb(m_allocCbUserData, nullptr, sizeof(ThreadCachedAllocator), alignof(ThreadCachedAllocator)));
+			::new(m_threadCache) ThreadCachedAllocator(m_allocCb, m_allocCbUserData, slot);
+		}
+		else
+		{
+			ANKI_UTIL_LOGW("Too many thread cached memory pools. Falling back to passthrough: %s", getName());
+		}
+	}
 }
 
 void HeapMemoryPool::destroy()
 {
-	const U32 count = m_allocationCount.load();
+	const U32 count = getAllocationCount();
 	if(count != 0)
 	{
 		ANKI_UTIL_LOGE("Memory pool destroyed before all memory being released (%u deallocations missed): %s", count, getName());
 	}
+
+	if(m_threadCache)
+	{
+		const U32 slot = m_threadCache->getSlot();
+		m_threadCache->~ThreadCachedAllocator();
+		m_allocCb(m_allocCbUserData, m_threadCache, 0, 0);
+		m_threadCache = nullptr;
+		ThreadCachedAllocator::releaseSlot(slot);
+	}
+
 	BaseMemoryPool::destroy();
 }
 
 void* HeapMemoryPool::allocate(PtrSize size, PtrSize alignment)
 {
 	ANKI_ASSERT(size > 0);
+
+	if(m_threadCache)
+	{
+		return (ThreadCachedAllocator::isSmall(size, alignment)) ? m_threadCache->allocate(size, alignment)
+																 : m_threadCache->allocateLarge(size, alignment);
+	}
+
 #if ANKI_MEM_EXTRA_CHECKS
 	ANKI_ASSERT(alignment <= kExtraChecksMaxAlignment && "Wrong assumption");
 	size += kAllocationHeaderSize;
@@ -219,6 +920,12 @@ void HeapMemoryPool::free(void* ptr)
 		return;
 	}
 
+	if(m_threadCache)
+	{
+		m_threadCache->free(ptr);
+		return;
+	}
+
 #if ANKI_MEM_EXTRA_CHECKS
 	U8* memU8 = static_cast<U8*>(ptr) - kAllocationHeaderSize;
 	AllocationHeader& header = *reinterpret_cast<AllocationHeader*>(memU8);
@@ -234,6 +941,20 @@ void HeapMemoryPool::free(void* ptr)
 	m_allocCb(m_allocCbUserData, ptr, 0, 0);
 }
 
+U32 HeapMemoryPool::getAllocationCount() const
+{
+	return m_allocationCount.load() + ((m_threadCache) ? m_threadCache->getAllocationCount() : 0);
+}
+
+void HeapMemoryPool::getStats(HeapMemoryPoolStats& stats) const
+{
+	stats = {};
+	if(m_threadCache)
+	{
+		m_threadCache->getStats(stats);
+	}
+}
+
 Error StackMemoryPool::StackAllocatorBuilderInterface::allocateChunk(PtrSize size, Chunk*& out)
 {
 	ANKI_ASSERT(size > 0);
@@ -42,6 +42,9 @@ using PoolSignature = U32;
 /// @return On allocation mode it will return the newelly allocated block or nullptr on error. On deallocation returns nullptr
 void* allocAligned(void* userData, void* ptr, PtrSize size, PtrSize alignment);
 
+// Forward
+class MemoryPoolTelemetry;
+
 /// Generic memory pool. The base of HeapMemoryPool or StackMemoryPool.
 class BaseMemoryPool
 {
@@ -77,7 +80,7 @@ public:
 	}
 
 	/// Return number of allocations
-	U32 getAllocationCount() const
+	virtual U32 getAllocationCount() const
 	{
 		return m_allocationCount.load();
 	}
@@ -88,6 +91,9 @@ public:
 		return (m_name) ? m_name : "Unamed";
 	}
 
+	/// Get the telemetry that tracks the pool. It's nullptr if the pool wasn't initialized with MemoryPoolTelemetry::allocCallback.
+	const MemoryPoolTelemetry* getTelemetry() const;
+
 protected:
 	/// Pool type.
 	enum class Type : U8
@@ -123,7 +129,40 @@ private:
 	Type m_type = Type::kNone;
 };
 
-/// A dummy interface to match the StackMemoryPool interfaces in order to be used by the same allocator template.
+/// How HeapMemoryPool serves the allocations.
+enum class HeapMemoryPoolMode : U8
+{
+	kPassthrough, ///< Forward every allocate() and free() to the AllocAlignedCallback.
+	kThreadCached ///< Small allocations are served by per-thread size class caches. The rest get a block of their own from the AllocAlignedCallback.
+};
+
+/// Statistics of a HeapMemoryPool in HeapMemoryPoolMode::kThreadCached mode.
+class HeapMemoryPoolStats
+{
+public:
+	U64 m_cacheHits = 0; ///< Small allocations served by the free list of the thread.
+	U64 m_cacheMisses = 0; ///< Small allocations that had to carve a new block.
+	U64 m_remoteFrees = 0; ///< Small allocations freed by a thread other than the one that allocated them.
+	U64 m_largeAllocations = 0; ///< Live allocations that are too large or too aligned for the size classes.
+	PtrSize m_reservedBytes = 0; ///< Memory the size classes got from the AllocAlignedCallback.
+	PtrSize m_usedBytes = 0; ///< The part of m_reservedBytes that is handed out.
+	U32 m_threadCacheCount = 0;
+
+	F64 getHitRate() const
+	{
+		const U64 total = m_cacheHits + m_cacheMisses;
+		return (total) ? F64(m_cacheHits) / F64(total) : 1.0;
+	}
+
+	/// The part of the reserved memory that is not handed out (free blocks and size class rounding).
+	F64 getFragmentation() const
+	{
+		return (m_reservedBytes) ? 1.0 - F64(m_usedBytes) / F64(m_reservedBytes) : 0.0;
+	}
+};
+
+/// A dummy interface to match the StackMemoryPool interfaces in order to be used by the same allocator template. In
+/// HeapMemoryPoolMode::kThreadCached mode it's a thread caching allocator instead.
 class HeapMemoryPool : public BaseMemoryPool
 {
 public:
@@ -134,10 +173,11 @@ public:
 	}
 
 	/// @see init
-	HeapMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name = nullptr)
+	HeapMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name = nullptr,
+				   HeapMemoryPoolMode mode = HeapMemoryPoolMode::kPassthrough)
 		: HeapMemoryPool()
 	{
-		init(allocCb, allocCbUserData, name);
+		init(allocCb, allocCbUserData, name, mode);
 	}
 
 	/// Destroy
@@ -150,7 +190,9 @@ public:
 	/// @param allocCb The allocation function callback.
 	/// @param allocCbUserData The user data to pass to the allocation function.
 	/// @param name An optional name.
-	void init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name = nullptr);
+	/// @param mode See HeapMemoryPoolMode.
+	void init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name = nullptr,
+			  HeapMemoryPoolMode mode = HeapMemoryPoolMode::kPassthrough);
 
 	/// Manual destroy. The destructor calls that as well.
 	void destroy();
@@ -162,7 +204,22 @@ public:
 	/// @param[in, out] ptr Memory block to deallocate.
 	void free(void* ptr);
 
+	U32 getAllocationCount() const override;
+
+	HeapMemoryPoolMode getMode() const
+	{
+		return (m_threadCache) ? HeapMemoryPoolMode::kThreadCached : HeapMemoryPoolMode::kPassthrough;
+	}
+
+	/// Get the statistics of the thread caches. They are all zero in HeapMemoryPoolMode::kPassthrough mode.
+	/// @note It's thread-safe but the values are approximate if other threads allocate at the same time.
+	void getStats(HeapMemoryPoolStats& stats) const;
+
 private:
+	class ThreadCachedAllocator;
+
+	ThreadCachedAllocator* m_threadCache = nullptr;
+
 #if ANKI_MEM_EXTRA_CHECKS
 	PoolSignature m_signature = 0;
 #endif
@@ -175,8 +232,8 @@ class DefaultMemoryPool : public HeapMemoryPool, public MakeSingleton<DefaultMem
 	friend class MakeSingleton;
 
 private:
-	DefaultMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData)
-		: HeapMemoryPool(allocCb, allocCbUserData, "DefaultMemPool")
+	DefaultMemoryPool(AllocAlignedCallback allocCb, void* allocCbUserData, HeapMemoryPoolMode mode = HeapMemoryPoolMode::kPassthrough)
+		: HeapMemoryPool(allocCb, allocCbUserData, "DefaultMemPool", mode)
 	{
 	}
 
@@ -247,6 +304,13 @@ public:
 		return m_builder.getMemoryCapacity();
 	}
 
+	/// Get the memory that was allocated since the last reset.
+	/// @note It's not thread safe with other methods.
+	PtrSize getMemoryUsage() const
+	{
+		return m_builder.getMemoryUsage();
+	}
+
 private:
 	/// This is the absolute max alignment.
 	static constexpr U32 kMaxAlignment = ANKI_SAFE_ALIGNMENT;
@@ -0,0 +1,122 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/MemoryPoolTelemetry.h>
+#include <AnKi/Util/Functions.h>
+#include <bit>
+
+namespace anki {
+
+/// Lives right before the memory that is handed out.
+class alignas(16) MemoryPoolTelemetryHeader
+{
+public:
+	PtrSize m_size; ///< The size the user asked for.
+	PtrSize m_offset; ///< The offset from the memory of the callback to the memory that is handed out.
+};
+
+static_assert(sizeof(MemoryPoolTelemetryHeader) == 16);
+
+static U32 getHistogramBucket(PtrSize size)
+{
+	const U32 log2 = (size) ? U32(std::bit_width(size)) - 1 : 0;
+	return min(max(log2, 3u) - 3u, MemoryPoolTelemetry::kHistogramBucketCount - 1);
+}
+
+void MemoryPoolTelemetry::init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name)
+{
+	ANKI_ASSERT(allocCb && allocCb != allocCallback);
+	ANKI_ASSERT(!isInitialized());
+
+	m_allocCb = allocCb;
+	m_allocCbUserData = allocCbUserData;
+	if(name)
+	{
+		m_name = name;
+	}
+
+	for(Atomic<U64>& count : m_histogram)
+	{
+		count.setNonAtomically(0);
+	}
+}
+
+void* MemoryPoolTelemetry::allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment)
+{
+	ANKI_ASSERT(userData);
+	MemoryPoolTelemetry& self = *static_cast<MemoryPoolTelemetry*>(userData);
+	ANKI_ASSERT(self.isInitialized());
+
+	if(ptr == nullptr)
+	{
+		// Allocate. The header goes right before the returned memory so pad the front to keep the alignment
+		ANKI_ASSERT(size > 0 && isPowerOfTwo(alignment));
+		const PtrSize offset = max<PtrSize>(alignment, sizeof(MemoryPoolTelemetryHeader));
+
+		const PtrSize memAlignment = max(alignment, alignof(MemoryPoolTelemetryHeader));
+		U8* mem = static_cast<U8*>(self.m_allocCb(self.m_allocCbUserData, nullptr, size + offset, memAlignment));
+		if(!mem) [[unlikely]]
+		{
+			return nullptr;
+		}
+
+		U8* out = mem + offset;
+		MemoryPoolTelemetryHeader& header = *reinterpret_cast<MemoryPoolTelemetryHeader*>(out - sizeof(MemoryPoolTelemetryHeader));
+		header.m_size = size;
+		header.m_offset = offset;
+
+		const PtrSize liveBytes = self.m_liveBytes.fetchAdd(size) + size;
+		PtrSize peakBytes = self.m_peakBytes.load();
+		while(liveBytes > peakBytes && !self.m_peakBytes.compareExchange(peakBytes, liveBytes))
+		{
+		}
+
+		self.m_allocationCount.fetchAdd(1);
+		self.m_histogram[getHistogramBucket(size)].fetchAdd(1);
+
+		return out;
+	}
+	else
+	{
+		// Free
+		U8* mem = static_cast<U8*>(ptr);
+		const MemoryPoolTelemetryHeader& header = *reinterpret_cast<const MemoryPoolTelemetryHeader*>(mem - sizeof(MemoryPoolTelemetryHeader));
+		ANKI_ASSERT(header.m_size > 0 && header.m_offset >= sizeof(MemoryPoolTelemetryHeader));
+
+		self.m_liveBytes.fetchSub(header.m_size);
+		self.m_freeCount.fetchAdd(1);
+
+		self.m_allocCb(self.m_allocCbUserData, mem - header.m_offset, 0, 0);
+		return nullptr;
+	}
+}
+
+void MemoryPoolTelemetry::getHistogram(Array<U64, kHistogramBucketCount>& histogram) const
+{
+	for(U32 i = 0; i < kHistogramBucketCount; ++i)
+	{
+		histogram[i] = m_histogram[i].load();
+	}
+}
+
+void MemoryPoolTelemetry::endFrame()
+{
+	const U64 allocationCount = m_allocationCount.load();
+	const U64 freeCount = m_freeCount.load();
+	m_frameAllocationCount = allocationCount - m_prevAllocationCount;
+	m_frameFreeCount = freeCount - m_prevFreeCount;
+	m_prevAllocationCount = allocationCount;
+	m_prevFreeCount = freeCount;
+
+	Array<U64, kHistogramBucketCount> histogram;
+	getHistogram(histogram);
+	for(U32 i = 0; i < kHistogramBucketCount; ++i)
+	{
+		m_frameHistogram[i] = histogram[i] - m_prevHistogram[i];
+	}
+	m_prevHistogram = histogram;
+}
+
+} // end namespace anki
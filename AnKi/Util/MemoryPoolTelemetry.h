@@ -0,0 +1,135 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/MemoryPool.h>
+#include <AnKi/Util/Array.h>
+
+namespace anki {
+
+/// @addtogroup util_memory
+/// @{
+
+/// Opt-in statistics of the memory that goes through an AllocAlignedCallback: live bytes, peak bytes, allocation rate and a histogram of the
+/// allocation sizes. It sits between the memory pools and the real callback. Pass allocCallback() and the telemetry object as the user data to
+/// the pools to track them. Every allocation gets a small header to remember its size.
+/// @code
+/// MemoryPoolTelemetry telemetry;
+/// telemetry.init(allocAligned, nullptr, "Scene");
+/// HeapMemoryPool pool(MemoryPoolTelemetry::allocCallback, &telemetry);
+/// @endcode
+class MemoryPoolTelemetry
+{
+public:
+	/// Bucket 0 counts the allocations smaller than 16 bytes. Bucket N counts the allocations in [2^(N+3), 2^(N+4)) and the last one everything
+	/// larger than that.
+	static constexpr U32 kHistogramBucketCount = 16;
+
+	MemoryPoolTelemetry() = default;
+
+	MemoryPoolTelemetry(const MemoryPoolTelemetry&) = delete; // Non-copyable
+
+	~MemoryPoolTelemetry() = default;
+
+	MemoryPoolTelemetry& operator=(const MemoryPoolTelemetry&) = delete; // Non-copyable
+
+	/// Init.
+	/// @param allocCb The callback that will do the actual allocations.
+	/// @param allocCbUserData The user data of allocCb.
+	/// @param name The name of the pool or the subsystem that is tracked. The object doesn't copy the string so it should outlive the object.
+	void init(AllocAlignedCallback allocCb, void* allocCbUserData, const Char* name);
+
+	/// The AllocAlignedCallback to pass to the memory pools. The user data is the MemoryPoolTelemetry.
+	static void* allocCallback(void* userData, void* ptr, PtrSize size, PtrSize alignment);
+
+	Bool isInitialized() const
+	{
+		return m_allocCb != nullptr;
+	}
+
+	const Char* getName() const
+	{
+		return m_name;
+	}
+
+	/// The bytes that are currently allocated. It doesn't count the headers.
+	PtrSize getLiveBytes() const
+	{
+		return m_liveBytes.load(AtomicMemoryOrder::kRelaxed);
+	}
+
+	/// The max of getLiveBytes() since init.
+	PtrSize getPeakBytes() const
+	{
+		return m_peakBytes.load(AtomicMemoryOrder::kRelaxed);
+	}
+
+	/// The number of allocations that haven't been freed.
+	U64 getLiveAllocationCount() const
+	{
+		return m_allocationCount.load(AtomicMemoryOrder::kRelaxed) - m_freeCount.load(AtomicMemoryOrder::kRelaxed);
+	}
+
+	/// The number of allocations since init.
+	U64 getAllocationCount() const
+	{
+		return m_allocationCount.load(AtomicMemoryOrder::kRelaxed);
+	}
+
+	/// The number of allocations in the frame that endFrame() closed last.
+	U64 getFrameAllocationCount() const
+	{
+		return m_frameAllocationCount;
+	}
+
+	/// The number of frees in the frame that endFrame() closed last.
+	U64 getFrameFreeCount() const
+	{
+		return m_frameFreeCount;
+	}
+
+	/// The histogram of all allocations since init.
+	void getHistogram(Array<U64, kHistogramBucketCount>& histogram) const;
+
+	/// The histogram of the allocations of the frame that endFrame() closed last.
+	void getFrameHistogram(Array<U64, kHistogramBucketCount>& histogram) const
+	{
+		histogram = m_frameHistogram;
+	}
+
+	/// The smallest allocation size that goes to a bucket of the histogram.
+	static PtrSize getHistogramBucketMinSize(U32 bucket)
+	{
+		ANKI_ASSERT(bucket < kHistogramBucketCount);
+		return (bucket == 0) ? 0 : PtrSize(8) << bucket;
+	}
+
+	/// Close the current frame and compute the per-frame counters.
+	/// @note It's thread-safe with the allocations but not with itself.
+	void endFrame();
+
+private:
+	AllocAlignedCallback m_allocCb = nullptr;
+	void* m_allocCbUserData = nullptr;
+	const Char* m_name = "Unamed";
+
+	Atomic<PtrSize> m_liveBytes = {0};
+	Atomic<PtrSize> m_peakBytes = {0};
+	Atomic<U64> m_allocationCount = {0};
+	Atomic<U64> m_freeCount = {0};
+	Array<Atomic<U64>, kHistogramBucketCount> m_histogram; ///< Zeroed by init().
+
+	// Per-frame stuff. Only endFrame() touches them
+	U64 m_frameAllocationCount = 0;
+	U64 m_frameFreeCount = 0;
+	U64 m_prevAllocationCount = 0;
+	U64 m_prevFreeCount = 0;
+	Array<U64, kHistogramBucketCount> m_frameHistogram = {};
+	Array<U64, kHistogramBucketCount> m_prevHistogram = {};
+};
+/// @}
+
+} // end namespace anki
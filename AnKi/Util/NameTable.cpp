@@ -0,0 +1,170 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/NameTable.h>
+#include <AnKi/Util/Logger.h>
+
+namespace anki {
+
+NameTable::NameTable()
+{
+	m_stringPool.init(DefaultMemoryPool::getSingleton().getAllocationCallback(), DefaultMemoryPool::getSingleton().getAllocationCallbackUserData(),
+					  64_KB, 2.0, 0, true, 1, "NameTableStrings");
+}
+
+NameTable::~NameTable()
+{
+	for(Entry* page : m_pages)
+	{
+		if(page)
+		{
+			DefaultMemoryPool::getSingleton().free(page);
+		}
+	}
+
+	if(m_buckets)
+	{
+		DefaultMemoryPool::getSingleton().free(m_buckets);
+	}
+}
+
+U32 NameTable::findInternal(CString str, U64 hash) const
+{
+	if(m_bucketCount == 0)
+	{
+		return 0;
+	}
+
+	const U32 length = str.getLength();
+	U32 bucket = U32(hash) & (m_bucketCount - 1);
+	while(m_buckets[bucket])
+	{
+		const Entry& entry = getEntry(m_buckets[bucket]);
+		if(entry.m_hash == hash && entry.m_length == length && memcmp(entry.m_str, str.cstr(), length) == 0)
+		{
+			return m_buckets[bucket];
+		}
+
+		bucket = (bucket + 1) & (m_bucketCount - 1);
+	}
+
+	return 0;
+}
+
+Name NameTable::find(CString str) const
+{
+	Name out;
+	if(!str.isEmpty())
+	{
+		const U64 hash = str.computeHash();
+		RLockGuard lock(m_mtx);
+		out.m_id = findInternal(str, hash);
+	}
+
+	return out;
+}
+
+Name NameTable::intern(CString str)
+{
+	Name out;
+	if(str.isEmpty())
+	{
+		return out;
+	}
+
+	const U64 hash = str.computeHash();
+
+	// Most of the times the string is already there
+	{
+		RLockGuard lock(m_mtx);
+		out.m_id = findInternal(str, hash);
+	}
+
+	if(out.m_id)
+	{
+		return out;
+	}
+
+	WLockGuard lock(m_mtx);
+
+	// Someone might have added it while the lock was released
+	out.m_id = findInternal(str, hash);
+	if(out.m_id)
+	{
+		return out;
+	}
+
+	const U32 idx = m_nameCount.load(AtomicMemoryOrder::kRelaxed);
+	const U32 pageIdx = idx >> kEntriesPerPageLog2;
+	if(pageIdx >= kMaxPageCount) [[unlikely]]
+	{
+		ANKI_UTIL_LOGF("Too many interned names");
+	}
+
+	if(m_pages[pageIdx] == nullptr)
+	{
+		m_pages[pageIdx] = static_cast<Entry*>(DefaultMemoryPool::getSingleton().allocate(sizeof(Entry) * kEntriesPerPage, alignof(Entry)));
+	}
+
+	const U32 length = str.getLength();
+	Char* strCopy = static_cast<Char*>(m_stringPool.allocate(length + 1, 1));
+	memcpy(strCopy, str.cstr(), length + 1);
+
+	Entry& entry = m_pages[pageIdx][idx & (kEntriesPerPage - 1)];
+	entry.m_str = strCopy;
+	entry.m_hash = hash;
+	entry.m_length = length;
+
+	out.m_id = idx + 1;
+	m_nameCount.store(idx + 1, AtomicMemoryOrder::kRelease);
+
+	// Keep the load factor under 0.5
+	if((idx + 1) * 2 > m_bucketCount)
+	{
+		growBuckets();
+	}
+	else
+	{
+		U32 bucket = U32(hash) & (m_bucketCount - 1);
+		while(m_buckets[bucket])
+		{
+			bucket = (bucket + 1) & (m_bucketCount - 1);
+		}
+
+		m_buckets[bucket] = out.m_id;
+	}
+
+	return out;
+}
+
+void NameTable::growBuckets()
+{
+	const U32 newBucketCount = max(m_bucketCount * 2, 1024u);
+	U32* newBuckets = static_cast<U32*>(DefaultMemoryPool::getSingleton().allocate(sizeof(U32) * newBucketCount, alignof(U32)));
+	memset(newBuckets, 0, sizeof(U32) * newBucketCount);
+
+	// Re-insert all names. The new name is already in the entries
+	const U32 nameCount = getNameCount();
+	for(U32 id = 1; id <= nameCount; ++id)
+	{
+		U32 bucket = U32(getEntry(id).m_hash) & (newBucketCount - 1);
+		while(newBuckets[bucket])
+		{
+			bucket = (bucket + 1) & (newBucketCount - 1);
+		}
+
+		newBuckets[bucket] = id;
+	}
+
+	if(m_buckets)
+	{
+		DefaultMemoryPool::getSingleton().free(m_buckets);
+	}
+
+	m_buckets = newBuckets;
+	m_bucketCount = newBucketCount;
+}
+
+} // end namespace anki
@@ -0,0 +1,159 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/String.h>
+#include <AnKi/Util/Singleton.h>
+#include <AnKi/Util/Thread.h>
+#include <AnKi/Util/Array.h>
+
+namespace anki {
+
+/// @addtogroup util_containers
+/// @{
+
+/// A string that was interned in the NameTable. It's a 32-bit ID so copying and comparing names is an integer operation and the hash of the
+/// string is precomputed. The interned strings are not freed one by one so names and their CStrings stay valid until the NameTable is freed.
+class Name
+{
+	friend class NameTable;
+
+public:
+	/// Create an invalid name.
+	Name() = default;
+
+	/// Intern a string. An empty string gives an invalid name.
+	explicit Name(CString str);
+
+	Name(const Name& b) = default;
+
+	Name& operator=(const Name& b) = default;
+
+	/// Find a string that is already interned without interning it. Returns an invalid name if it's not found.
+	static Name find(CString str);
+
+	Bool isValid() const
+	{
+		return m_id != 0;
+	}
+
+	U32 getId() const
+	{
+		return m_id;
+	}
+
+	/// Get the string. It's empty for invalid names.
+	CString toCString() const;
+
+	/// The precomputed hash of the string. It's the same as CString::computeHash() of the string.
+	U64 computeHash() const;
+
+	Bool operator==(const Name& b) const
+	{
+		return m_id == b.m_id;
+	}
+
+	Bool operator!=(const Name& b) const
+	{
+		return m_id != b.m_id;
+	}
+
+private:
+	U32 m_id = 0;
+};
+
+/// The global table of interned strings. See Name. Its memory comes from the DefaultMemoryPool so allocate it after the pool and free it
+/// before.
+/// The table only grows while it's alive (up to kMaxPageCount * kEntriesPerPage names). Everything that interns strings adds to it, including
+/// BinaryLog that interns the names of the trace events and the counters. Don't intern strings that are generated at runtime without bound.
+/// Freeing the table releases all names at once.
+/// @note It's thread-safe. Getting the string and the hash of a Name is lock-free.
+class NameTable : public MakeSingleton<NameTable>
+{
+	friend class Name;
+
+public:
+	NameTable();
+
+	NameTable(const NameTable&) = delete; // Non-copyable
+
+	~NameTable();
+
+	NameTable& operator=(const NameTable&) = delete; // Non-copyable
+
+	/// Intern a string or get the name of a string that is already interned.
+	Name intern(CString str);
+
+	/// Find a string that is already interned.
+	Name find(CString str) const;
+
+	/// Get the number of the interned strings.
+	U32 getNameCount() const
+	{
+		return m_nameCount.load(AtomicMemoryOrder::kRelaxed);
+	}
+
+private:
+	static constexpr U32 kEntriesPerPageLog2 = 12;
+	static constexpr U32 kEntriesPerPage = 1u << kEntriesPerPageLog2;
+	static constexpr U32 kMaxPageCount = 1024;
+
+	class Entry
+	{
+	public:
+		const Char* m_str;
+		U64 m_hash;
+		U32 m_length;
+	};
+
+	StackMemoryPool m_stringPool;
+
+	/// The entries of all names indexed by the ID. The pages never move so readers don't need the lock.
+	Array<Entry*, kMaxPageCount> m_pages = {};
+	Atomic<U32> m_nameCount = {0};
+
+	/// Open addressing hash table from the hash of the string to the ID. Zero is an empty bucket.
+	U32* m_buckets = nullptr;
+	U32 m_bucketCount = 0;
+
+	mutable RWMutex m_mtx;
+
+	const Entry& getEntry(U32 id) const
+	{
+		ANKI_ASSERT(id > 0 && id <= getNameCount());
+		const U32 idx = id - 1;
+		return m_pages[idx >> kEntriesPerPageLog2][idx & (kEntriesPerPage - 1)];
+	}
+
+	/// Returns zero if it's not found.
+	U32 findInternal(CString str, U64 hash) const;
+
+	void growBuckets();
+};
+
+inline Name::Name(CString str)
+	: m_id(NameTable::getSingleton().intern(str).m_id)
+{
+}
+
+inline Name Name::find(CString str)
+{
+	return NameTable::getSingleton().find(str);
+}
+
+inline CString Name::toCString() const
+{
+	return (m_id) ? CString(NameTable::getSingleton().getEntry(m_id).m_str) : CString();
+}
+
+inline U64 Name::computeHash() const
+{
+	ANKI_ASSERT(m_id);
+	return NameTable::getSingleton().getEntry(m_id).m_hash;
+}
+/// @}
+
+} // end namespace anki
@@ -8,6 +8,8 @@
 #include <AnKi/Util/Array.h>
 #include <AnKi/Util/DynamicArray.h>
 #include <AnKi/Util/StringList.h>
+#include <AnKi/Util/Atomic.h>
+#include <bit>
 
 namespace anki {
 
@@ -64,10 +66,16 @@ private:
 ///                    PtrSize getMinSizeAlignment() const;
 ///                    @endcode
 /// @tparam TLock User defined lock (eg Mutex).
+///
+/// Small allocations can optionally go through the bins (see initBins()). The bins are lock-free stacks of cached blocks, one for every size
+/// class. They are refilled and emptied in batches under the lock so threads that allocate and free small blocks rarely touch the lock.
 template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
 class SegregatedListsAllocatorBuilder
 {
 public:
+	/// The max allocation size initBins() accepts.
+	static constexpr PtrSize kMaxBinnedSize = 4_KB;
+
 	SegregatedListsAllocatorBuilder(const TMemoryPool& pool = TMemoryPool())
 		: m_chunks(pool)
 	{
@@ -87,11 +95,28 @@ public:
 	/// @note This is thread safe.
 	Error allocate(PtrSize size, PtrSize alignment, TChunk*& chunk, PtrSize& offset);
 
+	/// Same as allocate() but it only uses the free space of the existing chunks. It fails with Error::kOutOfMemory instead of allocating a new chunk
+	/// and it doesn't log in that case. It doesn't take blocks from the bins.
+	/// @note This is thread safe.
+	Error allocateWithoutNewChunk(PtrSize size, PtrSize alignment, TChunk*& chunk, PtrSize& offset);
+
 	/// Free memory.
 	/// @param chunk The chunk the allocation belongs to.
 	/// @param offset The memory offset inside the chunk.
+	/// @note This is thread safe.
 	void free(TChunk* chunk, PtrSize offset, PtrSize size);
 
+	/// Enable the bins. Allocations up to maxBinnedSize are rounded up to the size of their bin (multiples of 16 up to 256 and powers of two
+	/// after that) and are served by the bins.
+	/// @param maxBinnedSize The max size that goes through the bins. Can't be larger than kMaxBinnedSize.
+	/// @param blocksPerBin The max number of free blocks a bin can cache.
+	/// @note It's not thread safe and it should be called before any allocation.
+	void initBins(PtrSize maxBinnedSize, U32 blocksPerBin);
+
+	/// Return the blocks that the bins cache back to the free lists.
+	/// @note This is thread safe.
+	void flushBins();
+
 	/// Validate the internal structures. It's only used in testing.
 	Error validate() const;
 
@@ -118,12 +143,37 @@ private:
 	using FreeBlock = detail::SegregatedListsAllocatorBuilderFreeBlock;
 	using ChunksIterator = typename DynamicArray<TChunk*>::Iterator;
 
+	static constexpr U32 kBinCount = 20; ///< 16 bins for the multiples of 16 up to 256 and 4 for 512, 1K, 2K and 4K.
+
+	/// A free block that is cached in a bin.
+	class BinNode
+	{
+	public:
+		TChunk* m_chunk = nullptr;
+		PtrSize m_offset = 0;
+		Atomic<U32> m_next = {kMaxU32};
+	};
+
+	/// A bin has 2 lock-free stacks of BinNodes. One with the cached blocks and one with the nodes that are not used. The heads pack the index of
+	/// the top node with a counter that changes on every push and pop to avoid the ABA problem.
+	class alignas(ANKI_CACHE_LINE_SIZE) Bin
+	{
+	public:
+		Atomic<U64> m_blocks = {kMaxU32};
+		Atomic<U64> m_freeNodes = {kMaxU32};
+	};
+
 	TInterface m_interface; ///< The interface.
 
 	DynamicArray<TChunk*, TMemoryPool> m_chunks;
 
 	mutable TLock m_lock;
 
+	Array<Bin, kBinCount> m_bins;
+	DynamicArray<BinNode, TMemoryPool> m_binNodes;
+	PtrSize m_maxBinnedSize = 0; ///< Zero if the bins are disabled.
+	U32 m_blocksPerBin = 0;
+
 	TMemoryPool& getMemoryPool()
 	{
 		return m_chunks.getMemoryPool();
@@ -137,6 +187,49 @@ private:
 	/// Place a free block in one of the lists.
 	/// @param[in,out] chunk The input chunk. If it's freed the pointer will become null.
 	void placeFreeBlock(PtrSize address, PtrSize size, ChunksIterator chunkIt);
+
+	/// allocate() without the lock and the bins.
+	/// @param allowNewChunk If false it fails with Error::kOutOfMemory instead of allocating a new chunk. It doesn't log in that case.
+	Error allocateInternal(PtrSize size, PtrSize alignment, Bool allowNewChunk, TChunk*& chunk, PtrSize& offset);
+
+	/// allocateInternal() that tries the free lists, then flushes the bins and tries again and allocates a new chunk as the last resort. It expects
+	/// the lock to be held.
+	Error allocateInternalOrFlushBins(PtrSize size, PtrSize alignment, TChunk*& chunk, PtrSize& offset);
+
+	/// free() without the lock and the bins.
+	void freeInternal(TChunk* chunk, PtrSize offset, PtrSize size);
+
+	static U32 getBinIndex(PtrSize size)
+	{
+		ANKI_ASSERT(size > 0 && size <= kMaxBinnedSize);
+		return (size <= 256) ? U32((size + 15) / 16 - 1) : U32(16 + std::bit_width(size - 1) - 9);
+	}
+
+	static PtrSize getBinSize(U32 binIdx)
+	{
+		ANKI_ASSERT(binIdx < kBinCount);
+		return (binIdx < 16) ? PtrSize(binIdx + 1) * 16 : PtrSize(512) << (binIdx - 16);
+	}
+
+	/// The alignment all blocks of a bin have. It's the largest power of two that divides the size.
+	static PtrSize getBinAlignment(U32 binIdx)
+	{
+		const PtrSize size = getBinSize(binIdx);
+		return size & ~(size - 1);
+	}
+
+	void pushBinNode(Atomic<U64>& head, U32 nodeIdx);
+
+	U32 popBinNode(Atomic<U64>& head);
+
+	/// Allocate from a bin and refill it if it's empty.
+	Error allocateFromBin(U32 binIdx, TChunk*& chunk, PtrSize& offset);
+
+	/// Cache a block to a bin. If the bin is full return half of its blocks to the free lists.
+	void freeToBin(U32 binIdx, TChunk* chunk, PtrSize offset);
+
+	/// Move up to maxBlockCount blocks from a bin to the free lists. It expects the lock to be held.
+	void drainBin(U32 binIdx, U32 maxBlockCount);
 };
 /// @}
 
@@ -4,12 +4,18 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Util/SegregatedListsAllocatorBuilder.h>
+#include <numeric>
 
 namespace anki {
 
 template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
 SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::~SegregatedListsAllocatorBuilder()
 {
+	if(m_maxBinnedSize)
+	{
+		flushBins();
+	}
+
 	if(!m_chunks.isEmpty())
 	{
 		ANKI_UTIL_LOGE("Forgot to free memory");
@@ -258,6 +264,78 @@ Error SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::a
 																						PtrSize& outOffset)
 {
 	ANKI_ASSERT(origSize > 0 && origAlignment > 0);
+
+	if(origSize <= m_maxBinnedSize)
+	{
+		const U32 binIdx = getBinIndex(origSize);
+		const PtrSize binAlignment = getBinAlignment(binIdx);
+		if(isPowerOfTwo(origAlignment) && origAlignment <= binAlignment)
+		{
+			return allocateFromBin(binIdx, outChunk, outOffset);
+		}
+		else
+		{
+			// The alignment is too strict for the bin. Allocate a block that can still go to the bin when it's freed
+			LockGuard<TLock> lock(m_lock);
+			return allocateInternalOrFlushBins(getBinSize(binIdx), std::lcm(origAlignment, binAlignment), outChunk, outOffset);
+		}
+	}
+
+	LockGuard<TLock> lock(m_lock);
+	return allocateInternalOrFlushBins(origSize, origAlignment, outChunk, outOffset);
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+Error SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::allocateWithoutNewChunk(PtrSize origSize, PtrSize origAlignment,
+																							   TChunk*& outChunk, PtrSize& outOffset)
+{
+	ANKI_ASSERT(origSize > 0 && origAlignment > 0);
+
+	PtrSize size = origSize;
+	PtrSize alignment = origAlignment;
+	if(origSize <= m_maxBinnedSize)
+	{
+		// free() will give the block to a bin so allocate one that fits there
+		const U32 binIdx = getBinIndex(origSize);
+		size = getBinSize(binIdx);
+		alignment = std::lcm(origAlignment, getBinAlignment(binIdx));
+	}
+
+	LockGuard<TLock> lock(m_lock);
+	return allocateInternal(size, alignment, false, outChunk, outOffset);
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+Error SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::allocateInternalOrFlushBins(PtrSize size, PtrSize alignment,
+																										   TChunk*& outChunk, PtrSize& outOffset)
+{
+	Error err = allocateInternal(size, alignment, false, outChunk, outOffset);
+	if(err == Error::kOutOfMemory && m_maxBinnedSize > 0)
+	{
+		// The free memory might be cached in the bins of other sizes. Give it back to the free lists and try again
+		for(U32 binIdx = 0; binIdx < kBinCount; ++binIdx)
+		{
+			drainBin(binIdx, kMaxU32);
+		}
+
+		err = allocateInternal(size, alignment, false, outChunk, outOffset);
+	}
+
+	if(err == Error::kOutOfMemory)
+	{
+		// Nothing fits in the free lists, grow
+		err = allocateInternal(size, alignment, true, outChunk, outOffset);
+	}
+
+	return err;
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+Error SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::allocateInternal(PtrSize origSize, PtrSize origAlignment,
+																								Bool allowNewChunk, TChunk*& outChunk,
+																								PtrSize& outOffset)
+{
+	ANKI_ASSERT(origSize > 0 && origAlignment > 0);
 	const PtrSize size = getAlignedRoundUp(m_interface.getMinSizeAlignment(), origSize);
 	const PtrSize alignment = max<PtrSize>(m_interface.getMinSizeAlignment(), origAlignment);
 
@@ -269,8 +347,6 @@ Error SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::a
 		return Error::kOutOfMemory;
 	}
 
-	LockGuard<TLock> lock(m_lock);
-
 	// Sort the chunks because we want to try allocate from the least empty first
 	std::sort(m_chunks.getBegin(), m_chunks.getEnd(), [](const TChunk* a, const TChunk* b) {
 		return a->m_freeSize < b->m_freeSize;
@@ -314,7 +390,11 @@ Error SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::a
 		}
 	}
 
-	if(freeBlock == nullptr)
+	if(freeBlock == nullptr && !allowNewChunk)
+	{
+		return Error::kOutOfMemory;
+	}
+	else if(freeBlock == nullptr)
 	{
 		// No free blocks, allocate new chunk
 
@@ -388,7 +468,20 @@ void SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::fr
 {
 	ANKI_ASSERT(chunk && size);
 
+	if(size <= m_maxBinnedSize)
+	{
+		freeToBin(getBinIndex(size), chunk, offset);
+		return;
+	}
+
 	LockGuard<TLock> lock(m_lock);
+	freeInternal(chunk, offset, size);
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+void SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::freeInternal(TChunk* chunk, PtrSize offset, PtrSize size)
+{
+	ANKI_ASSERT(chunk && size);
 
 	ChunksIterator it = m_chunks.getBegin();
 	for(; it != m_chunks.getEnd(); ++it)
@@ -405,6 +498,183 @@ void SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::fr
 	placeFreeBlock(offset, size, it);
 }
 
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+void SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::initBins(PtrSize maxBinnedSize, U32 blocksPerBin)
+{
+	ANKI_ASSERT(m_maxBinnedSize == 0 && "Already initialized");
+	ANKI_ASSERT(maxBinnedSize > 0 && maxBinnedSize <= kMaxBinnedSize && blocksPerBin > 0);
+	ANKI_ASSERT(isAligned(m_interface.getMinSizeAlignment(), getBinSize(0)) && "The bin sizes should respect the min size alignment");
+
+	const U32 binCount = getBinIndex(maxBinnedSize) + 1;
+	m_binNodes.resize(binCount * blocksPerBin);
+
+	for(U32 binIdx = 0; binIdx < binCount; ++binIdx)
+	{
+		for(U32 i = 0; i < blocksPerBin; ++i)
+		{
+			pushBinNode(m_bins[binIdx].m_freeNodes, binIdx * blocksPerBin + i);
+		}
+	}
+
+	m_maxBinnedSize = maxBinnedSize;
+	m_blocksPerBin = blocksPerBin;
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+void SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::flushBins()
+{
+	LockGuard<TLock> lock(m_lock);
+
+	for(U32 binIdx = 0; binIdx < kBinCount; ++binIdx)
+	{
+		drainBin(binIdx, kMaxU32);
+	}
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+void SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::pushBinNode(Atomic<U64>& head, U32 nodeIdx)
+{
+	U64 crntHead = head.load();
+	while(true)
+	{
+		m_binNodes[nodeIdx].m_next.store(U32(crntHead));
+		const U64 newHead = (((crntHead >> 32) + 1) << 32) | nodeIdx;
+		if(head.compareExchange(crntHead, newHead))
+		{
+			break;
+		}
+	}
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+U32 SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::popBinNode(Atomic<U64>& head)
+{
+	U64 crntHead = head.load();
+	while(true)
+	{
+		const U32 nodeIdx = U32(crntHead);
+		if(nodeIdx == kMaxU32)
+		{
+			return kMaxU32;
+		}
+
+		// The node might have been popped by another thread already. Its next will be garbage but the CAS will fail because the counter changed
+		const U64 newHead = (((crntHead >> 32) + 1) << 32) | m_binNodes[nodeIdx].m_next.load();
+		if(head.compareExchange(crntHead, newHead))
+		{
+			return nodeIdx;
+		}
+	}
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+Error SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::allocateFromBin(U32 binIdx, TChunk*& outChunk, PtrSize& outOffset)
+{
+	Bin& bin = m_bins[binIdx];
+
+	U32 nodeIdx = popBinNode(bin.m_blocks);
+	if(nodeIdx != kMaxU32) [[likely]]
+	{
+		outChunk = m_binNodes[nodeIdx].m_chunk;
+		outOffset = m_binNodes[nodeIdx].m_offset;
+		pushBinNode(bin.m_freeNodes, nodeIdx);
+		return Error::kNone;
+	}
+
+	// The bin is empty, refill it. Allocate a few blocks at once, keep the 1st and cache the rest
+	const PtrSize binSize = getBinSize(binIdx);
+	const PtrSize binAlignment = getBinAlignment(binIdx);
+	U32 blockCount = U32(min<PtrSize>(max(m_blocksPerBin / 2, 1u), max<PtrSize>(64_KB / binSize, 1)));
+
+	LockGuard<TLock> lock(m_lock);
+
+	if(findClass(blockCount * binSize, binAlignment) == kMaxU32)
+	{
+		blockCount = 1;
+	}
+
+	// Refill from the free lists if they have the space. Growing for the extra blocks would waste memory so if only a single block fits take that
+	// and grow only if nothing fits
+	TChunk* chunk;
+	PtrSize offset;
+	Error err = Error::kOutOfMemory;
+	if(blockCount > 1)
+	{
+		err = allocateInternal(blockCount * binSize, binAlignment, false, chunk, offset);
+	}
+
+	if(err)
+	{
+		blockCount = 1;
+		err = allocateInternalOrFlushBins(binSize, binAlignment, chunk, offset);
+	}
+	ANKI_CHECK(err);
+
+	for(U32 i = 1; i < blockCount; ++i)
+	{
+		const PtrSize blockOffset = offset + i * binSize;
+
+		nodeIdx = popBinNode(bin.m_freeNodes);
+		if(nodeIdx == kMaxU32)
+		{
+			// Other threads filled the bin in the meantime, give back the rest
+			freeInternal(chunk, blockOffset, (blockCount - i) * binSize);
+			break;
+		}
+
+		m_binNodes[nodeIdx].m_chunk = chunk;
+		m_binNodes[nodeIdx].m_offset = blockOffset;
+		pushBinNode(bin.m_blocks, nodeIdx);
+	}
+
+	outChunk = chunk;
+	outOffset = offset;
+	return Error::kNone;
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+void SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::freeToBin(U32 binIdx, TChunk* chunk, PtrSize offset)
+{
+	ANKI_ASSERT(isAligned(getBinAlignment(binIdx), offset));
+	Bin& bin = m_bins[binIdx];
+
+	const U32 nodeIdx = popBinNode(bin.m_freeNodes);
+	if(nodeIdx != kMaxU32) [[likely]]
+	{
+		m_binNodes[nodeIdx].m_chunk = chunk;
+		m_binNodes[nodeIdx].m_offset = offset;
+		pushBinNode(bin.m_blocks, nodeIdx);
+		return;
+	}
+
+	// The bin is full. Give back the block and half of the bin in one go
+	LockGuard<TLock> lock(m_lock);
+	freeInternal(chunk, offset, getBinSize(binIdx));
+	drainBin(binIdx, max(m_blocksPerBin / 2, 1u));
+}
+
+template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
+void SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::drainBin(U32 binIdx, U32 maxBlockCount)
+{
+	Bin& bin = m_bins[binIdx];
+	const PtrSize binSize = getBinSize(binIdx);
+
+	for(U32 i = 0; i < maxBlockCount; ++i)
+	{
+		const U32 nodeIdx = popBinNode(bin.m_blocks);
+		if(nodeIdx == kMaxU32)
+		{
+			break;
+		}
+
+		TChunk* chunk = m_binNodes[nodeIdx].m_chunk;
+		const PtrSize offset = m_binNodes[nodeIdx].m_offset;
+		pushBinNode(bin.m_freeNodes, nodeIdx);
+
+		freeInternal(chunk, offset, binSize);
+	}
+}
+
 template<typename TChunk, typename TInterface, typename TLock, typename TMemoryPool>
 Error SegregatedListsAllocatorBuilder<TChunk, TInterface, TLock, TMemoryPool>::validate() const
 {
@@ -0,0 +1,298 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/MemoryPool.h>
+#include <AnKi/Util/Functions.h>
+#include <AnKi/Util/Forward.h>
+
+namespace anki {
+
+/// @addtogroup util_containers
+/// @{
+
+/// Dynamic array that holds the first kInlineCount elements inside the object and spills to the memory pool when it grows more than that. Used
+/// for short lists that are built often, it avoids the allocations altogether in the common case. It has the same interface and iterators as
+/// DynamicArray.
+/// @note The inline elements live inside the object so moving the array moves the elements as well. Pointers to the elements are invalidated by
+///       a move. Also, there is no moveAndReset() since the inline storage can't be detached.
+/// @tparam T The type this array will hold.
+/// @tparam kInlineCount The number of elements that fit in the object.
+/// @tparam TSize The type that denotes the maximum number of elements of the array.
+template<typename T, U32 kInlineCount, typename TMemoryPool = SingletonMemoryPoolWrapper<DefaultMemoryPool>, typename TSize = U32>
+class SmallDynamicArray
+{
+	static_assert(kInlineCount > 0);
+
+public:
+	using Value = T;
+	using Iterator = Value*;
+	using ConstIterator = const Value*;
+	using Reference = Value&;
+	using ConstReference = const Value&;
+	using Size = TSize;
+
+	static constexpr F32 kGrowScale = 2.0f;
+	static constexpr F32 kShrinkScale = 2.0f;
+
+	SmallDynamicArray(const TMemoryPool& pool = TMemoryPool())
+		: m_pool(pool)
+		, m_data(getInlineStorage())
+	{
+	}
+
+	/// Copy.
+	SmallDynamicArray(const SmallDynamicArray& b)
+		: SmallDynamicArray(b.m_pool)
+	{
+		*this = b;
+	}
+
+	/// Move.
+	SmallDynamicArray(SmallDynamicArray&& b)
+		: SmallDynamicArray(b.m_pool)
+	{
+		*this = std::move(b);
+	}
+
+	~SmallDynamicArray()
+	{
+		destroy();
+	}
+
+	/// Move. If the elements of b are inline they will be moved one by one.
+	SmallDynamicArray& operator=(SmallDynamicArray&& b);
+
+	/// Copy and trim extra capacity.
+	SmallDynamicArray& operator=(const SmallDynamicArray& b);
+
+	Reference operator[](const Size n)
+	{
+		ANKI_ASSERT(n < m_size);
+		return m_data[n];
+	}
+
+	ConstReference operator[](const Size n) const
+	{
+		ANKI_ASSERT(n < m_size);
+		return m_data[n];
+	}
+
+	Iterator getBegin()
+	{
+		return m_data;
+	}
+
+	ConstIterator getBegin() const
+	{
+		return m_data;
+	}
+
+	Iterator getEnd()
+	{
+		return m_data + m_size;
+	}
+
+	ConstIterator getEnd() const
+	{
+		return m_data + m_size;
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	Iterator begin()
+	{
+		return getBegin();
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	ConstIterator begin() const
+	{
+		return getBegin();
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	Iterator end()
+	{
+		return getEnd();
+	}
+
+	/// Make it compatible with the C++11 range based for loop.
+	ConstIterator end() const
+	{
+		return getEnd();
+	}
+
+	/// Get first element.
+	Reference getFront()
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_data[0];
+	}
+
+	/// Get first element.
+	ConstReference getFront() const
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_data[0];
+	}
+
+	/// Get last element.
+	Reference getBack()
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_data[m_size - 1];
+	}
+
+	/// Get last element.
+	ConstReference getBack() const
+	{
+		ANKI_ASSERT(!isEmpty());
+		return m_data[m_size - 1];
+	}
+
+	Size getSize() const
+	{
+		return m_size;
+	}
+
+	Bool isEmpty() const
+	{
+		return m_size == 0;
+	}
+
+	PtrSize getSizeInBytes() const
+	{
+		return m_size * sizeof(Value);
+	}
+
+	/// The number of elements that fit in the current storage.
+	Size getCapacity() const
+	{
+		return m_capacity;
+	}
+
+	/// True if the elements live inside the object and not in memory from the pool.
+	Bool isInline() const
+	{
+		return m_data == getInlineStorage();
+	}
+
+	/// Destroy the elements and free the pool memory if there is any. The array will go back to the inline storage.
+	void destroy();
+
+	/// Grow or create the array. @a T needs to be copyable and moveable else you might get an assertion.
+	template<typename... TArgs>
+	void resize(Size size, TArgs... args);
+
+	/// Push back value.
+	template<typename... TArgs>
+	Iterator emplaceBack(TArgs&&... args)
+	{
+		resizeStorage(m_size + 1);
+		callConstructor(m_data[m_size], std::forward<TArgs>(args)...);
+		++m_size;
+		return &m_data[m_size - 1];
+	}
+
+	/// Remove the last value.
+	void popBack()
+	{
+		if(m_size > 0)
+		{
+			resizeStorage(m_size - 1);
+		}
+	}
+
+	/// Emplace a new element at a specific position. @a T needs to be movable and default constructible.
+	/// @param where Points to the position to emplace. Should be less or equal to what getEnd() returns.
+	/// @param args  Constructor arguments.
+	template<typename... TArgs>
+	Iterator emplaceAt(ConstIterator where, TArgs&&... args);
+
+	/// Removes the (first, last] elements.
+	/// @param first Points to the position of the first element to remove.
+	/// @param last Points to the position of the last element to remove minus one.
+	void erase(ConstIterator first, ConstIterator last);
+
+	/// Removes one element.
+	/// @param at Points to the position of the element to remove.
+	void erase(ConstIterator at)
+	{
+		erase(at, at + 1);
+	}
+
+	/// Validate it. Will only work when assertions are enabled.
+	void validate() const
+	{
+		ANKI_ASSERT(m_data);
+		ANKI_ASSERT(m_size <= m_capacity);
+		ANKI_ASSERT(isInline() == (m_capacity == kInlineCount));
+	}
+
+	/// Resizes the storage but DOESN'T CONSTRUCT ANY ELEMENTS. It only moves or destroys. If the new size fits in the inline storage the elements
+	/// will move back to it.
+	void resizeStorage(Size newSize);
+
+	/// Search the array until you find the 1st value.
+	Iterator find(const Value& what)
+	{
+		Value* it = m_data;
+		Value* end = m_data + m_size;
+		for(; it != end; ++it)
+		{
+			if(*it == what)
+			{
+				return it;
+			}
+		}
+		return end;
+	}
+
+	/// Fill the array.
+	static void fill(Iterator begin, Iterator end, const T& val)
+	{
+		while(begin != end)
+		{
+			*begin = val;
+			++begin;
+		}
+	}
+
+	void fill(const T& val)
+	{
+		fill(getBegin(), getEnd(), val);
+	}
+
+	TMemoryPool& getMemoryPool()
+	{
+		return m_pool;
+	}
+
+protected:
+	TMemoryPool m_pool;
+	Value* m_data; ///< Points to m_inlineStorage or to memory from the pool.
+	Size m_size = 0;
+	Size m_capacity = kInlineCount;
+	alignas(Value) U8 m_inlineStorage[sizeof(Value) * kInlineCount];
+
+	Value* getInlineStorage()
+	{
+		return reinterpret_cast<Value*>(&m_inlineStorage[0]);
+	}
+
+	const Value* getInlineStorage() const
+	{
+		return reinterpret_cast<const Value*>(&m_inlineStorage[0]);
+	}
+
+	/// Move the elements to a new storage and free the old one if it's not the inline.
+	void moveToStorage(Value* newStorage, Size newCapacity);
+};
+/// @}
+
+} // end namespace anki
+
+#include <AnKi/Util/SmallDynamicArray.inl.h>
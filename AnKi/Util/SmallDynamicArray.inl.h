@@ -0,0 +1,236 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/SmallDynamicArray.h>
+
+namespace anki {
+
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>& SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::operator=(SmallDynamicArray&& b)
+{
+	ANKI_ASSERT(this != &b);
+	destroy();
+	m_pool = b.m_pool;
+
+	if(b.isInline())
+	{
+		for(Size i = 0; i < b.m_size; ++i)
+		{
+			callConstructor(m_data[i], std::move(b.m_data[i]));
+			b.m_data[i].~T();
+		}
+	}
+	else
+	{
+		// Steal the pool memory
+		m_data = b.m_data;
+		m_capacity = b.m_capacity;
+		b.m_data = b.getInlineStorage();
+		b.m_capacity = kInlineCount;
+	}
+
+	m_size = b.m_size;
+	b.m_size = 0;
+	return *this;
+}
+
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>&
+SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::operator=(const SmallDynamicArray& b)
+{
+	ANKI_ASSERT(this != &b);
+	destroy();
+	m_pool = b.m_pool;
+
+	if(b.m_size > kInlineCount)
+	{
+		m_data = static_cast<Value*>(m_pool.allocate(sizeof(Value) * b.m_size, alignof(Value)));
+		m_capacity = b.m_size;
+	}
+
+	for(Size i = 0; i < b.m_size; ++i)
+	{
+		::new(&m_data[i]) T(b.m_data[i]);
+	}
+
+	m_size = b.m_size;
+	return *this;
+}
+
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+void SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::destroy()
+{
+	for(Size i = 0; i < m_size; ++i)
+	{
+		m_data[i].~T();
+	}
+
+	if(!isInline())
+	{
+		m_pool.free(m_data);
+		m_data = getInlineStorage();
+	}
+
+	m_size = 0;
+	m_capacity = kInlineCount;
+}
+
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+void SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::moveToStorage(Value* newStorage, Size newCapacity)
+{
+	ANKI_ASSERT(newStorage != m_data);
+	ANKI_ASSERT(m_size <= newCapacity);
+
+	for(Size i = 0; i < m_size; ++i)
+	{
+		callConstructor(newStorage[i], std::move(m_data[i]));
+		m_data[i].~T();
+	}
+
+	if(!isInline())
+	{
+		m_pool.free(m_data);
+	}
+
+	m_data = newStorage;
+	m_capacity = newCapacity;
+}
+
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+void SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::resizeStorage(Size newSize)
+{
+	if(newSize > m_capacity)
+	{
+		// Need to grow, the new storage always comes from the pool
+
+		const Size newCapacity = max(newSize, Size(F64(m_capacity) * kGrowScale));
+		moveToStorage(static_cast<Value*>(m_pool.allocate(newCapacity * sizeof(Value), alignof(Value))), newCapacity);
+	}
+	else if(newSize < m_size)
+	{
+		// Delete remaining stuff
+		for(Size i = newSize; i < m_size; ++i)
+		{
+			m_data[i].~T();
+		}
+
+		m_size = newSize;
+
+		if(!isInline())
+		{
+			if(newSize <= kInlineCount)
+			{
+				// Fits in the object again
+				moveToStorage(getInlineStorage(), kInlineCount);
+			}
+			else if(newSize < Size(F64(m_capacity) / kShrinkScale))
+			{
+				// Need to shrink
+				moveToStorage(static_cast<Value*>(m_pool.allocate(newSize * sizeof(Value), alignof(Value))), newSize);
+			}
+		}
+	}
+}
+
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+template<typename... TArgs>
+void SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::resize(Size newSize, TArgs... args)
+{
+	if constexpr(std::is_move_constructible<T>::value)
+	{
+		const Bool willGrow = newSize > m_size;
+		resizeStorage(newSize);
+
+		if(willGrow)
+		{
+			// Fill with new values
+			for(Size i = m_size; i < newSize; ++i)
+			{
+				::new(&m_data[i]) T(args...);
+			}
+
+			m_size = newSize;
+		}
+	}
+	else
+	{
+		ANKI_ASSERT(m_size == 0 && "Cannot resize storage for non-movable");
+		if(newSize > kInlineCount)
+		{
+			m_data = static_cast<T*>(m_pool.allocate(sizeof(T) * newSize, alignof(T)));
+			m_capacity = newSize;
+		}
+
+		for(Size i = 0; i < newSize; ++i)
+		{
+			::new(&m_data[i]) T(args...);
+		}
+		m_size = newSize;
+	}
+
+	ANKI_ASSERT(m_size <= m_capacity);
+	ANKI_ASSERT(m_size == newSize);
+}
+
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+template<typename... TArgs>
+typename SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::Iterator
+SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::emplaceAt(ConstIterator where, TArgs&&... args)
+{
+	ANKI_ASSERT(where >= m_data && where <= m_data + m_size);
+
+	const Size oldSize = m_size;
+	const Size whereIdx = Size(where - m_data); // Get that before grow the storage
+
+	resizeStorage(oldSize + 1);
+
+	Size elementsToMoveRight = oldSize - whereIdx;
+	if(elementsToMoveRight > 0)
+	{
+		// Construct the last element because we will move to it
+		callConstructor(m_data[oldSize]);
+
+		// Move the elements one place to the right
+		while(elementsToMoveRight--)
+		{
+			const Size idx = whereIdx + elementsToMoveRight;
+			m_data[idx + 1] = std::move(m_data[idx]);
+		}
+
+		// Even if it's moved, call the destructor
+		m_data[whereIdx].~Value();
+	}
+
+	// Construct the new object
+	callConstructor(m_data[whereIdx], std::forward<TArgs>(args)...);
+
+	// Increase the size because resizeStorage will not
+	++m_size;
+
+	return &m_data[whereIdx];
+}
+
+template<typename T, U32 kInlineCount, typename TMemoryPool, typename TSize>
+void SmallDynamicArray<T, kInlineCount, TMemoryPool, TSize>::erase(ConstIterator first, ConstIterator last)
+{
+	ANKI_ASSERT(first != last);
+	ANKI_ASSERT(first >= m_data && first < m_data + m_size);
+	ANKI_ASSERT(last > m_data && last <= m_data + m_size);
+
+	// Move from the back to close the gap
+	const Size firsti = Size(first - m_data);
+	const Size lasti = Size(last - m_data);
+	const Size toMove = m_size - lasti;
+	for(Size i = 0; i < toMove; ++i)
+	{
+		m_data[firsti + i] = std::move(m_data[lasti + i]);
+	}
+
+	// Resize storage
+	const Size newSize = m_size - Size(last - first);
+	resizeStorage(newSize);
+}
+
+} // end namespace anki
@@ -240,6 +240,7 @@ public:
 
 		m_elements = b.m_elements;
 		m_metadata = b.m_metadata;
+		m_aliveMask = b.m_aliveMask;
 		m_elementCount = b.m_elementCount;
 		m_capacity = b.m_capacity;
 		m_config = std::move(b.m_config);
@@ -362,6 +363,10 @@ public:
 	/// Remove an element.
 	void erase(Iterator it);
 
+	/// Shrink the storage to the smallest capacity that respects the max load factor. It re-inserts the elements so after a lot of erases
+	/// the live elements end up close to each other. Iterators are invalidated.
+	void compact();
+
 	/// Check the validity of the array.
 	void validate() const;
 
@@ -382,6 +387,7 @@ protected:
 	TMemoryPool m_pool;
 	Value* m_elements = nullptr;
 	Metadata* m_metadata = nullptr;
+	U64* m_aliveMask = nullptr; ///< One bit per slot. Mirrors Metadata::m_alive so iteration skips 64 empty slots at once.
 	Index m_elementCount = 0;
 	Index m_capacity = 0;
 	Config m_config;
@@ -420,7 +426,50 @@ protected:
 	Index insert(Index idx, Value& val);
 
 	/// Grow the storage and re-insert.
-	void grow();
+	void grow()
+	{
+		rehash((m_capacity == 0) ? getInitialStorageSize() : m_capacity * 2);
+	}
+
+	/// Allocate new storage and re-insert the elements.
+	void rehash(Index newCapacity);
+
+	static Index getAliveMaskWordCount(Index capacity)
+	{
+		return (capacity + 63) / 64;
+	}
+
+	void setAlive(Index pos, Bool alive)
+	{
+		m_metadata[pos].m_alive = alive;
+		const U64 bit = 1_U64 << (pos % 64);
+		U64& word = m_aliveMask[pos / 64];
+		word = (alive) ? (word | bit) : (word & ~bit);
+	}
+
+	/// Find the first alive slot that is equal or after pos.
+	Index findNextAlive(Index pos) const
+	{
+		if(pos >= m_capacity)
+		{
+			return getMaxNumericLimit<Index>();
+		}
+
+		const Index wordCount = getAliveMaskWordCount(m_capacity);
+		Index wordIdx = pos / 64;
+		U64 word = m_aliveMask[wordIdx] & (kMaxU64 << (pos % 64));
+		while(word == 0)
+		{
+			if(++wordIdx == wordCount)
+			{
+				return getMaxNumericLimit<Index>();
+			}
+
+			word = m_aliveMask[wordIdx];
+		}
+
+		return wordIdx * 64 + Index(__builtin_ctzll(word));
+	}
 
 	/// Compute the distance between a desired position and the current one. This method does a trick with capacity to
 	/// account for wrapped positions.
@@ -437,16 +486,9 @@ protected:
 			return getMaxNumericLimit<Index>();
 		}
 
-		for(Index i = 0; i < m_capacity; ++i)
-		{
-			if(m_metadata[i].m_alive)
-			{
-				return i;
-			}
-		}
-
-		ANKI_ASSERT(0);
-		return getMaxNumericLimit<Index>();
+		const Index pos = findNextAlive(0);
+		ANKI_ASSERT(pos != getMaxNumericLimit<Index>());
+		return pos;
 	}
 
 	/// Find an element and return its position inside m_elements.
@@ -457,6 +499,7 @@ protected:
 	{
 		m_elements = nullptr;
 		m_metadata = nullptr;
+		m_aliveMask = nullptr;
 		m_elementCount = 0;
 		m_capacity = 0;
 		invalidateIterators();
@@ -469,13 +512,13 @@ protected:
 		ANKI_ASSERT(n > 0);
 		ANKI_ASSERT(m_metadata[pos].m_alive);
 
-		while(n > 0 && ++pos < m_capacity)
+		while(n > 0 && pos != getMaxNumericLimit<Index>())
 		{
-			ANKI_ASSERT(m_metadata[pos].m_alive == 1 || m_metadata[pos].m_alive == 0);
-			n -= Index(m_metadata[pos].m_alive);
+			pos = findNextAlive(pos + 1);
+			--n;
 		}
 
-		return (pos >= m_capacity) ? getMaxNumericLimit<Index>() : pos;
+		return pos;
 	}
 
 	template<typename... TArgs>
@@ -24,6 +24,9 @@ void SparseArray<T, TMemoryPool, TConfig>::destroy()
 
 		ANKI_ASSERT(m_metadata);
 		m_pool.free(m_metadata);
+
+		ANKI_ASSERT(m_aliveMask);
+		m_pool.free(m_aliveMask);
 	}
 
 	resetMembers();
@@ -78,7 +81,7 @@ typename TConfig::Index SparseArray<T, TMemoryPool, TConfig>::insert(Index idx,
 			{
 				// Empty slot was found, construct in-place
 
-				meta.m_alive = true;
+				setAlive(pos, true);
 				meta.m_idx = idx;
 				callConstructor(crntVal, std::move(val));
 
@@ -119,33 +122,31 @@ typename TConfig::Index SparseArray<T, TMemoryPool, TConfig>::insert(Index idx,
 }
 
 template<typename T, typename TMemoryPool, typename TConfig>
-void SparseArray<T, TMemoryPool, TConfig>::grow()
+void SparseArray<T, TMemoryPool, TConfig>::rehash(Index newCapacity)
 {
-	if(m_capacity == 0)
-	{
-		ANKI_ASSERT(m_elementCount == 0);
-		m_capacity = getInitialStorageSize();
-		m_elements = static_cast<Value*>(m_pool.allocate(m_capacity * sizeof(Value), alignof(Value)));
-
-		m_metadata = static_cast<Metadata*>(m_pool.allocate(m_capacity * sizeof(Metadata), alignof(Metadata)));
-
-		memset(m_metadata, 0, m_capacity * sizeof(Metadata));
-
-		return;
-	}
+	ANKI_ASSERT(isPowerOfTwo(newCapacity) && newCapacity > m_elementCount);
 
 	// Allocate new storage
 	Value* const oldElements = m_elements;
 	Metadata* const oldMetadata = m_metadata;
+	U64* const oldAliveMask = m_aliveMask;
 	const Index oldCapacity = m_capacity;
 	[[maybe_unused]] const Index oldElementCount = m_elementCount;
 
-	m_capacity *= 2;
+	m_capacity = newCapacity;
 	m_elements = static_cast<Value*>(m_pool.allocate(m_capacity * sizeof(Value), alignof(Value)));
 	m_metadata = static_cast<Metadata*>(m_pool.allocate(m_capacity * sizeof(Metadata), alignof(Metadata)));
 	memset(m_metadata, 0, m_capacity * sizeof(Metadata));
+	m_aliveMask = static_cast<U64*>(m_pool.allocate(getAliveMaskWordCount(m_capacity) * sizeof(U64), alignof(U64)));
+	memset(m_aliveMask, 0, getAliveMaskWordCount(m_capacity) * sizeof(U64));
 	m_elementCount = 0;
 
+	if(oldCapacity == 0)
+	{
+		ANKI_ASSERT(oldElementCount == 0);
+		return;
+	}
+
 	// Find from where we start
 	Index startPos = ~Index(0);
 	for(Index i = 0; i < oldCapacity; ++i)
@@ -185,6 +186,28 @@ void SparseArray<T, TMemoryPool, TConfig>::grow()
 	// Finalize
 	m_pool.free(oldElements);
 	m_pool.free(oldMetadata);
+	m_pool.free(oldAliveMask);
+}
+
+template<typename T, typename TMemoryPool, typename TConfig>
+void SparseArray<T, TMemoryPool, TConfig>::compact()
+{
+	if(m_elementCount == 0)
+	{
+		return;
+	}
+
+	Index newCapacity = getInitialStorageSize();
+	while(F32(m_elementCount) / F32(newCapacity) > getMaxLoadFactor())
+	{
+		newCapacity *= 2;
+	}
+
+	if(newCapacity < m_capacity)
+	{
+		rehash(newCapacity);
+		invalidateIterators();
+	}
 }
 
 template<typename T, typename TMemoryPool, typename TConfig>
@@ -232,7 +255,7 @@ void SparseArray<T, TMemoryPool, TConfig>::erase(Iterator it)
 
 	// Delete the element in the given pos
 	destroyElement(m_elements[crntPos]);
-	m_metadata[crntPos].m_alive = false;
+	setAlive(crntPos, false);
 	--m_elementCount;
 
 	// If you erased everything destroy the storage
@@ -249,7 +272,7 @@ void SparseArray<T, TMemoryPool, TConfig>::validate() const
 {
 	if(m_capacity == 0)
 	{
-		ANKI_ASSERT(m_elementCount == 0 && m_elements == nullptr && m_metadata == nullptr);
+		ANKI_ASSERT(m_elementCount == 0 && m_elements == nullptr && m_metadata == nullptr && m_aliveMask == nullptr);
 		return;
 	}
 
@@ -277,6 +300,7 @@ void SparseArray<T, TMemoryPool, TConfig>::validate() const
 	Index prevPos = ~Index(0);
 	while(count--)
 	{
+		ANKI_ASSERT(!!(m_aliveMask[pos / 64] & (1_U64 << (pos % 64))) == m_metadata[pos].m_alive);
 		if(m_metadata[pos].m_alive)
 		{
 			[[maybe_unused]] const Index myDesiredPos = mod(m_metadata[pos].m_idx);
@@ -342,6 +366,8 @@ SparseArray<T, TMemoryPool, TConfig>& SparseArray<T, TMemoryPool, TConfig>::oper
 	m_elements = static_cast<Value*>(m_pool.allocate(b.m_capacity * sizeof(Value), alignof(Value)));
 	m_metadata = static_cast<Metadata*>(m_pool.allocate(b.m_capacity * sizeof(Metadata), alignof(Metadata)));
 	memcpy(m_metadata, b.m_metadata, b.m_capacity * sizeof(Metadata));
+	m_aliveMask = static_cast<U64*>(m_pool.allocate(getAliveMaskWordCount(b.m_capacity) * sizeof(U64), alignof(U64)));
+	memcpy(m_aliveMask, b.m_aliveMask, getAliveMaskWordCount(b.m_capacity) * sizeof(U64));
 
 	for(U i = 0; i < b.m_capacity; ++i)
 	{
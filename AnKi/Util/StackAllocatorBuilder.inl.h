@@ -200,4 +200,24 @@ void StackAllocatorBuilder<TChunk, TInterface, TLock>::reset()
 	}
 }
 
+template<typename TChunk, typename TInterface, typename TLock>
+PtrSize StackAllocatorBuilder<TChunk, TInterface, TLock>::getMemoryUsage() const
+{
+	// The chunks are used in list order so walk the list up to the current one
+	const TChunk* crntChunk = m_crntChunk.load();
+	PtrSize usage = 0;
+	for(const TChunk* chunk = (crntChunk) ? m_chunksListHead : nullptr; chunk; chunk = chunk->m_nextChunk)
+	{
+		// The offset might have gone past the end if an allocation didn't fit
+		usage += min(chunk->m_offsetInChunk.load(), chunk->m_chunkSize);
+
+		if(chunk == crntChunk)
+		{
+			break;
+		}
+	}
+
+	return usage;
+}
+
 } // end namespace anki
@@ -0,0 +1,412 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#pragma once
+
+#include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/String.h>
+#if ANKI_SIMD_SSE
+#	include <emmintrin.h>
+#elif ANKI_SIMD_NEON
+#	include <arm_neon.h>
+#endif
+
+namespace anki {
+
+/// @addtogroup util_containers
+/// @{
+
+/// Hasher that gives the same hash for CString and BaseString. Use it in maps that are searched with both.
+class StringHasher
+{
+public:
+	U64 operator()(CString str) const
+	{
+		return str.computeHash();
+	}
+
+	template<typename TMemoryPool>
+	U64 operator()(const BaseString<TMemoryPool>& str) const
+	{
+		return str.toCString().computeHash();
+	}
+};
+
+namespace detail {
+
+/// A group of control bytes of SwissHashMap that is scanned with a single SIMD compare.
+class SwissHashMapGroup
+{
+public:
+	static constexpr U32 kWidth = 16;
+	static constexpr U8 kEmpty = 0x80;
+
+#if ANKI_SIMD_NEON
+	static constexpr U32 kBitsPerSlot = 4;
+	static constexpr U64 kMaskFilter = 0x8888888888888888_U64;
+#else
+	static constexpr U32 kBitsPerSlot = 1;
+	static constexpr U64 kMaskFilter = kMaxU64;
+#endif
+
+	explicit SwissHashMapGroup(const U8* ctrl)
+	{
+#if ANKI_SIMD_SSE
+		m_ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl));
+#elif ANKI_SIMD_NEON
+		m_ctrl = vld1q_u8(ctrl);
+#else
+		m_ctrl = ctrl;
+#endif
+	}
+
+	/// Get a mask with kBitsPerSlot bits for every slot that has this H2.
+	U64 match(U8 h2) const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_epi8(_mm_cmpeq_epi8(m_ctrl, _mm_set1_epi8(Char(h2)))));
+#elif ANKI_SIMD_NEON
+		return toMask(vceqq_u8(m_ctrl, vdupq_n_u8(h2)));
+#else
+		U64 mask = 0;
+		for(U32 i = 0; i < kWidth; ++i)
+		{
+			mask |= U64(m_ctrl[i] == h2) << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// Get a mask with kBitsPerSlot bits for every empty slot.
+	U64 matchEmpty() const
+	{
+#if ANKI_SIMD_SSE
+		return U32(_mm_movemask_epi8(m_ctrl));
+#elif ANKI_SIMD_NEON
+		return toMask(vcltzq_s8(vreinterpretq_s8_u8(m_ctrl)));
+#else
+		return match(kEmpty);
+#endif
+	}
+
+	/// Get the slot of the lowest bit of a mask.
+	static U32 getFirstSlot(U64 mask)
+	{
+		ANKI_ASSERT(mask);
+		return U32(__builtin_ctzll(mask)) / kBitsPerSlot;
+	}
+
+private:
+#if ANKI_SIMD_SSE
+	__m128i m_ctrl;
+#elif ANKI_SIMD_NEON
+	uint8x16_t m_ctrl;
+
+	static U64 toMask(uint8x16_t bytes)
+	{
+		// Narrow every byte to a nibble
+		const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(bytes), 4);
+		return vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & kMaskFilter;
+	}
+#else
+	const U8* m_ctrl;
+#endif
+};
+
+} // end namespace detail
+
+/// SwissHashMap iterator. It's the same as the HashMap's iterator (it even returns the hash in getKey()).
+template<typename TValuePointer, typename TValueReference, typename TMapPtr>
+class SwissHashMapIterator
+{
+	template<typename, typename, typename, typename>
+	friend class SwissHashMap;
+
+	template<typename, typename, typename>
+	friend class SwissHashMapIterator;
+
+public:
+	SwissHashMapIterator() = default;
+
+	/// Allow conversion from iterator to const iterator.
+	template<typename YValuePointer, typename YValueReference, typename YMapPtr>
+	SwissHashMapIterator(const SwissHashMapIterator<YValuePointer, YValueReference, YMapPtr>& b)
+		: m_map(b.m_map)
+		, m_slot(b.m_slot)
+	{
+	}
+
+	TValueReference operator*() const
+	{
+		check();
+		return m_map->m_slots[m_slot].getValue();
+	}
+
+	TValuePointer operator->() const
+	{
+		check();
+		return &m_map->m_slots[m_slot].getValue();
+	}
+
+	SwissHashMapIterator& operator++()
+	{
+		check();
+		m_slot = m_map->findFullSlot(m_slot + 1);
+		return *this;
+	}
+
+	SwissHashMapIterator operator++(int)
+	{
+		SwissHashMapIterator out = *this;
+		++(*this);
+		return out;
+	}
+
+	Bool operator==(const SwissHashMapIterator& b) const
+	{
+		ANKI_ASSERT(m_map == b.m_map);
+		return m_slot == b.m_slot;
+	}
+
+	Bool operator!=(const SwissHashMapIterator& b) const
+	{
+		return !(*this == b);
+	}
+
+	/// Get the hash of the key.
+	U64 getKey() const
+	{
+		check();
+		return m_map->m_slots[m_slot].m_hash;
+	}
+
+private:
+	TMapPtr m_map = nullptr;
+	U32 m_slot = kMaxU32;
+
+	SwissHashMapIterator(TMapPtr map, U32 slot)
+		: m_map(map)
+		, m_slot(slot)
+	{
+	}
+
+	void check() const
+	{
+		ANKI_ASSERT(m_map && m_slot < m_map->m_capacity && m_map->m_ctrl[m_slot] != detail::SwissHashMapGroup::kEmpty);
+	}
+};
+
+/// An open addressing hash map with the same interface and semantics as HashMap: the elements are identified by the 64bit hash of the key
+/// and the keys are not stored. Every slot has a control byte that is empty or holds 7 bits of the hash. Lookups compare a group of 16
+/// control bytes at once (SSE2 or NEON) and only look at the full hash on a match. The probing is linear so erase() shifts the following
+/// elements back instead of leaving tombstones.
+/// find() accepts any key type that THasher accepts (see StringHasher) so there is no need to construct a TKey for lookups.
+template<typename TKey, typename TValue, typename THasher = DefaultHasher<TKey>, typename TMemoryPool = SingletonMemoryPoolWrapper<DefaultMemoryPool>>
+class SwissHashMap
+{
+	template<typename, typename, typename>
+	friend class SwissHashMapIterator;
+
+public:
+	using Value = TValue;
+	using Key = TKey;
+	using Hasher = THasher;
+	using Iterator = SwissHashMapIterator<TValue*, TValue&, SwissHashMap*>;
+	using ConstIterator = SwissHashMapIterator<const TValue*, const TValue&, const SwissHashMap*>;
+
+	SwissHashMap(const TMemoryPool& pool = TMemoryPool())
+		: m_pool(pool)
+	{
+	}
+
+	/// Move.
+	SwissHashMap(SwissHashMap&& b)
+	{
+		*this = std::move(b);
+	}
+
+	/// Copy.
+	SwissHashMap(const SwissHashMap& b)
+	{
+		*this = b;
+	}
+
+	~SwissHashMap()
+	{
+		destroy();
+	}
+
+	/// Move.
+	SwissHashMap& operator=(SwissHashMap&& b)
+	{
+		destroy();
+		m_pool = b.m_pool;
+		m_ctrl = b.m_ctrl;
+		m_slots = b.m_slots;
+		m_capacity = b.m_capacity;
+		m_elementCount = b.m_elementCount;
+		b.m_ctrl = nullptr;
+		b.m_slots = nullptr;
+		b.m_capacity = 0;
+		b.m_elementCount = 0;
+		return *this;
+	}
+
+	/// Copy.
+	SwissHashMap& operator=(const SwissHashMap& b)
+	{
+		destroy();
+		m_pool = b.m_pool;
+		for(auto it = b.getBegin(); it != b.getEnd(); ++it)
+		{
+			emplaceHash(it.getKey(), *it);
+		}
+		return *this;
+	}
+
+	Iterator getBegin()
+	{
+		return Iterator(this, findFullSlot(0));
+	}
+
+	ConstIterator getBegin() const
+	{
+		return ConstIterator(this, findFullSlot(0));
+	}
+
+	Iterator getEnd()
+	{
+		return Iterator(this, m_capacity);
+	}
+
+	ConstIterator getEnd() const
+	{
+		return ConstIterator(this, m_capacity);
+	}
+
+	Iterator begin()
+	{
+		return getBegin();
+	}
+
+	ConstIterator begin() const
+	{
+		return getBegin();
+	}
+
+	Iterator end()
+	{
+		return getEnd();
+	}
+
+	ConstIterator end() const
+	{
+		return getEnd();
+	}
+
+	Bool isEmpty() const
+	{
+		return m_elementCount == 0;
+	}
+
+	PtrSize getSize() const
+	{
+		return m_elementCount;
+	}
+
+	/// Destroy the map.
+	void destroy();
+
+	/// Construct an element inside the map. If an element with the same key exists it will be replaced.
+	template<typename... TArgs>
+	Iterator emplace(const TKey& key, TArgs&&... args)
+	{
+		return emplaceHash(THasher()(key), std::forward<TArgs>(args)...);
+	}
+
+	/// Erase an element. The iterators that point after the erased element are invalidated.
+	void erase(Iterator it);
+
+	/// Find a value using a key or anything else that THasher accepts.
+	template<typename TOtherKey>
+	Iterator find(const TOtherKey& key)
+	{
+		return Iterator(this, findSlot(THasher()(key)));
+	}
+
+	/// Find a value using a key or anything else that THasher accepts.
+	template<typename TOtherKey>
+	ConstIterator find(const TOtherKey& key) const
+	{
+		return ConstIterator(this, findSlot(THasher()(key)));
+	}
+
+private:
+	using Group = detail::SwissHashMapGroup;
+
+	static constexpr U32 kMinCapacity = 16;
+
+	/// The hash lives next to the value so a lookup touches one cache line after the control bytes.
+	class Slot
+	{
+	public:
+		U64 m_hash;
+		alignas(TValue) U8 m_value[sizeof(TValue)];
+
+		TValue& getValue()
+		{
+			return *reinterpret_cast<TValue*>(&m_value[0]);
+		}
+
+		const TValue& getValue() const
+		{
+			return *reinterpret_cast<const TValue*>(&m_value[0]);
+		}
+	};
+
+	TMemoryPool m_pool;
+	U8* m_ctrl = nullptr; ///< m_capacity + Group::kWidth control bytes. The last kWidth mirror the first so groups don't wrap.
+	Slot* m_slots = nullptr;
+	U32 m_capacity = 0;
+	U32 m_elementCount = 0;
+
+	static U8 getH2(U64 hash)
+	{
+		return U8(hash & 0x7F);
+	}
+
+	U32 getHomeSlot(U64 hash) const
+	{
+		return U32(hash >> 7) & (m_capacity - 1);
+	}
+
+	void setCtrl(U32 slot, U8 ctrl)
+	{
+		m_ctrl[slot] = ctrl;
+		if(slot < Group::kWidth)
+		{
+			m_ctrl[m_capacity + slot] = ctrl;
+		}
+	}
+
+	/// Return m_capacity if not found.
+	U32 findSlot(U64 hash) const;
+
+	/// Find the next slot that is not empty starting from a slot.
+	U32 findFullSlot(U32 slot) const;
+
+	/// Find the first empty slot of a probe sequence. There must be one.
+	U32 findEmptySlot(U64 hash) const;
+
+	template<typename... TArgs>
+	Iterator emplaceHash(U64 hash, TArgs&&... args);
+
+	void grow();
+};
+/// @}
+
+} // end namespace anki
+
+#include <AnKi/Util/SwissHashMap.inl.h>
@@ -0,0 +1,203 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/SwissHashMap.h>
+
+namespace anki {
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+void SwissHashMap<TKey, TValue, THasher, TMemoryPool>::destroy()
+{
+	if(m_ctrl)
+	{
+		for(U32 slot = 0; slot < m_capacity; ++slot)
+		{
+			if(m_ctrl[slot] != Group::kEmpty)
+			{
+				m_slots[slot].getValue().~TValue();
+			}
+		}
+
+		m_pool.free(m_ctrl);
+		m_pool.free(m_slots);
+	}
+
+	m_ctrl = nullptr;
+	m_slots = nullptr;
+	m_capacity = 0;
+	m_elementCount = 0;
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+U32 SwissHashMap<TKey, TValue, THasher, TMemoryPool>::findSlot(U64 hash) const
+{
+	if(m_elementCount == 0)
+	{
+		return m_capacity;
+	}
+
+	const U8 h2 = getH2(hash);
+	const U32 mask = m_capacity - 1;
+	U32 groupStart = getHomeSlot(hash);
+	while(true)
+	{
+		const Group group(m_ctrl + groupStart);
+
+		U64 matches = group.match(h2) & Group::kMaskFilter;
+		while(matches)
+		{
+			const U32 slot = (groupStart + Group::getFirstSlot(matches)) & mask;
+			if(m_slots[slot].m_hash == hash)
+			{
+				return slot;
+			}
+
+			matches &= matches - 1;
+		}
+
+		// The probing is linear and there are no tombstones so an empty slot terminates the search
+		if(group.matchEmpty())
+		{
+			return m_capacity;
+		}
+
+		groupStart = (groupStart + Group::kWidth) & mask;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+U32 SwissHashMap<TKey, TValue, THasher, TMemoryPool>::findFullSlot(U32 slot) const
+{
+	while(slot < m_capacity)
+	{
+		// The mirrored control bytes are all past m_capacity so groups near the end are fine
+		const U64 full = ~Group(m_ctrl + slot).matchEmpty() & ((Group::kBitsPerSlot == 1) ? 0xFFFF_U64 : Group::kMaskFilter);
+		if(full)
+		{
+			return min(slot + Group::getFirstSlot(full), m_capacity);
+		}
+
+		slot += Group::kWidth;
+	}
+
+	return m_capacity;
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+U32 SwissHashMap<TKey, TValue, THasher, TMemoryPool>::findEmptySlot(U64 hash) const
+{
+	const U32 mask = m_capacity - 1;
+	U32 groupStart = getHomeSlot(hash);
+	while(true)
+	{
+		const U64 empty = Group(m_ctrl + groupStart).matchEmpty() & Group::kMaskFilter;
+		if(empty)
+		{
+			return (groupStart + Group::getFirstSlot(empty)) & mask;
+		}
+
+		groupStart = (groupStart + Group::kWidth) & mask;
+	}
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+template<typename... TArgs>
+typename SwissHashMap<TKey, TValue, THasher, TMemoryPool>::Iterator SwissHashMap<TKey, TValue, THasher, TMemoryPool>::emplaceHash(U64 hash,
+																																	 TArgs&&... args)
+{
+	U32 slot = findSlot(hash);
+	if(slot != m_capacity)
+	{
+		// Same key, replace
+		m_slots[slot].getValue().~TValue();
+		::new(&m_slots[slot].getValue()) TValue(std::forward<TArgs>(args)...);
+		return Iterator(this, slot);
+	}
+
+	// Max load factor is 7/8
+	if((m_elementCount + 1) * 8 > m_capacity * 7)
+	{
+		grow();
+	}
+
+	slot = findEmptySlot(hash);
+	setCtrl(slot, getH2(hash));
+	m_slots[slot].m_hash = hash;
+	::new(&m_slots[slot].getValue()) TValue(std::forward<TArgs>(args)...);
+	++m_elementCount;
+
+	return Iterator(this, slot);
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+void SwissHashMap<TKey, TValue, THasher, TMemoryPool>::erase(Iterator it)
+{
+	ANKI_ASSERT(it.m_map == this);
+	it.check();
+
+	U32 hole = it.m_slot;
+	m_slots[hole].getValue().~TValue();
+	--m_elementCount;
+
+	// Backward shift deletion. Move back the elements of the same cluster that are allowed to move so the probe sequences that passed
+	// over the hole stay unbroken
+	const U32 mask = m_capacity - 1;
+	U32 slot = hole;
+	while(true)
+	{
+		slot = (slot + 1) & mask;
+		if(m_ctrl[slot] == Group::kEmpty)
+		{
+			break;
+		}
+
+		// The element can move to the hole if the hole is between its home slot and its current slot
+		const U32 home = getHomeSlot(m_slots[slot].m_hash);
+		if(((slot - home) & mask) >= ((slot - hole) & mask))
+		{
+			setCtrl(hole, m_ctrl[slot]);
+			m_slots[hole].m_hash = m_slots[slot].m_hash;
+			::new(&m_slots[hole].getValue()) TValue(std::move(m_slots[slot].getValue()));
+			m_slots[slot].getValue().~TValue();
+			hole = slot;
+		}
+	}
+
+	setCtrl(hole, Group::kEmpty);
+}
+
+template<typename TKey, typename TValue, typename THasher, typename TMemoryPool>
+void SwissHashMap<TKey, TValue, THasher, TMemoryPool>::grow()
+{
+	const U32 oldCapacity = m_capacity;
+	U8* oldCtrl = m_ctrl;
+	Slot* oldSlots = m_slots;
+
+	m_capacity = max(kMinCapacity, oldCapacity * 2);
+	m_ctrl = static_cast<U8*>(m_pool.allocate(m_capacity + Group::kWidth, alignof(U8)));
+	m_slots = static_cast<Slot*>(m_pool.allocate(sizeof(Slot) * m_capacity, alignof(Slot)));
+	memset(m_ctrl, Group::kEmpty, m_capacity + Group::kWidth);
+
+	for(U32 oldSlot = 0; oldSlot < oldCapacity; ++oldSlot)
+	{
+		if(oldCtrl[oldSlot] != Group::kEmpty)
+		{
+			const U64 hash = oldSlots[oldSlot].m_hash;
+			const U32 slot = findEmptySlot(hash);
+			setCtrl(slot, getH2(hash));
+			m_slots[slot].m_hash = hash;
+			::new(&m_slots[slot].getValue()) TValue(std::move(oldSlots[oldSlot].getValue()));
+			oldSlots[oldSlot].getValue().~TValue();
+		}
+	}
+
+	if(oldCtrl)
+	{
+		m_pool.free(oldCtrl);
+		m_pool.free(oldSlots);
+	}
+}
+
+} // end namespace anki
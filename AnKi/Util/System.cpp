@@ -8,6 +8,7 @@
 #include <AnKi/Util/StringList.h>
 #include <AnKi/Util/Thread.h>
 #include <cstdio>
+#include <algorithm>
 
 #if ANKI_POSIX
 #	include <unistd.h>
@@ -44,6 +45,268 @@ U32 getCpuCoresCount()
 #endif
 }
 
+#if ANKI_OS_LINUX
+/// Read the 1st line of a sysfs file. Doesn't use File because the size of the sysfs files is not known in advance.
+static Bool readSysfsLine(CString path, Array<Char, 512>& line)
+{
+	FILE* file = fopen(path.cstr(), "r");
+	if(!file)
+	{
+		return false;
+	}
+
+	const Bool ok = fgets(&line[0], line.getSize(), file) != nullptr;
+	fclose(file);
+	return ok;
+}
+
+/// Parse a CPU list of the form "0-3,8,10-11".
+static void parseCpuList(const Array<Char, 512>& line, DynamicArray<U32>& cpus)
+{
+	const Char* it = &line[0];
+	while(*it >= '0' && *it <= '9')
+	{
+		Char* end;
+		const U32 first = U32(strtoul(it, &end, 10));
+		U32 last = first;
+		it = end;
+		if(*it == '-')
+		{
+			last = U32(strtoul(it + 1, &end, 10));
+			it = end;
+		}
+
+		for(U32 cpu = first; cpu <= last; ++cpu)
+		{
+			cpus.emplaceBack(cpu);
+		}
+
+		if(*it == ',')
+		{
+			++it;
+		}
+	}
+}
+
+/// Get a sysfs value that is a CPU list and return the 1st CPU in that list.
+static U32 getFirstCpuOfList(CString path, U32 defaultCpu)
+{
+	Array<Char, 512> line;
+	DynamicArray<U32> cpus;
+	if(readSysfsLine(path, line))
+	{
+		parseCpuList(line, cpus);
+	}
+
+	return (cpus.getSize()) ? cpus[0] : defaultCpu;
+}
+#endif
+
+void getCpuTopology(CpuTopology& topology)
+{
+	topology.m_logicalCores.destroy();
+
+#if ANKI_OS_LINUX
+	DynamicArray<U32> onlineCpus;
+	Array<Char, 512> line;
+	if(readSysfsLine("/sys/devices/system/cpu/online", line))
+	{
+		parseCpuList(line, onlineCpus);
+	}
+
+	// Map every CPU to its NUMA node
+	DynamicArray<U32> cpuToNumaNode;
+	for(U32 node = 0;; ++node)
+	{
+		String path;
+		path.sprintf("/sys/devices/system/node/node%u/cpulist", node);
+		if(!readSysfsLine(path, line))
+		{
+			break;
+		}
+
+		DynamicArray<U32> cpus;
+		parseCpuList(line, cpus);
+		for(U32 cpu : cpus)
+		{
+			if(cpu >= cpuToNumaNode.getSize())
+			{
+				cpuToNumaNode.resize(cpu + 1, 0);
+			}
+			cpuToNumaNode[cpu] = node;
+		}
+	}
+
+	// Gather the info of each CPU. Physical cores and L3 domains are identified by the 1st CPU that belongs to them
+	DynamicArray<U32> physicalCoreKeys;
+	DynamicArray<U32> l3DomainKeys;
+	DynamicArray<U32> numaNodes;
+	for(U32 cpu : onlineCpus)
+	{
+		CpuLogicalCoreInfo& info = *topology.m_logicalCores.emplaceBack();
+		info.m_logicalCoreId = cpu;
+
+		String path;
+		path.sprintf("/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list", cpu);
+		DynamicArray<U32> siblings;
+		if(readSysfsLine(path, line))
+		{
+			parseCpuList(line, siblings);
+		}
+
+		const U32 physicalCoreKey = (siblings.getSize()) ? siblings[0] : cpu;
+		auto coreIt = physicalCoreKeys.find(physicalCoreKey);
+		if(coreIt == physicalCoreKeys.getEnd())
+		{
+			coreIt = physicalCoreKeys.emplaceBack(physicalCoreKey);
+		}
+		info.m_physicalCore = U32(coreIt - physicalCoreKeys.getBegin());
+
+		auto siblingIt = siblings.find(cpu);
+		info.m_smtIndex = (siblingIt != siblings.getEnd()) ? U32(siblingIt - siblings.getBegin()) : 0;
+
+		// Find the L3. Some systems don't expose it, use the package then
+		U32 l3Key = kMaxU32;
+		for(U32 idx = 0;; ++idx)
+		{
+			path.sprintf("/sys/devices/system/cpu/cpu%u/cache/index%u/level", cpu, idx);
+			if(!readSysfsLine(path, line))
+			{
+				break;
+			}
+
+			if(atoi(&line[0]) == 3)
+			{
+				path.sprintf("/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list", cpu, idx);
+				l3Key = getFirstCpuOfList(path, cpu);
+				break;
+			}
+		}
+
+		if(l3Key == kMaxU32)
+		{
+			path.sprintf("/sys/devices/system/cpu/cpu%u/topology/core_siblings_list", cpu);
+			l3Key = getFirstCpuOfList(path, 0);
+		}
+
+		auto l3It = l3DomainKeys.find(l3Key);
+		if(l3It == l3DomainKeys.getEnd())
+		{
+			l3It = l3DomainKeys.emplaceBack(l3Key);
+		}
+		info.m_l3Domain = U32(l3It - l3DomainKeys.getBegin());
+
+		info.m_numaNode = (cpu < cpuToNumaNode.getSize()) ? cpuToNumaNode[cpu] : 0;
+		if(numaNodes.find(info.m_numaNode) == numaNodes.getEnd())
+		{
+			numaNodes.emplaceBack(info.m_numaNode);
+		}
+	}
+
+	topology.m_physicalCoreCount = physicalCoreKeys.getSize();
+	topology.m_l3DomainCount = l3DomainKeys.getSize();
+	topology.m_numaNodeCount = numaNodes.getSize();
+#endif
+
+	if(topology.m_logicalCores.getSize() == 0)
+	{
+		// Unknown topology, consider every logical core a physical one
+		const U32 coreCount = getCpuCoresCount();
+		for(U32 i = 0; i < coreCount; ++i)
+		{
+			CpuLogicalCoreInfo& info = *topology.m_logicalCores.emplaceBack();
+			info.m_logicalCoreId = i;
+			info.m_physicalCore = i;
+		}
+
+		topology.m_physicalCoreCount = coreCount;
+		topology.m_l3DomainCount = 1;
+		topology.m_numaNodeCount = 1;
+	}
+}
+
+void computeThreadPlacement(ThreadPlacementPolicy policy, U32 threadCount, DynamicArray<ThreadCoreAffinityMask>& affinities)
+{
+	affinities.destroy();
+	affinities.resize(threadCount, ThreadCoreAffinityMask(false));
+	if(policy == ThreadPlacementPolicy::kNone || threadCount == 0)
+	{
+		return;
+	}
+
+	CpuTopology topology;
+	getCpuTopology(topology);
+
+	// Rank the physical cores inside their L3 domain and the L3 domains inside their NUMA node. They are needed by the scatter policy
+	DynamicArray<U32> coreRanks;
+	coreRanks.resize(topology.m_physicalCoreCount, kMaxU32);
+	DynamicArray<U32> l3Ranks;
+	l3Ranks.resize(topology.m_l3DomainCount, kMaxU32);
+	{
+		DynamicArray<U32> l3CoreCounts;
+		l3CoreCounts.resize(topology.m_l3DomainCount, 0);
+		DynamicArray<U32> numaL3Counts;
+		for(const CpuLogicalCoreInfo& info : topology.m_logicalCores)
+		{
+			if(coreRanks[info.m_physicalCore] == kMaxU32)
+			{
+				coreRanks[info.m_physicalCore] = l3CoreCounts[info.m_l3Domain]++;
+			}
+
+			if(l3Ranks[info.m_l3Domain] == kMaxU32)
+			{
+				if(info.m_numaNode >= numaL3Counts.getSize())
+				{
+					numaL3Counts.resize(info.m_numaNode + 1, 0);
+				}
+				l3Ranks[info.m_l3Domain] = numaL3Counts[info.m_numaNode]++;
+			}
+		}
+	}
+
+	// Sort the logical cores in the order they will be assigned to threads
+	DynamicArray<U64> keys;
+	for(const CpuLogicalCoreInfo& info : topology.m_logicalCores)
+	{
+		Array<U32, 4> fields = {};
+		switch(policy)
+		{
+		case ThreadPlacementPolicy::kCompact:
+			fields = {info.m_numaNode, info.m_l3Domain, info.m_physicalCore, info.m_smtIndex};
+			break;
+		case ThreadPlacementPolicy::kScatter:
+			fields = {info.m_smtIndex, coreRanks[info.m_physicalCore], l3Ranks[info.m_l3Domain], info.m_numaNode};
+			break;
+		case ThreadPlacementPolicy::kSkipSmtSiblings:
+			fields = {info.m_smtIndex, info.m_numaNode, info.m_l3Domain, info.m_physicalCore};
+			break;
+		default:
+			ANKI_ASSERT(0);
+		}
+
+		// 12 bits per field is enough for 4K cores. The low 16 bits hold the index
+		U64 key = 0;
+		for(U32 field : fields)
+		{
+			key = (key << 12) | min<U32>(field, 0xFFF);
+		}
+		key = (key << 16) | U64(&info - topology.m_logicalCores.getBegin());
+		keys.emplaceBack(key);
+	}
+
+	std::sort(keys.getBegin(), keys.getEnd());
+
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		const U32 idx = U32(keys[i % keys.getSize()] & 0xFFFF);
+		const U32 logicalCoreId = topology.m_logicalCores[idx].m_logicalCoreId;
+		if(logicalCoreId < kMaxThreadCoreAffinityBits)
+		{
+			affinities[i].set(logicalCoreId);
+		}
+	}
+}
+
 void backtraceInternal(const Function<void(CString)>& lambda)
 {
 #if ANKI_POSIX && !ANKI_OS_ANDROID
@@ -8,6 +8,8 @@
 #include <AnKi/Util/StdTypes.h>
 #include <AnKi/Util/Function.h>
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/Thread.h>
 #include <ctime>
 
 namespace anki {
@@ -18,6 +20,38 @@ namespace anki {
 /// Get the number of CPU cores
 ANKI_PURE U32 getCpuCoresCount();
 
+/// Information about a logical core (a hardware thread).
+/// @memberof CpuTopology
+class CpuLogicalCoreInfo
+{
+public:
+	U32 m_logicalCoreId = 0; ///< The ID the OS uses in affinity masks.
+	U32 m_physicalCore = 0; ///< SMT siblings share the same physical core.
+	U32 m_smtIndex = 0; ///< 0 for the 1st hardware thread of a physical core, 1 for the 2nd etc.
+	U32 m_l3Domain = 0; ///< Logical cores that share an L3 cache have the same domain.
+	U32 m_numaNode = 0;
+};
+
+/// The layout of the CPU.
+class CpuTopology
+{
+public:
+	DynamicArray<CpuLogicalCoreInfo> m_logicalCores;
+	U32 m_physicalCoreCount = 0;
+	U32 m_l3DomainCount = 0;
+	U32 m_numaNodeCount = 0;
+};
+
+/// Query the CPU topology. On Linux it's read from /sys/devices/system/cpu. On other platforms every logical core is considered a physical
+/// core and all of them share a single L3 domain and NUMA node.
+void getCpuTopology(CpuTopology& topology);
+
+/// Compute the cores that each thread of a pool will be pinned to.
+/// @param policy The placement policy.
+/// @param threadCount The number of threads of the pool.
+/// @param[out] affinities The affinity of each thread. An empty mask means that the thread shouldn't be pinned.
+void computeThreadPlacement(ThreadPlacementPolicy policy, U32 threadCount, DynamicArray<ThreadCoreAffinityMask>& affinities);
+
 /// @internal
 void backtraceInternal(const Function<void(CString)>& lambda);
 
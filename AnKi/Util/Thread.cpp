@@ -4,6 +4,7 @@
 // http://www.anki3d.org/LICENSE
 
 #include <AnKi/Util/Thread.h>
+#include <AnKi/Util/MemoryPool.h>
 
 namespace anki {
 
@@ -36,4 +37,112 @@ const Char* Thread::getCurrentThreadName()
 	}
 }
 
+TreeBarrier::TreeBarrier(U32 threadCount, U32 fanIn)
+	: m_threadCount(threadCount)
+	, m_fanIn(fanIn)
+{
+	ANKI_ASSERT(threadCount > 0 && fanIn > 1);
+
+	// Count the nodes of all levels. The leaves are first and the root is last
+	U32 levelSize = threadCount;
+	do
+	{
+		levelSize = (levelSize + fanIn - 1) / fanIn;
+		m_nodeCount += levelSize;
+	} while(levelSize > 1);
+
+	m_nodes = static_cast<Node*>(mallocAligned(sizeof(Node) * m_nodeCount, alignof(Node)));
+	for(U32 i = 0; i < m_nodeCount; ++i)
+	{
+		::new(&m_nodes[i]) Node();
+	}
+
+	// Connect the nodes
+	U32 childCount = threadCount; // Children of the current level
+	U32 levelBegin = 0;
+	do
+	{
+		levelSize = (childCount + fanIn - 1) / fanIn;
+		for(U32 i = 0; i < levelSize; ++i)
+		{
+			Node& node = m_nodes[levelBegin + i];
+			node.m_expectedCount = min(fanIn, childCount - i * fanIn);
+			node.m_parent = (levelSize > 1) ? levelBegin + levelSize + i / fanIn : kMaxU32;
+		}
+
+		levelBegin += levelSize;
+		childCount = levelSize;
+	} while(levelSize > 1);
+
+	ANKI_ASSERT(levelBegin == m_nodeCount);
+}
+
+TreeBarrier::~TreeBarrier()
+{
+	for(U32 i = 0; i < m_nodeCount; ++i)
+	{
+		m_nodes[i].~Node();
+	}
+
+	freeAligned(m_nodes);
+}
+
+void TreeBarrier::wait(U32 threadIdx)
+{
+	ANKI_ASSERT(threadIdx < m_threadCount);
+
+	const U32 generation = m_generation.load(AtomicMemoryOrder::kAcquire);
+
+	// Climb the tree while being the last to arrive to a node
+	U32 nodeIdx = threadIdx / m_fanIn;
+	while(true)
+	{
+		Node& node = m_nodes[nodeIdx];
+		const U32 arrived = node.m_arrivedCount.fetchAdd(1, AtomicMemoryOrder::kAcqRel) + 1;
+		if(arrived < node.m_expectedCount)
+		{
+			break;
+		}
+
+		// Last one, reset the node for the next use. No one will touch the node before the release
+		node.m_arrivedCount.store(0, AtomicMemoryOrder::kRelaxed);
+
+		if(node.m_parent == kMaxU32)
+		{
+			// Root, release everyone
+			m_generation.store(generation + 1, AtomicMemoryOrder::kSeqCst);
+			if(m_sleepingCount.load(AtomicMemoryOrder::kSeqCst) > 0)
+			{
+				LockGuard lock(m_mtx);
+				m_cvar.notifyAll();
+			}
+
+			return;
+		}
+
+		nodeIdx = node.m_parent;
+	}
+
+	// Wait for the release. Spin a bit first since the other threads are probably close
+	for(U32 spinCount = 0; spinCount < 1024; ++spinCount)
+	{
+		if(m_generation.load(AtomicMemoryOrder::kAcquire) != generation)
+		{
+			return;
+		}
+
+#if ANKI_SIMD_SSE
+		_mm_pause();
+#endif
+	}
+
+	LockGuard lock(m_mtx);
+	m_sleepingCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+	while(m_generation.load(AtomicMemoryOrder::kSeqCst) == generation)
+	{
+		m_cvar.wait(m_mtx);
+	}
+	m_sleepingCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
+}
+
 } // end namespace anki
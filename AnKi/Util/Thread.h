@@ -29,9 +29,24 @@ namespace anki {
 /// @memberof Thread
 using ThreadId = U64;
 
+/// The max number of logical cores a ThreadCoreAffinityMask can address.
+/// @memberof Thread
+constexpr U32 kMaxThreadCoreAffinityBits = 256;
+
 /// Core affinity mask.
 /// @memberof Thread
-using ThreadCoreAffinityMask = BitSet<256, U64>;
+using ThreadCoreAffinityMask = BitSet<kMaxThreadCoreAffinityBits, U64>;
+
+/// How the threads of a thread pool are placed to the CPU cores. @see computeThreadPlacement
+enum class ThreadPlacementPolicy : U8
+{
+	kNone, ///< Don't pin the threads.
+	kCompact, ///< Fill all the hardware threads of a physical core before moving to the next core of the same L3 domain and NUMA node.
+	kScatter, ///< Spread the threads across NUMA nodes, L3 domains and then physical cores. Good for bandwidth bound work.
+	kSkipSmtSiblings, ///< One thread per physical core, filling one NUMA node at a time. SMT siblings are used only if there are more threads.
+
+	kCount
+};
 
 /// It holds some information to be passed to the thread's callback.
 /// @memberof Thread
@@ -479,6 +494,91 @@ private:
 #endif
 };
 
+/// A barrier for a large number of threads. The threads arrive to the leaves of a tree of counters and only the last thread that arrives
+/// to a node moves to its parent, so no counter is touched by more than fanIn threads. The last thread that arrives to the root releases
+/// everyone. Waiters spin for a while and then sleep.
+class TreeBarrier
+{
+public:
+	/// @param threadCount The number of threads that will call wait().
+	/// @param fanIn The number of children of each node.
+	TreeBarrier(U32 threadCount, U32 fanIn = 4);
+
+	TreeBarrier(const TreeBarrier&) = delete;
+
+	~TreeBarrier();
+
+	TreeBarrier& operator=(const TreeBarrier&) = delete;
+
+	/// Wait until all threads call wait().
+	/// @param threadIdx A unique index of the calling thread in [0, threadCount).
+	void wait(U32 threadIdx);
+
+	U32 getThreadCount() const
+	{
+		return m_threadCount;
+	}
+
+private:
+	class alignas(ANKI_CACHE_LINE_SIZE) Node
+	{
+	public:
+		Atomic<U32> m_arrivedCount = {0};
+		U32 m_expectedCount = 0;
+		U32 m_parent = kMaxU32;
+	};
+
+	Node* m_nodes = nullptr;
+	U32 m_nodeCount = 0;
+	U32 m_threadCount = 0;
+	U32 m_fanIn = 0;
+
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U32> m_generation = {0};
+	Atomic<U32> m_sleepingCount = {0};
+	Mutex m_mtx;
+	ConditionVariable m_cvar;
+};
+
+/// A 32bit value that threads can sleep on until someone wakes them. Unlike ConditionVariable it doesn't need a mutex and the wakers can
+/// choose how many threads to wake. It's a futex on Linux and Android and std::atomic::wait everywhere else.
+class Futex
+{
+public:
+	Futex(U32 value = 0)
+		: m_value(value)
+	{
+	}
+
+	Futex(const Futex&) = delete; // Non-copyable
+
+	Futex& operator=(const Futex&) = delete; // Non-copyable
+
+	Atomic<U32>& getValue()
+	{
+		return m_value;
+	}
+
+	const Atomic<U32>& getValue() const
+	{
+		return m_value;
+	}
+
+	/// Sleep if the value is equal to expectedValue. It might return spuriously so the caller should check the value again.
+	void wait(U32 expectedValue);
+
+	/// Wake at most threadCount threads that sleep on the futex.
+	void wake(U32 threadCount);
+
+	/// Wake all threads that sleep on the futex.
+	void wakeAll()
+	{
+		wake(kMaxU32);
+	}
+
+private:
+	Atomic<U32> m_value;
+};
+
 /// Semaphore for thread synchronization.
 class Semaphore
 {
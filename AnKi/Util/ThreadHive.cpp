@@ -5,12 +5,14 @@
 
 #include <AnKi/Util/ThreadHive.h>
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/System.h>
 #include <cstring>
 #include <cstdio>
 
 namespace anki {
 
 Atomic<U32> ThreadHive::m_uuid = {0};
+thread_local ThreadHive::Thread* ThreadHive::m_threadTls = nullptr;
 
 #define ANKI_ENABLE_HIVE_DEBUG_PRINT 0
 
@@ -20,21 +22,24 @@ Atomic<U32> ThreadHive::m_uuid = {0};
 #	define ANKI_HIVE_DEBUG_PRINT(...) ((void)0)
 #endif
 
-class ThreadHive::Thread
+class alignas(ANKI_CACHE_LINE_SIZE) ThreadHive::Thread
 {
 public:
 	U32 m_id; ///< An ID
 	anki::Thread m_thread; ///< Runs the workingFunc
 	ThreadHive* m_hive;
 
+	/// It's 1 when the thread sleeps or is about to. Whoever changes it to 0 wakes the thread and decrements m_sleepingThreadCount.
+	Futex m_sleeping = {0};
+
 	/// Constructor
-	Thread(U32 id, ThreadHive* hive, Bool pinToCore, CString threadName)
+	Thread(U32 id, ThreadHive* hive, const ThreadCoreAffinityMask& affinity, CString threadName)
 		: m_id(id)
 		, m_thread(threadName.cstr())
 		, m_hive(hive)
 	{
 		ANKI_ASSERT(hive);
-		m_thread.start(this, threadCallback, ThreadCoreAffinityMask(false).set(m_id, pinToCore));
+		m_thread.start(this, threadCallback, affinity);
 	}
 
 private:
@@ -42,6 +47,7 @@ private:
 	static Error threadCallback(anki::ThreadCallbackInfo& info)
 	{
 		Thread& self = *static_cast<Thread*>(info.m_userData);
+		m_threadTls = &self;
 
 		self.m_hive->threadRun(self.m_id);
 		return Error::kNone;
@@ -51,7 +57,7 @@ private:
 class ThreadHive::Task
 {
 public:
-	Task* m_next; ///< Next in the list.
+	Task* m_next; ///< Next in the free list or in the overflow list.
 
 	ThreadHiveTaskCallback m_cb; ///< Callback that defines the task.
 	void* m_arg; ///< Args for the callback.
@@ -60,19 +66,32 @@ public:
 	ThreadHiveSemaphore* m_signalSemaphore;
 };
 
-ThreadHive::ThreadHive(U32 threadCount, Bool pinToCores)
+ThreadHive::ThreadHive(U32 threadCount, ThreadPlacementPolicy placement)
 	: m_pool(stackPoolAllocate, nullptr, 4_KB)
 	, m_threadCount(threadCount)
 {
+	m_queue = static_cast<TaskQueueCell*>(DefaultMemoryPool::getSingleton().allocate(sizeof(TaskQueueCell) * kTaskQueueSize, ANKI_CACHE_LINE_SIZE));
+	for(U32 i = 0; i < kTaskQueueSize; ++i)
+	{
+		::new(&m_queue[i]) TaskQueueCell();
+		m_queue[i].m_sequence.setNonAtomically(i);
+		m_queue[i].m_task = nullptr;
+	}
+
+	m_freeLists = newArray<TaskFreeList>(DefaultMemoryPool::getSingleton(), threadCount + 1);
+
 	m_threads = static_cast<Thread*>(DefaultMemoryPool::getSingleton().allocate(sizeof(Thread) * threadCount, alignof(Thread)));
 
 	const U32 uuid = m_uuid.fetchAdd(1);
 
+	DynamicArray<ThreadCoreAffinityMask> affinities;
+	computeThreadPlacement(placement, threadCount, affinities);
+
 	for(U32 i = 0; i < threadCount; ++i)
 	{
 		Array<Char, 32> threadName;
 		snprintf(&threadName[0], threadName.getSize(), "Hive#%u/#%u", uuid, i);
-		::new(&m_threads[i]) Thread(i, this, pinToCores, &threadName[0]);
+		::new(&m_threads[i]) Thread(i, this, affinities[i], &threadName[0]);
 	}
 }
 
@@ -80,13 +99,9 @@ ThreadHive::~ThreadHive()
 {
 	if(m_threads)
 	{
-		{
-			LockGuard<Mutex> lock(m_mtx);
-			m_quit = true;
-
-			// Wake the threads
-			m_cvar.notifyAll();
-		}
+		// Wake the threads
+		m_quit.store(1, AtomicMemoryOrder::kSeqCst);
+		wakeThreads(kMaxU32);
 
 		// Join and destroy
 		U32 threadCount = m_threadCount;
@@ -98,60 +113,236 @@ ThreadHive::~ThreadHive()
 
 		DefaultMemoryPool::getSingleton().free(static_cast<void*>(m_threads));
 	}
+
+	for(Task* block : m_taskBlocks)
+	{
+		DefaultMemoryPool::getSingleton().free(block);
+	}
+
+	deleteArray(DefaultMemoryPool::getSingleton(), m_freeLists, m_threadCount + 1);
+
+	for(U32 i = 0; i < kTaskQueueSize; ++i)
+	{
+		m_queue[i].~TaskQueueCell();
+	}
+	DefaultMemoryPool::getSingleton().free(m_queue);
 }
 
-void ThreadHive::submitTasks(ThreadHiveTask* tasks, const U32 taskCount)
+ThreadHive::Task* ThreadHive::newTask(U32 freeListIdx)
 {
-	ANKI_ASSERT(tasks && taskCount > 0);
+	TaskFreeList& list = m_freeLists[freeListIdx];
+	const Bool shared = freeListIdx == m_threadCount;
+	if(shared)
+	{
+		list.m_lock.lock();
+	}
 
-	// Allocate tasks
-	Task* const htasks = newArray<Task>(m_pool, taskCount);
+	Task* task = list.m_head;
+	if(task)
+	{
+		list.m_head = task->m_next;
+		if(list.m_head == nullptr)
+		{
+			list.m_tail = nullptr;
+		}
+	}
+	else
+	{
+		// Out of nodes, allocate a new block. Keep the 1st node and put the rest in the free list
+		Task* block = static_cast<Task*>(DefaultMemoryPool::getSingleton().allocate(sizeof(Task) * kTaskBlockSize, alignof(Task)));
+		{
+			LockGuard lock(m_taskBlocksLock);
+			m_taskBlocks.emplaceBack(block);
+		}
 
-	// Initialize tasks
-	Task* prevTask = nullptr;
-	for(U32 i = 0; i < taskCount; ++i)
+		for(U32 i = 1; i < kTaskBlockSize; ++i)
+		{
+			block[i].m_next = (i + 1 < kTaskBlockSize) ? &block[i + 1] : nullptr;
+		}
+
+		task = &block[0];
+		list.m_head = &block[1];
+		list.m_tail = &block[kTaskBlockSize - 1];
+	}
+
+	if(shared)
 	{
-		const ThreadHiveTask& inTask = tasks[i];
-		Task& outTask = htasks[i];
+		list.m_lock.unlock();
+	}
 
-		outTask.m_next = nullptr;
-		outTask.m_cb = inTask.m_callback;
-		outTask.m_arg = inTask.m_argument;
-		outTask.m_waitSemaphore = inTask.m_waitSemaphore;
-		outTask.m_signalSemaphore = inTask.m_signalSemaphore;
+	return task;
+}
 
-		// Connect tasks
-		if(prevTask)
+void ThreadHive::deleteTask(Task* task, U32 freeListIdx)
+{
+	TaskFreeList& list = m_freeLists[freeListIdx];
+	const Bool shared = freeListIdx == m_threadCount;
+	if(shared)
+	{
+		list.m_lock.lock();
+	}
+
+	task->m_next = list.m_head;
+	list.m_head = task;
+	if(list.m_tail == nullptr)
+	{
+		list.m_tail = task;
+	}
+
+	if(shared)
+	{
+		list.m_lock.unlock();
+	}
+}
+
+void ThreadHive::pushTask(Task* task)
+{
+	// Vyukov's bounded MPMC queue
+	const U32 mask = kTaskQueueSize - 1;
+	U32 pos = m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
+	TaskQueueCell* cell;
+	while(true)
+	{
+		cell = &m_queue[pos & mask];
+		const U32 seq = cell->m_sequence.load(AtomicMemoryOrder::kAcquire);
+		const I32 diff = I32(seq - pos);
+		if(diff == 0)
 		{
-			prevTask->m_next = &outTask;
+			if(m_enqueuePos.compareExchange(pos, pos + 1, AtomicMemoryOrder::kRelaxed, AtomicMemoryOrder::kRelaxed))
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			// Full, use the overflow list
+			task->m_next = nullptr;
+
+			LockGuard lock(m_overflowLock);
+			if(m_overflowTail)
+			{
+				m_overflowTail->m_next = task;
+			}
+			else
+			{
+				m_overflowHead = task;
+			}
+			m_overflowTail = task;
+			m_overflowCount.fetchAdd(1, AtomicMemoryOrder::kRelease);
+			return;
+		}
+		else
+		{
+			pos = m_enqueuePos.load(AtomicMemoryOrder::kRelaxed);
 		}
-		prevTask = &outTask;
 	}
 
-	// Push work
-	{
-		LockGuard<Mutex> lock(m_mtx);
+	cell->m_task = task;
+	cell->m_sequence.store(pos + 1, AtomicMemoryOrder::kRelease);
+}
 
-		if(m_head != nullptr)
+ThreadHive::Task* ThreadHive::popTask()
+{
+	const U32 mask = kTaskQueueSize - 1;
+	U32 pos = m_dequeuePos.load(AtomicMemoryOrder::kRelaxed);
+	TaskQueueCell* cell;
+	while(true)
+	{
+		cell = &m_queue[pos & mask];
+		const U32 seq = cell->m_sequence.load(AtomicMemoryOrder::kAcquire);
+		const I32 diff = I32(seq - (pos + 1));
+		if(diff == 0)
 		{
-			ANKI_ASSERT(m_tail && m_head);
-			m_tail->m_next = &htasks[0];
-			m_tail = &htasks[taskCount - 1];
+			if(m_dequeuePos.compareExchange(pos, pos + 1, AtomicMemoryOrder::kRelaxed, AtomicMemoryOrder::kRelaxed))
+			{
+				break;
+			}
+		}
+		else if(diff < 0)
+		{
+			// Empty, try the overflow list
+			Task* task = nullptr;
+			if(m_overflowCount.load(AtomicMemoryOrder::kAcquire) > 0)
+			{
+				LockGuard lock(m_overflowLock);
+				task = m_overflowHead;
+				if(task)
+				{
+					m_overflowHead = task->m_next;
+					if(m_overflowHead == nullptr)
+					{
+						m_overflowTail = nullptr;
+					}
+					m_overflowCount.fetchSub(1, AtomicMemoryOrder::kRelaxed);
+				}
+			}
+
+			return task;
 		}
 		else
 		{
-			ANKI_ASSERT(m_tail == nullptr);
-			m_head = &htasks[0];
-			m_tail = &htasks[taskCount - 1];
+			pos = m_dequeuePos.load(AtomicMemoryOrder::kRelaxed);
 		}
+	}
 
-		m_pendingTasks += taskCount;
+	Task* task = cell->m_task;
+	cell->m_sequence.store(pos + mask + 1, AtomicMemoryOrder::kRelease);
+	return task;
+}
 
-		ANKI_HIVE_DEBUG_PRINT("submit tasks\n");
+void ThreadHive::wakeThreads(U32 threadCount)
+{
+	// Pairs with the sleeping threads that increment m_sleepingThreadCount and then check m_workEpoch
+	m_workEpoch.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+	if(m_sleepingThreadCount.load(AtomicMemoryOrder::kSeqCst) == 0)
+	{
+		return;
 	}
 
-	// Notify all threads
-	m_cvar.notifyAll();
+	// Wake specific threads so no syscall is wasted on threads that are already awake
+	const U32 firstThread = m_nextThreadToWake.fetchAdd(1, AtomicMemoryOrder::kRelaxed);
+	for(U32 i = 0; i < m_threadCount && threadCount > 0; ++i)
+	{
+		Thread& thread = m_threads[(firstThread + i) % m_threadCount];
+		U32 sleeping = 1;
+		if(thread.m_sleeping.getValue().load(AtomicMemoryOrder::kSeqCst) == 1
+		   && thread.m_sleeping.getValue().compareExchange(sleeping, 0, AtomicMemoryOrder::kSeqCst, AtomicMemoryOrder::kRelaxed))
+		{
+			m_sleepingThreadCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
+			thread.m_sleeping.wake(1);
+			--threadCount;
+		}
+	}
+}
+
+void ThreadHive::submitTasks(ThreadHiveTask* tasks, const U32 taskCount)
+{
+	ANKI_ASSERT(tasks && taskCount > 0);
+
+	const U32 freeListIdx = (m_threadTls && m_threadTls->m_hive == this) ? m_threadTls->m_id : m_threadCount;
+
+	// Count them before they become visible to the threads
+	m_pendingTasks.getValue().fetchAdd(taskCount, AtomicMemoryOrder::kRelaxed);
+	m_queuedTaskCount.fetchAdd(taskCount, AtomicMemoryOrder::kRelaxed);
+
+	for(U32 i = 0; i < taskCount; ++i)
+	{
+		const ThreadHiveTask& inTask = tasks[i];
+		Task& outTask = *newTask(freeListIdx);
+
+		outTask.m_next = nullptr;
+		outTask.m_cb = inTask.m_callback;
+		outTask.m_arg = inTask.m_argument;
+		outTask.m_waitSemaphore = inTask.m_waitSemaphore;
+		outTask.m_signalSemaphore = inTask.m_signalSemaphore;
+
+		pushTask(&outTask);
+	}
+
+	ANKI_HIVE_DEBUG_PRINT("submit tasks\n");
+
+	// Wake as many threads as the tasks
+	wakeThreads(taskCount);
 }
 
 void ThreadHive::threadRun(U32 threadId)
@@ -172,97 +363,152 @@ void ThreadHive::threadRun(U32 threadId)
 		// Signal the semaphore as early as possible
 		if(task->m_signalSemaphore)
 		{
-			[[maybe_unused]] const U32 out = task->m_signalSemaphore->m_atomic.fetchSub(1);
+			const U32 out = task->m_signalSemaphore->m_atomic.fetchSub(1, AtomicMemoryOrder::kAcqRel);
 			ANKI_ASSERT(out > 0u);
 			ANKI_HIVE_DEBUG_PRINT("\tsem is %u\n", out - 1u);
+
+			if(out == 1)
+			{
+				// A dependency got resolved, the tasks that wait on it can't be known so wake everyone
+				wakeThreads(kMaxU32);
+			}
+		}
+
+		// Recycle the task before completing it. waitAllTasks() touches the free lists
+		deleteTask(task, threadId);
+		task = nullptr;
+
+		if(m_pendingTasks.getValue().fetchSub(1, AtomicMemoryOrder::kAcqRel) == 1)
+		{
+			ANKI_HIVE_DEBUG_PRINT("tid: %lu out of tasks\n", threadId);
+			m_pendingTasks.wakeAll();
 		}
 	}
 
 	ANKI_HIVE_DEBUG_PRINT("tid: %lu thread quits!\n", threadId);
 }
 
-Bool ThreadHive::waitForWork([[maybe_unused]] U32 threadId, Task*& task)
+Bool ThreadHive::waitForWork(U32 threadId, Task*& task)
 {
-	LockGuard<Mutex> lock(m_mtx);
+	Futex& sleeping = m_threads[threadId].m_sleeping;
 
-	ANKI_HIVE_DEBUG_PRINT("tid: %lu locking\n", threadId);
-
-	// Complete the previous task
-	if(task)
+	while(true)
 	{
-		--m_pendingTasks;
+		// Read the epoch before looking for work. If someone submits after that the epoch will change and the thread will not sleep
+		const U32 epoch = m_workEpoch.load(AtomicMemoryOrder::kSeqCst);
 
-		if(task->m_signalSemaphore || m_pendingTasks == 0)
+		task = getNewTask();
+		if(task)
 		{
-			// A dependency maybe got resolved or we are out of tasks. Wake them all
-			ANKI_HIVE_DEBUG_PRINT("tid: %lu wake all\n", threadId);
-			m_cvar.notifyAll();
+			return false;
+		}
+
+		if(m_quit.load(AtomicMemoryOrder::kSeqCst))
+		{
+			return true;
+		}
+
+		// More work usually comes soon, give it a chance before sleeping
+		Bool epochChanged = false;
+		for(U32 i = 0; i < kSpinCountBeforeSleep && !epochChanged; ++i)
+		{
+			std::this_thread::yield();
+			epochChanged = m_workEpoch.load(AtomicMemoryOrder::kSeqCst) != epoch;
+		}
+
+		if(epochChanged)
+		{
+			continue;
 		}
-	}
 
-	while(!m_quit && (task = getNewTask()) == nullptr)
-	{
 		ANKI_HIVE_DEBUG_PRINT("tid: %lu waiting\n", threadId);
 
-		// Wait if there is no work.
-		m_cvar.wait(m_mtx);
-	}
+		sleeping.getValue().store(1, AtomicMemoryOrder::kSeqCst);
+		m_sleepingThreadCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+
+		if(m_workEpoch.load(AtomicMemoryOrder::kSeqCst) != epoch)
+		{
+			// Something changed, don't sleep. If the CAS fails a waker already took care of the counter
+			U32 one = 1;
+			if(sleeping.getValue().compareExchange(one, 0, AtomicMemoryOrder::kSeqCst, AtomicMemoryOrder::kRelaxed))
+			{
+				m_sleepingThreadCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
+			}
 
-	return m_quit;
+			continue;
+		}
+
+		while(sleeping.getValue().load(AtomicMemoryOrder::kSeqCst) == 1)
+		{
+			sleeping.wait(1);
+		}
+	}
 }
 
 ThreadHive::Task* ThreadHive::getNewTask()
 {
-	Task* prevTask = nullptr;
-	Task* task = m_head;
-	while(task)
+	// Tasks that wait on a semaphore go back to the queue. Look at every queued task at most once
+	U32 attempts = m_queuedTaskCount.load(AtomicMemoryOrder::kAcquire);
+	while(attempts-- > 0)
 	{
+		Task* task = popTask();
+		if(task == nullptr)
+		{
+			break;
+		}
+
 		// Check if there are dependencies
-		const Bool allDepsCompleted = task->m_waitSemaphore == nullptr || task->m_waitSemaphore->m_atomic.load() == 0;
+		const Bool allDepsCompleted = task->m_waitSemaphore == nullptr || task->m_waitSemaphore->m_atomic.load(AtomicMemoryOrder::kAcquire) == 0;
 
 		if(allDepsCompleted)
 		{
-			// Found something, pop it
-			if(prevTask)
-			{
-				prevTask->m_next = task->m_next;
-			}
-
-			if(m_head == task)
-			{
-				m_head = task->m_next;
-			}
-
-			if(m_tail == task)
-			{
-				m_tail = prevTask;
-			}
-
-#if ANKI_EXTRA_CHECKS
-			task->m_next = nullptr;
-#endif
-			break;
+			m_queuedTaskCount.fetchSub(1, AtomicMemoryOrder::kRelaxed);
+			return task;
 		}
 
-		prevTask = task;
-		task = task->m_next;
+		pushTask(task);
 	}
 
-	return task;
+	return nullptr;
 }
 
 void ThreadHive::waitAllTasks()
 {
 	ANKI_HIVE_DEBUG_PRINT("mt: waiting all\n");
 
-	LockGuard<Mutex> lock(m_mtx);
-	while(m_pendingTasks > 0)
+	while(true)
 	{
-		m_cvar.wait(m_mtx);
+		const U32 pending = m_pendingTasks.getValue().load(AtomicMemoryOrder::kAcquire);
+		if(pending == 0)
+		{
+			break;
+		}
+
+		m_pendingTasks.wait(pending);
+	}
+
+	// The threads are idle. Give the nodes they recycled to the non-hive threads since they are the ones that submit most of the work
+	TaskFreeList& sharedList = m_freeLists[m_threadCount];
+	LockGuard lock(sharedList.m_lock);
+	for(U32 i = 0; i < m_threadCount; ++i)
+	{
+		TaskFreeList& list = m_freeLists[i];
+		if(list.m_head == nullptr)
+		{
+			continue;
+		}
+
+		list.m_tail->m_next = sharedList.m_head;
+		sharedList.m_head = list.m_head;
+		if(sharedList.m_tail == nullptr)
+		{
+			sharedList.m_tail = list.m_tail;
+		}
+
+		list.m_head = nullptr;
+		list.m_tail = nullptr;
 	}
 
-	m_head = nullptr;
-	m_tail = nullptr;
 	m_pool.reset();
 
 	ANKI_HIVE_DEBUG_PRINT("mt: done waiting all\n");
@@ -8,6 +8,7 @@
 #include <AnKi/Util/Thread.h>
 #include <AnKi/Util/WeakArray.h>
 #include <AnKi/Util/MemoryPool.h>
+#include <AnKi/Util/DynamicArray.h>
 
 namespace anki {
 
@@ -72,13 +73,15 @@ public:
 
 /// A scheduler of small tasks. It takes a number of tasks and schedules them in one of the threads. The tasks can
 /// depend on previously submitted tasks or be completely independent.
+/// Submission is lock-free, the task nodes are recycled in per-thread free lists and every idle thread sleeps on its own futex so
+/// submitters can wake only as many threads as the tasks they submitted.
 class ThreadHive
 {
 public:
-	static constexpr U32 kMaxThreads = 32;
-
 	/// Create the hive.
-	ThreadHive(U32 threadCount, Bool pinToCores = false);
+	/// @param threadCount The number of threads.
+	/// @param placement How the threads will be pinned to the CPU cores.
+	ThreadHive(U32 threadCount, ThreadPlacementPolicy placement = ThreadPlacementPolicy::kNone);
 
 	ThreadHive(const ThreadHive&) = delete; // Non-copyable
 
@@ -133,19 +136,56 @@ private:
 	/// Lightweight task.
 	class Task;
 
-	StackMemoryPool m_pool;
+	/// A list of recycled Task nodes. Every thread has one.
+	class alignas(ANKI_CACHE_LINE_SIZE) TaskFreeList
+	{
+	public:
+		Task* m_head = nullptr;
+		Task* m_tail = nullptr;
+		SpinLock m_lock; ///< Only the list of the non-hive threads needs it.
+	};
+
+	/// A cell of the submission queue.
+	class TaskQueueCell
+	{
+	public:
+		Atomic<U32> m_sequence;
+		Task* m_task;
+	};
+
+	static constexpr U32 kTaskQueueSize = 4096;
+	static constexpr U32 kSpinCountBeforeSleep = 16;
+	static constexpr U32 kTaskBlockSize = 64; ///< Task nodes are allocated in blocks of that many.
+
+	StackMemoryPool m_pool; ///< Semaphores and scratch memory.
 	Thread* m_threads = nullptr;
 	U32 m_threadCount = 0;
 
-	Task* m_head = nullptr; ///< Head of the task list.
-	Task* m_tail = nullptr; ///< Tail of the task list.
-	Bool m_quit = false;
-	U32 m_pendingTasks = 0;
-
-	Mutex m_mtx;
-	ConditionVariable m_cvar;
+	/// Bounded lock-free MPMC queue (Vyukov) of submitted tasks. Tasks that are waiting on a semaphore cycle back into it.
+	TaskQueueCell* m_queue = nullptr;
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U32> m_enqueuePos = {0};
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U32> m_dequeuePos = {0};
+
+	/// Tasks that didn't fit in m_queue.
+	alignas(ANKI_CACHE_LINE_SIZE) Task* m_overflowHead = nullptr;
+	Task* m_overflowTail = nullptr;
+	SpinLock m_overflowLock;
+	Atomic<U32> m_overflowCount = {0};
+
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<U32> m_queuedTaskCount = {0}; ///< Tasks in m_queue and in the overflow list.
+	Futex m_pendingTasks; ///< Submitted tasks that haven't finished. waitAllTasks() sleeps on it.
+	Atomic<U32> m_workEpoch = {0}; ///< Incremented when new work may be available.
+	Atomic<U32> m_sleepingThreadCount = {0};
+	Atomic<U32> m_nextThreadToWake = {0};
+	Atomic<U32> m_quit = {0};
+
+	/// m_threadCount + 1 free lists. The last one is shared by all non-hive threads.
+	TaskFreeList* m_freeLists = nullptr;
+	DynamicArray<Task*> m_taskBlocks;
+	SpinLock m_taskBlocksLock;
 
 	static Atomic<U32> m_uuid;
+	static thread_local Thread* m_threadTls;
 
 	void threadRun(U32 threadId);
 
@@ -155,6 +195,15 @@ private:
 	/// Get new work from the queue.
 	Task* getNewTask();
 
+	void pushTask(Task* task);
+	Task* popTask();
+
+	Task* newTask(U32 freeListIdx);
+	void deleteTask(Task* task, U32 freeListIdx);
+
+	/// New work is available. Wake up to threadCount idle threads.
+	void wakeThreads(U32 threadCount);
+
 	static void* stackPoolAllocate([[maybe_unused]] void* userData, void* ptr, PtrSize size, PtrSize alignment)
 	{
 		if(ptr)
@@ -5,48 +5,188 @@
 
 #include <AnKi/Util/ThreadJobManager.h>
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/System.h>
 
 namespace anki {
 
+thread_local ThreadJobManager::WorkerThread* ThreadJobManager::m_workerTls = nullptr;
+
+void ThreadJobDeleter::operator()(ThreadJob* job)
+{
+	job->m_manager->deleteTask(job);
+}
+
+/// Chase-Lev work-stealing deque of fixed capacity. Based on "Correct and Efficient Work-Stealing for Weak Memory Models" (Le et al. 2013). The
+/// owner pushes and pops at the bottom, thieves steal from the top.
+class ThreadJobManager::WorkStealingQueue
+{
+public:
+	WorkStealingQueue(U32 capacity)
+	{
+		ANKI_ASSERT(isPowerOfTwo(capacity));
+		m_mask = capacity - 1;
+		m_slots = newArray<Atomic<ThreadJob*>>(DefaultMemoryPool::getSingleton(), capacity);
+		for(U32 i = 0; i < capacity; ++i)
+		{
+			m_slots[i].setNonAtomically(nullptr);
+		}
+	}
+
+	~WorkStealingQueue()
+	{
+		ANKI_ASSERT(m_top.load() == m_bottom.load() && "Queue not empty");
+		deleteArray(DefaultMemoryPool::getSingleton(), m_slots, m_mask + 1);
+	}
+
+	/// Only the owner can call it.
+	/// @return False if the queue is full.
+	Bool push(ThreadJob* task)
+	{
+		const I64 b = m_bottom.load(AtomicMemoryOrder::kRelaxed);
+		const I64 t = m_top.load(AtomicMemoryOrder::kAcquire);
+		if(b - t > I64(m_mask))
+		{
+			return false;
+		}
+
+		// Publish the slot with a release store. The thieves acquire m_bottom
+		m_slots[b & m_mask].store(task, AtomicMemoryOrder::kRelaxed);
+		m_bottom.store(b + 1, AtomicMemoryOrder::kRelease);
+		return true;
+	}
+
+	/// Only the owner can call it.
+	ThreadJob* pop()
+	{
+		const I64 b = m_bottom.load(AtomicMemoryOrder::kRelaxed) - 1;
+		m_bottom.store(b, AtomicMemoryOrder::kRelaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		I64 t = m_top.load(AtomicMemoryOrder::kRelaxed);
+
+		ThreadJob* task = nullptr;
+		if(t <= b)
+		{
+			task = m_slots[b & m_mask].load(AtomicMemoryOrder::kRelaxed);
+			if(t == b)
+			{
+				// Last element, race against the thieves
+				if(!m_top.compareExchange(t, t + 1, AtomicMemoryOrder::kSeqCst, AtomicMemoryOrder::kRelaxed))
+				{
+					task = nullptr;
+				}
+				m_bottom.store(b + 1, AtomicMemoryOrder::kRelaxed);
+			}
+		}
+		else
+		{
+			// Empty
+			m_bottom.store(b + 1, AtomicMemoryOrder::kRelaxed);
+		}
+
+		return task;
+	}
+
+	/// Any thread can call it.
+	ThreadJob* steal()
+	{
+		I64 t = m_top.load(AtomicMemoryOrder::kAcquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const I64 b = m_bottom.load(AtomicMemoryOrder::kAcquire);
+
+		ThreadJob* task = nullptr;
+		if(t < b)
+		{
+			task = m_slots[t & m_mask].load(AtomicMemoryOrder::kRelaxed);
+			if(!m_top.compareExchange(t, t + 1, AtomicMemoryOrder::kSeqCst, AtomicMemoryOrder::kRelaxed))
+			{
+				// Lost the race
+				task = nullptr;
+			}
+		}
+
+		return task;
+	}
+
+private:
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<I64> m_top = {0};
+	alignas(ANKI_CACHE_LINE_SIZE) Atomic<I64> m_bottom = {0};
+	Atomic<ThreadJob*>* m_slots = nullptr;
+	U32 m_mask = 0;
+};
+
 class ThreadJobManager::WorkerThread
 {
 public:
 	U32 m_id;
 	Thread m_thread;
 	ThreadJobManager* m_manager;
+	WorkStealingQueue* m_queue = nullptr;
+	JobFreeList m_freeList; ///< Only this thread touches it.
 
-	WorkerThread(ThreadJobManager* manager, U32 id, Bool pinToCore, CString threadName)
+	WorkerThread(ThreadJobManager* manager, U32 id, CString threadName)
 		: m_id(id)
 		, m_thread(threadName.cstr())
 		, m_manager(manager)
 	{
-		m_thread.start(this, threadCallback, ThreadCoreAffinityMask(false).set(m_id, pinToCore));
+	}
+
+	~WorkerThread()
+	{
+		deleteInstance(DefaultMemoryPool::getSingleton(), m_queue);
 	}
 
 	static Error threadCallback(ThreadCallbackInfo& info)
 	{
 		WorkerThread& self = *static_cast<WorkerThread*>(info.m_userData);
-		self.m_manager->threadRun(self.m_id);
+		ThreadJobManager& manager = *self.m_manager;
+
+		// Wait for the thread to be pinned and then allocate the queue from the thread itself. With the first-touch policy of the OS the memory
+		// will come from the NUMA node of the thread
+		manager.m_initBarrier.wait();
+		self.m_queue = newInstance<WorkStealingQueue>(DefaultMemoryPool::getSingleton(), manager.m_queueSize);
+		manager.m_initBarrier.wait();
+
+		m_workerTls = &self;
+		manager.threadRun(self.m_id);
+		m_workerTls = nullptr;
 		return Error::kNone;
 	}
 };
 
-ThreadJobManager::ThreadJobManager(U32 threadCount, Bool pinToCores, U32 queueSize)
+ThreadJobManager::ThreadJobManager(U32 threadCount, ThreadPlacementPolicy placement, U32 queueSize)
+	: m_initBarrier(threadCount + 1)
 {
 	ANKI_ASSERT(threadCount);
+	ANKI_ASSERT(queueSize);
+	m_queueSize = nextPowerOfTwo(queueSize);
+
+	m_submitQueue = newInstance<WorkStealingQueue>(DefaultMemoryPool::getSingleton(), m_queueSize);
+
+	DynamicArray<ThreadCoreAffinityMask> affinities;
+	computeThreadPlacement(placement, threadCount, affinities);
+
 	m_threads.resize(threadCount);
 	for(U32 i = 0; i < threadCount; ++i)
 	{
 		String threadName;
 		threadName.sprintf("JobManager#%u", i);
-		m_threads[i] = newInstance<WorkerThread>(DefaultMemoryPool::getSingleton(), this, i, pinToCores, threadName);
+		m_threads[i] = newInstance<WorkerThread>(DefaultMemoryPool::getSingleton(), this, i, threadName);
 	}
 
-	m_tasks.resize(queueSize);
+	// Start the threads and wait for all of them to create their queues because they steal from each other
+	for(U32 i = 0; i < threadCount; ++i)
+	{
+		m_threads[i]->m_thread.start(m_threads[i], WorkerThread::threadCallback, affinities[i]);
+	}
+
+	m_initBarrier.wait();
+	m_initBarrier.wait();
 }
 
 ThreadJobManager::~ThreadJobManager()
 {
+	waitForAllTasksToFinish();
+
 	{
 		LockGuard lock(m_mtx);
 		m_quit = true;
@@ -57,48 +197,395 @@ ThreadJobManager::~ThreadJobManager()
 	for(WorkerThread* thread : m_threads)
 	{
 		[[maybe_unused]] const Error err = thread->m_thread.join();
+	}
+
+#if ANKI_ASSERTIONS_ENABLED
+	U32 freeJobCount = m_sharedFreeList.m_count;
+	for(WorkerThread* thread : m_threads)
+	{
+		freeJobCount += thread->m_freeList.m_count;
+	}
+	ANKI_ASSERT(freeJobCount == m_jobBlocks.getSize() * kJobBlockSize && "Some ThreadJobHandles outlived the manager");
+#endif
+
+	for(ThreadJob* block : m_jobBlocks)
+	{
+		DefaultMemoryPool::getSingleton().free(block);
+	}
+
+	for(WorkerThread* thread : m_threads)
+	{
 		deleteInstance(DefaultMemoryPool::getSingleton(), thread);
 	}
+
+	deleteInstance(DefaultMemoryPool::getSingleton(), m_submitQueue);
 }
 
-Bool ThreadJobManager::pushBackTask(const Func& func)
+ThreadJobHandle ThreadJobManager::dispatchTask(const Func& func, ConstWeakArray<ThreadJobHandle> dependencies)
 {
-	LockGuard lock(m_tasksMtx);
-	const U32 next = (m_tasksBack + 1) % m_tasks.getSize();
-	if(next != m_tasksFront)
+	m_tasksInFlightCount.fetchAdd(1);
+
+	ThreadJob* task = newTask(func);
+	task->retain(); // The manager holds a reference until the task is done
+	ThreadJobHandle handle(task);
+
+	// Register to the dependencies that are still running. The initial pending count is 1 so the task can't be queued before all dependencies
+	// are registered
+	for(const ThreadJobHandle& dep : dependencies)
 	{
-		m_tasks[m_tasksBack] = func;
-		m_tasksBack = next;
-		return true;
+		ANKI_ASSERT(dep);
+		LockGuard lock(dep->m_dependentsLock);
+		if(!dep->isFinished())
+		{
+			task->m_pendingDependencyCount.fetchAdd(1);
+			dep->m_dependents.emplaceBack(task);
+		}
+	}
+
+	if(task->m_pendingDependencyCount.fetchSub(1, AtomicMemoryOrder::kAcqRel) == 1)
+	{
+		pushTask(task);
 	}
 
-	return false;
+	return handle;
 }
 
-Bool ThreadJobManager::popFrontTask(Func& func)
+ThreadJobHandle ThreadJobManager::parallelFor(U32 begin, U32 end, U32 grainSize, const RangeFunc& func,
+											  ConstWeakArray<ThreadJobHandle> dependencies)
 {
-	LockGuard lock(m_tasksMtx);
+	ANKI_ASSERT(begin <= end);
+	const U32 count = end - begin;
 
-	if(m_tasksBack != m_tasksFront)
+	if(grainSize == 0)
 	{
-		func = m_tasks[m_tasksFront];
-		m_tasksFront = (m_tasksFront + 1) % m_tasks.getSize();
-		return true;
+		// A few chunks per thread to balance the load
+		grainSize = max(1u, count / ((getThreadCount() + 1) * 4));
+	}
+
+	const U32 chunkCount = (count + grainSize - 1) / grainSize;
+
+	// The chunks share a single copy of the function. The join task will delete it
+	RangeFunc* sharedFunc = newInstance<RangeFunc>(DefaultMemoryPool::getSingleton(), func);
+
+	DynamicArray<ThreadJobHandle> chunks;
+	chunks.resizeStorage(chunkCount);
+	for(U32 chunk = 0; chunk < chunkCount; ++chunk)
+	{
+		const U32 chunkBegin = begin + chunk * grainSize;
+		const U32 chunkEnd = min(chunkBegin + grainSize, end);
+
+		chunks.emplaceBack(dispatchTask(
+			[sharedFunc, chunkBegin, chunkEnd](U32 threadId) {
+				(*sharedFunc)(chunkBegin, chunkEnd, threadId);
+			},
+			dependencies));
 	}
 
-	return false;
+	return dispatchTask(
+		[sharedFunc]([[maybe_unused]] U32 threadId) {
+			deleteInstance(DefaultMemoryPool::getSingleton(), sharedFunc);
+		},
+		(chunkCount) ? ConstWeakArray<ThreadJobHandle>(chunks) : dependencies);
+}
+
+U32 ThreadJobManager::getCurrentThreadId() const
+{
+	return (m_workerTls && m_workerTls->m_manager == this) ? m_workerTls->m_id : getThreadCount();
+}
+
+ThreadJob* ThreadJobManager::newTask(const Func& func)
+{
+	JobFreeList* localList = (m_workerTls && m_workerTls->m_manager == this) ? &m_workerTls->m_freeList : nullptr;
+
+	ThreadJob* task = nullptr;
+	if(localList && localList->m_head)
+	{
+		task = localList->m_head;
+		localList->m_head = task->m_next;
+		--localList->m_count;
+	}
+	else
+	{
+		LockGuard lock(m_sharedFreeList.m_lock);
+
+		task = m_sharedFreeList.m_head;
+		if(task)
+		{
+			m_sharedFreeList.m_head = task->m_next;
+			--m_sharedFreeList.m_count;
+
+			// A worker takes a few more so it doesn't come back to the shared list for every task
+			while(localList && m_sharedFreeList.m_head && localList->m_count < kJobBlockSize / 2)
+			{
+				ThreadJob* node = m_sharedFreeList.m_head;
+				m_sharedFreeList.m_head = node->m_next;
+				--m_sharedFreeList.m_count;
+
+				node->m_next = localList->m_head;
+				localList->m_head = node;
+				++localList->m_count;
+			}
+		}
+	}
+
+	if(!task)
+	{
+		// Out of nodes, allocate a new block. Keep the 1st node and put the rest in the free list
+		ThreadJob* block = static_cast<ThreadJob*>(DefaultMemoryPool::getSingleton().allocate(sizeof(ThreadJob) * kJobBlockSize, alignof(ThreadJob)));
+		{
+			LockGuard lock(m_jobBlocksLock);
+			m_jobBlocks.emplaceBack(block);
+		}
+
+		for(U32 i = 1; i < kJobBlockSize; ++i)
+		{
+			block[i].m_next = (i + 1 < kJobBlockSize) ? &block[i + 1] : nullptr;
+		}
+
+		JobFreeList& list = (localList) ? *localList : m_sharedFreeList;
+		if(!localList)
+		{
+			list.m_lock.lock();
+		}
+
+		block[kJobBlockSize - 1].m_next = list.m_head;
+		list.m_head = &block[1];
+		list.m_count += kJobBlockSize - 1;
+
+		if(!localList)
+		{
+			list.m_lock.unlock();
+		}
+
+		task = &block[0];
+	}
+
+	callConstructor(*task, this, func);
+	return task;
+}
+
+void ThreadJobManager::deleteTask(ThreadJob* task)
+{
+	callDestructor(*task);
+
+	JobFreeList* localList = (m_workerTls && m_workerTls->m_manager == this) ? &m_workerTls->m_freeList : nullptr;
+	if(localList)
+	{
+		task->m_next = localList->m_head;
+		localList->m_head = task;
+		++localList->m_count;
+
+		if(localList->m_count > kMaxWorkerFreeJobCount)
+		{
+			// The worker recycles more than it dispatches, give some nodes to the threads that dispatch
+			ThreadJob* first = localList->m_head;
+			ThreadJob* last = first;
+			for(U32 i = 1; i < kJobBlockSize; ++i)
+			{
+				last = last->m_next;
+			}
+
+			localList->m_head = last->m_next;
+			localList->m_count -= kJobBlockSize;
+
+			LockGuard lock(m_sharedFreeList.m_lock);
+			last->m_next = m_sharedFreeList.m_head;
+			m_sharedFreeList.m_head = first;
+			m_sharedFreeList.m_count += kJobBlockSize;
+		}
+	}
+	else
+	{
+		LockGuard lock(m_sharedFreeList.m_lock);
+		task->m_next = m_sharedFreeList.m_head;
+		m_sharedFreeList.m_head = task;
+		++m_sharedFreeList.m_count;
+	}
+}
+
+void ThreadJobManager::waitForTask(const ThreadJobHandle& handle)
+{
+	ANKI_ASSERT(handle);
+	const U32 threadId = getCurrentThreadId();
+
+	while(!handle->isFinished())
+	{
+		ThreadJob* task = popTask(threadId);
+		if(task)
+		{
+			runTask(task, threadId);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void ThreadJobManager::waitForAllTasksToFinish()
+{
+	const U32 threadId = getCurrentThreadId();
+
+	while(m_tasksInFlightCount.load(AtomicMemoryOrder::kAcquire) != 0)
+	{
+		ThreadJob* task = popTask(threadId);
+		if(task)
+		{
+			runTask(task, threadId);
+		}
+		else
+		{
+			// Some other thread is running the last tasks
+			std::this_thread::yield();
+		}
+	}
+}
+
+void ThreadJobManager::pushTask(ThreadJob* task)
+{
+	// Count the task before publishing it. A thief might pop it and decrement the count before this thread gets to increment it. The increment
+	// of the queued count and the sleeping count need to be sequentially consistent with the ones in threadRun() so that no wake-up is lost
+	m_queuedTaskCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+
+	Bool pushed;
+	if(m_workerTls && m_workerTls->m_manager == this)
+	{
+		pushed = m_workerTls->m_queue->push(task);
+	}
+	else
+	{
+		LockGuard lock(m_submitLock);
+		pushed = m_submitQueue->push(task);
+	}
+
+	if(!pushed)
+	{
+		pushOverflowTask(task);
+	}
+
+	if(m_sleepingThreadCount.load(AtomicMemoryOrder::kSeqCst) > 0)
+	{
+		LockGuard lock(m_mtx);
+		m_cvar.notifyOne();
+	}
+}
+
+ThreadJob* ThreadJobManager::popTask(U32 threadId)
+{
+	ThreadJob* task = nullptr;
+	const U32 threadCount = getThreadCount();
+
+	// First try the local queue
+	if(threadId < threadCount)
+	{
+		task = m_threads[threadId]->m_queue->pop();
+	}
+
+	// Then the tasks coming from the outside
+	if(!task)
+	{
+		task = m_submitQueue->steal();
+	}
+
+	// Then steal from the other workers. Start from the next worker to spread the stealing
+	for(U32 i = 1; i <= threadCount && !task; ++i)
+	{
+		const U32 victim = (threadId + i) % threadCount;
+		if(victim != threadId)
+		{
+			task = m_threads[victim]->m_queue->steal();
+		}
+	}
+
+	// And lastly the overflow tasks
+	if(!task && m_overflowCount.load() > 0)
+	{
+		task = popOverflowTask();
+	}
+
+	if(task)
+	{
+		m_queuedTaskCount.fetchSub(1);
+	}
+
+	return task;
+}
+
+void ThreadJobManager::runTask(ThreadJob* task, U32 threadId)
+{
+	task->m_func(threadId);
+	task->m_func.destroy();
+
+	// Mark as finished and release the dependents
+	DynamicArray<ThreadJob*> dependents;
+	{
+		LockGuard lock(task->m_dependentsLock);
+		task->m_finished.store(1, AtomicMemoryOrder::kRelease);
+		dependents = std::move(task->m_dependents);
+	}
+
+	for(ThreadJob* dependent : dependents)
+	{
+		if(dependent->m_pendingDependencyCount.fetchSub(1, AtomicMemoryOrder::kAcqRel) == 1)
+		{
+			pushTask(dependent);
+		}
+	}
+
+	if(task->release() == 1)
+	{
+		ThreadJobDeleter()(task);
+	}
+
+	[[maybe_unused]] const U32 count = m_tasksInFlightCount.fetchSub(1, AtomicMemoryOrder::kRelease);
+	ANKI_ASSERT(count > 0);
+}
+
+void ThreadJobManager::pushOverflowTask(ThreadJob* task)
+{
+	LockGuard lock(m_overflowMtx);
+
+	task->m_next = nullptr;
+	if(m_overflowTail)
+	{
+		m_overflowTail->m_next = task;
+	}
+	else
+	{
+		m_overflowHead = task;
+	}
+	m_overflowTail = task;
+
+	m_overflowCount.fetchAdd(1);
+}
+
+ThreadJob* ThreadJobManager::popOverflowTask()
+{
+	LockGuard lock(m_overflowMtx);
+
+	ThreadJob* task = m_overflowHead;
+	if(task)
+	{
+		m_overflowHead = task->m_next;
+		if(m_overflowHead == nullptr)
+		{
+			m_overflowTail = nullptr;
+		}
+
+		m_overflowCount.fetchSub(1);
+	}
+
+	return task;
 }
 
 void ThreadJobManager::threadRun(U32 threadId)
 {
 	while(true)
 	{
-		Func func;
-		if(popFrontTask(func))
+		ThreadJob* task = popTask(threadId);
+		if(task)
 		{
-			func(threadId);
-			[[maybe_unused]] const U32 count = m_tasksInFlightCount.fetchSub(1);
-			ANKI_ASSERT(count > 0);
+			runTask(task, threadId);
 		}
 		else
 		{
@@ -107,7 +594,13 @@ void ThreadJobManager::threadRun(U32 threadId)
 			{
 				break;
 			}
-			m_cvar.wait(m_mtx);
+
+			m_sleepingThreadCount.fetchAdd(1, AtomicMemoryOrder::kSeqCst);
+			if(m_queuedTaskCount.load(AtomicMemoryOrder::kSeqCst) == 0)
+			{
+				m_cvar.wait(m_mtx);
+			}
+			m_sleepingThreadCount.fetchSub(1, AtomicMemoryOrder::kSeqCst);
 		}
 	}
 }
@@ -8,20 +8,103 @@
 #include <AnKi/Util/Thread.h>
 #include <AnKi/Util/Function.h>
 #include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/WeakArray.h>
+#include <AnKi/Util/Ptr.h>
 
 namespace anki {
 
+// Forward
+class ThreadJobManager;
+
 /// @addtogroup util_thread
 /// @{
 
+/// A job of the ThreadJobManager. Users only see it through a ThreadJobHandle.
+class ThreadJob
+{
+	friend class ThreadJobManager;
+	friend class ThreadJobDeleter;
+
+	ANKI_FRIEND_CALL_CONSTRUCTOR_AND_DESTRUCTOR
+
+public:
+	ThreadJob(const ThreadJob&) = delete; // Non-copyable
+
+	ThreadJob& operator=(const ThreadJob&) = delete; // Non-copyable
+
+	/// Check if the job and its function have finished executing. Thread-safe.
+	Bool isFinished() const
+	{
+		return m_finished.load(AtomicMemoryOrder::kAcquire) != 0;
+	}
+
+	void retain() const
+	{
+		m_refcount.fetchAdd(1);
+	}
+
+	I32 release() const
+	{
+		// Jobs are released by the workers as well, acq_rel so the last owner sees all the writes before deleting
+		return m_refcount.fetchSub(1, AtomicMemoryOrder::kAcqRel);
+	}
+
+private:
+	Function<void(U32)> m_func;
+	ThreadJobManager* m_manager;
+	ThreadJob* m_next = nullptr; ///< Used by the overflow list and the free lists.
+
+	mutable Atomic<I32> m_refcount = {0};
+
+	/// The number of dependencies that haven't finished. The job is queued when it drops to zero.
+	Atomic<U32> m_pendingDependencyCount = {1};
+
+	/// The jobs that depend on this one. Protected by m_dependentsLock.
+	DynamicArray<ThreadJob*> m_dependents;
+	SpinLock m_dependentsLock;
+	Atomic<U32> m_finished = {0};
+
+	ThreadJob(ThreadJobManager* manager, const Function<void(U32)>& func)
+		: m_func(func)
+		, m_manager(manager)
+	{
+	}
+
+	~ThreadJob() = default;
+};
+
+/// @memberof ThreadJob
+class ThreadJobDeleter
+{
+public:
+	void operator()(ThreadJob* job);
+};
+
+/// A reference counted handle to a dispatched job. It can be used as a dependency of other jobs or to wait for the job to finish. It shouldn't
+/// outlive the ThreadJobManager that created it.
+using ThreadJobHandle = IntrusivePtr<ThreadJob, ThreadJobDeleter>;
+
 /// Parallel task dispatcher. You feed it with tasks and sends them for execution in parallel and then waits for all to finish.
+/// Every worker thread owns a work-stealing (Chase-Lev) deque. Tasks dispatched from a worker go to its own deque, tasks dispatched from other
+/// threads go to a shared submission deque. Idle workers steal from the other deques. If a deque is full the task goes to an unbounded
+/// overflow list.
+/// The task nodes are recycled in per-thread free lists so dispatching doesn't allocate in the steady state.
+/// Tasks can depend on other tasks. A task that has dependencies will be queued when all of its dependencies finish.
 class ThreadJobManager
 {
+	friend class ThreadJobDeleter;
+
 public:
 	using Func = Function<void(U32 threadId)>;
 
+	/// The callback of parallelFor(). It processes the range [begin, end).
+	using RangeFunc = Function<void(U32 begin, U32 end, U32 threadId)>;
+
 	/// Constructor.
-	ThreadJobManager(U32 threadCount, Bool pinToCores = false, U32 queueSize = 256);
+	/// @param threadCount The number of worker threads.
+	/// @param placement How the worker threads will be pinned to the CPU cores.
+	/// @param queueSize The capacity of every work-stealing deque. Will be rounded up to a power of two.
+	ThreadJobManager(U32 threadCount, ThreadPlacementPolicy placement = ThreadPlacementPolicy::kNone, U32 queueSize = 256);
 
 	ThreadJobManager(const ThreadJobManager&) = delete; // Non-copyable
 
@@ -29,29 +112,27 @@ public:
 
 	ThreadJobManager& operator=(const ThreadJobManager&) = delete; // Non-copyable
 
-	/// Assign a task to a working thread
-	void dispatchTask(const Func& func)
-	{
-		m_tasksInFlightCount.fetchAdd(1);
+	/// Assign a task to a working thread. Thread-safe.
+	/// @param func The function of the task.
+	/// @param dependencies The task will not start before these tasks finish.
+	/// @return A handle that can be used to wait for the task or as a dependency of other tasks.
+	ThreadJobHandle dispatchTask(const Func& func, ConstWeakArray<ThreadJobHandle> dependencies = {});
 
-		while(!pushBackTask(func))
-		{
-			m_cvar.notifyOne();
-			std::this_thread::yield();
-		}
+	/// Split the range [begin, end) into chunks and process them in parallel. Thread-safe.
+	/// @param begin The start of the range.
+	/// @param end The end of the range (exclusive).
+	/// @param grainSize The max number of elements of each chunk. If zero it will be computed from the number of threads.
+	/// @param func The function that will process a chunk.
+	/// @param dependencies The chunks will not start before these tasks finish.
+	/// @return A handle that will be finished when all the chunks are.
+	ThreadJobHandle parallelFor(U32 begin, U32 end, U32 grainSize, const RangeFunc& func, ConstWeakArray<ThreadJobHandle> dependencies = {});
 
-		m_cvar.notifyOne();
-	}
+	/// Wait for a single task (and its dependencies) to finish. The calling thread will execute tasks while waiting.
+	void waitForTask(const ThreadJobHandle& handle);
 
-	/// Wait for all tasks to finish.
-	void waitForAllTasksToFinish()
-	{
-		while(m_tasksInFlightCount.load() != 0)
-		{
-			m_cvar.notifyOne();
-			std::this_thread::yield();
-		}
-	}
+	/// Wait for all tasks to finish. The calling thread will execute tasks while waiting. If the calling thread is not one of the workers
+	/// the tasks it executes will be passed getThreadCount() as their threadId.
+	void waitForAllTasksToFinish();
 
 	U32 getThreadCount() const
 	{
@@ -59,24 +140,62 @@ public:
 	}
 
 private:
+	class WorkStealingQueue;
 	class WorkerThread;
 
+	/// A list of recycled ThreadJob nodes. Every worker has one and there is one more for the rest of the threads.
+	class alignas(ANKI_CACHE_LINE_SIZE) JobFreeList
+	{
+	public:
+		ThreadJob* m_head = nullptr;
+		U32 m_count = 0;
+		SpinLock m_lock; ///< Only the shared list needs it.
+	};
+
+	static constexpr U32 kJobBlockSize = 64; ///< Job nodes are allocated in blocks of that many.
+	static constexpr U32 kMaxWorkerFreeJobCount = kJobBlockSize * 2; ///< Above that a worker gives kJobBlockSize nodes to the shared list.
+
 	DynamicArray<WorkerThread*> m_threads;
+	U32 m_queueSize = 0;
+	Barrier m_initBarrier; ///< Used only during construction. Not a local because the threads might still be inside wait() when it returns.
+
+	/// The queue that non-worker threads push to. Pushes are serialized by m_submitLock, steals are lock-free.
+	WorkStealingQueue* m_submitQueue = nullptr;
+	SpinLock m_submitLock;
 
-	DynamicArray<Func> m_tasks;
-	U32 m_tasksFront = 0;
-	U32 m_tasksBack = 0;
-	Mutex m_tasksMtx;
+	/// Tasks that didn't fit in the deques.
+	ThreadJob* m_overflowHead = nullptr;
+	ThreadJob* m_overflowTail = nullptr;
+	Mutex m_overflowMtx;
+	Atomic<U32> m_overflowCount = {0};
+
+	/// The free list of the non-worker threads. The workers take nodes from it when theirs is empty and give back the nodes they don't need.
+	JobFreeList m_sharedFreeList;
+	DynamicArray<ThreadJob*> m_jobBlocks;
+	SpinLock m_jobBlocksLock;
 
 	Atomic<U32> m_tasksInFlightCount = {0};
+	Atomic<U32> m_queuedTaskCount = {0}; ///< Tasks that are in some queue. Used for sleeping.
+	Atomic<U32> m_sleepingThreadCount = {0};
 
 	ConditionVariable m_cvar;
 	Mutex m_mtx;
 
 	Bool m_quit = false;
 
-	Bool pushBackTask(const Func& func);
-	Bool popFrontTask(Func& func);
+	static thread_local WorkerThread* m_workerTls;
+
+	U32 getCurrentThreadId() const;
+
+	ThreadJob* newTask(const Func& func);
+	void deleteTask(ThreadJob* task);
+
+	void pushTask(ThreadJob* task);
+	ThreadJob* popTask(U32 threadId);
+	void runTask(ThreadJob* task, U32 threadId);
+
+	void pushOverflowTask(ThreadJob* task);
+	ThreadJob* popOverflowTask();
 
 	void threadRun(U32 threadId);
 };
@@ -6,6 +6,7 @@
 #include <AnKi/Util/ThreadPool.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/String.h>
+#include <AnKi/Util/System.h>
 #include <cstdlib>
 #include <new>
 
@@ -24,14 +25,14 @@ public:
 	Bool m_quit = false;
 
 	/// Constructor
-	ThreadPoolThread(U32 id, ThreadPool* threadpool, Bool pinToCore, CString threadName)
+	ThreadPoolThread(U32 id, ThreadPool* threadpool, const ThreadCoreAffinityMask& affinity, CString threadName)
 		: m_id(id)
 		, m_thread(threadName.cstr())
 		, m_task(nullptr)
 		, m_threadpool(threadpool)
 	{
 		ANKI_ASSERT(threadpool);
-		m_thread.start(this, threadCallback, ThreadCoreAffinityMask(false).set(m_id, pinToCore));
+		m_thread.start(this, threadCallback, affinity);
 	}
 
 private:
@@ -39,14 +40,14 @@ private:
 	static Error threadCallback(ThreadCallbackInfo& info)
 	{
 		ThreadPoolThread& self = *static_cast<ThreadPoolThread*>(info.m_userData);
-		Barrier& barrier = self.m_threadpool->m_barrier;
+		TreeBarrier& barrier = self.m_threadpool->m_barrier;
 		const PtrSize threadCount = self.m_threadpool->getThreadCount();
 		Bool quit = false;
 
 		while(!quit)
 		{
 			// Wait for something
-			barrier.wait();
+			barrier.wait(self.m_id);
 			quit = self.m_quit;
 
 			// Exec
@@ -57,7 +58,7 @@ private:
 			}
 
 			// Sync with main thread
-			barrier.wait();
+			barrier.wait(self.m_id);
 		}
 
 		return Error::kNone;
@@ -68,11 +69,11 @@ private:
 
 ThreadPool::DummyTask ThreadPool::m_dummyTask;
 
-ThreadPool::ThreadPool(U32 threadCount, Bool pinToCores)
+ThreadPool::ThreadPool(U32 threadCount, ThreadPlacementPolicy placement)
 	: m_barrier(threadCount + 1)
 {
 	m_threadsCount = threadCount;
-	ANKI_ASSERT(m_threadsCount <= kMaxThreads && m_threadsCount > 0);
+	ANKI_ASSERT(m_threadsCount > 0);
 
 	m_threads = static_cast<detail::ThreadPoolThread*>(malloc(sizeof(detail::ThreadPoolThread) * m_threadsCount));
 
@@ -81,11 +82,19 @@ ThreadPool::ThreadPool(U32 threadCount, Bool pinToCores)
 		ANKI_UTIL_LOGF("Out of memory");
 	}
 
+	// The ThreadPool doesn't need the DefaultMemoryPool so don't touch it if there is no placement
+	DynamicArray<ThreadCoreAffinityMask> affinities;
+	if(placement != ThreadPlacementPolicy::kNone)
+	{
+		computeThreadPlacement(placement, threadCount, affinities);
+	}
+
 	for(U32 i = 0; i < threadCount; ++i)
 	{
 		Array<Char, 64> threadName;
 		snprintf(&threadName[0], threadName.getSize(), "ThreadPool#%u", i);
-		::new(&m_threads[i]) detail::ThreadPoolThread(i, this, pinToCores, &threadName[0]);
+		const ThreadCoreAffinityMask affinity = (affinities.getSize()) ? affinities[i] : ThreadCoreAffinityMask(false);
+		::new(&m_threads[i]) detail::ThreadPoolThread(i, this, affinity, &threadName[0]);
 	}
 }
 
@@ -102,10 +111,10 @@ ThreadPool::~ThreadPool()
 	}
 
 	// Wakeup the threads
-	m_barrier.wait();
+	m_barrier.wait(m_threadsCount);
 
 	// Wait the threads
-	m_barrier.wait();
+	m_barrier.wait(m_threadsCount);
 
 	while(m_threadsCount-- != 0)
 	{
@@ -133,7 +142,7 @@ void ThreadPool::assignNewTask(U32 slot, ThreadPoolTask* task)
 	if(m_tasksAssigned == m_threadsCount)
 	{
 		// Last task is assigned. Wake all threads
-		m_barrier.wait();
+		m_barrier.wait(m_threadsCount);
 	}
 }
 
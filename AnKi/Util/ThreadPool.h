@@ -36,10 +36,10 @@ class ThreadPool
 	friend class detail::ThreadPoolThread;
 
 public:
-	static constexpr U kMaxThreads = 32; ///< An absolute limit
-
 	/// Constructor.
-	ThreadPool(U32 threadCount, Bool pinToCores = false);
+	/// @param threadCount The number of threads.
+	/// @param placement How the threads will be pinned to the CPU cores.
+	ThreadPool(U32 threadCount, ThreadPlacementPolicy placement = ThreadPlacementPolicy::kNone);
 
 	ThreadPool(const ThreadPool&) = delete; // Non-copyable
 
@@ -56,7 +56,7 @@ public:
 	/// @return The error code in one of the worker threads.
 	Error waitForAllThreadsToFinish()
 	{
-		m_barrier.wait();
+		m_barrier.wait(m_threadsCount);
 		m_tasksAssigned = 0;
 		Error err = m_err;
 		m_err = Error::kNone;
@@ -80,7 +80,7 @@ private:
 		}
 	};
 
-	Barrier m_barrier; ///< Synchronization barrier
+	TreeBarrier m_barrier; ///< Synchronization barrier. The main thread uses the last index
 	detail::ThreadPoolThread* m_threads = nullptr; ///< Threads array
 	U32 m_tasksAssigned = 0;
 	U32 m_threadsCount = 0;
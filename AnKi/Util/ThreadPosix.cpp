@@ -6,6 +6,11 @@
 #include <AnKi/Util/Thread.h>
 #include <AnKi/Util/Logger.h>
 #include <AnKi/Util/String.h>
+#if ANKI_OS_LINUX || ANKI_OS_ANDROID
+#	include <linux/futex.h>
+#	include <sys/syscall.h>
+#	include <unistd.h>
+#endif
 
 namespace anki {
 
@@ -110,4 +115,31 @@ void Thread::setCurrentThreadName(const Char* name)
 	pthread_setname_np(pthread_self(), &m_nameTls[0]);
 }
 
+void Futex::wait(U32 expectedValue)
+{
+#if ANKI_OS_LINUX || ANKI_OS_ANDROID
+	static_assert(sizeof(m_value) == sizeof(U32));
+	syscall(SYS_futex, reinterpret_cast<U32*>(&m_value), FUTEX_WAIT_PRIVATE, expectedValue, nullptr, nullptr, 0);
+#else
+	reinterpret_cast<std::atomic<U32>*>(&m_value)->wait(expectedValue);
+#endif
+}
+
+void Futex::wake(U32 threadCount)
+{
+	ANKI_ASSERT(threadCount > 0);
+#if ANKI_OS_LINUX || ANKI_OS_ANDROID
+	syscall(SYS_futex, reinterpret_cast<U32*>(&m_value), FUTEX_WAKE_PRIVATE, min<U32>(threadCount, kMaxI32), nullptr, nullptr, 0);
+#else
+	if(threadCount == 1)
+	{
+		reinterpret_cast<std::atomic<U32>*>(&m_value)->notify_one();
+	}
+	else
+	{
+		reinterpret_cast<std::atomic<U32>*>(&m_value)->notify_all();
+	}
+#endif
+}
+
 } // end namespace anki
@@ -126,4 +126,22 @@ void Thread::setCurrentThreadName(const Char* name)
 	}
 }
 
+void Futex::wait(U32 expectedValue)
+{
+	reinterpret_cast<std::atomic<U32>*>(&m_value)->wait(expectedValue);
+}
+
+void Futex::wake(U32 threadCount)
+{
+	ANKI_ASSERT(threadCount > 0);
+	if(threadCount == 1)
+	{
+		reinterpret_cast<std::atomic<U32>*>(&m_value)->notify_one();
+	}
+	else
+	{
+		reinterpret_cast<std::atomic<U32>*>(&m_value)->notify_all();
+	}
+}
+
 } // end namespace anki
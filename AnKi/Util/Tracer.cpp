@@ -5,6 +5,7 @@
 
 #include <AnKi/Util/Tracer.h>
 #include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/BinaryLog.h>
 #include <AnKi/Util/HashMap.h>
 #include <AnKi/Util/List.h>
 #if ANKI_OS_ANDROID
@@ -141,6 +142,11 @@ void Tracer::endEvent(const char* eventName, TracerEventHandle event)
 		return;
 	}
 
+	if(BinaryLog::isCapturing())
+	{
+		BinaryLog::getSingleton().writeTraceEvent(eventName, event.m_start, duration);
+	}
+
 	ThreadLocal& tlocal = getThreadLocal();
 
 	// Write the event
@@ -166,6 +172,11 @@ void Tracer::addCustomEvent(const char* eventName, Second start, Second duration
 		return;
 	}
 
+	if(BinaryLog::isCapturing())
+	{
+		BinaryLog::getSingleton().writeTraceEvent(eventName, start, duration);
+	}
+
 	ThreadLocal& tlocal = getThreadLocal();
 
 	// Write the event
@@ -190,6 +201,11 @@ void Tracer::incrementCounter(const char* counterName, U64 value)
 		return;
 	}
 
+	if(BinaryLog::isCapturing())
+	{
+		BinaryLog::getSingleton().writeCounter(counterName, value);
+	}
+
 	ThreadLocal& tlocal = getThreadLocal();
 
 	LockGuard<SpinLock> lock(tlocal.m_currentChunkLock);
@@ -28,3 +28,4 @@ ANKI_T_STRUCT(CONSOLE_SCREEN_BUFFER_INFO)
 ANKI_T_STRUCT(SYSTEM_INFO)
 ANKI_T_STRUCT(FILETIME)
 ANKI_T_STRUCT(SMALL_RECT)
+ANKI_T_STRUCT(WIN32_MEMORY_RANGE_ENTRY)
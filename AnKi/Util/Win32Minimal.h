@@ -74,6 +74,8 @@ typedef struct _CONSOLE_SCREEN_BUFFER_INFO CONSOLE_SCREEN_BUFFER_INFO, *PCONSOLE
 
 typedef struct _SYSTEM_INFO SYSTEM_INFO, *LPSYSTEM_INFO;
 
+typedef struct _WIN32_MEMORY_RANGE_ENTRY WIN32_MEMORY_RANGE_ENTRY, *PWIN32_MEMORY_RANGE_ENTRY;
+
 // Thread & locks
 ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateThread(LPSECURITY_ATTRIBUTES lpThreadAttributes, SIZE_T dwStackSize, LPTHREAD_START_ROUTINE lpStartAddress,
 												LPVOID lpParameter, DWORD dwCreationFlags, LPDWORD lpThreadId);
@@ -114,6 +116,17 @@ ANKI_WINBASEAPI HANDLE ANKI_WINAPI FindFirstFileA(LPCSTR lpFileName, LPWIN32_FIN
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindClose(HANDLE hFindFile);
 ANKI_WINBASEAPI BOOL ANKI_WINAPI FindNextFileA(HANDLE hFindFile, LPWIN32_FIND_DATAA lpFindFileData);
 ANKI_WINBASEAPI DWORD ANKI_WINAPI GetTempPathA(DWORD nBufferLength, LPSTR lpBuffer);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode,
+											  LPSECURITY_ATTRIBUTES lpSecurityAttributes, DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes,
+											  HANDLE hTemplateFile);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* lpFileSize);
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI CreateFileMappingA(HANDLE hFile, LPSECURITY_ATTRIBUTES lpFileMappingAttributes, DWORD flProtect,
+													 DWORD dwMaximumSizeHigh, DWORD dwMaximumSizeLow, LPCSTR lpName);
+ANKI_WINBASEAPI LPVOID ANKI_WINAPI MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow,
+												 SIZE_T dwNumberOfBytesToMap);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI UnmapViewOfFile(LPCVOID lpBaseAddress);
+ANKI_WINBASEAPI BOOL ANKI_WINAPI PrefetchVirtualMemory(HANDLE hProcess, ULONG_PTR NumberOfEntries, PWIN32_MEMORY_RANGE_ENTRY VirtualAddresses,
+													   ULONG Flags);
 
 // Other
 ANKI_WINBASEAPI DWORD ANKI_WINAPI GetLastError(VOID);
@@ -130,6 +143,7 @@ ANKI_WINBASEAPI DWORD ANKI_WINAPI FormatMessageA(DWORD dwFlags, LPCVOID lpSource
 												 va_list* Arguments);
 ANKI_WINBASEAPI HLOCAL ANKI_WINAPI LocalFree(HLOCAL hMem);
 ANKI_WINBASEAPI BOOL ANKI_WINAPI IsDebuggerPresent();
+ANKI_WINBASEAPI HANDLE ANKI_WINAPI GetCurrentProcess();
 
 #undef ANKI_WINBASEAPI
 #undef ANKI_DECLARE_HANDLE
@@ -178,6 +192,13 @@ constexpr DWORD FORMAT_MESSAGE_MAX_WIDTH_MASK = 0x000000FF;
 constexpr DWORD LANG_NEUTRAL = 0x00;
 constexpr DWORD SUBLANG_DEFAULT = 0x01;
 
+constexpr DWORD GENERIC_READ = 0x80000000L;
+constexpr DWORD FILE_SHARE_READ = 0x00000001;
+constexpr DWORD OPEN_EXISTING = 3;
+constexpr DWORD FILE_ATTRIBUTE_NORMAL = 0x00000080;
+constexpr DWORD PAGE_READONLY = 0x02;
+constexpr DWORD FILE_MAP_READ = 0x0004;
+
 // Types
 typedef union _LARGE_INTEGER
 {
@@ -321,6 +342,12 @@ typedef struct _SYSTEM_INFO
 	WORD wProcessorRevision;
 } SYSTEM_INFO, *LPSYSTEM_INFO;
 
+typedef struct _WIN32_MEMORY_RANGE_ENTRY
+{
+	PVOID VirtualAddress;
+	SIZE_T NumberOfBytes;
+} WIN32_MEMORY_RANGE_ENTRY, *PWIN32_MEMORY_RANGE_ENTRY;
+
 // Critical section
 inline void InitializeCriticalSection(LPCRITICAL_SECTION lpCriticalSection)
 {
@@ -446,6 +473,41 @@ inline DWORD GetTempPathA(DWORD nBufferLength, LPSTR lpBuffer)
 	return ::GetTempPathA(nBufferLength, lpBuffer);
 }
 
+inline HANDLE CreateFileA(LPCSTR lpFileName, DWORD dwDesiredAccess, DWORD dwShareMode, LPSECURITY_ATTRIBUTES lpSecurityAttributes,
+						  DWORD dwCreationDisposition, DWORD dwFlagsAndAttributes, HANDLE hTemplateFile)
+{
+	return ::CreateFileA(lpFileName, dwDesiredAccess, dwShareMode, reinterpret_cast<::LPSECURITY_ATTRIBUTES>(lpSecurityAttributes),
+						 dwCreationDisposition, dwFlagsAndAttributes, hTemplateFile);
+}
+
+inline BOOL GetFileSizeEx(HANDLE hFile, LARGE_INTEGER* lpFileSize)
+{
+	return ::GetFileSizeEx(hFile, reinterpret_cast<::LARGE_INTEGER*>(lpFileSize));
+}
+
+inline HANDLE CreateFileMappingA(HANDLE hFile, LPSECURITY_ATTRIBUTES lpFileMappingAttributes, DWORD flProtect, DWORD dwMaximumSizeHigh,
+								 DWORD dwMaximumSizeLow, LPCSTR lpName)
+{
+	return ::CreateFileMappingA(hFile, reinterpret_cast<::LPSECURITY_ATTRIBUTES>(lpFileMappingAttributes), flProtect, dwMaximumSizeHigh,
+								dwMaximumSizeLow, lpName);
+}
+
+inline LPVOID MapViewOfFile(HANDLE hFileMappingObject, DWORD dwDesiredAccess, DWORD dwFileOffsetHigh, DWORD dwFileOffsetLow,
+							SIZE_T dwNumberOfBytesToMap)
+{
+	return ::MapViewOfFile(hFileMappingObject, dwDesiredAccess, dwFileOffsetHigh, dwFileOffsetLow, dwNumberOfBytesToMap);
+}
+
+inline BOOL UnmapViewOfFile(LPCVOID lpBaseAddress)
+{
+	return ::UnmapViewOfFile(lpBaseAddress);
+}
+
+inline BOOL PrefetchVirtualMemory(HANDLE hProcess, ULONG_PTR NumberOfEntries, PWIN32_MEMORY_RANGE_ENTRY VirtualAddresses, ULONG Flags)
+{
+	return ::PrefetchVirtualMemory(hProcess, NumberOfEntries, reinterpret_cast<::PWIN32_MEMORY_RANGE_ENTRY>(VirtualAddresses), Flags);
+}
+
 // Other
 inline BOOL QueryPerformanceFrequency(LARGE_INTEGER* lpFrequency)
 {
@@ -492,4 +554,9 @@ inline BOOL IsDebuggerPresent()
 	return ::IsDebuggerPresent();
 }
 
+inline HANDLE GetCurrentProcess()
+{
+	return ::GetCurrentProcess();
+}
+
 } // end namespace anki
@@ -0,0 +1,105 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <Tests/Gr/GrCommon.h>
+#include <AnKi/Gr.h>
+#include <AnKi/Gr/Utils/SegregatedListsGpuMemoryPool.h>
+
+ANKI_TEST(Gr, SegregatedListsGpuMemoryPoolCompaction)
+{
+	commonInit();
+
+	{
+		// Bigger than what goes through the bins
+		constexpr PtrSize kAllocationSize = 16_KB;
+		constexpr U32 kAllocationCount = 32;
+
+		const Array<PtrSize, 2> classes = {64_KB, 1_MB};
+		SegregatedListsGpuMemoryPool pool;
+		pool.init(BufferUsageBit::kAllStorage, classes, 1_MB, "Compaction test", false, BufferMapAccessBit::kRead | BufferMapAccessBit::kWrite);
+
+		class Allocation
+		{
+		public:
+			SegregatedListsGpuMemoryPoolToken m_token;
+			U32 m_relocationCount = 0;
+		};
+
+		Array<Allocation, kAllocationCount> allocs;
+		auto relocationCallback = [](void* userData, const SegregatedListsGpuMemoryPoolToken& oldToken,
+									 const SegregatedListsGpuMemoryPoolToken& newToken) {
+			Allocation& alloc = *static_cast<Allocation*>(userData);
+			ANKI_TEST_EXPECT_EQ(alloc.m_token == oldToken, true);
+			ANKI_TEST_EXPECT_LT(newToken.m_offset, oldToken.m_offset);
+			alloc.m_token = newToken;
+			++alloc.m_relocationCount;
+		};
+
+		for(U32 i = 0; i < kAllocationCount; ++i)
+		{
+			pool.allocate(kAllocationSize, 16, allocs[i].m_token, relocationCallback, &allocs[i]);
+
+			U32* data = reinterpret_cast<U32*>(static_cast<U8*>(pool.getGpuBufferMappedMemory()) + allocs[i].m_token.m_offset);
+			for(U32 j = 0; j < kAllocationSize / sizeof(U32); ++j)
+			{
+				data[j] = i;
+			}
+		}
+		pool.getGpuBuffer().flush(0, kMaxPtrSize);
+
+		// Free every other allocation of the lower half to leave holes
+		for(U32 i = 0; i < kAllocationCount / 2; i += 2)
+		{
+			pool.deferredFree(allocs[i].m_token);
+		}
+
+		for(U32 i = 0; i < kMaxFramesInFlight; ++i)
+		{
+			pool.endFrame();
+		}
+
+		// Not fragmented enough
+		ANKI_TEST_EXPECT_EQ(pool.compact(kMaxPtrSize, 1.1f), 0);
+
+		// Move everything that can be moved
+		const PtrSize bytesMoved = pool.compact(kMaxPtrSize, 0.0f);
+		ANKI_TEST_EXPECT_GT(bytesMoved, 0);
+		ANKI_TEST_EXPECT_EQ(bytesMoved % kAllocationSize, 0);
+		GrManager::getSingleton().finish();
+
+		// The contents moved with the allocations
+		pool.getGpuBuffer().invalidate(0, kMaxPtrSize);
+		PtrSize relocatedBytes = 0;
+		for(U32 i = 0; i < kAllocationCount; ++i)
+		{
+			if(!allocs[i].m_token.isValid())
+			{
+				continue;
+			}
+
+			relocatedBytes += allocs[i].m_relocationCount * kAllocationSize;
+
+			const U32* data = reinterpret_cast<const U32*>(static_cast<const U8*>(pool.getGpuBufferMappedMemory()) + allocs[i].m_token.m_offset);
+			for(U32 j = 0; j < kAllocationSize / sizeof(U32); ++j)
+			{
+				ANKI_TEST_EXPECT_EQ(data[j], i);
+			}
+		}
+		ANKI_TEST_EXPECT_EQ(relocatedBytes, bytesMoved);
+
+		for(Allocation& alloc : allocs)
+		{
+			pool.deferredFree(alloc.m_token);
+		}
+
+		for(U32 i = 0; i < kMaxFramesInFlight; ++i)
+		{
+			pool.endFrame();
+		}
+	}
+
+	commonDestroy();
+}
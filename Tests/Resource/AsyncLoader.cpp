@@ -13,23 +13,20 @@ using namespace anki;
 
 namespace {
 
-#if 0
-class Task : public AsyncLoaderTask
+class TestTask : public AsyncLoaderTask
 {
 public:
 	F32 m_sleepTime = 0.0;
 	Barrier* m_barrier = nullptr;
 	Atomic<U32>* m_count = nullptr;
 	I32 m_id = -1;
-	Bool m_pause;
 	Bool m_resubmit;
 
-	Task(F32 time, Barrier* barrier, Atomic<U32>* count, I32 id = -1, Bool pause = false, Bool resubmit = false)
+	TestTask(F32 time, Barrier* barrier, Atomic<U32>* count, I32 id = -1, Bool resubmit = false)
 		: m_sleepTime(time)
 		, m_barrier(barrier)
 		, m_count(count)
 		, m_id(id)
-		, m_pause(pause)
 		, m_resubmit(resubmit)
 	{
 	}
@@ -60,7 +57,6 @@ public:
 			m_barrier->wait();
 		}
 
-		ctx.m_pause = m_pause;
 		ctx.m_resubmitTask = m_resubmit;
 		m_resubmit = false;
 
@@ -99,11 +95,56 @@ public:
 	}
 };
 
+/// Records the order it runs in.
+class OrderTask : public AsyncLoaderTask
+{
+public:
+	Atomic<U32>* m_count;
+	Atomic<U32>* m_order;
+
+	OrderTask(Atomic<U32>* count, Atomic<U32>* order)
+		: m_count(count)
+		, m_order(order)
+	{
+	}
+
+	Error operator()([[maybe_unused]] AsyncLoaderTaskContext& ctx)
+	{
+		m_order->store(m_count->fetchAdd(1));
+		return Error::kNone;
+	}
+};
+
+class CancelableTask : public AsyncLoaderTask
+{
+public:
+	Atomic<U32>* m_canceled;
+	Atomic<U32>* m_count;
+
+	CancelableTask(Atomic<U32>* canceled, Atomic<U32>* count)
+		: m_canceled(canceled)
+		, m_count(count)
+	{
+	}
+
+	Error operator()([[maybe_unused]] AsyncLoaderTaskContext& ctx)
+	{
+		m_count->fetchAdd(1);
+		return Error::kNone;
+	}
+
+	Bool isCanceled() const
+	{
+		return m_canceled->load() != 0;
+	}
+};
+
 } // namespace
 
 ANKI_TEST(Resource, AsyncLoader)
 {
 	HeapMemoryPool pool(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
 
 	// Simple create destroy
 	{
@@ -112,17 +153,17 @@ ANKI_TEST(Resource, AsyncLoader)
 
 	// Simple task that will finish
 	{
-		AsyncLoader a;
 		Barrier barrier(2);
+		AsyncLoader a;
 
-		a.submitNewTask<Task>(0.0f, &barrier, nullptr);
+		a.submitNewTask<TestTask>(AsyncLoaderPriority::kMedium, 0.0f, &barrier, nullptr);
 		barrier.wait();
 	}
 
 	// Many tasks that will finish
 	{
-		AsyncLoader a;
 		Barrier barrier(2);
+		AsyncLoader a;
 		Atomic<U32> counter = {0};
 		const U COUNT = 100;
 
@@ -135,7 +176,7 @@ ANKI_TEST(Resource, AsyncLoader)
 				pbarrier = &barrier;
 			}
 
-			a.submitNewTask<Task>(0.01f, pbarrier, &counter);
+			a.submitNewTask<TestTask>(AsyncLoaderPriority::kMedium, 0.01f, pbarrier, &counter);
 		}
 
 		barrier.wait();
@@ -149,14 +190,14 @@ ANKI_TEST(Resource, AsyncLoader)
 
 		for(U i = 0; i < 100; i++)
 		{
-			a.submitNewTask<Task>(0.0f, nullptr, nullptr);
+			a.submitNewTask<TestTask>(AsyncLoaderPriority::kMedium, 0.0f, nullptr, nullptr);
 		}
 	}
 
 	// Tasks that allocate
 	{
-		AsyncLoader a;
 		Barrier barrier(2);
+		AsyncLoader a;
 
 		for(U i = 0; i < 10; i++)
 		{
@@ -167,7 +208,7 @@ ANKI_TEST(Resource, AsyncLoader)
 				pbarrier = &barrier;
 			}
 
-			a.submitNewTask<MemTask>(&pool, pbarrier);
+			a.submitNewTask<MemTask>(AsyncLoaderPriority::kMedium, &pool, pbarrier);
 		}
 
 		barrier.wait();
@@ -179,73 +220,31 @@ ANKI_TEST(Resource, AsyncLoader)
 
 		for(U i = 0; i < 10; i++)
 		{
-			a.submitNewTask<MemTask>(&pool, nullptr);
+			a.submitNewTask<MemTask>(AsyncLoaderPriority::kMedium, &pool, nullptr);
 		}
 	}
 
-	// Pause/resume
+	// Resubmit
 	{
-		AsyncLoader a;
-		Atomic<U32> counter(0);
 		Barrier barrier(2);
-
-		// Check if the pause will sync
-		a.submitNewTask<Task>(0.5f, nullptr, &counter, 0);
-		HighRezTimer::sleep(0.25); // Wait for the thread to pick the task...
-		a.pause(); /// ...and then sync
-		ANKI_TEST_EXPECT_EQ(counter.load(), 1);
-
-		// Test resume
-		a.submitNewTask<Task>(0.1f, nullptr, &counter, 1);
-		HighRezTimer::sleep(1.0);
-		ANKI_TEST_EXPECT_EQ(counter.load(), 1);
-		a.resume();
-
-		// Sync
-		a.submitNewTask<Task>(0.1f, &barrier, &counter, 2);
-		barrier.wait();
-
-		ANKI_TEST_EXPECT_EQ(counter.load(), 3);
-	}
-
-	// Pause/resume
-	{
 		AsyncLoader a;
 		Atomic<U32> counter(0);
-		Barrier barrier(2);
 
-		// Check task resubmit
-		a.submitNewTask<Task>(0.0f, &barrier, &counter, -1, false, true);
+		a.submitNewTask<TestTask>(AsyncLoaderPriority::kMedium, 0.0f, &barrier, &counter, -1, true);
 		barrier.wait();
 		barrier.wait();
 		ANKI_TEST_EXPECT_EQ(counter.load(), 2);
 
-		// Check task pause
-		a.submitNewTask<Task>(0.0f, nullptr, &counter, -1, true, false);
-		a.submitNewTask<Task>(0.0f, nullptr, &counter, -1, false, false);
-		HighRezTimer::sleep(1.0);
-		ANKI_TEST_EXPECT_EQ(counter.load(), 3);
-		a.resume();
-		HighRezTimer::sleep(1.0);
-		ANKI_TEST_EXPECT_EQ(counter.load(), 4);
-
-		// Check both
-		counter.setNonAtomically(0);
-		a.submitNewTask<Task>(0.0f, nullptr, &counter, 0, false, false);
-		a.submitNewTask<Task>(0.0f, nullptr, &counter, -1, true, true);
-		a.submitNewTask<Task>(0.0f, nullptr, &counter, 2, false, false);
-
-		HighRezTimer::sleep(1.0);
-		ANKI_TEST_EXPECT_EQ(counter.load(), 2);
-		a.resume();
-		HighRezTimer::sleep(1.0);
-		ANKI_TEST_EXPECT_EQ(counter.load(), 4);
+		while(a.getTasksInFlightCount() != 0)
+		{
+			HighRezTimer::sleep(0.01);
+		}
 	}
 
 	// Fuzzy test
 	{
-		AsyncLoader a;
 		Barrier barrier(2);
+		AsyncLoader a;
 		Atomic<U32> counter = {0};
 
 		for(U32 i = 0; i < 10; i++)
@@ -257,12 +256,107 @@ ANKI_TEST(Resource, AsyncLoader)
 				pbarrier = &barrier;
 			}
 
-			a.submitNewTask<Task>(getRandomRange(0.0f, 0.5f), pbarrier, &counter, i);
+			a.submitNewTask<TestTask>(AsyncLoaderPriority::kMedium, getRandomRange(0.0f, 0.5f), pbarrier, &counter, i);
 		}
 
 		barrier.wait();
 		ANKI_TEST_EXPECT_EQ(counter.load(), 10);
 	}
-#endif
 
-} // namespace
+	// Many threads
+	{
+		constexpr U32 kThreadCount = 4;
+
+		// All the threads need to run at the same time to pass the barrier
+		Barrier barrier(kThreadCount + 1);
+		AsyncLoader a(kThreadCount);
+		ANKI_TEST_EXPECT_EQ(a.getThreadCount(), kThreadCount);
+
+		for(U32 i = 0; i < kThreadCount; ++i)
+		{
+			a.submitNewTask<TestTask>(AsyncLoaderPriority::kMedium, 0.0f, &barrier, nullptr);
+		}
+
+		barrier.wait();
+
+		while(a.getTasksInFlightCount() != 0)
+		{
+			HighRezTimer::sleep(0.01);
+		}
+	}
+
+	// Priorities
+	{
+		Barrier barrier(2);
+		AsyncLoader a;
+		Atomic<U32> counter = {0};
+		Array<Atomic<U32>, 6> order;
+
+		// Block the thread so the rest of the tasks get queued
+		a.submitNewTask<TestTask>(AsyncLoaderPriority::kMedium, 0.0f, &barrier, nullptr);
+		while(a.getQueueDepth(AsyncLoaderPriority::kMedium) != 0)
+		{
+			HighRezTimer::sleep(0.01);
+		}
+
+		a.submitTask(a.newTask<OrderTask>(&counter, &order[0]), AsyncLoaderPriority::kLow);
+		a.submitTask(a.newTask<OrderTask>(&counter, &order[1]), AsyncLoaderPriority::kMedium);
+		a.submitTask(a.newTask<OrderTask>(&counter, &order[2]), AsyncLoaderPriority::kHigh);
+		a.submitTask(a.newTask<OrderTask>(&counter, &order[3]), AsyncLoaderPriority::kLow);
+		a.submitNewTask<OrderTask>(AsyncLoaderPriority::kHigh, &counter, &order[4]);
+		a.submitNewTask<OrderTask>(AsyncLoaderPriority::kMedium, &counter, &order[5]);
+
+		ANKI_TEST_EXPECT_EQ(a.getQueueDepth(AsyncLoaderPriority::kHigh), 2);
+		ANKI_TEST_EXPECT_EQ(a.getQueueDepth(AsyncLoaderPriority::kMedium), 2);
+		ANKI_TEST_EXPECT_EQ(a.getQueueDepth(AsyncLoaderPriority::kLow), 2);
+
+		barrier.wait();
+
+		while(a.getTasksInFlightCount() != 0)
+		{
+			HighRezTimer::sleep(0.01);
+		}
+
+		// High first, then medium and low. FIFO inside a priority
+		ANKI_TEST_EXPECT_EQ(order[2].load(), 0);
+		ANKI_TEST_EXPECT_EQ(order[4].load(), 1);
+		ANKI_TEST_EXPECT_EQ(order[1].load(), 2);
+		ANKI_TEST_EXPECT_EQ(order[5].load(), 3);
+		ANKI_TEST_EXPECT_EQ(order[0].load(), 4);
+		ANKI_TEST_EXPECT_EQ(order[3].load(), 5);
+
+		for(AsyncLoaderPriority priority : EnumIterable<AsyncLoaderPriority>())
+		{
+			ANKI_TEST_EXPECT_EQ(a.getQueueDepth(priority), 0);
+		}
+	}
+
+	// Cancel
+	{
+		Barrier barrier(2);
+		AsyncLoader a;
+		Atomic<U32> canceled = {0};
+		Atomic<U32> notCanceled = {0};
+		Atomic<U32> counter = {0};
+
+		a.submitNewTask<TestTask>(AsyncLoaderPriority::kMedium, 0.0f, &barrier, nullptr);
+
+		for(U32 i = 0; i < 10; ++i)
+		{
+			a.submitNewTask<CancelableTask>(AsyncLoaderPriority::kMedium, (i & 1) ? &canceled : &notCanceled, &counter);
+		}
+
+		canceled.store(1);
+		barrier.wait();
+
+		while(a.getTasksInFlightCount() != 0)
+		{
+			HighRezTimer::sleep(0.01);
+		}
+
+		ANKI_TEST_EXPECT_EQ(counter.load(), 5);
+		ANKI_TEST_EXPECT_EQ(a.getCanceledTaskCount(), 5);
+	}
+
+	ResourceMemoryPool::freeSingleton();
+}
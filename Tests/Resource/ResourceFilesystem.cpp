@@ -5,6 +5,9 @@
 
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Resource/ResourceFilesystem.h>
+#include <AnKi/Util/Filesystem.h>
+#include <AnKi/Core/CVarSet.h>
+#include <cstdio>
 
 ANKI_TEST(Resource, ResourceFilesystem)
 {
@@ -31,3 +34,452 @@ ANKI_TEST(Resource, ResourceFilesystem)
 		ANKI_TEST_EXPECT_EQ(txt, "hell\n");
 	}
 }
+
+ANKI_TEST(Resource, MappedResourceFile)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		if(directoryExists("./mapped_data"))
+		{
+			ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./mapped_data"));
+		}
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory("./mapped_data"));
+
+		Array<U32, 1000> data;
+		for(U32 i = 0; i < data.getSize(); ++i)
+		{
+			data[i] = i;
+		}
+
+		File f;
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./mapped_data/file.bin", FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+		ANKI_TEST_EXPECT_NO_ERR(f.write(&data[0], sizeof(data)));
+		f.close();
+
+		ResourceFilesystem fs;
+		ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./mapped_data", ResourceStringList(), ResourceStringList()));
+
+		ResourceFilePtr file;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("file.bin", file));
+		ANKI_TEST_EXPECT_EQ(file->getSize(), sizeof(data));
+
+		// Reads
+		U32 u;
+		ANKI_TEST_EXPECT_NO_ERR(file->readU32(u));
+		ANKI_TEST_EXPECT_EQ(u, 0);
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(10 * sizeof(U32), FileSeekOrigin::kCurrent));
+		ANKI_TEST_EXPECT_NO_ERR(file->readU32(u));
+		ANKI_TEST_EXPECT_EQ(u, 11);
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(500 * sizeof(U32), FileSeekOrigin::kBeginning));
+		Array<U32, 10> arr;
+		ANKI_TEST_EXPECT_NO_ERR(file->read(&arr[0], sizeof(arr)));
+		ANKI_TEST_EXPECT_EQ(arr[0], 500);
+		ANKI_TEST_EXPECT_EQ(arr[9], 509);
+
+		// Reading past the end fails
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(0, FileSeekOrigin::kEnd));
+		ANKI_TEST_EXPECT_ERR(file->readU32(u), Error::kFileAccess);
+
+		// Views
+		file->adviseAccess(0, file->getSize(), FileAccessHint::kSequential);
+		const U32* view = static_cast<const U32*>(file->getMappedView(sizeof(U32) * 100, sizeof(U32) * 10));
+#if ANKI_POSIX
+		ANKI_TEST_EXPECT_NEQ(view, nullptr);
+		ANKI_TEST_EXPECT_EQ(view[0], 100);
+		ANKI_TEST_EXPECT_EQ(view[9], 109);
+
+		// Out of bounds
+		ANKI_TEST_EXPECT_EQ(file->getMappedView(file->getSize() - sizeof(U32), sizeof(U32) * 2), nullptr);
+		ANKI_TEST_EXPECT_EQ(file->getMappedView(file->getSize() + 1, 0), nullptr);
+		ANKI_TEST_EXPECT_EQ(file->getMappedView(sizeof(U32), kMaxPtrSize), nullptr);
+#else
+		ANKI_TEST_EXPECT_EQ(view, nullptr);
+#endif
+
+		file.reset(nullptr);
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./mapped_data"));
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Resource, AsyncFileReader)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		if(directoryExists("./async_data"))
+		{
+			ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./async_data"));
+		}
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory("./async_data"));
+
+		constexpr U32 kValueCount = 256 * 1024;
+		ResourceDynamicArray<U32> data;
+		data.resize(kValueCount);
+		for(U32 i = 0; i < kValueCount; ++i)
+		{
+			data[i] = i;
+		}
+
+		File f;
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./async_data/file.bin", FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+		ANKI_TEST_EXPECT_NO_ERR(f.write(&data[0], data.getSizeInBytes()));
+		f.close();
+
+		// Try all the combinations of file types and backends
+		for(const Char* mapFiles : {"1", "0"})
+		{
+			ANKI_TEST_EXPECT_NO_ERR(CVarSet::getSingleton().setMultiple(Array<const Char*, 2>{"MemoryMapResourceFiles", mapFiles}));
+
+			ResourceFilesystem fs;
+			ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./async_data", ResourceStringList(), ResourceStringList()));
+
+			ResourceFilePtr file;
+			ANKI_TEST_EXPECT_NO_ERR(fs.openFile("file.bin", file));
+
+			for(Bool useIoUring : {false, true})
+			{
+				AsyncFileReader reader;
+				ANKI_TEST_EXPECT_NO_ERR(reader.init(2, useIoUring));
+
+				// Many reads of different sizes and offsets. The last one is empty
+				constexpr U32 kRequestCount = 300;
+				ResourceDynamicArray<U32> out;
+				out.resize(kValueCount, 0);
+				Array<AsyncFileReadRequest, kRequestCount> requests;
+				U32 offset = 0;
+				for(U32 i = 0; i < kRequestCount; ++i)
+				{
+					const U32 count = (i == kRequestCount - 1) ? 0 : min(kValueCount - offset, (i % 7) * 333 + 1);
+					requests[i].m_file = file.get();
+					requests[i].m_offset = offset * sizeof(U32);
+					requests[i].m_size = count * sizeof(U32);
+					requests[i].m_destination = out.getBegin() + offset;
+					offset += count;
+				}
+
+				AsyncFileReadBatch batch;
+				reader.submit(requests, batch);
+				ANKI_TEST_EXPECT_NO_ERR(batch.wait());
+				ANKI_TEST_EXPECT_EQ(batch.isDone(), true);
+
+				Bool match = true;
+				for(U32 i = 0; i < offset; ++i)
+				{
+					match = match && out[i] == i;
+				}
+				ANKI_TEST_EXPECT_EQ(match, true);
+
+				// Reading past the end fails
+				U32 u;
+				AsyncFileReadRequest badRequest = {file.get(), data.getSizeInBytes() - 2, sizeof(u), &u};
+				ANKI_TEST_EXPECT_ERR(reader.read({&badRequest, 1}), Error::kFileAccess);
+			}
+
+			// Reads with the file's position in the middle
+			ANKI_TEST_EXPECT_NO_ERR(file->seek(100 * sizeof(U32), FileSeekOrigin::kBeginning));
+			U32 u;
+			ANKI_TEST_EXPECT_NO_ERR(file->readAt(5000 * sizeof(U32), &u, sizeof(u)));
+			ANKI_TEST_EXPECT_EQ(u, 5000);
+			ANKI_TEST_EXPECT_NO_ERR(file->read(&u, sizeof(u)));
+			ANKI_TEST_EXPECT_EQ(u, 100);
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(CVarSet::getSingleton().setMultiple(Array<const Char*, 2>{"MemoryMapResourceFiles", "1"}));
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./async_data"));
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Resource, ResourcePackage)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		for(CString dir : {"./package_data", "./package_data2"})
+		{
+			if(directoryExists(dir))
+			{
+				ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir));
+			}
+			ANKI_TEST_EXPECT_NO_ERR(createDirectory(dir));
+		}
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory("./package_data/dir"));
+
+		// A compressible file, an incompressible file and a text file
+		constexpr U32 kValueCount = 300 * 1024;
+		ResourceDynamicArray<U32> values;
+		values.resize(kValueCount);
+		ResourceDynamicArray<U32> noise;
+		noise.resize(kValueCount / 4);
+		for(U32 i = 0; i < kValueCount; ++i)
+		{
+			values[i] = i / 3;
+		}
+		for(U32& n : noise)
+		{
+			n = U32(getRandom());
+		}
+
+		File f;
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./package_data/dir/values.bin", FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+		ANKI_TEST_EXPECT_NO_ERR(f.write(&values[0], values.getSizeInBytes()));
+		f.close();
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./package_data/dir/noise.bin", FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+		ANKI_TEST_EXPECT_NO_ERR(f.write(&noise[0], noise.getSizeInBytes()));
+		f.close();
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./package_data/hello.txt", FileOpenFlag::kWrite));
+		ANKI_TEST_EXPECT_NO_ERR(f.writeText("hello package"));
+		f.close();
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./package_data2/override.txt", FileOpenFlag::kWrite));
+		ANKI_TEST_EXPECT_NO_ERR(f.writeText("from dir"));
+		f.close();
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./package_data/override.txt", FileOpenFlag::kWrite));
+		ANKI_TEST_EXPECT_NO_ERR(f.writeText("from package"));
+		f.close();
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./package_data/empty.txt", FileOpenFlag::kWrite));
+		f.close();
+
+		ANKI_TEST_EXPECT_NO_ERR(buildResourcePackage("./package_data", "./package.ankipak", 64_KB));
+
+		// The package's TOC
+		{
+			ResourcePackage package;
+			ANKI_TEST_EXPECT_NO_ERR(package.open("./package.ankipak"));
+			ANKI_TEST_EXPECT_EQ(package.getFileCount(), 5);
+			const U32 idx = package.findFile("dir/values.bin");
+			ANKI_TEST_EXPECT_NEQ(idx, kMaxU32);
+			ANKI_TEST_EXPECT_EQ(package.getFilename(idx), "dir/values.bin");
+			ANKI_TEST_EXPECT_EQ(package.getFileSize(idx), values.getSizeInBytes());
+			ANKI_TEST_EXPECT_EQ(package.findFile("dir/nothing.bin"), kMaxU32);
+		}
+
+		// A block that is smaller than the block size but it's not the last block of its file
+		{
+			ANKI_TEST_EXPECT_NO_ERR(f.open("./package.ankipak", FileOpenFlag::kRead | FileOpenFlag::kBinary));
+			ResourceDynamicArray<U8> data;
+			data.resize(U32(f.getSize()));
+			ANKI_TEST_EXPECT_NO_ERR(f.read(&data[0], data.getSize()));
+			f.close();
+
+			ResourcePackageHeader header;
+			memcpy(&header, &data[0], sizeof(header));
+			const PtrSize blocksOffset = header.m_tocOffset + sizeof(ResourcePackageFileEntry) * header.m_fileCount;
+			for(U32 i = 0; i < header.m_blockCount; ++i)
+			{
+				ResourcePackageBlock block;
+				memcpy(&block, &data[blocksOffset + sizeof(block) * i], sizeof(block));
+				if(block.m_uncompressedSize == header.m_blockSize)
+				{
+					block.m_compressedSize = min(block.m_compressedSize, block.m_uncompressedSize - 1);
+					--block.m_uncompressedSize;
+					memcpy(&data[blocksOffset + sizeof(block) * i], &block, sizeof(block));
+					break;
+				}
+			}
+
+			ANKI_TEST_EXPECT_NO_ERR(f.open("./corrupted.ankipak", FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+			ANKI_TEST_EXPECT_NO_ERR(f.write(&data[0], data.getSize()));
+			f.close();
+
+			ResourcePackage package;
+			ANKI_TEST_EXPECT_ERR(package.open("./corrupted.ankipak"), Error::kUserData);
+			ANKI_TEST_EXPECT_NO_ERR(removeFile("./corrupted.ankipak"));
+		}
+
+		// The package side by side with a directory. The directory is added last so it takes precedence
+		ResourceFilesystem fs;
+		ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./package.ankipak", ResourceStringList(), ResourceStringList()));
+		ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./package_data2", ResourceStringList(), ResourceStringList()));
+
+		ResourceFilePtr file;
+		ResourceString txt;
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("hello.txt", file));
+		ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt));
+		ANKI_TEST_EXPECT_EQ(txt, "hello package");
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("override.txt", file));
+		ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt));
+		ANKI_TEST_EXPECT_EQ(txt, "from dir");
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("empty.txt", file));
+		ANKI_TEST_EXPECT_EQ(file->getSize(), 0);
+		ANKI_TEST_EXPECT_ERR(file->readAllText(txt), Error::kFunctionFailed);
+
+		// Small reads, seeks and reads that cross blocks
+		ANKI_TEST_EXPECT_NO_ERR(fs.openFile("dir/values.bin", file));
+		ANKI_TEST_EXPECT_EQ(file->getSize(), values.getSizeInBytes());
+		U32 u;
+		for(U32 i = 0; i < 100; ++i)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(file->readU32(u));
+			ANKI_TEST_EXPECT_EQ(u, values[i]);
+		}
+		Array<U32, 20> arr;
+		const U32 blockBoundary = U32(64_KB / sizeof(U32));
+		ANKI_TEST_EXPECT_NO_ERR(file->seek((blockBoundary - 10) * sizeof(U32), FileSeekOrigin::kBeginning));
+		ANKI_TEST_EXPECT_NO_ERR(file->read(&arr[0], sizeof(arr)));
+		ANKI_TEST_EXPECT_EQ(arr[0], values[blockBoundary - 10]);
+		ANKI_TEST_EXPECT_EQ(arr[19], values[blockBoundary + 9]);
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(sizeof(U32), FileSeekOrigin::kBeginning));
+		ANKI_TEST_EXPECT_NO_ERR(file->readU32(u));
+		ANKI_TEST_EXPECT_EQ(u, values[1]);
+		ANKI_TEST_EXPECT_NO_ERR(file->seek(0, FileSeekOrigin::kEnd));
+		ANKI_TEST_EXPECT_ERR(file->readU32(u), Error::kFileAccess);
+
+		// Read everything in parallel
+		for(const Char* fname : {"dir/values.bin", "dir/noise.bin"})
+		{
+			ANKI_TEST_EXPECT_NO_ERR(fs.openFile(fname, file));
+			const ResourceDynamicArray<U32>& expected = (CString(fname) == "dir/values.bin") ? values : noise;
+
+			AsyncFileReader reader;
+			ANKI_TEST_EXPECT_NO_ERR(reader.init(4, true));
+
+			ResourceDynamicArray<U32> out;
+			out.resize(expected.getSize(), 0);
+			const PtrSize half = out.getSizeInBytes() / 2 + 3;
+			U8* outBytes = reinterpret_cast<U8*>(out.getBegin());
+			Array<AsyncFileReadRequest, 2> requests = {
+				{{file.get(), 0, half, outBytes}, {file.get(), half, out.getSizeInBytes() - half, outBytes + half}}};
+			ANKI_TEST_EXPECT_NO_ERR(reader.read(requests));
+			ANKI_TEST_EXPECT_EQ(memcmp(out.getBegin(), expected.getBegin(), out.getSizeInBytes()), 0);
+		}
+
+		file.reset(nullptr);
+		ANKI_TEST_EXPECT_NO_ERR(removeFile("./package.ankipak"));
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./package_data"));
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./package_data2"));
+	}
+
+	ResourceMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Resource, ResourceFilesystemIndex)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		if(directoryExists("./index_data"))
+		{
+			ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./index_data"));
+		}
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory("./index_data"));
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory("./index_data/sub"));
+
+		File f;
+		ANKI_TEST_EXPECT_NO_ERR(f.open("./index_data/sub/a.txt", FileOpenFlag::kWrite));
+		ANKI_TEST_EXPECT_NO_ERR(f.writeText("index"));
+		f.close();
+
+		ANKI_TEST_EXPECT_NO_ERR(CVarSet::getSingleton().setMultiple(Array<const Char*, 2>{"WatchDataPaths", "1"}));
+
+		ResourceFilesystem fs;
+		ANKI_TEST_EXPECT_NO_ERR(fs.init());
+		ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("Tests/Data/Dir", ResourceStringList(), ResourceStringList()));
+		ANKI_TEST_EXPECT_NO_ERR(fs.addNewPath("./index_data", ResourceStringList(), ResourceStringList()));
+
+		// Different spellings of the same file
+		for(CString fname : {"sub/a.txt", "./sub//a.txt", "sub\\a.txt"})
+		{
+			ResourceFilePtr file;
+			ANKI_TEST_EXPECT_NO_ERR(fs.openFile(fname, file));
+			ResourceString txt;
+			ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt));
+			ANKI_TEST_EXPECT_EQ(txt, "index");
+		}
+
+		// A file of the 1st path
+		{
+			ResourceFilePtr file;
+			ANKI_TEST_EXPECT_NO_ERR(fs.openFile("subdir1/./subdir2/file.txt", file));
+		}
+
+		// The latest path shadows the older ones
+		{
+			ANKI_TEST_EXPECT_NO_ERR(f.open("./index_data/a.txt", FileOpenFlag::kWrite));
+			ANKI_TEST_EXPECT_NO_ERR(f.writeText("shadow"));
+			f.close();
+			ANKI_TEST_EXPECT_NO_ERR(fs.updateFileIndex());
+
+			ResourceFilePtr file;
+			ANKI_TEST_EXPECT_NO_ERR(fs.openFile("a.txt", file));
+			ResourceString txt;
+			ANKI_TEST_EXPECT_NO_ERR(file->readAllText(txt));
+			ANKI_TEST_EXPECT_EQ(txt, "shadow");
+		}
+
+		// New files in new directories are picked up
+		{
+			ANKI_TEST_EXPECT_NO_ERR(createDirectory("./index_data/new"));
+			ANKI_TEST_EXPECT_NO_ERR(fs.updateFileIndex());
+			ANKI_TEST_EXPECT_NO_ERR(f.open("./index_data/new/b.txt", FileOpenFlag::kWrite));
+			ANKI_TEST_EXPECT_NO_ERR(f.writeText("new"));
+			f.close();
+			ANKI_TEST_EXPECT_NO_ERR(fs.updateFileIndex());
+
+			U32 count = 0;
+			ANKI_TEST_EXPECT_NO_ERR(fs.iterateAllFilenames([&](CString fname) -> Error {
+				count += fname == "new/b.txt";
+				return Error::kNone;
+			}));
+			ANKI_TEST_EXPECT_EQ(count, 1);
+
+			ResourceFilePtr file;
+			ANKI_TEST_EXPECT_NO_ERR(fs.openFile("new/b.txt", file));
+		}
+
+		// Deleted files are removed from the index
+		{
+			ANKI_TEST_EXPECT_NO_ERR(removeFile("./index_data/a.txt"));
+			ANKI_TEST_EXPECT_NO_ERR(fs.updateFileIndex());
+
+			ResourceFilePtr file;
+			ANKI_TEST_EXPECT_NO_ERR(fs.openFile("a.txt", file));
+			ANKI_TEST_EXPECT_EQ(file->getSize(), 0);
+		}
+
+		// Directories that are renamed or removed
+		{
+			auto countFiles = [&](CString prefix) {
+				U32 count = 0;
+				ANKI_TEST_EXPECT_NO_ERR(fs.iterateAllFilenames([&](CString fname) -> Error {
+					count += fname.find(prefix) == 0;
+					return Error::kNone;
+				}));
+				return count;
+			};
+
+			ANKI_TEST_EXPECT_EQ(rename("./index_data/new", "./index_data/moved"), 0);
+			ANKI_TEST_EXPECT_NO_ERR(fs.updateFileIndex());
+			ANKI_TEST_EXPECT_EQ(countFiles("new/"), 0);
+			ANKI_TEST_EXPECT_EQ(countFiles("moved/b.txt"), 1);
+
+			ANKI_TEST_EXPECT_NO_ERR(f.open("./index_data/moved/c.txt", FileOpenFlag::kWrite));
+			ANKI_TEST_EXPECT_NO_ERR(f.writeText("moved"));
+			f.close();
+			ANKI_TEST_EXPECT_NO_ERR(fs.updateFileIndex());
+			ANKI_TEST_EXPECT_EQ(countFiles("moved/"), 2);
+
+			ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./index_data/moved"));
+			ANKI_TEST_EXPECT_NO_ERR(fs.updateFileIndex());
+			ANKI_TEST_EXPECT_EQ(countFiles("moved/"), 0);
+			ANKI_TEST_EXPECT_EQ(countFiles("sub/a.txt"), 1);
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(CVarSet::getSingleton().setMultiple(Array<const Char*, 2>{"WatchDataPaths", "0"}));
+	}
+
+	ANKI_TEST_EXPECT_NO_ERR(removeDirectory("./index_data"));
+
+	ResourceMemoryPool::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
@@ -9,6 +9,9 @@
 
 ANKI_TEST(Resource, ResourceManager)
 {
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	NameTable::allocateSingleton(); // The resources are keyed on their interned filenames
+
 	// Create
 	ResourceManager* resources = &ResourceManager::allocateSingleton();
 	ANKI_TEST_EXPECT_NO_ERR(resources->init(allocAligned, nullptr));
@@ -71,4 +74,6 @@ ANKI_TEST(Resource, ResourceManager)
 
 	// Delete
 	ResourceManager::freeSingleton();
+	NameTable::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
 }
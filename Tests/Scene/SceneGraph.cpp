@@ -0,0 +1,131 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Scene.h>
+#include <AnKi/Util/HighRezTimer.h>
+
+using namespace anki;
+
+namespace {
+
+class SceneGraphBenchApp : public App
+{
+public:
+	static constexpr U32 kRootNodeCount = 10'000;
+	static constexpr U32 kChildrenPerRoot = 9; ///< 100K nodes in total.
+	static constexpr U32 kFrameCount = 60;
+
+	DynamicArray<SceneNode*> m_roots;
+	U32 m_frame = 0;
+	Second m_updateTime = 0.0;
+	Second m_hotDataWalkTime = 0.0;
+	Second m_nodeWalkTime = 0.0;
+
+	using App::App;
+
+	Error userMainLoop(Bool& quit, [[maybe_unused]] Second elapsedTime) override
+	{
+		SceneGraph& scene = SceneGraph::getSingleton();
+
+		if(m_frame == 0)
+		{
+			for(U32 i = 0; i < kRootNodeCount; ++i)
+			{
+				SceneNode* root;
+				ANKI_CHECK(scene.newSceneNode(CString(), root));
+				root->setLocalOrigin(Vec4(F32(i % 100), 0.0f, F32(i / 100), 0.0f));
+				m_roots.emplaceBack(root);
+
+				for(U32 c = 0; c < kChildrenPerRoot; ++c)
+				{
+					SceneNode* child;
+					ANKI_CHECK(scene.newSceneNode(CString(), child));
+					child->setLocalOrigin(Vec4(0.0f, F32(c + 1), 0.0f, 0.0f));
+					root->addChild(child);
+				}
+			}
+		}
+		else
+		{
+			// Move 10% of the hierarchies every frame
+			for(U32 i = m_frame % 10; i < kRootNodeCount; i += 10)
+			{
+				m_roots[i]->setLocalOrigin(m_roots[i]->getLocalOrigin() + Vec4(0.0f, 0.1f, 0.0f, 0.0f));
+			}
+
+			HighRezTimer timer;
+			timer.start();
+			ANKI_CHECK(scene.update(0.0, 1.0 / 60.0));
+			timer.stop();
+			m_updateTime += timer.getElapsedTime();
+
+			// Walk the world transforms through the hot data
+			timer.start();
+			Vec4 sum1(0.0f);
+			U32 count1 = 0;
+			scene.getHotData().iterateSlots([&](const SceneHotDataChunk& chunk, U32 idx) {
+				sum1 += chunk.m_worldTransforms[idx].getOrigin();
+				++count1;
+			});
+			timer.stop();
+			m_hotDataWalkTime += timer.getElapsedTime();
+
+			// Walk the world transforms through the nodes
+			timer.start();
+			Vec4 sum2(0.0f);
+			U32 count2 = 0;
+			ANKI_CHECK(scene.iterateSceneNodes([&](SceneNode& node) {
+				sum2 += node.getWorldTransform().getOrigin();
+				++count2;
+				return Error::kNone;
+			}));
+			timer.stop();
+			m_nodeWalkTime += timer.getElapsedTime();
+
+			ANKI_TEST_EXPECT_EQ(count1, count2);
+			ANKI_TEST_EXPECT_NEAR(sum1.y() / F32(count1), sum2.y() / F32(count2), 0.01f);
+
+			// The moved hierarchies are one step ahead of their previous transforms, the rest didn't move
+			if(m_frame > 10)
+			{
+				const SceneNode& moved = *m_roots[m_frame % 10];
+				ANKI_TEST_EXPECT_EQ(moved.movedThisFrame(), true);
+				ANKI_TEST_EXPECT_NEAR(moved.getWorldTransform().getOrigin().y() - moved.getPreviousWorldTransform().getOrigin().y(), 0.1f, 0.001f);
+
+				const SceneNode& still = *m_roots[(m_frame + 5) % 10];
+				ANKI_TEST_EXPECT_EQ(still.movedThisFrame(), false);
+				ANKI_TEST_EXPECT_EQ(still.getWorldTransform(), still.getPreviousWorldTransform());
+			}
+		}
+
+		++m_frame;
+		quit = m_frame > kFrameCount;
+		return Error::kNone;
+	}
+};
+
+} // namespace
+
+ANKI_TEST(Scene, SceneGraphUpdateBench)
+{
+	g_windowWidthCVar.set(640);
+	g_windowHeightCVar.set(480);
+	g_dataPathsCVar.set("EngineAssets");
+
+	SceneGraphBenchApp* app = new SceneGraphBenchApp(allocAligned, nullptr);
+	ANKI_TEST_EXPECT_NO_ERR(app->init());
+	ANKI_TEST_EXPECT_NO_ERR(app->mainLoop());
+
+	const SceneHotData& hotData = SceneGraph::getSingleton().getHotData();
+	ANKI_TEST_EXPECT_GEQ(hotData.getSize(), SceneGraphBenchApp::kRootNodeCount * (SceneGraphBenchApp::kChildrenPerRoot + 1));
+	ANKI_TEST_EXPECT_EQ(hotData.getChunkCount(), (hotData.getSize() + SceneHotDataChunk::kSize - 1) / SceneHotDataChunk::kSize);
+
+	const F64 frames = F64(SceneGraphBenchApp::kFrameCount);
+	ANKI_TEST_LOGI("SceneGraph::update() of %u nodes: %fms. Walk the world transforms: hot data %fms, nodes %fms", hotData.getSize(),
+				   app->m_updateTime / frames * 1000.0, app->m_hotDataWalkTime / frames * 1000.0, app->m_nodeWalkTime / frames * 1000.0);
+
+	delete app;
+}
@@ -62,6 +62,8 @@ ANKI_TEST(Ui, Ui)
 	g_windowHeightCVar.set(760);
 	g_dataPathsCVar.set("EngineAssets");
 
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	NameTable::allocateSingleton();
 	initWindow();
 	ANKI_TEST_EXPECT_NO_ERR(Input::allocateSingleton().init());
 	initGrManager();
@@ -143,4 +145,6 @@ ANKI_TEST(Ui, Ui)
 	GrManager::freeSingleton();
 	Input::freeSingleton();
 	NativeWindow::freeSingleton();
+	NameTable::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
 }
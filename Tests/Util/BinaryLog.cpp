@@ -0,0 +1,198 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/BinaryLog.h>
+#include <AnKi/Util/BinaryLogReader.h>
+#include <AnKi/Util/NameTable.h>
+#include <AnKi/Util/Thread.h>
+#include <AnKi/Util/Filesystem.h>
+
+ANKI_TEST(Util, BinaryLogFormat)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		// Build the arguments the way the writer does
+		class ArgWriter
+		{
+		public:
+			DynamicArray<U8> m_data;
+
+			void push(BinaryLogArgType type, U64 value)
+			{
+				m_data.emplaceBack(U8(type));
+				for(U32 i = 0; i < sizeof(value); ++i)
+				{
+					m_data.emplaceBack(U8(value >> (i * 8)));
+				}
+			}
+
+			void push(const Char* str)
+			{
+				const U16 length = U16(strlen(str));
+				m_data.emplaceBack(U8(BinaryLogArgType::kString));
+				m_data.emplaceBack(U8(length));
+				m_data.emplaceBack(U8(length >> 8));
+				for(U32 i = 0; i < length; ++i)
+				{
+					m_data.emplaceBack(U8(str[i]));
+				}
+			}
+		};
+
+		ArgWriter args;
+		args.push(BinaryLogArgType::kI64, U64(-42));
+		args.push(BinaryLogArgType::kU64, 0xABCD);
+		F64 f = 1.5;
+		U64 fbits;
+		memcpy(&fbits, &f, sizeof(f));
+		args.push(BinaryLogArgType::kF64, fbits);
+		args.push("hello");
+		args.push(BinaryLogArgType::kI64, 6);
+		args.push(BinaryLogArgType::kU64, 7);
+
+		String out;
+		ANKI_TEST_EXPECT_NO_ERR(BinaryLogReader::formatMessage("%d %lx %.2f [%s] [%*u] 100%%", args.m_data, out));
+		ANKI_TEST_EXPECT_EQ(out, "-42 abcd 1.50 [hello] [     7] 100%");
+
+		// The integers are truncated to the size of their length modifier like printf() does
+		{
+			ArgWriter intArgs;
+			intArgs.push(BinaryLogArgType::kI64, U64(-1));
+			intArgs.push(BinaryLogArgType::kI64, U64(-1));
+			intArgs.push(BinaryLogArgType::kU64, 0xFFFFFFFF);
+			intArgs.push(BinaryLogArgType::kI64, U64(-1));
+			intArgs.push(BinaryLogArgType::kI64, U64(-2));
+			intArgs.push(BinaryLogArgType::kU64, 0x1FF);
+
+			ANKI_TEST_EXPECT_NO_ERR(BinaryLogReader::formatMessage("%u %x %d %llu %hd %hhu", intArgs.m_data, out));
+			ANKI_TEST_EXPECT_EQ(out, "4294967295 ffffffff -1 18446744073709551615 -2 255");
+		}
+
+		// Not enough arguments
+		ANKI_TEST_EXPECT_ERR(BinaryLogReader::formatMessage("%d %d %d %d %d %d %d", args.m_data, out), Error::kUserData);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, BinaryLog)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	NameTable::allocateSingleton();
+
+	{
+		String filename;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(filename));
+		filename += "/BinaryLogTest.ablog";
+
+		constexpr U32 kThreadCount = 4;
+		constexpr U32 kMessagesPerThread = 2000;
+
+		ANKI_TEST_EXPECT_NO_ERR(BinaryLog::getSingleton().beginCapture(filename.cstr()));
+		ANKI_TEST_EXPECT_EQ(BinaryLog::isCapturing(), true);
+
+		const String str = "a string";
+		const Char* cstr = "a C string";
+		const void* ptr = numberToPtr<const void*>(0x1234);
+		ANKI_UTIL_LOGI("Test %d %u %.3f %s %s %p", -1, 2u, 3.25f, str.cstr(), cstr, ptr);
+		ANKI_UTIL_LOGW("Warning %s", str.cstr());
+
+		// The arguments are evaluated once even if the message goes to the capture and to the handlers
+		U32 evaluationCount = 0;
+		ANKI_UTIL_LOGW("Evaluated %u", ++evaluationCount);
+		ANKI_TEST_EXPECT_EQ(evaluationCount, 1);
+
+		Array<Thread*, kThreadCount> threads;
+		for(U32 i = 0; i < kThreadCount; ++i)
+		{
+			threads[i] = newInstance<Thread>(DefaultMemoryPool::getSingleton(), "BinaryLogTest");
+			threads[i]->start(numberToPtr<void*>(i), [](ThreadCallbackInfo& info) -> Error {
+				const U32 threadIdx = U32(ptrToNumber(info.m_userData));
+				for(U32 m = 0; m < kMessagesPerThread; ++m)
+				{
+					ANKI_UTIL_LOGI("Thread %u message %u", threadIdx, m);
+				}
+
+				BinaryLog::getSingleton().writeTraceEvent("Event", 1.0, 0.5);
+				BinaryLog::getSingleton().writeCounter("Counter", threadIdx);
+				return Error::kNone;
+			});
+		}
+
+		for(U32 i = 0; i < kThreadCount; ++i)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(threads[i]->join());
+			deleteInstance(DefaultMemoryPool::getSingleton(), threads[i]);
+		}
+
+		BinaryLog::getSingleton().endCapture();
+		ANKI_TEST_EXPECT_EQ(BinaryLog::isCapturing(), false);
+
+		BinaryLogReader reader;
+		ANKI_TEST_EXPECT_NO_ERR(reader.load(filename));
+
+		// Find the first messages
+		Bool foundTest = false;
+		Bool foundWarning = false;
+		Array<U32, kThreadCount> nextMessage = {};
+		for(const BinaryLogReader::Message& msg : reader.getMessages())
+		{
+			if(msg.m_text.find("Test ") == 0)
+			{
+				String expected;
+				expected.sprintf("Test %d %u %.3f %s %s %p", -1, 2u, 3.25f, str.cstr(), cstr, ptr);
+				ANKI_TEST_EXPECT_EQ(msg.m_text, expected);
+				ANKI_TEST_EXPECT_EQ(msg.m_type, LoggerMessageType::kNormal);
+				ANKI_TEST_EXPECT_EQ(msg.m_subsystem, "UTIL");
+				foundTest = true;
+			}
+			else if(msg.m_text == "Warning a string")
+			{
+				ANKI_TEST_EXPECT_EQ(msg.m_type, LoggerMessageType::kWarning);
+				foundWarning = true;
+			}
+			else if(msg.m_text.find("Thread ") == 0)
+			{
+				U32 threadIdx, m;
+				ANKI_TEST_EXPECT_EQ(sscanf(msg.m_text.cstr(), "Thread %u message %u", &threadIdx, &m), 2);
+				ANKI_TEST_EXPECT_LT(threadIdx, kThreadCount);
+
+				// The messages of a thread are in order
+				ANKI_TEST_EXPECT_EQ(m, nextMessage[threadIdx]);
+				++nextMessage[threadIdx];
+			}
+		}
+
+		ANKI_TEST_EXPECT_EQ(foundTest, true);
+		ANKI_TEST_EXPECT_EQ(foundWarning, true);
+		for(U32 i = 0; i < kThreadCount; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(nextMessage[i], kMessagesPerThread);
+		}
+
+		ANKI_TEST_EXPECT_EQ(reader.getTraceEvents().getSize(), kThreadCount);
+		for(const BinaryLogReader::TraceEvent& event : reader.getTraceEvents())
+		{
+			ANKI_TEST_EXPECT_EQ(event.m_name, "Event");
+			ANKI_TEST_EXPECT_NEAR(event.m_duration, 0.5, 0.000001);
+		}
+
+		ANKI_TEST_EXPECT_EQ(reader.getCounters().getSize(), kThreadCount);
+		U64 counterSum = 0;
+		for(const BinaryLogReader::Counter& counter : reader.getCounters())
+		{
+			ANKI_TEST_EXPECT_EQ(counter.m_name, "Counter");
+			counterSum += counter.m_value;
+		}
+		ANKI_TEST_EXPECT_EQ(counterSum, 0 + 1 + 2 + 3);
+
+		ANKI_TEST_EXPECT_NO_ERR(removeFile(filename));
+	}
+
+	NameTable::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
@@ -191,3 +191,130 @@ ANKI_TEST(Util, BlockArray)
 
 	DefaultMemoryPool::freeSingleton();
 }
+
+ANKI_TEST(Util, BlockArraySparse)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Iterate and compact a sparse array
+	TestFoo::reset();
+	{
+		constexpr U32 kInsertionCount = 1000;
+		BlockArray<TestFoo> arr;
+		std::vector<int> values(kInsertionCount, -1); // Indexed by the array index
+
+		for(U32 i = 0; i < kInsertionCount; ++i)
+		{
+			auto it = arr.emplace(int(i));
+			ANKI_TEST_EXPECT_EQ(it.getArrayIndex(), i);
+			values[i] = int(i);
+		}
+
+		// Leave ~25% of the elements and a few blocks completely empty
+		for(U32 i = 0; i < kInsertionCount; ++i)
+		{
+			if((i % 4) != 0 || (i >= 128 && i < 320))
+			{
+				arr.erase(i);
+				values[i] = -1;
+			}
+		}
+		arr.validate();
+
+		// Iterate
+		U32 count = 0;
+		for(auto it = arr.getBegin(); it != arr.getEnd(); ++it)
+		{
+			ANKI_TEST_EXPECT_EQ(it->m_x, values[it.getArrayIndex()]);
+			++count;
+		}
+		ANKI_TEST_EXPECT_EQ(count, arr.getSize());
+
+		// Emplace re-uses the first hole
+		auto it = arr.emplace(-2);
+		ANKI_TEST_EXPECT_EQ(it.getArrayIndex(), 1);
+		values[1] = -2;
+		arr.validate();
+
+		// Compact
+		std::vector<int> newValues(kInsertionCount, -1);
+		for(U32 i = 0; i < kInsertionCount; ++i)
+		{
+			newValues[i] = values[i];
+		}
+
+		arr.compact([&](U32 oldIdx, U32 newIdx) {
+			ANKI_TEST_EXPECT_GT(oldIdx, newIdx);
+			ANKI_TEST_EXPECT_EQ(newValues[newIdx], -1);
+			newValues[newIdx] = newValues[oldIdx];
+			newValues[oldIdx] = -1;
+		});
+		arr.validate();
+
+		for(U32 i = 0; i < arr.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(arr.indexExists(i), true);
+			ANKI_TEST_EXPECT_EQ(arr[i].m_x, newValues[i]);
+		}
+		ANKI_TEST_EXPECT_EQ(arr.indexExists(arr.getSize()), false);
+
+		// It should still work as usual
+		it = arr.emplace(1234);
+		ANKI_TEST_EXPECT_EQ(it.getArrayIndex(), arr.getSize() - 1);
+		arr.validate();
+
+		// Compact everything away
+		while(!arr.isEmpty())
+		{
+			arr.erase(arr.getBegin());
+		}
+		arr.compact([](U32, U32) {});
+		arr.validate();
+		ANKI_TEST_EXPECT_EQ(arr.emplace(1).getArrayIndex(), 0);
+	}
+	ANKI_TEST_EXPECT_EQ(TestFoo::m_constructorCount, TestFoo::m_destructorCount);
+	ANKI_TEST_EXPECT_EQ(TestFoo::m_copyCount, 0);
+
+	// Iteration performance of a sparse array
+	if(ANKI_OPTIMIZE)
+	{
+		constexpr U32 kInsertionCount = 2'000'000;
+		BlockArray<U64> arr;
+		for(U32 i = 0; i < kInsertionCount; ++i)
+		{
+			arr.emplace(i);
+		}
+
+		// Keep 1 every 5 elements and empty whole blocks here and there
+		for(U32 i = 0; i < kInsertionCount; ++i)
+		{
+			if((i % 5) != 0 || ((i / 64) % 3) == 0)
+			{
+				arr.erase(i);
+			}
+		}
+
+		U64 begin = HighRezTimer::getCurrentTimeUs();
+		U64 sum = 0;
+		for(U64 x : arr)
+		{
+			sum += x;
+		}
+		const U64 sparseTime = HighRezTimer::getCurrentTimeUs() - begin;
+
+		arr.compact([](U32, U32) {});
+
+		begin = HighRezTimer::getCurrentTimeUs();
+		U64 sum2 = 0;
+		for(U64 x : arr)
+		{
+			sum2 += x;
+		}
+		const U64 compactTime = HighRezTimer::getCurrentTimeUs() - begin;
+
+		ANKI_TEST_EXPECT_EQ(sum, sum2);
+		ANKI_TEST_LOGI("Iteration time of %u elements: sparse %luus, compacted %luus", arr.getSize(), sparseTime, compactTime);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,167 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/ConcurrentHashMap.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
+
+using namespace anki;
+
+ANKI_TEST(Util, ConcurrentHashMap)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Single threaded
+	{
+		ConcurrentHashMap<U32, U64> map;
+
+		U64 value;
+		ANKI_TEST_EXPECT_EQ(map.find(123u, value), false);
+
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(map.emplace(i, U64(i) * 10), true);
+		}
+		ANKI_TEST_EXPECT_EQ(map.emplace(10u, 0), false); // Doesn't replace
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 1000);
+
+		for(U32 i = 0; i < 1000; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(map.find(i, value), true);
+			ANKI_TEST_EXPECT_EQ(value, U64(i) * 10);
+		}
+		ANKI_TEST_EXPECT_EQ(map.find(1000u, value), false);
+
+		// The hash used for empty slots
+		ANKI_TEST_EXPECT_EQ(map.findHash(0, value), false);
+		ANKI_TEST_EXPECT_EQ(map.emplaceHash(0, 666), true);
+		ANKI_TEST_EXPECT_EQ(map.findHash(0, value), true);
+		ANKI_TEST_EXPECT_EQ(value, 666);
+
+		U64 sum = 0;
+		U32 count = 0;
+		map.iterate([&]([[maybe_unused]] U64 hash, U64 v) {
+			sum += v;
+			++count;
+		});
+		ANKI_TEST_EXPECT_EQ(count, 1001);
+		ANKI_TEST_EXPECT_EQ(sum, 666 + 10 * (999 * 1000 / 2));
+	}
+
+	// Readers while a writer inserts and grows the table
+	{
+		constexpr U32 kElementCount = 100000;
+		const U32 threadCount = max(4u, getCpuCoresCount());
+
+		ConcurrentHashMap<U32, U64> map;
+		Atomic<U32> insertedCount = {0};
+		Atomic<U32> errors = {0};
+
+		ThreadJobManager jobs(threadCount);
+
+		jobs.dispatchTask([&]([[maybe_unused]] U32 threadId) {
+			for(U32 i = 0; i < kElementCount; ++i)
+			{
+				map.emplace(i, U64(i) + 1);
+				insertedCount.store(i + 1, AtomicMemoryOrder::kRelease);
+			}
+		});
+
+		auto reader = [&](U32 threadId) {
+			U32 seed = threadId + 1;
+			while(insertedCount.load(AtomicMemoryOrder::kAcquire) < kElementCount)
+			{
+				const U32 inserted = insertedCount.load(AtomicMemoryOrder::kAcquire);
+				if(inserted == 0)
+				{
+					continue;
+				}
+
+				// Everything that got inserted should be visible
+				seed = seed * 1664525u + 1013904223u;
+				const U32 key = seed % inserted;
+				U64 value;
+				if(!map.find(key, value) || value != U64(key) + 1)
+				{
+					errors.fetchAdd(1);
+				}
+			}
+		};
+		for(U32 i = 0; i < threadCount - 1; ++i)
+		{
+			jobs.dispatchTask(reader);
+		}
+
+		jobs.waitForAllTasksToFinish();
+
+		ANKI_TEST_EXPECT_EQ(errors.load(), 0);
+		ANKI_TEST_EXPECT_EQ(map.getSize(), kElementCount);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, ConcurrentHashMapBench)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kElementCount = 1024;
+		constexpr U32 kLookupsPerThread = 2 * 1024 * 1024;
+		const U32 threadCount = max(4u, getCpuCoresCount());
+
+		ConcurrentHashMap<U32, U64> map;
+		HashMap<U32, U64> lockedMap;
+		RWMutex mtx;
+		for(U32 i = 0; i < kElementCount; ++i)
+		{
+			map.emplace(i, i);
+			lockedMap.emplace(i, i);
+		}
+
+		ThreadJobManager jobs(threadCount);
+		Atomic<U64> sum = {0}; // To avoid compiler opts
+
+		auto run = [&](auto func) -> Second {
+			HighRezTimer timer;
+			timer.start();
+			for(U32 i = 0; i < threadCount; ++i)
+			{
+				jobs.dispatchTask(func);
+			}
+			jobs.waitForAllTasksToFinish();
+			timer.stop();
+			return timer.getElapsedTime();
+		};
+
+		const Second lockedTime = run([&]([[maybe_unused]] U32 threadId) {
+			U64 localSum = 0;
+			for(U32 i = 0; i < kLookupsPerThread; ++i)
+			{
+				RLockGuard<RWMutex> lock(mtx);
+				localSum += *lockedMap.find(i % kElementCount);
+			}
+			sum.fetchAdd(localSum);
+		});
+
+		const Second concurrentTime = run([&]([[maybe_unused]] U32 threadId) {
+			U64 localSum = 0;
+			for(U32 i = 0; i < kLookupsPerThread; ++i)
+			{
+				U64 value = 0;
+				map.find(i % kElementCount, value);
+				localSum += value;
+			}
+			sum.fetchAdd(localSum);
+		});
+
+		ANKI_TEST_LOGI("Lookup bench (%u threads): HashMap+RWMutex %f ConcurrentHashMap %f | %f%% (%lu)", threadCount, lockedTime, concurrentTime,
+					   lockedTime / concurrentTime * 100.0, sum.load());
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -0,0 +1,189 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/Coroutine.h>
+#include <AnKi/Util/System.h>
+
+using namespace anki;
+
+namespace {
+
+CoroutineTask<U32> addOne(U32 x)
+{
+	co_return x + 1;
+}
+
+CoroutineTask<U32> addTwo(U32 x)
+{
+	const U32 y = co_await addOne(x);
+	co_return co_await addOne(y);
+}
+
+CoroutineTask<void> increment(Atomic<U32>& counter)
+{
+	counter.fetchAdd(1);
+	co_return;
+}
+
+/// A fake GPU fence.
+class TestFence
+{
+public:
+	Futex m_signaled;
+
+	Bool clientWait(Second seconds)
+	{
+		while(seconds > 0.0 && m_signaled.getValue().load() == 0)
+		{
+			m_signaled.wait(0);
+		}
+
+		return m_signaled.getValue().load() != 0;
+	}
+
+	void signal()
+	{
+		m_signaled.getValue().store(1);
+		m_signaled.wakeAll();
+	}
+};
+
+/// load -> decode -> upload written linearly.
+CoroutineTask<Error> pipeline(ThreadJobManager& jobs, CoroutineWaitThread& waitThread, File& file, U32& result)
+{
+	co_await resumeOn(jobs);
+
+	Array<U32, 4> data;
+	ANKI_CO_CHECK(co_await readFile(waitThread, file, &data[0], sizeof(data)));
+
+	U32 decoded = 0;
+	ThreadJobHandle decodeJob = jobs.dispatchTask([&data, &decoded]([[maybe_unused]] U32 threadId) {
+		for(U32 x : data)
+		{
+			decoded += x;
+		}
+	});
+	co_await awaitJob(jobs, decodeJob);
+
+	TestFence fence;
+	ThreadJobHandle signalJob = jobs.dispatchTask([&fence]([[maybe_unused]] U32 threadId) {
+		fence.signal();
+	});
+	const Bool signaled = co_await awaitFence(waitThread, &fence);
+	ANKI_TEST_EXPECT_EQ(signaled, true);
+	co_await awaitJob(jobs, signalJob); // The fence lives in the coroutine frame, don't destroy it while signal() is still running
+
+	result = decoded;
+	co_return Error::kNone;
+}
+
+} // namespace
+
+ANKI_TEST(Util, Coroutine)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Without threads
+	{
+		ANKI_TEST_EXPECT_EQ(syncWait(addTwo(10)), 12);
+
+		Atomic<U32> counter = {0};
+		CoroutineTask<void> task = increment(counter);
+		ANKI_TEST_EXPECT_EQ(counter.load(), 0); // Tasks are lazy
+		syncWait(task);
+		ANKI_TEST_EXPECT_EQ(counter.load(), 1);
+		ANKI_TEST_EXPECT_EQ(task.isDone(), true);
+	}
+
+	// Pipeline
+	{
+		ThreadJobManager jobs(max(2u, getCpuCoresCount()));
+		CoroutineWaitThread waitThread(jobs);
+
+		{
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open("coroutine_test.bin", FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+			const Array<U32, 4> data = {1, 2, 3, 4};
+			ANKI_TEST_EXPECT_NO_ERR(file.write(&data[0], sizeof(data)));
+		}
+
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open("coroutine_test.bin", FileOpenFlag::kRead | FileOpenFlag::kBinary));
+
+		U32 result = 0;
+		ANKI_TEST_EXPECT_NO_ERR(syncWait(pipeline(jobs, waitThread, file, result)));
+		ANKI_TEST_EXPECT_EQ(result, 10);
+
+		// Reading past the end fails
+		ANKI_TEST_EXPECT_ANY_ERR(syncWait(pipeline(jobs, waitThread, file, result)));
+	}
+
+	// Many coroutines that hop between workers
+	{
+		constexpr U32 kTaskCount = 256;
+
+		ThreadJobManager jobs(max(2u, getCpuCoresCount()));
+		Atomic<U32> counter = {0};
+
+		auto hop = [](ThreadJobManager& jobs, Atomic<U32>& counter) -> CoroutineTask<void> {
+			for(U32 i = 0; i < 4; ++i)
+			{
+				co_await resumeOn(jobs);
+				counter.fetchAdd(1);
+			}
+		};
+
+		auto root = [&]() -> CoroutineTask<void> {
+			for(U32 i = 0; i < kTaskCount; ++i)
+			{
+				co_await hop(jobs, counter);
+			}
+		};
+
+		syncWait(root());
+		ANKI_TEST_EXPECT_EQ(counter.load(), kTaskCount * 4);
+
+		jobs.waitForAllTasksToFinish();
+	}
+
+	// Many coroutines that wait for an event
+	{
+		constexpr U32 kTaskCount = 64;
+
+		ThreadJobManager jobs(max(2u, getCpuCoresCount()));
+		CoroutineEvent event;
+		Atomic<U32> counter = {0};
+
+		auto waiter = [](ThreadJobManager& jobs, CoroutineEvent& event, Atomic<U32>& counter) -> CoroutineTask<void> {
+			co_await resumeOn(jobs);
+			co_await awaitEvent(jobs, event);
+			counter.fetchAdd(1);
+		};
+
+		auto root = [&]() -> CoroutineTask<void> {
+			// Signal from a worker while some of the coroutines are still starting
+			jobs.dispatchTask([&event]([[maybe_unused]] U32 threadId) {
+				event.signal();
+			});
+
+			for(U32 i = 0; i < kTaskCount; ++i)
+			{
+				co_await waiter(jobs, event, counter);
+			}
+
+			// Already signaled, doesn't suspend
+			co_await awaitEvent(jobs, event);
+		};
+
+		syncWait(root());
+		ANKI_TEST_EXPECT_EQ(counter.load(), kTaskCount);
+		ANKI_TEST_EXPECT_EQ(event.isSignaled(), true);
+
+		jobs.waitForAllTasksToFinish();
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -5,6 +5,8 @@
 
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Util/DynamicArray.h>
+#include <AnKi/Util/SmallDynamicArray.h>
+#include <AnKi/Util/HighRezTimer.h>
 #include <vector>
 #include <ctime>
 
@@ -315,3 +317,197 @@ ANKI_TEST(Util, DynamicArrayErase)
 		ANKI_TEST_EXPECT_EQ(g_constructor0Count + g_constructor1Count + g_constructor2Count + g_constructor3Count, g_destructorCount);
 	}
 }
+
+ANKI_TEST(Util, SmallDynamicArray)
+{
+	HeapMemoryPool pool(allocAligned, nullptr);
+	using Arr = SmallDynamicArray<DynamicArrayFoo, 4, MemoryPoolPtrWrapper<HeapMemoryPool>>;
+
+	// Inline until it spills
+	{
+		Arr arr(&pool);
+		ANKI_TEST_EXPECT_EQ(arr.isInline(), true);
+		ANKI_TEST_EXPECT_EQ(arr.getCapacity(), 4);
+
+		for(I32 i = 0; i < 4; ++i)
+		{
+			arr.emplaceBack(i);
+		}
+		ANKI_TEST_EXPECT_EQ(arr.isInline(), true);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+
+		arr.emplaceBack(4);
+		ANKI_TEST_EXPECT_EQ(arr.isInline(), false);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 1);
+		for(I32 i = 0; i < 5; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(arr[i].m_x, i);
+		}
+
+		// Back to inline
+		arr.popBack();
+		ANKI_TEST_EXPECT_EQ(arr.isInline(), true);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+		for(I32 i = 0; i < 4; ++i)
+		{
+			ANKI_TEST_EXPECT_EQ(arr[i].m_x, i);
+		}
+		arr.validate();
+	}
+
+	// Move and copy in both states
+	{
+		Arr a(&pool);
+		a.emplaceBack(10);
+		a.emplaceBack(20);
+
+		Arr b(std::move(a));
+		ANKI_TEST_EXPECT_EQ(a.getSize(), 0);
+		ANKI_TEST_EXPECT_EQ(b.getSize(), 2);
+		ANKI_TEST_EXPECT_EQ(b.isInline(), true);
+		ANKI_TEST_EXPECT_EQ(b[1].m_x, 20);
+
+		Arr c(&pool);
+		c.resize(10, 7);
+		const DynamicArrayFoo* heapData = c.getBegin();
+		b = std::move(c);
+		ANKI_TEST_EXPECT_EQ(b.getBegin(), heapData); // Stolen, not moved one by one
+		ANKI_TEST_EXPECT_EQ(b.getSize(), 10);
+		ANKI_TEST_EXPECT_EQ(c.isInline(), true);
+		ANKI_TEST_EXPECT_EQ(c.getSize(), 0);
+
+		const Arr d = b;
+		ANKI_TEST_EXPECT_EQ(d.isInline(), false);
+		ANKI_TEST_EXPECT_EQ(d.getSize(), 10);
+		ANKI_TEST_EXPECT_EQ(d[9].m_x, 7);
+
+		b.resize(3);
+		const Arr e = b;
+		ANKI_TEST_EXPECT_EQ(e.isInline(), true);
+		ANKI_TEST_EXPECT_EQ(e.getSize(), 3);
+		ANKI_TEST_EXPECT_EQ(e[2].m_x, 7);
+
+		c.emplaceAt(c.getEnd(), 1);
+		c.emplaceAt(c.getBegin(), 0);
+		ANKI_TEST_EXPECT_EQ(c[0].m_x, 0);
+		ANKI_TEST_EXPECT_EQ(c[1].m_x, 1);
+	}
+
+	ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+
+	// Fuzzy against std::vector
+	{
+		srand(U32(time(nullptr)));
+
+		Arr arr(&pool);
+		std::vector<DynamicArrayFoo> vec;
+
+		for(U32 i = 0; i < 100000; ++i)
+		{
+			const U32 op = getRandom() % 4;
+			if(op == 0)
+			{
+				const I32 r = rand();
+				arr.emplaceBack(r);
+				vec.push_back(r);
+			}
+			else if(op == 1)
+			{
+				const U32 where = U32(getRandom() % (arr.getSize() + 1));
+				const I32 r = rand();
+				arr.emplaceAt(arr.getBegin() + where, r);
+				vec.insert(vec.begin() + where, r);
+			}
+			else if(op == 2 && arr.getSize() > 0)
+			{
+				PtrSize eraseFrom = getRandom() % arr.getSize();
+				PtrSize eraseTo = getRandom() % (arr.getSize() + 1);
+				if(eraseTo < eraseFrom)
+				{
+					swapValues(eraseTo, eraseFrom);
+				}
+
+				if(eraseTo != eraseFrom)
+				{
+					vec.erase(vec.begin() + eraseFrom, vec.begin() + eraseTo);
+					arr.erase(arr.getBegin() + eraseFrom, arr.getBegin() + eraseTo);
+				}
+			}
+			else if(op == 3)
+			{
+				// Keep the sizes around the inline capacity
+				const U32 newSize = U32(getRandom() % 12);
+				const I32 r = rand();
+				vec.resize(newSize, r);
+				arr.resize(newSize, r);
+			}
+
+			arr.validate();
+			ANKI_TEST_EXPECT_EQ(arr.getSize(), vec.size());
+			for(U32 j = 0; j < arr.getSize(); ++j)
+			{
+				ANKI_TEST_EXPECT_EQ(arr[j].m_x, vec[j].m_x);
+			}
+		}
+
+		arr.destroy();
+		vec.resize(0);
+	}
+
+	ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+	ANKI_TEST_EXPECT_EQ(g_constructor0Count + g_constructor1Count + g_constructor2Count + g_constructor3Count, g_destructorCount);
+}
+
+ANKI_TEST(Util, SmallDynamicArrayBench)
+{
+	// Build many short lists like the RenderGraph does every frame and count the allocations
+	class CountingPool
+	{
+	public:
+		HeapMemoryPool* m_pool = nullptr;
+		U32* m_allocationCount = nullptr;
+
+		void* allocate(PtrSize size, PtrSize alignment)
+		{
+			++(*m_allocationCount);
+			return m_pool->allocate(size, alignment);
+		}
+
+		void free(void* ptr)
+		{
+			m_pool->free(ptr);
+		}
+	};
+
+	HeapMemoryPool heapPool(allocAligned, nullptr);
+	constexpr U32 kListCount = 4 * 1024 * 1024;
+
+	auto run = [&](auto& arr) -> Second {
+		HighRezTimer timer;
+		timer.start();
+		for(U32 i = 0; i < kListCount; ++i)
+		{
+			const U32 size = i % 8 + 1;
+			for(U32 j = 0; j < size; ++j)
+			{
+				arr.emplaceBack(i + j);
+			}
+			arr.destroy();
+		}
+		timer.stop();
+		return timer.getElapsedTime();
+	};
+
+	U32 dynArrAllocationCount = 0;
+	DynamicArray<U32, CountingPool> dynArr(CountingPool{&heapPool, &dynArrAllocationCount});
+	const Second dynArrTime = run(dynArr);
+
+	U32 smallArrAllocationCount = 0;
+	SmallDynamicArray<U32, 8, CountingPool> smallArr(CountingPool{&heapPool, &smallArrAllocationCount});
+	const Second smallArrTime = run(smallArr);
+
+	ANKI_TEST_EXPECT_EQ(smallArrAllocationCount, 0);
+	ANKI_TEST_EXPECT_EQ(heapPool.getAllocationCount(), 0);
+	ANKI_TEST_LOGI("Short lists bench: DynamicArray %f (%u allocations) SmallDynamicArray %f (%u allocations)", dynArrTime, dynArrAllocationCount,
+				   smallArrTime, smallArrAllocationCount);
+}
@@ -6,6 +6,7 @@
 #include <Tests/Framework/Framework.h>
 #include <AnKi/Util/Filesystem.h>
 #include <AnKi/Util/File.h>
+#include <AnKi/Util/MemoryMappedFile.h>
 
 ANKI_TEST(Util, FileExists)
 {
@@ -120,3 +121,50 @@ ANKI_TEST(Util, WalkDir)
 
 	ANKI_TEST_EXPECT_EQ(count, 1);
 }
+
+#if ANKI_POSIX
+ANKI_TEST(Util, MemoryMappedFile)
+{
+	// Create a file
+	Array<U32, 10000> data;
+	for(U32 i = 0; i < data.getSize(); ++i)
+	{
+		data[i] = i * 3;
+	}
+
+	File file;
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./mapped_tmp", FileOpenFlag::kWrite | FileOpenFlag::kBinary));
+	ANKI_TEST_EXPECT_NO_ERR(file.write(&data[0], sizeof(data)));
+	file.close();
+
+	// Map it
+	{
+		MemoryMappedFile mfile;
+		ANKI_TEST_EXPECT_NO_ERR(mfile.open("./mapped_tmp"));
+		ANKI_TEST_EXPECT_EQ(mfile.isOpen(), true);
+		ANKI_TEST_EXPECT_EQ(mfile.getSize(), sizeof(data));
+		ANKI_TEST_EXPECT_EQ(memcmp(mfile.getData(), &data[0], sizeof(data)), 0);
+
+		// Hints on unaligned ranges
+		mfile.adviseAccess(123, 4567, FileAccessHint::kSequential);
+		mfile.adviseAccess(0, mfile.getSize(), FileAccessHint::kWillNeed);
+		mfile.adviseAccess(mfile.getSize() - 1, 1, FileAccessHint::kNormal);
+
+		mfile.close();
+		ANKI_TEST_EXPECT_EQ(mfile.isOpen(), false);
+	}
+
+	// Empty file
+	ANKI_TEST_EXPECT_NO_ERR(file.open("./mapped_tmp", FileOpenFlag::kWrite));
+	file.close();
+
+	{
+		MemoryMappedFile mfile;
+		ANKI_TEST_EXPECT_NO_ERR(mfile.open("./mapped_tmp"));
+		ANKI_TEST_EXPECT_EQ(mfile.getSize(), 0);
+		ANKI_TEST_EXPECT_EQ(mfile.getData(), nullptr);
+	}
+
+	ANKI_TEST_EXPECT_NO_ERR(removeFile("./mapped_tmp"));
+}
+#endif
@@ -0,0 +1,211 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/Hash.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/DynamicArray.h>
+#include <unordered_set>
+
+using namespace anki;
+
+/// The MurmurHash2 that computeHash used to be. Used for comparison. It's not inlined, like computeHash.
+ANKI_DONT_INLINE static U64 murmurHash2(const void* buffer, PtrSize bufferSize, U64 seed)
+{
+	constexpr U64 kHashM = 0xc6a4a7935bd1e995;
+	constexpr U64 kHashR = 47;
+
+	U64 h = seed ^ (bufferSize * kHashM);
+	const U8* data = static_cast<const U8*>(buffer);
+	const U8* const end = data + (bufferSize / sizeof(U64)) * sizeof(U64);
+
+	while(data != end)
+	{
+		U64 k;
+		memcpy(&k, data, sizeof(k));
+		data += sizeof(k);
+
+		k *= kHashM;
+		k ^= k >> kHashR;
+		k *= kHashM;
+
+		h ^= k;
+		h *= kHashM;
+	}
+
+	const PtrSize tailSize = bufferSize & (sizeof(U64) - 1);
+	if(tailSize)
+	{
+		for(PtrSize i = tailSize; i > 0; --i)
+		{
+			h ^= U64(data[i - 1]) << ((i - 1) * 8);
+		}
+		h *= kHashM;
+	}
+
+	h ^= h >> kHashR;
+	h *= kHashM;
+	h ^= h >> kHashR;
+	return h;
+}
+
+ANKI_TEST(Util, Hash)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		DynamicArray<U8> data;
+		data.resize(4096);
+		for(U8& x : data)
+		{
+			x = U8(rand());
+		}
+
+		// Streaming gives the same hash as hashing everything at once no matter how the input is split
+		for(U32 size : {0u, 1u, 3u, 4u, 8u, 15u, 16u, 17u, 33u, 63u, 64u, 65u, 127u, 128u, 1000u, 1024u, 1025u, 4096u})
+		{
+			const U64 hash = computeHash(&data[0], size, 0xBEEF);
+
+			for(U32 chunkSize : {1u, 3u, 7u, 16u, 63u, 64u, 100u})
+			{
+				StreamingHasher hasher(0xBEEF);
+				for(U32 offset = 0; offset < size; offset += chunkSize)
+				{
+					hasher.append(&data[offset], min(chunkSize, size - offset));
+				}
+
+				ANKI_TEST_EXPECT_EQ(hasher.getHash(), hash);
+			}
+		}
+
+		// Every input byte matters and so does the seed
+		for(U32 size : {1u, 5u, 16u, 40u, 64u, 200u, 2048u})
+		{
+			const U64 hash = computeHash(&data[0], size);
+			ANKI_TEST_EXPECT_NEQ(computeHash(&data[0], size, 321), hash);
+
+			for(U32 i = 0; i < size; ++i)
+			{
+				data[i] ^= 1;
+				ANKI_TEST_EXPECT_NEQ(computeHash(&data[0], size), hash);
+				data[i] ^= 1;
+			}
+		}
+
+		// Zeros of different sizes
+		DynamicArray<U8> zeros;
+		zeros.resize(300, U8(0));
+		std::unordered_set<U64> zeroHashes;
+		for(U32 size = 0; size < zeros.getSize(); ++size)
+		{
+			zeroHashes.insert(computeHash(&zeros[0], size));
+		}
+		ANKI_TEST_EXPECT_EQ(zeroHashes.size(), zeros.getSize());
+	}
+
+	// No collisions in a few million small keys
+	{
+		std::unordered_set<U64> hashes;
+		constexpr U32 kCount = 4 * 1024 * 1024;
+		hashes.reserve(kCount);
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			hashes.insert(computeObjectHash(i));
+		}
+		ANKI_TEST_EXPECT_EQ(hashes.size(), kCount);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, HashBench)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr PtrSize kMaxSize = 1024 * 1024;
+		constexpr PtrSize kBytesPerSize = 256 * 1024 * 1024;
+
+		DynamicArray<U8> data;
+		data.resize(kMaxSize);
+		for(U8& x : data)
+		{
+			x = U8(rand());
+		}
+
+		U64 sum = 0; // To avoid compiler opts
+		for(PtrSize size_ = 8; size_ <= kMaxSize; size_ *= 4)
+		{
+			// Don't let the compiler specialize for the size since computeHash lives in another translation unit
+			const volatile PtrSize size = size_;
+			const PtrSize iterations = kBytesPerSize / size;
+			HighRezTimer timer;
+
+			timer.start();
+			for(PtrSize i = 0; i < iterations; ++i)
+			{
+				sum += computeHash(&data[(i * 8) & (kMaxSize - 1) & ~(size - 1)], size, i);
+			}
+			timer.stop();
+			const Second time = timer.getElapsedTime();
+
+			timer.start();
+			for(PtrSize i = 0; i < iterations; ++i)
+			{
+				sum += murmurHash2(&data[(i * 8) & (kMaxSize - 1) & ~(size - 1)], size, i);
+			}
+			timer.stop();
+			const Second murmurTime = timer.getElapsedTime();
+
+			const F64 gb = F64(kBytesPerSize) / (1024.0 * 1024.0 * 1024.0);
+			ANKI_TEST_LOGI("Hash bench %7lu bytes: computeHash %6.2f GB/s MurmurHash2 %6.2f GB/s", size_, gb / time, gb / murmurTime);
+		}
+
+		// Hashing a struct field by field
+		class Fields
+		{
+		public:
+			U32 m_a;
+			U16 m_b;
+			U8 m_c;
+			U64 m_d;
+			F32 m_e;
+		};
+		const Fields fields = {1, 2, 3, 4, 5.0f};
+		constexpr U32 kIterations = 4 * 1024 * 1024;
+		HighRezTimer timer;
+
+		timer.start();
+		for(U32 i = 0; i < kIterations; ++i)
+		{
+			U64 h = appendObjectHash(fields.m_a, i);
+			h = appendObjectHash(fields.m_b, h);
+			h = appendObjectHash(fields.m_c, h);
+			h = appendObjectHash(fields.m_d, h);
+			h = appendObjectHash(fields.m_e, h);
+			sum += h;
+		}
+		timer.stop();
+		const Second appendTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < kIterations; ++i)
+		{
+			StreamingHasher hasher(i);
+			hasher.appendObject(fields.m_a);
+			hasher.appendObject(fields.m_b);
+			hasher.appendObject(fields.m_c);
+			hasher.appendObject(fields.m_d);
+			hasher.appendObject(fields.m_e);
+			sum += hasher.getHash();
+		}
+		timer.stop();
+		const Second streamingTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Field hash bench: appendObjectHash %f StreamingHasher %f (%lu)", appendTime, streamingTime, sum);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -6,6 +6,7 @@
 #include <Tests/Framework/Framework.h>
 #include <Tests/Util/Foo.h>
 #include <AnKi/Util/HashMap.h>
+#include <AnKi/Util/SwissHashMap.h>
 #include <AnKi/Util/DynamicArray.h>
 #include <AnKi/Util/HighRezTimer.h>
 #include <unordered_map>
@@ -274,3 +275,182 @@ ANKI_TEST(Util, HashMap)
 		akMap.destroy();
 	}
 }
+
+ANKI_TEST(Util, SwissHashMap)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Fuzzy test against the STL. Keys collide in the home slot a lot to stress the probing and the backward shift deletion
+	{
+		SwissHashMap<int, int, Hasher> map;
+		std::unordered_map<int, int> stdMap;
+
+		for(U32 i = 0; i < 200000; ++i)
+		{
+			const int key = (rand() % 4096) << (rand() % 2 ? 0 : 12);
+			const U32 op = rand() % 3;
+
+			if(op < 2)
+			{
+				map.emplace(key, int(i));
+				stdMap[key] = int(i);
+			}
+			else
+			{
+				auto it = map.find(key);
+				auto stdIt = stdMap.find(key);
+				ANKI_TEST_EXPECT_EQ(it == map.getEnd(), stdIt == stdMap.end());
+				if(stdIt != stdMap.end())
+				{
+					ANKI_TEST_EXPECT_EQ(*it, stdIt->second);
+					map.erase(it);
+					stdMap.erase(stdIt);
+				}
+			}
+
+			ANKI_TEST_EXPECT_EQ(map.getSize(), stdMap.size());
+		}
+
+		U32 count = 0;
+		for(auto it = map.getBegin(); it != map.getEnd(); ++it)
+		{
+			ANKI_TEST_EXPECT_EQ(stdMap[int(it.getKey())], *it);
+			++count;
+		}
+		ANKI_TEST_EXPECT_EQ(count, stdMap.size());
+
+		for(auto& it : stdMap)
+		{
+			auto it2 = map.find(it.first);
+			ANKI_TEST_EXPECT_NEQ(it2, map.getEnd());
+			ANKI_TEST_EXPECT_EQ(*it2, it.second);
+		}
+
+		// Copy and move
+		SwissHashMap<int, int, Hasher> copy = map;
+		ANKI_TEST_EXPECT_EQ(copy.getSize(), map.getSize());
+		SwissHashMap<int, int, Hasher> moved = std::move(copy);
+		ANKI_TEST_EXPECT_EQ(moved.getSize(), map.getSize());
+		ANKI_TEST_EXPECT_EQ(copy.isEmpty(), true);
+		for(auto& it : stdMap)
+		{
+			ANKI_TEST_EXPECT_EQ(*moved.find(it.first), it.second);
+		}
+	}
+
+	// Non-trivial values and heterogeneous lookup
+	{
+		SwissHashMap<String, String, StringHasher> map;
+		for(U32 i = 0; i < 100; ++i)
+		{
+			String key;
+			key.sprintf("key%u", i);
+			String val;
+			val.sprintf("val%u", i);
+			map.emplace(key, std::move(val));
+		}
+
+		ANKI_TEST_EXPECT_EQ(*map.find(CString("key42")), "val42");
+		ANKI_TEST_EXPECT_EQ(map.find(CString("nope")), map.getEnd());
+
+		map.erase(map.find(CString("key42")));
+		ANKI_TEST_EXPECT_EQ(map.find(String("key42")), map.getEnd());
+		ANKI_TEST_EXPECT_EQ(map.getSize(), 99);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, SwissHashMapBench)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kCount = 1024 * 1024 * 2;
+
+		DynamicArray<int> vals;
+		vals.resize(kCount);
+		std::unordered_map<int, int> tmpMap;
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			int v;
+			do
+			{
+				v = rand();
+			} while(tmpMap.find(v) != tmpMap.end());
+			tmpMap[v] = 1;
+
+			vals[i] = v;
+		}
+
+		HashMap<int, int> map;
+		SwissHashMap<int, int> swissMap;
+		HighRezTimer timer;
+
+		// Insertion
+		timer.start();
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			map.emplace(vals[i], vals[i]);
+		}
+		timer.stop();
+		const Second time = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			swissMap.emplace(vals[i], vals[i]);
+		}
+		timer.stop();
+		const Second swissTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Inserting bench: HashMap %f SwissHashMap %f | %f%%", time, swissTime, time / swissTime * 100.0);
+
+		// Search hits and misses
+		I64 count = 0; // To avoid compiler opts
+		randomShuffle(vals.begin(), vals.end());
+
+		timer.start();
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			count += *map.find(vals[i]);
+			count += map.find(vals[i] + 1) != map.getEnd();
+		}
+		timer.stop();
+		const Second findTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			count += *swissMap.find(vals[i]);
+			count += swissMap.find(vals[i] + 1) != swissMap.getEnd();
+		}
+		timer.stop();
+		const Second swissFindTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Find bench: HashMap %f SwissHashMap %f | %f%% (%ld)", findTime, swissFindTime, findTime / swissFindTime * 100.0, count);
+
+		// Delete in random order
+		randomShuffle(vals.begin(), vals.end());
+
+		timer.start();
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			map.erase(map.find(vals[i]));
+		}
+		timer.stop();
+		const Second eraseTime = timer.getElapsedTime();
+
+		timer.start();
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			swissMap.erase(swissMap.find(vals[i]));
+		}
+		timer.stop();
+		const Second swissEraseTime = timer.getElapsedTime();
+
+		ANKI_TEST_LOGI("Deleting bench: HashMap %f SwissHashMap %f | %f%%", eraseTime, swissEraseTime, eraseTime / swissEraseTime * 100.0);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
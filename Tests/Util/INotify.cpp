@@ -9,7 +9,7 @@
 
 ANKI_TEST(Util, INotify)
 {
-	HeapMemoryPool pool(allocAligned, nullptr);
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
 
 	// Monitor a dir
 	{
@@ -35,4 +35,60 @@ ANKI_TEST(Util, INotify)
 
 		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir));
 	}
+
+	// Monitor a dir and its subdirectories
+	{
+		CString dir = "in_test_dir_recursive";
+
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory(dir));
+		ANKI_TEST_EXPECT_NO_ERR(createDirectory(String().sprintf("%s/sub", dir.cstr())));
+
+		{
+			INotify in;
+			ANKI_TEST_EXPECT_NO_ERR(in.init(dir, true));
+
+			Bool modified;
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(modified));
+			ANKI_TEST_EXPECT_EQ(modified, false);
+
+			// A file in an existing subdirectory
+			File file;
+			ANKI_TEST_EXPECT_NO_ERR(file.open(String().sprintf("%s/sub/file.txt", dir.cstr()).toCString(), FileOpenFlag::kWrite));
+			file.close();
+
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(modified));
+			ANKI_TEST_EXPECT_EQ(modified, true);
+
+			// A file in a subdirectory that was created after init()
+			ANKI_TEST_EXPECT_NO_ERR(createDirectory(String().sprintf("%s/sub/new", dir.cstr())));
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(modified));
+			ANKI_TEST_EXPECT_EQ(modified, true);
+
+			ANKI_TEST_EXPECT_NO_ERR(file.open(String().sprintf("%s/sub/new/file.txt", dir.cstr()).toCString(), FileOpenFlag::kWrite));
+			file.close();
+
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(modified));
+			ANKI_TEST_EXPECT_EQ(modified, true);
+
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(modified));
+			ANKI_TEST_EXPECT_EQ(modified, false);
+
+			// What changed
+			DynamicArray<INotifyEvent> events;
+			ANKI_TEST_EXPECT_NO_ERR(createDirectory(String().sprintf("%s/sub/new/dir", dir.cstr())));
+			ANKI_TEST_EXPECT_NO_ERR(removeFile(String().sprintf("%s/sub/new/file.txt", dir.cstr())));
+			ANKI_TEST_EXPECT_NO_ERR(in.pollEvents(events));
+			ANKI_TEST_EXPECT_EQ(events.getSize(), 2);
+			ANKI_TEST_EXPECT_EQ(events[0].m_type, INotifyEventType::kCreated);
+			ANKI_TEST_EXPECT_EQ(events[0].m_path, "sub/new/dir");
+			ANKI_TEST_EXPECT_EQ(events[0].m_isDirectory, true);
+			ANKI_TEST_EXPECT_EQ(events[1].m_type, INotifyEventType::kDeleted);
+			ANKI_TEST_EXPECT_EQ(events[1].m_path, "sub/new/file.txt");
+			ANKI_TEST_EXPECT_EQ(events[1].m_isDirectory, false);
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(removeDirectory(dir));
+	}
+
+	DefaultMemoryPool::freeSingleton();
 }
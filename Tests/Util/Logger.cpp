@@ -0,0 +1,190 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/Logger.h>
+#include <AnKi/Util/Thread.h>
+#include <AnKi/Util/File.h>
+#include <AnKi/Util/Filesystem.h>
+#include <cstdio>
+
+using namespace anki;
+
+namespace {
+
+constexpr U32 kThreadCount = 4;
+constexpr U32 kMessagesPerThread = 500;
+
+class LoggerTestContext
+{
+public:
+	Array<I32, kThreadCount> m_lastMessage;
+	U32 m_messageCount = 0;
+	Bool m_outOfOrder = false;
+	Atomic<U32> m_threadIdx = {0};
+};
+
+} // namespace
+
+ANKI_TEST(Util, LoggerAsync)
+{
+	LoggerTestContext ctx;
+	ctx.m_lastMessage.fill(-1);
+
+	auto handler = [](void* ud, const LoggerMessageInfo& info) {
+		LoggerTestContext& ctx = *static_cast<LoggerTestContext*>(ud);
+
+		U32 threadIdx, messageIdx;
+		if(sscanf(info.m_msg, "Async test %u %u", &threadIdx, &messageIdx) == 2)
+		{
+			// Messages of the same thread should arrive in order
+			if(I32(messageIdx) <= ctx.m_lastMessage[threadIdx])
+			{
+				ctx.m_outOfOrder = true;
+			}
+
+			ctx.m_lastMessage[threadIdx] = I32(messageIdx);
+			++ctx.m_messageCount;
+		}
+	};
+
+	Logger& logger = Logger::getSingleton();
+	logger.addMessageHandler(&ctx, handler);
+	logger.enableAsync(true);
+	ANKI_TEST_EXPECT_EQ(logger.isAsyncEnabled(), true);
+
+	const U64 droppedBefore = logger.getDroppedMessageCount();
+
+	Array<Thread, kThreadCount> threads = {Thread(nullptr), Thread(nullptr), Thread(nullptr), Thread(nullptr)};
+	for(Thread& thread : threads)
+	{
+		thread.start(&ctx, [](ThreadCallbackInfo& info) -> Error {
+			LoggerTestContext& ctx = *static_cast<LoggerTestContext*>(info.m_userData);
+			const U32 threadIdx = ctx.m_threadIdx.fetchAdd(1);
+			for(U32 i = 0; i < kMessagesPerThread; ++i)
+			{
+				ANKI_LOGI("Async test %u %u", threadIdx, i);
+			}
+
+			return Error::kNone;
+		});
+	}
+
+	for(Thread& thread : threads)
+	{
+		ANKI_TEST_EXPECT_NO_ERR(thread.join());
+	}
+
+	logger.flushAsync();
+
+	// Every message either reached the handler or was counted as dropped
+	const U64 dropped = logger.getDroppedMessageCount() - droppedBefore;
+	ANKI_TEST_EXPECT_EQ(ctx.m_messageCount + dropped, kThreadCount * kMessagesPerThread);
+	ANKI_TEST_EXPECT_EQ(ctx.m_outOfOrder, false);
+
+	logger.enableAsync(false);
+	ANKI_TEST_EXPECT_EQ(logger.isAsyncEnabled(), false);
+
+	// Synchronous again
+	const U32 countBefore = ctx.m_messageCount;
+	ANKI_LOGI("Async test 0 %u", kMessagesPerThread);
+	ANKI_TEST_EXPECT_EQ(ctx.m_messageCount, countBefore + 1);
+
+	logger.removeMessageHandler(&ctx, handler);
+}
+
+ANKI_TEST(Util, LoggerAsyncRingReuse)
+{
+	// More threads than rings. The rings of the threads that exited get reused so all the messages still go through the drain thread
+	constexpr U32 kSequentialThreadCount = 100;
+
+	class Context
+	{
+	public:
+		U32 m_messageCount = 0;
+		U32 m_syncMessageCount = 0;
+	} ctx;
+
+	auto handler = [](void* ud, const LoggerMessageInfo& info) {
+		Context& ctx = *static_cast<Context*>(ud);
+		if(CString(info.m_msg) == "Ring reuse test")
+		{
+			++ctx.m_messageCount;
+			if(CString(Thread::getCurrentThreadName()) != "AnKiLogger")
+			{
+				++ctx.m_syncMessageCount;
+			}
+		}
+	};
+
+	Logger& logger = Logger::getSingleton();
+	logger.addMessageHandler(&ctx, handler);
+	logger.enableAsync(true);
+
+	for(U32 i = 0; i < kSequentialThreadCount; ++i)
+	{
+		Thread thread("RingReuse");
+		thread.start(nullptr, [](ThreadCallbackInfo&) -> Error {
+			ANKI_LOGI("Ring reuse test");
+			return Error::kNone;
+		});
+		ANKI_TEST_EXPECT_NO_ERR(thread.join());
+	}
+
+	logger.flushAsync();
+	logger.enableAsync(false);
+
+	ANKI_TEST_EXPECT_EQ(ctx.m_messageCount, kSequentialThreadCount);
+	ANKI_TEST_EXPECT_EQ(ctx.m_syncMessageCount, 0);
+
+	logger.removeMessageHandler(&ctx, handler);
+}
+
+ANKI_TEST(Util, LoggerAsyncFile)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kMessageCount = 2000;
+
+		String filename;
+		ANKI_TEST_EXPECT_NO_ERR(getTempDirectory(filename));
+		filename += "/LoggerTest.txt";
+
+		File file;
+		ANKI_TEST_EXPECT_NO_ERR(file.open(filename, FileOpenFlag::kWrite));
+
+		Logger& logger = Logger::getSingleton();
+		logger.addFileMessageHandler(&file);
+		logger.enableAsync(true);
+
+		const U64 droppedBefore = logger.getDroppedMessageCount();
+		for(U32 i = 0; i < kMessageCount; ++i)
+		{
+			ANKI_LOGI("File test %u", i);
+		}
+
+		logger.flushAsync();
+		logger.enableAsync(false);
+		logger.removeFileMessageHandler(&file);
+		const U64 dropped = logger.getDroppedMessageCount() - droppedBefore;
+
+		// Everything that went through the buffer of the file should be there after the close
+		file.close();
+		ANKI_TEST_EXPECT_NO_ERR(file.open(filename, FileOpenFlag::kRead));
+		String txt;
+		ANKI_TEST_EXPECT_NO_ERR(file.readAllText(txt));
+
+		U32 count = 0;
+		for(const Char* it = txt.cstr(); (it = strstr(it, "File test ")) != nullptr; ++it)
+		{
+			++count;
+		}
+
+		ANKI_TEST_EXPECT_EQ(count + dropped, kMessageCount);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -6,9 +6,15 @@
 #include <Tests/Framework/Framework.h>
 #include <Tests/Util/Foo.h>
 #include <AnKi/Util/MemoryPool.h>
+#include <AnKi/Util/FrameArenas.h>
+#include <AnKi/Util/MemoryPoolTelemetry.h>
 #include <AnKi/Util/ThreadPool.h>
+#include <AnKi/Util/ThreadJobManager.h>
+#include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
 #include <type_traits>
 #include <cstring>
+#include <vector>
 
 ANKI_TEST(Util, HeapMemoryPool)
 {
@@ -33,6 +39,364 @@ ANKI_TEST(Util, HeapMemoryPool)
 	}
 }
 
+ANKI_TEST(Util, HeapMemoryPoolThreadCached)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Sizes and alignments
+	{
+		HeapMemoryPool pool(allocAligned, nullptr, "Test", HeapMemoryPoolMode::kThreadCached);
+		ANKI_TEST_EXPECT_EQ(pool.getMode(), HeapMemoryPoolMode::kThreadCached);
+
+		std::vector<std::pair<U8*, PtrSize>> allocations;
+		for(U32 round = 0; round < 2; ++round)
+		{
+			for(PtrSize size = 1; size <= 2048; size += 7)
+			{
+				for(PtrSize alignment = 1; alignment <= 128; alignment *= 2)
+				{
+					U8* ptr = static_cast<U8*>(pool.allocate(size, alignment));
+					ANKI_TEST_EXPECT_NEQ(ptr, nullptr);
+					ANKI_TEST_EXPECT_EQ(isAligned(alignment, ptr), true);
+					memset(ptr, U8(size), size);
+					allocations.emplace_back(ptr, size);
+				}
+			}
+
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), allocations.size());
+
+			for(auto [ptr, size] : allocations)
+			{
+				for(PtrSize i = 0; i < size; ++i)
+				{
+					ANKI_TEST_EXPECT_EQ(ptr[i], U8(size));
+				}
+				pool.free(ptr);
+			}
+			allocations.clear();
+
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+		}
+
+		// The 2nd round reused the blocks of the 1st
+		HeapMemoryPoolStats stats;
+		pool.getStats(stats);
+		ANKI_TEST_EXPECT_GT(stats.m_cacheHits, 0);
+		ANKI_TEST_EXPECT_EQ(stats.m_usedBytes, 0);
+		ANKI_TEST_EXPECT_EQ(stats.m_largeAllocations, 0);
+		ANKI_TEST_EXPECT_EQ(stats.m_threadCacheCount, 1);
+	}
+
+	// Threads free the allocations of other threads
+	{
+		HeapMemoryPool pool(allocAligned, nullptr, "Test", HeapMemoryPoolMode::kThreadCached);
+
+		constexpr U32 kAllocationsPerThread = 10000;
+		const U32 threadCount = max(4u, getCpuCoresCount());
+		std::vector<U32*> allocations(kAllocationsPerThread * threadCount);
+		ThreadJobManager jobs(threadCount);
+
+		for(U32 round = 0; round < 4; ++round)
+		{
+			for(U32 t = 0; t < threadCount; ++t)
+			{
+				jobs.dispatchTask([&, t]([[maybe_unused]] U32 threadId) {
+					for(U32 i = 0; i < kAllocationsPerThread; ++i)
+					{
+						const U32 idx = t * kAllocationsPerThread + i;
+						const U32 count = idx % 100 + 1;
+						U32* ptr = static_cast<U32*>(pool.allocate(count * sizeof(U32), alignof(U32)));
+						for(U32 j = 0; j < count; ++j)
+						{
+							ptr[j] = idx;
+						}
+						allocations[idx] = ptr;
+					}
+				});
+			}
+			jobs.waitForAllTasksToFinish();
+
+			Atomic<U32> errors = {0};
+			for(U32 t = 0; t < threadCount; ++t)
+			{
+				jobs.dispatchTask([&, t]([[maybe_unused]] U32 threadId) {
+					const U32 other = (t + 1) % threadCount;
+					for(U32 i = 0; i < kAllocationsPerThread; ++i)
+					{
+						const U32 idx = other * kAllocationsPerThread + i;
+						const U32 count = idx % 100 + 1;
+						for(U32 j = 0; j < count; ++j)
+						{
+							if(allocations[idx][j] != idx)
+							{
+								errors.fetchAdd(1);
+							}
+						}
+						pool.free(allocations[idx]);
+					}
+				});
+			}
+			jobs.waitForAllTasksToFinish();
+
+			ANKI_TEST_EXPECT_EQ(errors.load(), 0);
+			ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+		}
+
+		HeapMemoryPoolStats stats;
+		pool.getStats(stats);
+		ANKI_TEST_EXPECT_GT(stats.m_remoteFrees, 0);
+		ANKI_TEST_EXPECT_EQ(stats.m_usedBytes, 0);
+		ANKI_TEST_LOGI("Thread cached pool: hit rate %f%%, reserved %lu KB, %u thread caches", stats.getHitRate() * 100.0, stats.m_reservedBytes / 1024,
+					   stats.m_threadCacheCount);
+	}
+
+	// Threads that exit leave their caches to the next threads
+	{
+		HeapMemoryPool pool(allocAligned, nullptr, "Test", HeapMemoryPoolMode::kThreadCached);
+
+		void* large = pool.allocate(4_KB, 256);
+		ANKI_TEST_EXPECT_EQ(isAligned(256, large), true);
+
+		for(U32 i = 0; i < 8; ++i)
+		{
+			Thread thread("Test");
+			thread.start(&pool, [](ThreadCallbackInfo& info) -> Error {
+				HeapMemoryPool& pool = *static_cast<HeapMemoryPool*>(info.m_userData);
+				void* small = pool.allocate(64, 16);
+				void* large = pool.allocate(4_KB, 16);
+				memset(small, 0xFF, 64);
+				memset(large, 0xFF, 4_KB);
+				pool.free(small);
+				pool.free(large);
+				return Error::kNone;
+			});
+			ANKI_TEST_EXPECT_NO_ERR(thread.join());
+		}
+
+		HeapMemoryPoolStats stats;
+		pool.getStats(stats);
+		ANKI_TEST_EXPECT_EQ(stats.m_threadCacheCount, 1);
+		ANKI_TEST_EXPECT_EQ(stats.m_reservedBytes, 64_KB);
+		ANKI_TEST_EXPECT_EQ(stats.m_largeAllocations, 1);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 1);
+
+		pool.free(large);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+	}
+
+	// Large allocations ask for the alignment they need and not the span alignment
+	{
+		class AllocData
+		{
+		public:
+			PtrSize m_largestSize = 0;
+			PtrSize m_largestSizeAlignment = 0;
+		} allocData;
+
+		HeapMemoryPool pool(
+			[](void* userData, void* ptr, PtrSize size, PtrSize alignment) -> void* {
+				AllocData& data = *static_cast<AllocData*>(userData);
+				if(ptr == nullptr && size > data.m_largestSize)
+				{
+					data.m_largestSize = size;
+					data.m_largestSizeAlignment = alignment;
+				}
+				return allocAligned(nullptr, ptr, size, alignment);
+			},
+			&allocData, "Test", HeapMemoryPoolMode::kThreadCached);
+
+		void* small = pool.allocate(32, 16);
+		void* large = pool.allocate(100_KB, 16);
+		ANKI_TEST_EXPECT_LEQ(allocData.m_largestSize, 100_KB + 64);
+		ANKI_TEST_EXPECT_EQ(allocData.m_largestSizeAlignment, 16);
+		memset(large, 0xFF, 100_KB);
+
+		void* aligned = pool.allocate(2_KB, 256);
+		ANKI_TEST_EXPECT_EQ(isAligned(256, aligned), true);
+
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 3);
+		pool.free(large);
+		pool.free(aligned);
+		pool.free(small);
+		ANKI_TEST_EXPECT_EQ(pool.getAllocationCount(), 0);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, HeapMemoryPoolThreadCachedBench)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kIterations = 4 * 1024 * 1024;
+		constexpr U32 kLiveAllocations = 256;
+		const U32 threadCount = max(4u, getCpuCoresCount());
+		ThreadJobManager jobs(threadCount);
+
+		auto run = [&](HeapMemoryPool& pool) -> Second {
+			HighRezTimer timer;
+			timer.start();
+			for(U32 t = 0; t < threadCount; ++t)
+			{
+				jobs.dispatchTask([&pool](U32 threadId) {
+					Array<void*, kLiveAllocations> live = {};
+					U32 seed = threadId + 1;
+					for(U32 i = 0; i < kIterations; ++i)
+					{
+						// Mostly small sizes like the ones of the containers and the scene objects
+						seed = seed * 1664525u + 1013904223u;
+						const PtrSize size = ((seed >> 16) % 16 == 0) ? (seed >> 16) % 1024 + 1 : (seed >> 16) % 128 + 1;
+
+						void*& slot = live[i % kLiveAllocations];
+						pool.free(slot);
+						slot = pool.allocate(size, 8);
+					}
+
+					for(void* ptr : live)
+					{
+						pool.free(ptr);
+					}
+				});
+			}
+			jobs.waitForAllTasksToFinish();
+			timer.stop();
+			return timer.getElapsedTime();
+		};
+
+		HeapMemoryPool passthroughPool(allocAligned, nullptr, "Passthrough");
+		const Second passthroughTime = run(passthroughPool);
+
+		HeapMemoryPool cachedPool(allocAligned, nullptr, "ThreadCached", HeapMemoryPoolMode::kThreadCached);
+		const Second cachedTime = run(cachedPool);
+
+		HeapMemoryPoolStats stats;
+		cachedPool.getStats(stats);
+		ANKI_TEST_LOGI("Heap pool bench (%u threads): passthrough %f thread cached %f | hit rate %f%%, reserved %lu KB", threadCount,
+					   passthroughTime, cachedTime, stats.getHitRate() * 100.0, stats.m_reservedBytes / 1024);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, MemoryPoolTelemetry)
+{
+	MemoryPoolTelemetry telemetry;
+	telemetry.init(allocAligned, nullptr, "Test");
+
+	// Use the callback directly
+	{
+		auto allocate = [&](PtrSize size, PtrSize alignment) {
+			return MemoryPoolTelemetry::allocCallback(&telemetry, nullptr, size, alignment);
+		};
+		auto free = [&](void* ptr) {
+			MemoryPoolTelemetry::allocCallback(&telemetry, ptr, 0, 0);
+		};
+
+		void* a = allocate(10, 1);
+		void* b = allocate(100, 64);
+		void* c = allocate(5000, 256);
+		ANKI_TEST_EXPECT_EQ(isAligned(64, b), true);
+		ANKI_TEST_EXPECT_EQ(isAligned(256, c), true);
+		memset(a, 1, 10);
+		memset(b, 2, 100);
+		memset(c, 3, 5000);
+
+		ANKI_TEST_EXPECT_EQ(telemetry.getLiveBytes(), 5110);
+		ANKI_TEST_EXPECT_EQ(telemetry.getLiveAllocationCount(), 3);
+
+		free(c);
+		ANKI_TEST_EXPECT_EQ(telemetry.getLiveBytes(), 110);
+		ANKI_TEST_EXPECT_EQ(telemetry.getPeakBytes(), 5110);
+
+		telemetry.endFrame();
+		ANKI_TEST_EXPECT_EQ(telemetry.getFrameAllocationCount(), 3);
+		ANKI_TEST_EXPECT_EQ(telemetry.getFrameFreeCount(), 1);
+
+		Array<U64, MemoryPoolTelemetry::kHistogramBucketCount> histogram;
+		telemetry.getFrameHistogram(histogram);
+		ANKI_TEST_EXPECT_EQ(histogram[0], 1); // 10 bytes
+		ANKI_TEST_EXPECT_EQ(histogram[3], 1); // [64, 128)
+		ANKI_TEST_EXPECT_EQ(histogram[9], 1); // [4096, 8192)
+		ANKI_TEST_EXPECT_EQ(MemoryPoolTelemetry::getHistogramBucketMinSize(3), 64);
+
+		free(a);
+		free(b);
+
+		telemetry.endFrame();
+		ANKI_TEST_EXPECT_EQ(telemetry.getFrameAllocationCount(), 0);
+		ANKI_TEST_EXPECT_EQ(telemetry.getFrameFreeCount(), 2);
+		ANKI_TEST_EXPECT_EQ(telemetry.getLiveBytes(), 0);
+	}
+
+	// Heap pool
+	{
+		HeapMemoryPool pool(MemoryPoolTelemetry::allocCallback, &telemetry, "Heap");
+		ANKI_TEST_EXPECT_EQ(pool.getTelemetry(), &telemetry);
+
+		void* a = pool.allocate(1000, 16);
+		ANKI_TEST_EXPECT_GEQ(telemetry.getLiveBytes(), 1000);
+		pool.free(a);
+	}
+	ANKI_TEST_EXPECT_EQ(telemetry.getLiveBytes(), 0);
+	ANKI_TEST_EXPECT_EQ(telemetry.getLiveAllocationCount(), 0);
+
+	// Pools that don't go through the telemetry
+	{
+		HeapMemoryPool pool(allocAligned, nullptr);
+		ANKI_TEST_EXPECT_EQ(pool.getTelemetry(), nullptr);
+	}
+
+	// The stack pool is tracked by its chunks
+	{
+		StackMemoryPool pool(MemoryPoolTelemetry::allocCallback, &telemetry, 1024);
+		pool.allocate(16, 16);
+		ANKI_TEST_EXPECT_GT(telemetry.getLiveBytes(), 1024);
+	}
+	ANKI_TEST_EXPECT_EQ(telemetry.getLiveBytes(), 0);
+
+	// Many threads
+	{
+		DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+		{
+			HeapMemoryPool pool(MemoryPoolTelemetry::allocCallback, &telemetry);
+			const U32 threadCount = max(4u, getCpuCoresCount());
+			ThreadJobManager jobs(threadCount);
+			const PtrSize peakBefore = telemetry.getPeakBytes();
+
+			for(U32 t = 0; t < threadCount; ++t)
+			{
+				jobs.dispatchTask([&pool](U32 threadId) {
+					Array<void*, 64> live;
+					for(U32 i = 0; i < 10000; ++i)
+					{
+						live[i % live.getSize()] = pool.allocate((i + threadId) % 256 + 1, 8);
+						if(i % live.getSize() == live.getSize() - 1)
+						{
+							for(void* ptr : live)
+							{
+								pool.free(ptr);
+							}
+						}
+					}
+
+					for(U32 i = 0; i < 10000 % live.getSize(); ++i)
+					{
+						pool.free(live[i]);
+					}
+				});
+			}
+			jobs.waitForAllTasksToFinish();
+
+			ANKI_TEST_EXPECT_EQ(telemetry.getLiveBytes(), 0);
+			ANKI_TEST_EXPECT_GEQ(telemetry.getPeakBytes(), peakBefore);
+		}
+
+		DefaultMemoryPool::freeSingleton();
+	}
+}
+
 ANKI_TEST(Util, StackMemoryPool)
 {
 	// Create/destroy test
@@ -157,3 +521,158 @@ ANKI_TEST(Util, StackMemoryPool)
 		}
 	}
 }
+
+ANKI_TEST(Util, FrameArenas)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Memory usage of the stack pool
+	{
+		StackMemoryPool pool(allocAligned, nullptr, 128, 1.0, 0, true, 16);
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), 0);
+
+		pool.allocate(10, 1);
+		pool.allocate(16, 16);
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), 32);
+
+		// Doesn't fit, will create a new chunk and the tail of the 1st counts as used
+		pool.allocate(100, 16);
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), 128 + 112);
+
+		pool.reset();
+		ANKI_TEST_EXPECT_EQ(pool.getMemoryUsage(), 0);
+	}
+
+	// Threads allocating from their arenas
+	{
+		constexpr U32 kAllocationsPerTask = 1024;
+		constexpr U32 kAllocationSize = 24;
+		constexpr U32 kTaskCount = 64;
+		const U32 threadCount = max(4u, getCpuCoresCount());
+
+		ThreadJobManager jobs(threadCount);
+		FrameArenas arenas;
+		arenas.init(allocAligned, nullptr, threadCount + 1, 1024, "Test");
+		ANKI_TEST_EXPECT_EQ(arenas.getThreadCount(), threadCount + 1);
+
+		Array<Array<U8*, kAllocationsPerTask>, kTaskCount> allocations;
+
+		for(U32 frame = 0; frame < 3; ++frame)
+		{
+			arenas.newFrame();
+
+			for(U32 task = 0; task < kTaskCount; ++task)
+			{
+				jobs.dispatchTask([&, task](U32 tid) {
+					StackMemoryPool& pool = arenas.getArena(tid);
+					for(U32 i = 0; i < kAllocationsPerTask; ++i)
+					{
+						U8* ptr = static_cast<U8*>(pool.allocate(kAllocationSize, 8));
+						memset(ptr, U8(task + frame), kAllocationSize);
+						allocations[task][i] = ptr;
+					}
+				});
+			}
+			jobs.waitForAllTasksToFinish();
+
+			// No allocation overlaps another
+			U32 errors = 0;
+			for(U32 task = 0; task < kTaskCount; ++task)
+			{
+				for(U8* ptr : allocations[task])
+				{
+					for(U32 k = 0; k < kAllocationSize; ++k)
+					{
+						errors += ptr[k] != U8(task + frame);
+					}
+				}
+			}
+			ANKI_TEST_EXPECT_EQ(errors, 0);
+
+			ANKI_TEST_EXPECT_GEQ(arenas.getMemoryUsage(), PtrSize(kTaskCount) * kAllocationsPerTask * kAllocationSize);
+			ANKI_TEST_EXPECT_GEQ(arenas.getMemoryCapacity(), arenas.getMemoryUsage());
+		}
+
+		// Only one thread allocates in a new frame. The high-water marks remember the previous frames
+		PtrSize maxHighWaterMark = 0;
+		for(U32 tid = 0; tid < arenas.getThreadCount(); ++tid)
+		{
+			maxHighWaterMark = max(maxHighWaterMark, arenas.getHighWaterMark(tid));
+		}
+		ANKI_TEST_EXPECT_GT(maxHighWaterMark, 0);
+
+		arenas.newFrame();
+		ANKI_TEST_EXPECT_EQ(arenas.getMemoryUsage(), 0);
+		arenas.getArena(0).allocate(16, 1);
+		ANKI_TEST_EXPECT_EQ(arenas.getMemoryUsage(), 16);
+
+		PtrSize maxHighWaterMark2 = 0;
+		for(U32 tid = 0; tid < arenas.getThreadCount(); ++tid)
+		{
+			maxHighWaterMark2 = max(maxHighWaterMark2, arenas.getHighWaterMark(tid));
+		}
+		ANKI_TEST_EXPECT_EQ(maxHighWaterMark2, maxHighWaterMark);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, FrameArenasBench)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		constexpr U32 kAllocationsPerTask = 64 * 1024;
+		constexpr U32 kFrameCount = 16;
+		const U32 threadCount = max(4u, getCpuCoresCount());
+		ThreadJobManager jobs(threadCount);
+
+		auto run = [&](auto newFrame, auto getPool) -> Second {
+			HighRezTimer timer;
+			timer.start();
+			for(U32 frame = 0; frame < kFrameCount; ++frame)
+			{
+				newFrame();
+				for(U32 t = 0; t < threadCount; ++t)
+				{
+					jobs.dispatchTask([&](U32 tid) {
+						StackMemoryPool& pool = getPool(tid);
+						for(U32 i = 0; i < kAllocationsPerTask; ++i)
+						{
+							// Small sizes like the ones of the component updates
+							U8* ptr = static_cast<U8*>(pool.allocate((i % 8 + 1) * 8, 8));
+							ptr[0] = U8(i);
+						}
+					});
+				}
+				jobs.waitForAllTasksToFinish();
+			}
+			timer.stop();
+			return timer.getElapsedTime();
+		};
+
+		StackMemoryPool sharedPool(allocAligned, nullptr, 1024 * 1024, 2.0, 0, true, ANKI_SAFE_ALIGNMENT, "Shared");
+		const Second sharedTime = run(
+			[&]() {
+				sharedPool.reset();
+			},
+			[&]([[maybe_unused]] U32 tid) -> StackMemoryPool& {
+				return sharedPool;
+			});
+
+		FrameArenas arenas;
+		arenas.init(allocAligned, nullptr, threadCount + 1, 256 * 1024, "Arenas");
+		const Second arenasTime = run(
+			[&]() {
+				arenas.newFrame();
+			},
+			[&](U32 tid) -> StackMemoryPool& {
+				return arenas.getArena(tid);
+			});
+
+		ANKI_TEST_LOGI("Frame memory bench (%u threads): shared StackMemoryPool %f FrameArenas %f | %f%%", threadCount, sharedTime, arenasTime,
+					   sharedTime / arenasTime * 100.0);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
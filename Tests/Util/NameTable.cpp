@@ -0,0 +1,129 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <Tests/Framework/Framework.h>
+#include <AnKi/Util/NameTable.h>
+#include <AnKi/Util/Thread.h>
+
+using namespace anki;
+
+ANKI_TEST(Util, NameTable)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	NameTable::allocateSingleton();
+
+	// Basic
+	{
+		const Name a("Foo");
+		const Name b("Bar");
+		const Name c(CString("Foo"));
+
+		ANKI_TEST_EXPECT_EQ(a.isValid(), true);
+		ANKI_TEST_EXPECT_EQ(b.isValid(), true);
+		ANKI_TEST_EXPECT_EQ(a == c, true);
+		ANKI_TEST_EXPECT_EQ(a != b, true);
+		ANKI_TEST_EXPECT_EQ(a.toCString(), "Foo");
+		ANKI_TEST_EXPECT_EQ(b.toCString(), "Bar");
+		ANKI_TEST_EXPECT_EQ(a.computeHash(), CString("Foo").computeHash());
+
+		ANKI_TEST_EXPECT_EQ(Name::find("Foo") == a, true);
+		ANKI_TEST_EXPECT_EQ(Name::find("NotInterned").isValid(), false);
+
+		const Name empty{CString()};
+		ANKI_TEST_EXPECT_EQ(empty.isValid(), false);
+		ANKI_TEST_EXPECT_EQ(empty.toCString().isEmpty(), true);
+		ANKI_TEST_EXPECT_EQ(Name() == empty, true);
+	}
+
+	// Many names to grow the buckets and the pages
+	{
+		constexpr U32 kCount = 100'000;
+		const U32 firstId = Name(CString("name_0")).getId();
+
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			Array<Char, 32> str;
+			snprintf(str.getBegin(), str.getSize(), "name_%u", i);
+			const Name name(str.getBegin());
+			ANKI_TEST_EXPECT_EQ(name.getId(), (i == 0) ? firstId : firstId + i);
+		}
+
+		for(U32 i = 0; i < kCount; i += 97)
+		{
+			Array<Char, 32> str;
+			snprintf(str.getBegin(), str.getSize(), "name_%u", i);
+			const Name name = Name::find(str.getBegin());
+			ANKI_TEST_EXPECT_EQ(name.getId(), firstId + i);
+			ANKI_TEST_EXPECT_EQ(name.toCString(), str.getBegin());
+		}
+	}
+
+	// Intern the same strings from many threads
+	{
+		constexpr U32 kThreadCount = 4;
+		constexpr U32 kCount = 10'000;
+
+		class Ctx
+		{
+		public:
+			Array<DynamicArray<U32>, kThreadCount> m_ids;
+			Atomic<U32> m_threadIdx = {0};
+		} ctx;
+
+		Array<Thread, kThreadCount> threads = {Thread(nullptr), Thread(nullptr), Thread(nullptr), Thread(nullptr)};
+		for(Thread& thread : threads)
+		{
+			thread.start(&ctx, [](ThreadCallbackInfo& info) -> Error {
+				Ctx& ctx = *static_cast<Ctx*>(info.m_userData);
+				DynamicArray<U32>& ids = ctx.m_ids[ctx.m_threadIdx.fetchAdd(1)];
+				for(U32 i = 0; i < kCount; ++i)
+				{
+					Array<Char, 32> str;
+					snprintf(str.getBegin(), str.getSize(), "threaded_%u", i);
+					const Name name(str.getBegin());
+					ids.emplaceBack(name.getId());
+					if(name.toCString() != str.getBegin())
+					{
+						return Error::kFunctionFailed;
+					}
+				}
+
+				return Error::kNone;
+			});
+		}
+
+		for(Thread& thread : threads)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(thread.join());
+		}
+
+		for(U32 t = 1; t < kThreadCount; ++t)
+		{
+			for(U32 i = 0; i < kCount; ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(ctx.m_ids[t][i], ctx.m_ids[0][i]);
+			}
+		}
+
+		for(DynamicArray<U32>& ids : ctx.m_ids)
+		{
+			ids.destroy();
+		}
+	}
+
+	// Freeing the table releases all names
+	{
+		ANKI_TEST_EXPECT_GT(NameTable::getSingleton().getNameCount(), 0);
+		NameTable::freeSingleton();
+		NameTable::allocateSingleton();
+
+		ANKI_TEST_EXPECT_EQ(NameTable::getSingleton().getNameCount(), 0);
+		ANKI_TEST_EXPECT_EQ(Name::find("Foo").isValid(), false);
+		ANKI_TEST_EXPECT_EQ(Name("Foo").getId(), 1);
+	}
+
+	NameTable::freeSingleton();
+	DefaultMemoryPool::freeSingleton();
+}
@@ -5,6 +5,8 @@
 
 #include <AnKi/Util/SegregatedListsAllocatorBuilder.h>
 #include <AnKi/Util/HighRezTimer.h>
+#include <AnKi/Util/System.h>
+#include <AnKi/Util/ThreadJobManager.h>
 #include <Tests/Framework/Framework.h>
 
 using namespace anki;
@@ -20,6 +22,8 @@ class SegregatedListsAllocatorBuilderInterface
 public:
 	HeapMemoryPool m_pool = {allocAligned, nullptr};
 	static constexpr PtrSize kChunkSize = 100_MB;
+	U32 m_maxChunkCount = kMaxU32;
+	U32 m_chunkCount = 0;
 
 	U32 getClassCount() const
 	{
@@ -34,6 +38,12 @@ public:
 
 	Error allocateChunk(SegregatedListsAllocatorBuilderChunk*& newChunk, PtrSize& chunkSize)
 	{
+		if(m_chunkCount == m_maxChunkCount)
+		{
+			return Error::kOutOfMemory;
+		}
+
+		++m_chunkCount;
 		newChunk = newInstance<SegregatedListsAllocatorBuilderChunk>(m_pool);
 		chunkSize = kChunkSize;
 		return Error::kNone;
@@ -41,6 +51,7 @@ public:
 
 	void deleteChunk(SegregatedListsAllocatorBuilderChunk* chunk)
 	{
+		--m_chunkCount;
 		deleteInstance(m_pool, chunk);
 	}
 
@@ -219,6 +230,37 @@ ANKI_TEST(Util, SegregatedListsAllocatorBuilder)
 		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
 	}
 
+	// Allocate without new chunks
+	{
+		SLAlloc sl;
+		sl.initBins(1_KB, 8);
+
+		SegregatedListsAllocatorBuilderChunk* chunk;
+		PtrSize address;
+		ANKI_TEST_EXPECT_EQ(sl.allocateWithoutNewChunk(64, 4, chunk, address), Error::kOutOfMemory);
+		ANKI_TEST_EXPECT_EQ(sl.getInterface().m_chunkCount, 0);
+
+		SegregatedListsAllocatorBuilderChunk* bigChunk;
+		PtrSize bigAddress;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(1_MB, 4, bigChunk, bigAddress));
+
+		// Gets a block that can go to the bins when it's freed
+		SegregatedListsAllocatorBuilderChunk* smallChunk;
+		PtrSize smallAddress;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocateWithoutNewChunk(40, 4, smallChunk, smallAddress));
+		ANKI_TEST_EXPECT_EQ(smallChunk, bigChunk);
+		ANKI_TEST_EXPECT_EQ(isAligned(16, smallAddress), true);
+
+		ANKI_TEST_EXPECT_EQ(sl.allocateWithoutNewChunk(SegregatedListsAllocatorBuilderInterface::kChunkSize, 4, chunk, address),
+							Error::kOutOfMemory);
+		ANKI_TEST_EXPECT_EQ(sl.getInterface().m_chunkCount, 1);
+
+		sl.free(smallChunk, smallAddress, 40);
+		sl.free(bigChunk, bigAddress, 1_MB);
+		sl.flushBins();
+		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
+	}
+
 	// Fuzzy test
 	fuzzyTest<true, 1024, false, true>();
 
@@ -231,3 +273,218 @@ ANKI_TEST(Util, SegregatedListsAllocatorBuilderBenchmark)
 	fuzzyTest<false, 2000000, true, false>();
 	DefaultMemoryPool::freeSingleton();
 }
+
+class SegregatedListsAllocatorBuilderTestAlloc
+{
+public:
+	SegregatedListsAllocatorBuilderChunk* m_chunk;
+	PtrSize m_address;
+	PtrSize m_size;
+};
+
+/// Many threads allocate and free small blocks.
+template<typename TAlloc>
+static void contentionTest(TAlloc& sl, U32 threadCount, U32 iterationCount, DynamicArray<SegregatedListsAllocatorBuilderTestAlloc>& survivors)
+{
+	Mutex survivorsMtx;
+	ThreadJobManager jobs(threadCount);
+
+	for(U32 t = 0; t < threadCount; ++t)
+	{
+		jobs.dispatchTask([&, t](U32) {
+			Array<SegregatedListsAllocatorBuilderTestAlloc, 128> live;
+			U32 liveCount = 0;
+			U32 seed = t * 7919 + 1;
+
+			for(U32 i = 0; i < iterationCount; ++i)
+			{
+				seed = seed * 1103515245 + 12345;
+				if(liveCount < live.getSize() && ((seed >> 16) % 3 != 0 || liveCount == 0))
+				{
+					SegregatedListsAllocatorBuilderTestAlloc& alloc = live[liveCount++];
+					alloc.m_size = (seed >> 8) % 600 + 1;
+					const PtrSize alignment = (seed & 1) ? 16 : 4;
+					ANKI_TEST_EXPECT_NO_ERR(sl.allocate(alloc.m_size, alignment, alloc.m_chunk, alloc.m_address));
+					ANKI_TEST_EXPECT_EQ(isAligned(alignment, alloc.m_address), true);
+				}
+				else
+				{
+					const U32 idx = (seed >> 16) % liveCount;
+					sl.free(live[idx].m_chunk, live[idx].m_address, live[idx].m_size);
+					live[idx] = live[--liveCount];
+				}
+			}
+
+			LockGuard lock(survivorsMtx);
+			for(U32 i = 0; i < liveCount; ++i)
+			{
+				survivors.emplaceBack(live[i]);
+			}
+		});
+	}
+
+	jobs.waitForAllTasksToFinish();
+}
+
+ANKI_TEST(Util, SegregatedListsAllocatorBuilderBins)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// Simple
+	{
+		SLAlloc sl;
+		sl.initBins(1_KB, 8);
+
+		SegregatedListsAllocatorBuilderChunk* chunk;
+		PtrSize address;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(40, 16, chunk, address));
+		ANKI_TEST_EXPECT_EQ(isAligned(16, address), true);
+
+		// Strict alignment goes around the bin but the block can still be cached when freed
+		SegregatedListsAllocatorBuilderChunk* chunk2;
+		PtrSize address2;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(40, 256, chunk2, address2));
+		ANKI_TEST_EXPECT_EQ(isAligned(256, address2), true);
+
+		SegregatedListsAllocatorBuilderChunk* chunk3;
+		PtrSize address3;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(40, 12, chunk3, address3));
+		ANKI_TEST_EXPECT_EQ(isAligned(12, address3), true);
+		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
+
+		sl.free(chunk, address, 40);
+		sl.free(chunk2, address2, 40);
+		sl.free(chunk3, address3, 40);
+
+		// Freed blocks are reused
+		SegregatedListsAllocatorBuilderChunk* chunk4;
+		PtrSize address4;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(48, 4, chunk4, address4));
+		ANKI_TEST_EXPECT_EQ(address4 == address || address4 == address2 || address4 == address3, true);
+		sl.free(chunk4, address4, 48);
+
+		sl.flushBins();
+		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
+	}
+
+	// Out of memory while the free memory is cached in a bin of another size
+	{
+		SLAlloc sl;
+		sl.initBins(4_KB, 64);
+		sl.getInterface().m_maxChunkCount = 1;
+
+		SegregatedListsAllocatorBuilderChunk* bigChunk;
+		PtrSize bigAddress;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(SegregatedListsAllocatorBuilderInterface::kChunkSize - 64_KB, 4, bigChunk, bigAddress));
+
+		// Use the rest of the chunk and move it to the 4K bin
+		Array<SegregatedListsAllocatorBuilderChunk*, 16> chunks;
+		Array<PtrSize, 16> addresses;
+		for(U32 i = 0; i < chunks.getSize(); ++i)
+		{
+			ANKI_TEST_EXPECT_NO_ERR(sl.allocate(4_KB, 4, chunks[i], addresses[i]));
+		}
+
+		for(U32 i = 0; i < chunks.getSize(); ++i)
+		{
+			sl.free(chunks[i], addresses[i], 4_KB);
+		}
+
+		SegregatedListsAllocatorBuilderChunk* chunk;
+		PtrSize address;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(8_KB, 4, chunk, address));
+		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
+
+		sl.free(chunk, address, 8_KB);
+		sl.free(bigChunk, bigAddress, SegregatedListsAllocatorBuilderInterface::kChunkSize - 64_KB);
+		sl.flushBins();
+		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
+	}
+
+	// The refill takes a single block from the free lists before it grows
+	{
+		SLAlloc sl;
+		sl.initBins(1_KB, 64);
+
+		SegregatedListsAllocatorBuilderChunk* bigChunk;
+		PtrSize bigAddress;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(SegregatedListsAllocatorBuilderInterface::kChunkSize - 64, 4, bigChunk, bigAddress));
+
+		SegregatedListsAllocatorBuilderChunk* chunk;
+		PtrSize address;
+		ANKI_TEST_EXPECT_NO_ERR(sl.allocate(48, 16, chunk, address));
+		ANKI_TEST_EXPECT_EQ(chunk, bigChunk);
+		ANKI_TEST_EXPECT_EQ(sl.getInterface().m_chunkCount, 1);
+
+		sl.free(chunk, address, 48);
+		sl.free(bigChunk, bigAddress, SegregatedListsAllocatorBuilderInterface::kChunkSize - 64);
+		sl.flushBins();
+		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
+	}
+
+	// Many threads and check that nothing overlaps
+	{
+		SLAlloc sl;
+		sl.initBins(SLAlloc::kMaxBinnedSize, 32);
+
+		DynamicArray<SegregatedListsAllocatorBuilderTestAlloc> survivors;
+		contentionTest(sl, max(4u, getCpuCoresCount()), 20000, survivors);
+
+		std::sort(survivors.getBegin(), survivors.getEnd(), [](const auto& a, const auto& b) {
+			return (a.m_chunk != b.m_chunk) ? a.m_chunk < b.m_chunk : a.m_address < b.m_address;
+		});
+
+		for(U32 i = 1; i < survivors.getSize(); ++i)
+		{
+			const SegregatedListsAllocatorBuilderTestAlloc& prev = survivors[i - 1];
+			const SegregatedListsAllocatorBuilderTestAlloc& crnt = survivors[i];
+			if(prev.m_chunk == crnt.m_chunk)
+			{
+				ANKI_TEST_EXPECT_LEQ(prev.m_address + prev.m_size, crnt.m_address);
+			}
+		}
+
+		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
+
+		for(const SegregatedListsAllocatorBuilderTestAlloc& alloc : survivors)
+		{
+			sl.free(alloc.m_chunk, alloc.m_address, alloc.m_size);
+		}
+
+		sl.flushBins();
+		ANKI_TEST_EXPECT_NO_ERR(sl.validate());
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, SegregatedListsAllocatorBuilderContentionBenchmark)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	const U32 threadCount = max(4u, getCpuCoresCount());
+	constexpr U32 kIterationCount = 200000;
+
+	for(U32 withBins = 0; withBins < 2; ++withBins)
+	{
+		SLAlloc sl;
+		if(withBins)
+		{
+			sl.initBins(SLAlloc::kMaxBinnedSize, 128);
+		}
+
+		DynamicArray<SegregatedListsAllocatorBuilderTestAlloc> survivors;
+		const Second start = HighRezTimer::getCurrentTime();
+		contentionTest(sl, threadCount, kIterationCount, survivors);
+		const Second dt = HighRezTimer::getCurrentTime() - start;
+
+		ANKI_TEST_LOGI("%s: %u threads, operations/sec %f", (withBins) ? "Bins" : "Lock only", threadCount, F64(threadCount * kIterationCount) / dt);
+
+		for(const SegregatedListsAllocatorBuilderTestAlloc& alloc : survivors)
+		{
+			sl.free(alloc.m_chunk, alloc.m_address, alloc.m_size);
+		}
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -336,6 +336,78 @@ static ANKI_DONT_INLINE void* allocAlignedStl([[maybe_unused]] void* userData, v
 	}
 }
 
+ANKI_TEST(Util, SparseArrayCompact)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		SparseArray<SAFoo, SingletonMemoryPoolWrapper<DefaultMemoryPool>, Config<U32>> arr(Config<U32>{64, 8, 0.8f});
+		std::unordered_map<U32, int> map;
+
+		constexpr U32 kCount = 2000;
+		for(U32 i = 0; i < kCount; ++i)
+		{
+			const U32 key = U32(getRandom());
+			if(map.find(key) == map.end())
+			{
+				arr.emplace(key, int(i));
+				map[key] = int(i);
+			}
+		}
+
+		// Remove most of them
+		U32 i = 0;
+		for(auto it = map.begin(); it != map.end();)
+		{
+			if((i++ % 16) != 0)
+			{
+				arr.erase(arr.find(it->first));
+				it = map.erase(it);
+			}
+			else
+			{
+				++it;
+			}
+		}
+		arr.validate();
+
+		// Iterate the sparse storage
+		auto checkContents = [&]() {
+			U32 count = 0;
+			I64 sum = 0;
+			for(const SAFoo& foo : arr)
+			{
+				sum += foo.m_x;
+				++count;
+			}
+			ANKI_TEST_EXPECT_EQ(count, map.size());
+
+			I64 sum2 = 0;
+			for(auto it : map)
+			{
+				ANKI_TEST_EXPECT_EQ(arr.find(it.first)->m_x, it.second);
+				sum2 += it.second;
+			}
+			ANKI_TEST_EXPECT_EQ(sum, sum2);
+		};
+		checkContents();
+
+		// Shrink
+		arr.compact();
+		arr.validate();
+		checkContents();
+
+		// Keep using it
+		arr.emplace(123, 321);
+		map[123] = 321;
+		arr.validate();
+		checkContents();
+	}
+	SAFoo::checkCalls();
+
+	DefaultMemoryPool::freeSingleton();
+}
+
 ANKI_TEST(Util, SparseArrayBench)
 {
 	HeapMemoryPool pool(allocAlignedAk, nullptr);
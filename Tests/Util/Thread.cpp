@@ -8,6 +8,7 @@
 #include <AnKi/Util/StdTypes.h>
 #include <AnKi/Util/HighRezTimer.h>
 #include <AnKi/Util/ThreadPool.h>
+#include <AnKi/Util/System.h>
 #include <cstring>
 
 ANKI_TEST(Util, Thread)
@@ -191,3 +192,168 @@ ANKI_TEST(Util, Barrier)
 		ANKI_TEST_EXPECT_NO_ERR(t.join());
 	}
 }
+
+ANKI_TEST(Util, TreeBarrier)
+{
+	// More threads than the old 32 limit and a count that doesn't fill the tree
+	constexpr U32 kThreadCount = 37;
+	constexpr U32 kRoundCount = 200;
+
+	class Ctx
+	{
+	public:
+		TreeBarrier m_barrier = {kThreadCount, 4};
+		Atomic<U32> m_counter = {0};
+		Atomic<U32> m_errors = {0};
+		Atomic<U32> m_threadIdx = {0};
+	} ctx;
+
+	auto callback = [](ThreadCallbackInfo& info) -> Error {
+		Ctx& ctx = *static_cast<Ctx*>(info.m_userData);
+		const U32 threadIdx = ctx.m_threadIdx.fetchAdd(1);
+
+		for(U32 round = 0; round < kRoundCount; ++round)
+		{
+			ctx.m_counter.fetchAdd(1);
+			ctx.m_barrier.wait(threadIdx);
+
+			// Everyone incremented the counter of this round and no one started the next one
+			if(ctx.m_counter.load() != (round + 1) * kThreadCount)
+			{
+				ctx.m_errors.fetchAdd(1);
+			}
+
+			ctx.m_barrier.wait(threadIdx);
+		}
+
+		return Error::kNone;
+	};
+
+	Array<Thread*, kThreadCount - 1> threads;
+	for(Thread*& thread : threads)
+	{
+		thread = new Thread("TreeBarrier");
+		thread->start(&ctx, callback);
+	}
+
+	ThreadCallbackInfo info;
+	info.m_userData = &ctx;
+	ANKI_TEST_EXPECT_NO_ERR(callback(info));
+
+	for(Thread* thread : threads)
+	{
+		ANKI_TEST_EXPECT_NO_ERR(thread->join());
+		delete thread;
+	}
+
+	ANKI_TEST_EXPECT_EQ(ctx.m_errors.load(), 0);
+	ANKI_TEST_EXPECT_EQ(ctx.m_counter.load(), kThreadCount * kRoundCount);
+}
+
+ANKI_TEST(Util, ThreadPoolScalingBench)
+{
+	// Run the same amount of work with 1 to N threads. N is more than the old 32 thread limit. Keep it small, it runs with the rest of the tests
+	constexpr U32 kProblemSize = 4 * 1024 * 1024;
+	constexpr U32 kDispatchCount = 16;
+
+	class Task : public ThreadPoolTask
+	{
+	public:
+		U64 m_result = 0;
+
+		Error operator()(U32 taskId, PtrSize threadsCount) final
+		{
+			U32 start, end;
+			splitThreadedProblem(taskId, U32(threadsCount), kProblemSize / kDispatchCount, start, end);
+
+			U64 result = 0;
+			for(U32 i = start; i < end; ++i)
+			{
+				result += (U64(i) * 2654435761u) >> 7;
+			}
+
+			m_result = result;
+			return Error::kNone;
+		}
+	};
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	// 1, 2, 4 ... and lastly the max
+	const U32 maxThreadCount = max(getCpuCoresCount(), 33u);
+	U32 threadCount = 1;
+	while(threadCount <= maxThreadCount)
+	{
+		ThreadPool pool(threadCount);
+		DynamicArray<Task> tasks;
+		tasks.resize(threadCount);
+
+		const Second start = HighRezTimer::getCurrentTime();
+		for(U32 dispatch = 0; dispatch < kDispatchCount; ++dispatch)
+		{
+			for(U32 i = 0; i < threadCount; ++i)
+			{
+				pool.assignNewTask(i, &tasks[i]);
+			}
+
+			ANKI_TEST_EXPECT_NO_ERR(pool.waitForAllThreadsToFinish());
+		}
+		const Second time = HighRezTimer::getCurrentTime() - start;
+
+		ANKI_TEST_LOGI("%u threads: %f ms, %f Melements/sec, %f dispatches/sec", threadCount, time * 1000.0, F64(kProblemSize) / time / 1000000.0,
+					   F64(kDispatchCount) / time);
+
+		threadCount = (threadCount < maxThreadCount) ? min(threadCount * 2, maxThreadCount) : maxThreadCount + 1;
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, CpuTopology)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	{
+		CpuTopology topology;
+		getCpuTopology(topology);
+
+		ANKI_TEST_EXPECT_EQ(topology.m_logicalCores.getSize(), getCpuCoresCount());
+		ANKI_TEST_EXPECT_GT(topology.m_physicalCoreCount, 0);
+		ANKI_TEST_EXPECT_LEQ(topology.m_physicalCoreCount, topology.m_logicalCores.getSize());
+		ANKI_TEST_EXPECT_GT(topology.m_l3DomainCount, 0);
+		ANKI_TEST_EXPECT_GT(topology.m_numaNodeCount, 0);
+
+		for(const CpuLogicalCoreInfo& info : topology.m_logicalCores)
+		{
+			ANKI_TEST_LOGI("Logical core %u: physical core %u, SMT %u, L3 %u, NUMA %u", info.m_logicalCoreId, info.m_physicalCore, info.m_smtIndex,
+						   info.m_l3Domain, info.m_numaNode);
+			ANKI_TEST_EXPECT_LT(info.m_physicalCore, topology.m_physicalCoreCount);
+			ANKI_TEST_EXPECT_LT(info.m_l3Domain, topology.m_l3DomainCount);
+		}
+
+		// Every policy should use every logical core once before wrapping around
+		const U32 threadCount = topology.m_logicalCores.getSize() * 2;
+		for(ThreadPlacementPolicy policy : {ThreadPlacementPolicy::kCompact, ThreadPlacementPolicy::kScatter, ThreadPlacementPolicy::kSkipSmtSiblings})
+		{
+			DynamicArray<ThreadCoreAffinityMask> affinities;
+			computeThreadPlacement(policy, threadCount, affinities);
+			ANKI_TEST_EXPECT_EQ(affinities.getSize(), threadCount);
+
+			ThreadCoreAffinityMask all(false);
+			for(U32 i = 0; i < topology.m_logicalCores.getSize(); ++i)
+			{
+				ANKI_TEST_EXPECT_EQ(affinities[i].getSetBitCount(), 1);
+				ANKI_TEST_EXPECT_EQ((all & affinities[i]).getSetBitCount(), 0);
+				all |= affinities[i];
+			}
+			ANKI_TEST_EXPECT_EQ(all.getSetBitCount(), topology.m_logicalCores.getSize());
+		}
+
+		DynamicArray<ThreadCoreAffinityMask> affinities;
+		computeThreadPlacement(ThreadPlacementPolicy::kNone, 4, affinities);
+		ANKI_TEST_EXPECT_EQ(affinities.getSize(), 4);
+		ANKI_TEST_EXPECT_EQ(affinities[0].getSetBitCount(), 0);
+	}
+
+	DefaultMemoryPool::freeSingleton();
+}
@@ -63,9 +63,11 @@ static void taskToWait(void* arg, [[maybe_unused]] U32 threadId, [[maybe_unused]
 
 ANKI_TEST(Util, ThreadHive)
 {
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
 	const U32 threadCount = 32;
-	HeapMemoryPool pool(allocAligned, nullptr);
-	ThreadHive hive(threadCount, &pool);
+	ThreadHive* hivePtr = newInstance<ThreadHive>(DefaultMemoryPool::getSingleton(), threadCount);
+	ThreadHive& hive = *hivePtr;
 
 	// Simple test
 	if(1)
@@ -170,6 +172,28 @@ ANKI_TEST(Util, ThreadHive)
 
 		ANKI_TEST_EXPECT_EQ(ctx.m_countAtomic.getNonAtomically(), number);
 	}
+
+	// Nested submissions from many threads recycle the task nodes
+	if(1)
+	{
+		ThreadHiveTestContext ctx;
+		ctx.m_count = 0;
+
+		for(U32 frame = 0; frame < 10; ++frame)
+		{
+			for(U32 i = 0; i < 1000; ++i)
+			{
+				hive.submitTask(incNumber, &ctx);
+			}
+
+			hive.waitAllTasks();
+		}
+
+		ANKI_TEST_EXPECT_EQ(ctx.m_countAtomic.getNonAtomically(), 10 * 1000 * 2);
+	}
+
+	deleteInstance(DefaultMemoryPool::getSingleton(), hivePtr);
+	DefaultMemoryPool::freeSingleton();
 }
 
 namespace {
@@ -232,9 +256,11 @@ ANKI_TEST(Util, ThreadHiveBench)
 {
 	static const U FIB_N = 32;
 
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
 	const U32 threadCount = getCpuCoresCount();
-	HeapMemoryPool pool(allocAligned, nullptr);
-	ThreadHive hive(threadCount, true);
+	ThreadHive* hivePtr = newInstance<ThreadHive>(DefaultMemoryPool::getSingleton(), threadCount, ThreadPlacementPolicy::kSkipSmtSiblings);
+	ThreadHive& hive = *hivePtr;
 
 	StackAllocator<U8> salloc(allocAligned, nullptr, 1024);
 	Atomic<U64> sum = {0};
@@ -250,4 +276,80 @@ ANKI_TEST(Util, ThreadHiveBench)
 
 	ANKI_TEST_LOGI("Total time %fms. Ground truth %fms", (timeB - timeA) * 1000.0, (timeC - timeB) * 1000.0);
 	ANKI_TEST_EXPECT_EQ(sum.getNonAtomically(), serialFib);
+
+	deleteInstance(DefaultMemoryPool::getSingleton(), hivePtr);
+	DefaultMemoryPool::freeSingleton();
+}
+
+ANKI_TEST(Util, ThreadHiveThroughputBench)
+{
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	constexpr U32 kFrameCount = 64;
+	constexpr U32 kTasksPerFrame = 16 * 1024;
+	constexpr U32 kBatchSize = 8;
+
+	const U32 threadCount = getCpuCoresCount();
+	ThreadHive* hive = newInstance<ThreadHive>(DefaultMemoryPool::getSingleton(), threadCount);
+
+	Atomic<U32> counter = {0};
+	ThreadHiveTaskCallback callback = [](void* arg, [[maybe_unused]] U32 threadId, [[maybe_unused]] ThreadHive& hive,
+										 [[maybe_unused]] ThreadHiveSemaphore* sem) {
+		static_cast<Atomic<U32>*>(arg)->fetchAdd(1);
+	};
+
+	// Tiny tasks submitted one by one from the main thread
+	Second timeA = HighRezTimer::getCurrentTime();
+	for(U32 frame = 0; frame < kFrameCount; ++frame)
+	{
+		for(U32 i = 0; i < kTasksPerFrame; ++i)
+		{
+			hive->submitTask(callback, &counter);
+		}
+
+		hive->waitAllTasks();
+	}
+	Second timeB = HighRezTimer::getCurrentTime();
+	ANKI_TEST_EXPECT_EQ(counter.getNonAtomically(), kFrameCount * kTasksPerFrame);
+	ANKI_TEST_LOGI("Single submissions: %f Mtasks/sec", F64(kFrameCount * kTasksPerFrame) / (timeB - timeA) / 1000000.0);
+
+	// Tiny tasks submitted in batches from the workers
+	class Ctx
+	{
+	public:
+		Atomic<U32>* m_counter;
+		ThreadHiveTaskCallback m_leafCallback;
+	} ctx = {&counter, callback};
+
+	ThreadHiveTaskCallback spawnCallback = [](void* arg, [[maybe_unused]] U32 threadId, ThreadHive& hive,
+											  [[maybe_unused]] ThreadHiveSemaphore* sem) {
+		Ctx& ctx = *static_cast<Ctx*>(arg);
+		Array<ThreadHiveTask, kBatchSize> tasks;
+		for(ThreadHiveTask& task : tasks)
+		{
+			task.m_callback = ctx.m_leafCallback;
+			task.m_argument = ctx.m_counter;
+		}
+
+		hive.submitTasks(&tasks[0], tasks.getSize());
+	};
+
+	counter.setNonAtomically(0);
+	timeA = HighRezTimer::getCurrentTime();
+	for(U32 frame = 0; frame < kFrameCount; ++frame)
+	{
+		for(U32 i = 0; i < kTasksPerFrame / kBatchSize; ++i)
+		{
+			hive->submitTask(spawnCallback, &ctx);
+		}
+
+		hive->waitAllTasks();
+	}
+	timeB = HighRezTimer::getCurrentTime();
+	ANKI_TEST_EXPECT_EQ(counter.getNonAtomically(), kFrameCount * kTasksPerFrame);
+	ANKI_TEST_LOGI("Nested batched submissions: %f Mtasks/sec",
+				   F64(kFrameCount * (kTasksPerFrame + kTasksPerFrame / kBatchSize)) / (timeB - timeA) / 1000000.0);
+
+	deleteInstance(DefaultMemoryPool::getSingleton(), hive);
+	DefaultMemoryPool::freeSingleton();
 }
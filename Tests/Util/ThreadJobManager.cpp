@@ -19,7 +19,7 @@ ANKI_TEST(Util, ThreadJobManager)
 	{
 		constexpr U32 kTaskCount = 64;
 
-		ThreadJobManager manager(getCpuCoresCount(), true, 16);
+		ThreadJobManager manager(getCpuCoresCount(), ThreadPlacementPolicy::kCompact, 16);
 
 		Atomic<U32> atomic(0);
 
@@ -36,6 +36,116 @@ ANKI_TEST(Util, ThreadJobManager)
 		ANKI_TEST_EXPECT_EQ(atomic.load(), kTaskCount);
 	}
 
+	// Overflow the queues and dispatch from the workers as well
+	{
+		constexpr U32 kTaskCount = 1024;
+		constexpr U32 kChildTaskCount = 8;
+
+		ThreadJobManager manager(getCpuCoresCount(), ThreadPlacementPolicy::kNone, 4);
+
+		Atomic<U32> atomic(0);
+
+		for(U32 i = 0; i < kTaskCount; ++i)
+		{
+			manager.dispatchTask([&atomic, &manager]([[maybe_unused]] U32 tid) {
+				ANKI_ASSERT(tid < manager.getThreadCount() + 1);
+
+				for(U32 j = 0; j < kChildTaskCount; ++j)
+				{
+					manager.dispatchTask([&atomic]([[maybe_unused]] U32 tid) {
+						atomic.fetchAdd(1);
+					});
+				}
+
+				atomic.fetchAdd(1);
+			});
+		}
+
+		manager.waitForAllTasksToFinish();
+
+		ANKI_TEST_EXPECT_EQ(atomic.load(), kTaskCount * (kChildTaskCount + 1));
+	}
+
+	// Dependencies
+	{
+		ThreadJobManager manager(getCpuCoresCount(), ThreadPlacementPolicy::kNone, 16);
+
+		Atomic<U32> stage(0);
+		Atomic<U32> errors(0);
+
+		ThreadJobHandle first = manager.dispatchTask([&stage]([[maybe_unused]] U32 tid) {
+			HighRezTimer::sleep(100.0_ms);
+			stage.store(1);
+		});
+
+		Array<ThreadJobHandle, 8> forks;
+		for(ThreadJobHandle& fork : forks)
+		{
+			fork = manager.dispatchTask(
+				[&stage, &errors]([[maybe_unused]] U32 tid) {
+					if(stage.load() != 1)
+					{
+						errors.fetchAdd(1);
+					}
+				},
+				ConstWeakArray<ThreadJobHandle>(&first, 1));
+		}
+
+		ThreadJobHandle join = manager.dispatchTask(
+			[&stage]([[maybe_unused]] U32 tid) {
+				stage.store(2);
+			},
+			forks);
+
+		manager.waitForTask(join);
+		ANKI_TEST_EXPECT_EQ(join->isFinished(), true);
+		ANKI_TEST_EXPECT_EQ(stage.load(), 2);
+		ANKI_TEST_EXPECT_EQ(errors.load(), 0);
+
+		// Depending on a finished task shouldn't block
+		ThreadJobHandle last = manager.dispatchTask(
+			[&stage]([[maybe_unused]] U32 tid) {
+				stage.store(3);
+			},
+			ConstWeakArray<ThreadJobHandle>(&join, 1));
+		manager.waitForTask(last);
+		ANKI_TEST_EXPECT_EQ(stage.load(), 3);
+	}
+
+	// Parallel for
+	{
+		constexpr U32 kElementCount = 10000;
+
+		ThreadJobManager manager(getCpuCoresCount());
+
+		DynamicArray<U32> elements;
+		elements.resize(kElementCount, 0);
+
+		for(U32 grainSize : {0u, 1u, 7u, kElementCount * 2})
+		{
+			ThreadJobHandle handle = manager.parallelFor(0, kElementCount, grainSize, [&elements](U32 begin, U32 end, [[maybe_unused]] U32 tid) {
+				for(U32 i = begin; i < end; ++i)
+				{
+					++elements[i];
+				}
+			});
+
+			manager.waitForTask(handle);
+		}
+
+		// Empty range
+		manager.waitForTask(manager.parallelFor(10, 10, 0, [](U32, U32, U32) {
+			ANKI_ASSERT(!"Shouldn't be called");
+		}));
+
+		U32 wrongCount = 0;
+		for(U32 e : elements)
+		{
+			wrongCount += (e != 4);
+		}
+		ANKI_TEST_EXPECT_EQ(wrongCount, 0);
+	}
+
 	DefaultMemoryPool::freeSingleton();
 }
 
@@ -48,7 +158,7 @@ ANKI_TEST(Util, ThreadJobManagerBench)
 	{
 		constexpr U32 kTaskCount = 20 * 1024 * 1024;
 
-		ThreadJobManager manager(getCpuCoresCount(), true, 256);
+		ThreadJobManager manager(getCpuCoresCount(), ThreadPlacementPolicy::kCompact, 256);
 
 		Atomic<U32> atomic(0);
 
@@ -0,0 +1,208 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Util/BinaryLogReader.h>
+#include <cstdio>
+#include <cinttypes>
+
+using namespace anki;
+
+static const char* kUsage = R"(Decode a binary log to text or to Chrome trace JSON
+Usage: %s [options] input_binary_log
+Options:
+-o <filename> : Output filename. By default it prints to stdout
+-json         : Write Chrome trace JSON. By default it writes text
+)";
+
+inline constexpr Array<const Char*, U(LoggerMessageType::kCount)> kMessageTypeTxt = {"I", "V", "E", "W", "F"};
+
+static Error parseCommandLineArgs(WeakArray<char*> argv, Bool& json, String& outFilename, String& filename)
+{
+	if(argv.getSize() < 2)
+	{
+		return Error::kUserData;
+	}
+
+	json = false;
+	filename = argv[argv.getSize() - 1];
+
+	for(U32 i = 1; i < argv.getSize() - 1; i++)
+	{
+		if(CString(argv[i]) == "-json")
+		{
+			json = true;
+		}
+		else if(CString(argv[i]) == "-o")
+		{
+			++i;
+			if(i >= argv.getSize() - 1)
+			{
+				return Error::kUserData;
+			}
+
+			outFilename = argv[i];
+		}
+		else
+		{
+			return Error::kUserData;
+		}
+	}
+
+	return Error::kNone;
+}
+
+static CString orNa(CString str)
+{
+	return (str.isEmpty()) ? "N/A" : str;
+}
+
+static String escapeJson(CString str)
+{
+	String out;
+	for(const Char* c = str.cstr(); c && *c; ++c)
+	{
+		if(*c == '"' || *c == '\\')
+		{
+			const Char escaped[3] = {'\\', *c, '\0'};
+			out += escaped;
+		}
+		else if(U8(*c) < 0x20)
+		{
+			out += " ";
+		}
+		else
+		{
+			const Char chr[2] = {*c, '\0'};
+			out += chr;
+		}
+	}
+
+	return out;
+}
+
+static void writeText(const BinaryLogReader& reader, FILE* out)
+{
+	for(const BinaryLogReader::Message& msg : reader.getMessages())
+	{
+		const CString threadName =
+			(msg.m_threadIdx < reader.getThreads().getSize()) ? reader.getThreads()[msg.m_threadIdx].m_name.toCString() : CString();
+
+		fprintf(out, "[%.6f][%s][%-4s] %s [%s:%d][%s][%s]\n", msg.m_time, kMessageTypeTxt[msg.m_type], orNa(msg.m_subsystem).cstr(),
+				orNa(msg.m_text).cstr(), orNa(msg.m_file).cstr(), msg.m_line, orNa(msg.m_func).cstr(), orNa(threadName).cstr());
+	}
+
+	for(const BinaryLogReader::TraceEvent& event : reader.getTraceEvents())
+	{
+		fprintf(out, "[%.6f][TRACE] %s %fms [%u]\n", event.m_start, orNa(event.m_name).cstr(), event.m_duration * 1000.0,
+				event.m_threadIdx);
+	}
+
+	for(const BinaryLogReader::Counter& counter : reader.getCounters())
+	{
+		fprintf(out, "[%.6f][COUNTER] %s %" PRIu64 " [%u]\n", counter.m_time, orNa(counter.m_name).cstr(), counter.m_value,
+				counter.m_threadIdx);
+	}
+}
+
+static void writeJson(const BinaryLogReader& reader, FILE* out)
+{
+	fprintf(out, "[\n");
+
+	auto getTid = [&](U32 threadIdx) -> U64 {
+		return (threadIdx < reader.getThreads().getSize()) ? reader.getThreads()[threadIdx].m_tid : threadIdx;
+	};
+
+	for(const BinaryLogReader::ThreadInfo& thread : reader.getThreads())
+	{
+		fprintf(out, "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %" PRIu64 ", \"args\": {\"name\": \"%s\"}},\n",
+				thread.m_tid, escapeJson(orNa(thread.m_name)).cstr());
+	}
+
+	for(const BinaryLogReader::TraceEvent& event : reader.getTraceEvents())
+	{
+		fprintf(out, "{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"X\", \"pid\": 1, \"tid\": %" PRIu64 ", \"ts\": %" PRIi64
+				", \"dur\": %" PRIi64 "},\n",
+				escapeJson(orNa(event.m_name)).cstr(), getTid(event.m_threadIdx), I64(event.m_start * 1000000.0),
+				I64(event.m_duration * 1000000.0));
+	}
+
+	for(const BinaryLogReader::Counter& counter : reader.getCounters())
+	{
+		fprintf(out, "{\"name\": \"%s\", \"cat\": \"PERF\", \"ph\": \"C\", \"pid\": 1, \"tid\": %" PRIu64 ", \"ts\": %" PRIi64
+				", \"args\": {\"value\": %" PRIu64 "}},\n",
+				escapeJson(orNa(counter.m_name)).cstr(), getTid(counter.m_threadIdx), I64(counter.m_time * 1000000.0),
+				counter.m_value);
+	}
+
+	for(const BinaryLogReader::Message& msg : reader.getMessages())
+	{
+		fprintf(out, "{\"name\": \"%s\", \"cat\": \"LOG\", \"ph\": \"i\", \"s\": \"t\", \"pid\": 1, \"tid\": %" PRIu64
+				", \"ts\": %" PRIi64 ", \"args\": {\"type\": \"%s\", \"subsystem\": \"%s\", \"location\": \"%s:%d %s\"}},\n",
+				escapeJson(orNa(msg.m_text)).cstr(), getTid(msg.m_threadIdx), I64(msg.m_time * 1000000.0),
+				kMessageTypeTxt[msg.m_type], escapeJson(orNa(msg.m_subsystem)).cstr(), escapeJson(orNa(msg.m_file)).cstr(),
+				msg.m_line, escapeJson(orNa(msg.m_func)).cstr());
+	}
+
+	// Chrome doesn't care about the trailing comma but close the array with an empty object to be valid JSON
+	fprintf(out, "{}\n]\n");
+}
+
+ANKI_MAIN_FUNCTION(myMain)
+int myMain(int argc, char** argv)
+{
+	class Dummy
+	{
+	public:
+		~Dummy()
+		{
+			DefaultMemoryPool::freeSingleton();
+		}
+	} dummy;
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	Bool json;
+	String outFilename;
+	String filename;
+	if(parseCommandLineArgs(WeakArray<char*>(argv, argc), json, outFilename, filename))
+	{
+		ANKI_LOGE(kUsage, argv[0]);
+		return 1;
+	}
+
+	BinaryLogReader reader;
+	if(reader.load(filename))
+	{
+		ANKI_LOGE("Failed to load the binary log: %s", filename.cstr());
+		return 1;
+	}
+
+	FILE* out = stdout;
+	if(!outFilename.isEmpty())
+	{
+		out = fopen(outFilename.cstr(), "w");
+		if(!out)
+		{
+			ANKI_LOGE("Failed to open the output file: %s", outFilename.cstr());
+			return 1;
+		}
+	}
+
+	if(json)
+	{
+		writeJson(reader, out);
+	}
+	else
+	{
+		writeText(reader, out);
+	}
+
+	if(out != stdout)
+	{
+		fclose(out);
+	}
+
+	return 0;
+}
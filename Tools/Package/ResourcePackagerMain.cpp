@@ -0,0 +1,109 @@
+// Copyright (C) 2009-present, Panagiotis Christopoulos Charitos and contributors.
+// All rights reserved.
+// Code licensed under the BSD License.
+// http://www.anki3d.org/LICENSE
+
+#include <AnKi/Resource/ResourcePackage.h>
+#include <AnKi/Util/WeakArray.h>
+
+using namespace anki;
+
+static const char* kUsage = R"(Pack a directory into a resource package (.ankipak)
+Usage: %s [options] input_dir output_package
+Options:
+-b <KB> : The uncompressed size of the blocks in KB. Default is 128
+-l <0-9>: zlib compression level. Default is 9
+-v      : Verbose log
+)";
+
+static Error parseCommandLineArgs(WeakArray<char*> argv, U32& blockSize, U32& compressionLevel, String& inputDir, String& outFilename)
+{
+	if(argv.getSize() < 3)
+	{
+		return Error::kUserData;
+	}
+
+	blockSize = kDefaultResourcePackageBlockSize;
+	compressionLevel = 9;
+	inputDir = argv[argv.getSize() - 2];
+	outFilename = argv[argv.getSize() - 1];
+
+	for(U32 i = 1; i < argv.getSize() - 2; i++)
+	{
+		if(CString(argv[i]) == "-b")
+		{
+			++i;
+			if(i >= argv.getSize() - 2)
+			{
+				return Error::kUserData;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(blockSize));
+			if(blockSize == 0 || blockSize > 16_MB / 1_KB)
+			{
+				return Error::kUserData;
+			}
+
+			blockSize *= U32(1_KB);
+		}
+		else if(CString(argv[i]) == "-l")
+		{
+			++i;
+			if(i >= argv.getSize() - 2)
+			{
+				return Error::kUserData;
+			}
+
+			ANKI_CHECK(CString(argv[i]).toNumber(compressionLevel));
+			if(compressionLevel > 9)
+			{
+				return Error::kUserData;
+			}
+		}
+		else if(CString(argv[i]) == "-v")
+		{
+			Logger::getSingleton().enableVerbosity(true);
+		}
+		else
+		{
+			return Error::kUserData;
+		}
+	}
+
+	return Error::kNone;
+}
+
+ANKI_MAIN_FUNCTION(myMain)
+int myMain(int argc, char** argv)
+{
+	class Dummy
+	{
+	public:
+		~Dummy()
+		{
+			ResourceMemoryPool::freeSingleton();
+			DefaultMemoryPool::freeSingleton();
+		}
+	} dummy;
+
+	DefaultMemoryPool::allocateSingleton(allocAligned, nullptr);
+	ResourceMemoryPool::allocateSingleton(allocAligned, nullptr);
+
+	U32 blockSize;
+	U32 compressionLevel;
+	String inputDir;
+	String outFilename;
+	if(parseCommandLineArgs(WeakArray<char*>(argv, argc), blockSize, compressionLevel, inputDir, outFilename))
+	{
+		ANKI_LOGE(kUsage, argv[0]);
+		return 1;
+	}
+
+	if(buildResourcePackage(inputDir, outFilename, blockSize, compressionLevel))
+	{
+		ANKI_LOGE("Failed to build the package: %s", outFilename.cstr());
+		return 1;
+	}
+
+	return 0;
+}
@@ -211,8 +211,11 @@ static Error work(const CmdLineArgs& info)
 			return Error::kNone;
 		}
 	} taskManager;
-	taskManager.m_jobManager.reset((info.m_threadCount) ? newInstance<ThreadJobManager>(DefaultMemoryPool::getSingleton(), info.m_threadCount, true)
-														: nullptr);
+	if(info.m_threadCount)
+	{
+		taskManager.m_jobManager.reset(
+			newInstance<ThreadJobManager>(DefaultMemoryPool::getSingleton(), info.m_threadCount, ThreadPlacementPolicy::kSkipSmtSiblings));
+	}
 
 	// Compile
 	ShaderBinary* binary = nullptr;